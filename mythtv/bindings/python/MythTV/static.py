@@ -5,11 +5,11 @@ Contains any static and global variables for MythTV Python Bindings
 """
 
 OWN_VERSION = (30,0,-1,0)
-SCHEMA_VERSION = 1348
+SCHEMA_VERSION = 1349
 NVSCHEMA_VERSION = 1007
 MUSICSCHEMA_VERSION = 1024
-PROTO_VERSION = '91'
-PROTO_TOKEN = 'BuzzOff'
+PROTO_VERSION = '93'
+PROTO_TOKEN = 'BlueHeron'
 BACKEND_SEP = '[]:[]'
 INSTALL_PREFIX = '/usr/local'
 
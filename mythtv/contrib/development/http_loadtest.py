@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+#
+# Simple keep-alive load generator for the MythTV HTTP server.
+#
+# Opens many persistent connections and repeatedly requests one URL on each
+# of them, then reports throughput and latency percentiles.  Most of the
+# connections spend their time idle between requests, which is what a large
+# number of UPnP clients and web browsers look like to the server.
+#
+#   http_loadtest.py -c 2000 -n 20 -d 0.5 http://backend:6544/Myth/GetHostName
+#
+
+import argparse
+import asyncio
+import sys
+import time
+from urllib.parse import urlsplit
+
+
+class Stats:
+    def __init__(self):
+        self.latencies = []
+        self.errors = 0
+        self.connect_errors = 0
+        self.reconnects = 0
+
+
+async def read_response(reader):
+    status = await reader.readline()
+    if not status:
+        raise ConnectionError("connection closed")
+    code = int(status.split()[1])
+    length = None
+    chunked = False
+    close = False
+    while True:
+        line = await reader.readline()
+        if line in (b"\r\n", b"\n", b""):
+            break
+        name, _, value = line.decode("latin-1").partition(":")
+        name = name.strip().lower()
+        value = value.strip().lower()
+        if name == "content-length":
+            length = int(value)
+        elif name == "transfer-encoding" and "chunked" in value:
+            chunked = True
+        elif name == "connection" and value == "close":
+            close = True
+    if chunked:
+        while True:
+            size = int((await reader.readline()).split(b";")[0], 16)
+            await reader.readexactly(size + 2)
+            if size == 0:
+                break
+    elif length is not None:
+        await reader.readexactly(length)
+    else:
+        await reader.read()
+        close = True
+    return code, close
+
+
+async def client(url, requests, delay, stats, start):
+    parts = urlsplit(url)
+    host = parts.hostname
+    port = parts.port or 80
+    path = parts.path or "/"
+    if parts.query:
+        path += "?" + parts.query
+    request = ("GET {} HTTP/1.1\r\nHost: {}:{}\r\n"
+               "Connection: keep-alive\r\n\r\n").format(path, host, port)
+    request = request.encode("latin-1")
+
+    await start.wait()
+    writer = None
+    try:
+        reader, writer = await asyncio.open_connection(host, port)
+    except OSError:
+        stats.connect_errors += 1
+        return
+
+    try:
+        for _ in range(requests):
+            begin = time.perf_counter()
+            try:
+                writer.write(request)
+                code, close = await read_response(reader)
+            except (OSError, ConnectionError, ValueError,
+                    asyncio.IncompleteReadError):
+                stats.errors += 1
+                close = True
+                code = 200
+            else:
+                stats.latencies.append(time.perf_counter() - begin)
+                if code >= 400:
+                    stats.errors += 1
+            if close:
+                writer.close()
+                stats.reconnects += 1
+                reader, writer = await asyncio.open_connection(host, port)
+            if delay:
+                await asyncio.sleep(delay)
+    except OSError:
+        stats.connect_errors += 1
+    finally:
+        if writer:
+            writer.close()
+
+
+def percentile(values, pct):
+    if not values:
+        return 0.0
+    idx = min(len(values) - 1, int(round(pct / 100.0 * (len(values) - 1))))
+    return values[idx]
+
+
+async def run(args):
+    stats = Stats()
+    start = asyncio.Event()
+    tasks = [asyncio.ensure_future(client(args.url, args.requests,
+                                          args.delay, stats, start))
+             for _ in range(args.connections)]
+    begin = time.perf_counter()
+    start.set()
+    await asyncio.gather(*tasks)
+    elapsed = time.perf_counter() - begin
+
+    lat = sorted(stats.latencies)
+    print("connections:     {}".format(args.connections))
+    print("requests:        {} ok, {} errors, {} connect errors, "
+          "{} reconnects".format(len(lat), stats.errors,
+                                 stats.connect_errors, stats.reconnects))
+    print("elapsed:         {:.2f} s".format(elapsed))
+    print("throughput:      {:.1f} requests/s".format(len(lat) / elapsed))
+    for pct in (50, 90, 99, 99.9):
+        print("latency p{:<5}   {:.2f} ms".format(
+            pct, percentile(lat, pct) * 1000))
+    if lat:
+        print("latency max      {:.2f} ms".format(lat[-1] * 1000))
+    return 0 if not stats.errors and not stats.connect_errors else 1
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Keep-alive load test for the MythTV HTTP server")
+    parser.add_argument("url", help="URL to request, e.g. "
+                        "http://localhost:6544/Myth/GetHostName")
+    parser.add_argument("-c", "--connections", type=int, default=1000,
+                        help="number of concurrent connections")
+    parser.add_argument("-n", "--requests", type=int, default=10,
+                        help="requests per connection")
+    parser.add_argument("-d", "--delay", type=float, default=1.0,
+                        help="idle seconds between requests on a connection")
+    args = parser.parse_args()
+
+    loop = asyncio.get_event_loop()
+    sys.exit(loop.run_until_complete(run(args)))
+
+
+if __name__ == "__main__":
+    main()
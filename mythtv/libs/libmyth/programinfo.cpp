@@ -5879,6 +5879,36 @@ bool LoadFromRecorded(
     const QMap<QString,bool> &isJobRunning,
     const QMap<QString, ProgramInfo*> &recMap,
     int sort)
+{
+    QString sql;
+    if (possiblyInProgressRecordingsOnly)
+        sql = "r.endtime >= NOW() AND r.starttime <= NOW()";
+
+    return LoadFromRecorded(destination, sql, MSqlBindings(), inUseMap,
+                            isJobRunning, recMap, sort);
+}
+
+/** \fn LoadFromRecorded(ProgramList&, const QString&, const MSqlBindings&,
+ *                       const QMap<QString,uint32_t>&,
+ *                       const QMap<QString,bool>&,
+ *                       const QMap<QString,ProgramInfo*>&, int, uint, uint)
+ *  \brief Loads the recordings matching sql, which holds the conditions of
+ *         the WHERE clause on the "r" (recorded) table, if it is not empty.
+ *
+ *  When sort is not zero recordings are ordered by start time and then by
+ *  recordedid, so that the order is stable and rows can be paged through
+ *  with start and limit, or with a condition on both columns.
+ */
+bool LoadFromRecorded(
+    ProgramList &destination,
+    const QString &sql,
+    const MSqlBindings &bindings,
+    const QMap<QString,uint32_t> &inUseMap,
+    const QMap<QString,bool> &isJobRunning,
+    const QMap<QString, ProgramInfo*> &recMap,
+    int sort,
+    uint start,
+    uint limit)
 {
     destination.clear();
 
@@ -5889,16 +5919,22 @@ bool LoadFromRecorded(
     // ----------------------------------------------------------------------
 
     QString thequery = ProgramInfo::kFromRecordedQuery;
-    if (possiblyInProgressRecordingsOnly)
-        thequery += "WHERE r.endtime >= NOW() AND r.starttime <= NOW() ";
+    if (!sql.isEmpty())
+        thequery += "WHERE " + sql + " ";
+
+    if (sort > 0)
+        thequery += "ORDER BY r.starttime, r.recordedid ";
+    else if (sort < 0)
+        thequery += "ORDER BY r.starttime DESC, r.recordedid DESC ";
 
-    if (sort)
-        thequery += "ORDER BY r.starttime ";
-    if (sort < 0)
-        thequery += "DESC ";
+    if (limit > 0)
+        thequery += QString("LIMIT %1, %2 ").arg(start).arg(limit);
+    else if (start > 0) // MySQL has no OFFSET without a LIMIT
+        thequery += QString("LIMIT %1, 18446744073709551615 ").arg(start);
 
     MSqlQuery query(MSqlQuery::InitCon());
     query.prepare(thequery);
+    query.bindValues(bindings);
 
     if (!query.exec())
     {
@@ -33,7 +33,7 @@ HEADERS += mythsystemlegacy.h mythtypes.h
 HEADERS += threadedfilewriter.h mythsingledownload.h codecutil.h
 HEADERS += mythsession.h
 HEADERS += ../../external/qjsonwrapper/qjsonwrapper/Json.h
-HEADERS += cleanupguard.h portchecker.h
+HEADERS += cleanupguard.h portchecker.h mythtrace.h logringbuffer.h
 
 SOURCES += mthread.cpp mthreadpool.cpp
 SOURCES += mythsocket.cpp
@@ -54,7 +54,7 @@ SOURCES += mythsystemlegacy.cpp mythtypes.cpp
 SOURCES += threadedfilewriter.cpp mythsingledownload.cpp codecutil.cpp
 SOURCES += mythsession.cpp
 SOURCES += ../../external/qjsonwrapper/qjsonwrapper/Json.cpp
-SOURCES += cleanupguard.cpp portchecker.cpp
+SOURCES += cleanupguard.cpp portchecker.cpp mythtrace.cpp logringbuffer.cpp
 
 unix {
     SOURCES += mythsystemunix.cpp
@@ -84,6 +84,7 @@ inc.files += plist.h bswap.h signalhandling.h ffmpeg-mmx.h mythdate.h
 inc.files += mythplugin.h mythpluginapi.h mythqtcompat.h
 inc.files += remotefile.h mythsystemlegacy.h mythtypes.h
 inc.files += threadedfilewriter.h mythsingledownload.h mythsession.h
+inc.files += mythtrace.h
 
 # Allow both #include <blah.h> and #include <libmythbase/blah.h>
 inc2.path  = $${PREFIX}/include/mythtv/libmythbase
@@ -11,12 +11,16 @@
 #include <QMap>
 #include <QRegExp>
 #include <QVariantMap>
+#include <QElapsedTimer>
+#include <QThreadStorage>
+#include <QVector>
 #include <iostream>
 
 using namespace std;
 
 #include "mythlogging.h"
 #include "logging.h"
+#include "logringbuffer.h"
 #include "loggingserver.h"
 #include "mythdb.h"
 #include "mythdirs.h"
@@ -68,9 +72,29 @@ extern "C" {
 #include <android/log.h>
 #endif
 
-static QMutex                  logQueueMutex;
-static QQueue<LoggingItem *>   logQueue;
-static QRegExp                 logRegExp = QRegExp("[%]{1,2}");
+namespace
+{
+    /// Owned by QThreadStorage, closes the ring on thread exit so the
+    /// logging thread can delete it once it has been drained.
+    class LogRingHolder
+    {
+      public:
+        explicit LogRingHolder(LogRingBuffer *r) : ring(r) {}
+        ~LogRingHolder() { ring->Close(); }
+
+        LogRingBuffer *ring;
+    };
+}
+
+static QMutex                  logQueueMutex;   ///< For waiting on the rings
+static QMutex                  logRingsMutex;   ///< Protects logRings
+static QList<LogRingBuffer *>  logRings;
+static QMutex                  logDrainMutex;   ///< One reader of the rings
+static QAtomicInt              logDrainerSleeping(0);
+static QThreadStorage<LogRingHolder *> logThreadRing;
+
+/// Records handled before the logging thread services its event loop again
+static const int kLogDrainBatch = 256;
 
 static LoggerThread           *logThread = NULL;
 static QMutex                  logThreadMutex;
@@ -123,6 +147,102 @@ void loglevelAdd(int value, QString name, char shortname);
 void verboseInit(void);
 void verboseHelp(void);
 
+/// \brief Monotonic time used to stamp log records, in ns.  This is much
+///        cheaper than getting the time of day, which is only done when the
+///        records are handed to the loggers.
+static qint64 loggingClockNsecs(void)
+{
+    class LogClock
+    {
+      public:
+        LogClock() { timer.start(); }
+        QElapsedTimer timer;
+    };
+    static const LogClock clock;
+
+    return clock.timer.nsecsElapsed();
+}
+
+/// \brief Get the operating system's id of the current thread
+/// \note  In different platforms, the actual value returned here will vary.
+///        The intention is to get a thread ID that will map well to what is
+///        shown in gdb.
+static int64_t loggingCurrentTid(void)
+{
+    int64_t tid = 0;
+
+#if defined(Q_OS_ANDROID)
+    tid = (int64_t)gettid();
+#elif defined(linux)
+    tid = (int64_t)syscall(SYS_gettid);
+#elif defined(__FreeBSD__)
+    long lwpid;
+    int dummy = thr_self( &lwpid );
+    (void)dummy;
+    tid = (int64_t)lwpid;
+#elif CONFIG_DARWIN
+    tid = (int64_t)mach_thread_self();
+#endif
+
+    return tid;
+}
+
+/// \brief Get the log ring of the current thread, creating it on the first
+///        message from the thread.
+static LogRingBuffer *loggingThreadRing(void)
+{
+    if (logThreadRing.hasLocalData())
+        return logThreadRing.localData()->ring;
+
+    uint64_t threadId = (uint64_t)(QThread::currentThreadId());
+    LogRingBuffer *ring = new LogRingBuffer(threadId, loggingCurrentTid());
+
+    {
+        QMutexLocker locker(&logRingsMutex);
+        logRings.append(ring);
+    }
+
+    logThreadRing.setLocalData(new LogRingHolder(ring));
+
+    return ring;
+}
+
+/// \brief Check whether every log ring has been drained
+static bool loggingRingsEmpty(void)
+{
+    QMutexLocker locker(&logRingsMutex);
+
+    QList<LogRingBuffer *>::const_iterator it;
+    for (it = logRings.constBegin(); it != logRings.constEnd(); ++it)
+    {
+        if (!(*it)->IsEmpty())
+            return false;
+    }
+
+    return true;
+}
+
+/// \brief Put a message into the current thread's log ring.  This is all
+///        the work done by the thread calling LOG(), turning the record
+///        into a LoggingItem is left to the logging thread.
+static void loggingPushRecord(const char *file, const char *function,
+                              int line, LogLevel_t level, int type,
+                              const char *message, uint length)
+{
+    LogRecord record;
+    record.nsecs    = loggingClockNsecs();
+    record.line     = line;
+    record.level    = level;
+    record.type     = type;
+
+    if (!loggingThreadRing()->Push(record, message, length, file, function))
+        return;
+
+    // Wake the logging thread if it went to sleep on empty rings
+    if (logDrainerSleeping.fetchAndAddOrdered(0) && logThread)
+        logThread->wake();
+}
+
 void loggingGetTimeStamp(qlonglong *epoch, uint *usec)
 {
 #if HAVE_GETTIMEOFDAY
@@ -232,20 +352,7 @@ void LoggingItem::setThreadTid(void)
     m_tid = logThreadTidHash.value(m_threadId, -1);
     if (m_tid == -1)
     {
-        m_tid = 0;
-
-#if defined(Q_OS_ANDROID)
-        m_tid = (int64_t)gettid();
-#elif defined(linux)
-        m_tid = (int64_t)syscall(SYS_gettid);
-#elif defined(__FreeBSD__)
-        long lwpid;
-        int dummy = thr_self( &lwpid );
-        (void)dummy;
-        m_tid = (int64_t)lwpid;
-#elif CONFIG_DARWIN
-        m_tid = (int64_t)mach_thread_self();
-#endif
+        m_tid = loggingCurrentTid();
         logThreadTidHash[m_threadId] = m_tid;
     }
 }
@@ -263,8 +370,10 @@ LoggerThread::LoggerThread(QString filename, bool progress, bool quiet,
     m_quiet(quiet), m_appname(QCoreApplication::applicationName()),
     m_tablename(table), m_facility(facility), m_pid(getpid()), m_epoch(0),
     m_zmqContext(NULL), m_zmqSocket(NULL), m_initialTimer(NULL),
-    m_heartbeatTimer(NULL), m_noserver(noserver)
+    m_heartbeatTimer(NULL), m_noserver(noserver), m_clockOffset(0)
 {
+    calibrateClock();
+
     char *debug = getenv("VERBOSE_THREADS");
     if (debug != NULL)
     {
@@ -300,10 +409,10 @@ LoggerThread::~LoggerThread()
     delete m_waitEmpty;
 }
 
-/// \brief Run the logging thread.  This thread reads from the logging queue,
-///        and handles distributing the LoggingItems to each logger instance.
-///        The thread will not exit until the logging queue is emptied
-///        completely, ensuring that all logging is flushed.
+/// \brief Run the logging thread.  This thread reads from the log rings of
+///        all of the threads, and handles distributing the LoggingItems to
+///        each logger instance.  The thread will not exit until the rings
+///        are emptied completely, ensuring that all logging is flushed.
 void LoggerThread::run(void)
 {
     RunProlog();
@@ -384,34 +493,41 @@ void LoggerThread::run(void)
     #endif
     }
 
-    QMutexLocker qLock(&logQueueMutex);
+    QElapsedTimer calibrated;
+    calibrated.start();
 
-    while (!m_aborted || !logQueue.isEmpty())
+    while (true)
     {
-        qLock.unlock();
         qApp->processEvents(QEventLoop::AllEvents, 10);
         qApp->sendPostedEvents(NULL, QEvent::DeferredDelete);
 
-        qLock.relock();
-        if (logQueue.isEmpty())
+        // Follow any change to the time of day
+        if (calibrated.elapsed() > 60000)
         {
-            m_waitEmpty->wakeAll();
-            m_waitNotEmpty->wait(qLock.mutex(), 100);
-            continue;
+            calibrateClock();
+            calibrated.restart();
         }
 
-        LoggingItem *item = logQueue.dequeue();
-        qLock.unlock();
+        if (drainRings() > 0)
+            continue;
 
-        fillItem(item);
-        handleItem(item);
-        logConsole(item);
-        item->DecrRef();
+        QMutexLocker qLock(&logQueueMutex);
 
-        qLock.relock();
-    }
+        if (!loggingRingsEmpty())
+            continue;
+
+        m_waitEmpty->wakeAll();
 
-    qLock.unlock();
+        if (m_aborted)
+            break;
+
+        // Producers check this after adding a record, so either they see
+        // it set and wake us, or we see their record here
+        logDrainerSleeping.fetchAndStoreOrdered(1);
+        if (loggingRingsEmpty())
+            m_waitNotEmpty->wait(qLock.mutex(), 100);
+        logDrainerSleeping.fetchAndStoreOrdered(0);
+    }
 
     // This must be before the timer stop below or we deadlock when the timer
     // thread tries to deregister, and we wait for it.
@@ -558,8 +674,6 @@ void LoggerThread::handleItem(LoggingItem *item)
 {
     if (item->m_type & kRegistering)
     {
-        item->m_tid = item->getThreadTid();
-
         QMutexLocker locker(&logThreadMutex);
         if (logThreadHash.contains(item->m_threadId))
         {
@@ -688,7 +802,7 @@ bool LoggerThread::logConsole(LoggingItem *item)
 
 
 /// \brief Stop the thread by setting the abort flag after waiting a second for
-///        the queue to be flushed.
+///        the rings to be flushed.
 void LoggerThread::stop(void)
 {
     logQueueMutex.lock();
@@ -698,21 +812,164 @@ void LoggerThread::stop(void)
     m_waitNotEmpty->wakeAll();
 }
 
-/// \brief  Wait for the queue to be flushed (up to a timeout)
-/// \param  timeoutMS   The number of ms to wait for the queue to flush
-/// \return true if the queue is empty, false otherwise
+/// \brief  Wait for the rings to be flushed (up to a timeout).  Must be
+///         called with logQueueMutex held.
+/// \param  timeoutMS   The number of ms to wait for the rings to flush
+/// \return true if the rings are empty, false otherwise
 bool LoggerThread::flush(int timeoutMS)
 {
     QTime t;
     t.start();
-    while (!m_aborted && !logQueue.isEmpty() && t.elapsed() < timeoutMS)
+    while (!m_aborted && !loggingRingsEmpty() && t.elapsed() < timeoutMS)
     {
         m_waitNotEmpty->wakeAll();
         int left = timeoutMS - t.elapsed();
         if (left > 0)
             m_waitEmpty->wait(&logQueueMutex, left);
     }
-    return logQueue.isEmpty();
+    return loggingRingsEmpty();
+}
+
+/// \brief  Wake the logging thread when a record has been added to a ring
+void LoggerThread::wake(void)
+{
+    QMutexLocker qLock(&logQueueMutex);
+    m_waitNotEmpty->wakeAll();
+}
+
+/// \brief  Work out the time of day of the logging clock's zero, which is
+///         used to convert the time stamps of log records
+void LoggerThread::calibrateClock(void)
+{
+    qlonglong epoch;
+    uint      usec;
+
+    qint64 before = loggingClockNsecs();
+    loggingGetTimeStamp(&epoch, &usec);
+    qint64 after  = loggingClockNsecs();
+
+    m_clockOffset = epoch * 1000000 + usec - (before + after) / 2000;
+}
+
+/// \brief  Turn a record taken from a log ring into a LoggingItem
+LoggingItem *LoggerThread::createItem(const LogRingBuffer *ring,
+                                      const LogRecord *record)
+{
+    LoggingItem *item = new LoggingItem;
+
+    item->m_threadId = ring->ThreadId();
+    item->m_tid      = ring->Tid();
+    item->m_line     = record->line;
+    item->m_type     = (LoggingType)record->type;
+    item->m_level    = (LogLevel_t)record->level;
+    item->m_file     = strdup(LogRingBuffer::File(record));
+    item->m_function = strdup(LogRingBuffer::Function(record));
+
+    qint64 usecs = m_clockOffset + record->nsecs / 1000;
+    item->m_epoch = usecs / 1000000;
+    item->m_usec  = usecs % 1000000;
+
+    const char *message = LogRingBuffer::Message(record);
+
+    // The name of a thread being registered is carried as the message
+    if (item->m_type & kRegistering)
+        item->m_threadName = strdup(message);
+    else
+        strncpy(item->m_message, message, LOGLINE_MAX);
+
+    return item;
+}
+
+/// \brief  Hand a LoggingItem to mythlogserver and the console
+void LoggerThread::dispatchItem(LoggingItem *item)
+{
+    fillItem(item);
+    handleItem(item);
+    logConsole(item);
+    item->DecrRef();
+}
+
+/// \brief  Take the records from the rings of all of the threads, oldest
+///         first, and hand them to the loggers.  Rings of threads that have
+///         exited are deleted once they have been drained.
+/// \return The number of records handled, at most kLogDrainBatch
+int LoggerThread::drainRings(void)
+{
+    // Only one thread may read the rings; if a logger logs while the rings
+    // are being drained, the record is picked up by the drain in progress
+    if (!logDrainMutex.tryLock())
+        return 0;
+
+    QList<LogRingBuffer *> rings;
+
+    {
+        QMutexLocker locker(&logRingsMutex);
+
+        QList<LogRingBuffer *>::iterator it = logRings.begin();
+        while (it != logRings.end())
+        {
+            if ((*it)->IsClosed() && (*it)->IsEmpty())
+            {
+                delete *it;
+                it = logRings.erase(it);
+            }
+            else
+                ++it;
+        }
+
+        rings = logRings;
+    }
+
+    QVector<const LogRecord *> heads(rings.size());
+
+    for (int i = 0; i < rings.size(); i++)
+    {
+        uint dropped = rings[i]->TakeDropped();
+        if (dropped)
+        {
+            LoggingItem *item = new LoggingItem;
+            item->m_threadId = rings[i]->ThreadId();
+            item->m_tid      = rings[i]->Tid();
+            item->m_level    = (LogLevel_t)LOG_WARNING;
+            item->m_file     = strdup(__FILE__);
+            item->m_function = strdup(__FUNCTION__);
+            item->m_line     = __LINE__;
+            loggingGetTimeStamp(&item->m_epoch, &item->m_usec);
+            snprintf(item->m_message, LOGLINE_MAX,
+                     "Dropped %u log messages, logging is not keeping up",
+                     dropped);
+            dispatchItem(item);
+        }
+
+        heads[i] = rings[i]->Peek();
+    }
+
+    int count = 0;
+
+    while (count < kLogDrainBatch)
+    {
+        int oldest = -1;
+
+        for (int i = 0; i < heads.size(); i++)
+        {
+            if (heads[i] &&
+                ((oldest < 0) || (heads[i]->nsecs < heads[oldest]->nsecs)))
+                oldest = i;
+        }
+
+        if (oldest < 0)
+            break;
+
+        dispatchItem(createItem(rings[oldest], heads[oldest]));
+
+        rings[oldest]->Pop();
+        heads[oldest] = rings[oldest]->Peek();
+        count++;
+    }
+
+    logDrainMutex.unlock();
+
+    return count;
 }
 
 void LoggerThread::fillItem(LoggingItem *item)
@@ -774,54 +1031,45 @@ void LogPrintLine( uint64_t mask, LogLevel_t level, const char *file, int line,
                    const char *format, ... )
 {
     va_list         arguments;
+    char            buffer[LOGLINE_MAX];
+    const char     *message = format;
+    int             length;
 
     int type = kMessage;
     type |= (mask & VB_FLUSH) ? kFlush : 0;
     type |= (mask & VB_STDIO) ? kStandardIO : 0;
-    LoggingItem *item = LoggingItem::create(file, function, line, level,
-                                            (LoggingType)type);
-    if (!item)
-        return;
 
-    char *formatcopy = NULL;
-    if( fromQString && strchr(format, '%') )
+    if (fromQString)
     {
-        QString string(format);
-        format = strdup(string.replace(logRegExp, "%%").toLocal8Bit()
-                              .constData());
-        formatcopy = (char *)format;
+        // Already formatted by the caller, it is only copied into the ring
+        length = strnlen(format, LOGLINE_MAX - 1);
     }
+    else
+    {
+        va_start(arguments, format);
+        length = vsnprintf(buffer, LOGLINE_MAX, format, arguments);
+        va_end(arguments);
 
-    va_start(arguments, format);
-    vsnprintf(item->m_message, LOGLINE_MAX, format, arguments);
-    va_end(arguments);
-
-    if (formatcopy)
-        free(formatcopy);
-
-    QMutexLocker qLock(&logQueueMutex);
+        message = buffer;
+        length  = max(0, min(length, LOGLINE_MAX - 1));
+    }
 
 #if defined( _MSC_VER ) && defined( _DEBUG )
-        OutputDebugStringA( item->m_message );
+        OutputDebugStringA( message );
         OutputDebugStringA( "\n" );
 #endif
 
-    logQueue.enqueue(item);
+    loggingPushRecord(file, function, line, level, type, message, length);
 
     if (logThread && logThreadFinished && !logThread->isRunning())
     {
-        while (!logQueue.isEmpty())
-        {
-            item = logQueue.dequeue();
-            qLock.unlock();
-            logThread->handleItem(item);
-            logThread->logConsole(item);
-            item->DecrRef();
-            qLock.relock();
-        }
+        while (logThread->drainRings() > 0)
+            ;
     }
-    else if (logThread && !logThreadFinished && (type & kFlush))
+    else if (logThread && !logThreadFinished && (type & kFlush) &&
+             QThread::currentThread() != logThread->qthread())
     {
+        QMutexLocker qLock(&logQueueMutex);
         logThread->flush();
     }
 }
@@ -971,16 +1219,12 @@ void loggingRegisterThread(const QString &name)
     if (logThreadFinished)
         return;
 
-    QMutexLocker qLock(&logQueueMutex);
-
-    LoggingItem *item = LoggingItem::create(__FILE__, __FUNCTION__,
-                                            __LINE__, (LogLevel_t)LOG_DEBUG,
-                                            kRegistering);
-    if (item)
-    {
-        item->setThreadName((char *)name.toLocal8Bit().constData());
-        logQueue.enqueue(item);
-    }
+    // Goes through the thread's own ring so it stays in order with the
+    // thread's messages
+    QByteArray ba = name.toLocal8Bit();
+    loggingPushRecord(__FILE__, __FUNCTION__, __LINE__, (LogLevel_t)LOG_DEBUG,
+                      kRegistering, ba.constData(),
+                      min(ba.size(), LOGLINE_MAX - 1));
 }
 
 /// \brief  Deregister the current thread's name.  This is triggered by the
@@ -990,13 +1234,8 @@ void loggingDeregisterThread(void)
     if (logThreadFinished)
         return;
 
-    QMutexLocker qLock(&logQueueMutex);
-
-    LoggingItem *item = LoggingItem::create(__FILE__, __FUNCTION__, __LINE__,
-                                            (LogLevel_t)LOG_DEBUG,
-                                            kDeregistering);
-    if (item)
-        logQueue.enqueue(item);
+    loggingPushRecord(__FILE__, __FUNCTION__, __LINE__, (LogLevel_t)LOG_DEBUG,
+                      kDeregistering, "", 0);
 }
 
 
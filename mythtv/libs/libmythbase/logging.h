@@ -42,6 +42,8 @@ namespace nzmqt {
 class QString;
 class MSqlQuery;
 class LoggingItem;
+class LogRingBuffer;
+struct LogRecord;
 
 void loggingRegisterThread(const QString &name);
 void loggingDeregisterThread(void);
@@ -174,8 +176,8 @@ class LoggingItem: public QObject, public ReferenceCounter
     ~LoggingItem();
 };
 
-/// \brief The logging thread that consumes the logging queue and dispatches
-///        each LoggingItem to mythlogserver via ZeroMQ
+/// \brief The logging thread that consumes the log rings of all threads and
+///        dispatches each LoggingItem to mythlogserver via ZeroMQ
 class LoggerThread : public QObject, public MThread
 {
     Q_OBJECT
@@ -189,14 +191,16 @@ class LoggerThread : public QObject, public MThread
     void run(void);
     void stop(void);
     bool flush(int timeoutMS = 200000);
+    void wake(void);
+    int  drainRings(void);
     void handleItem(LoggingItem *item);
     void fillItem(LoggingItem *item);
   private:
     QWaitCondition *m_waitNotEmpty; ///< Condition variable for waiting
-                                    ///  for the queue to not be empty
+                                    ///  for the rings to not be empty
                                     ///  Protected by logQueueMutex
     QWaitCondition *m_waitEmpty;    ///< Condition variable for waiting
-                                    ///  for the queue to be empty
+                                    ///  for the rings to be empty
                                     ///  Protected by logQueueMutex
     bool m_aborted;                 ///< Flag to abort the thread.
                                     ///  Protected by logQueueMutex
@@ -222,8 +226,13 @@ class LoggerThread : public QObject, public MThread
 
     bool m_noserver;
 
+    qint64 m_clockOffset;   ///< Time of day of the log clock's zero (us)
+
   protected:
     bool logConsole(LoggingItem *item);
+    void dispatchItem(LoggingItem *item);
+    LoggingItem *createItem(const LogRingBuffer *ring, const LogRecord *record);
+    void calibrateClock(void);
     void launchLogServer(void);
     void pingLogServer(void);
 
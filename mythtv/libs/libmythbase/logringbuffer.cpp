@@ -0,0 +1,125 @@
+#include <string.h>
+
+#include "logringbuffer.h"
+
+// Records start on 8 byte boundaries so the LogRecord can be read in place
+#define RECORD_ALIGN(x) (((x) + 7) & ~7u)
+
+LogRingBuffer::LogRingBuffer(uint64_t threadId, int64_t tid, uint size) :
+    m_threadId(threadId), m_tid(tid), m_buffer(NULL), m_size(1024), m_mask(0),
+    m_head(0), m_tail(0), m_dropped(0), m_closed(0)
+{
+    while (m_size < size)
+        m_size <<= 1;
+
+    m_mask   = m_size - 1;
+    m_buffer = new char[m_size];
+}
+
+LogRingBuffer::~LogRingBuffer()
+{
+    delete [] m_buffer;
+}
+
+/// \brief Appends a record, its message and copies of the file and function
+///        names to the ring.  The sizes and lengths of the record are filled
+///        in.
+/// \return false if there was no room, the record is then counted as dropped
+bool LogRingBuffer::Push(LogRecord &record, const char *message, uint length,
+                         const char *file, const char *function)
+{
+    size_t file_length     = file ? strlen(file) : 0;
+    size_t function_length = function ? strlen(function) : 0;
+    if (file_length > 0xFFFF)
+        file_length = 0xFFFF;
+    if (function_length > 0xFFFF)
+        function_length = 0xFFFF;
+
+    uint needed     = RECORD_ALIGN(sizeof(LogRecord) + length + 1 +
+                                   file_length + 1 + function_length + 1);
+    uint head       = (uint)m_head.load();
+    uint tail       = (uint)m_tail.loadAcquire();
+    uint offset     = head & m_mask;
+    uint contiguous = m_size - offset;
+
+    // Records never wrap, skip to the start if this one doesn't fit
+    uint padding    = (needed > contiguous) ? contiguous : 0;
+
+    if (needed + padding > m_size - (head - tail))
+    {
+        m_dropped.fetchAndAddRelaxed(1);
+        return false;
+    }
+
+    if (padding)
+    {
+        if (padding >= sizeof(LogRecord))
+            ((LogRecord *)(m_buffer + offset))->size = 0;
+        head  += padding;
+        offset = 0;
+    }
+
+    record.size           = needed;
+    record.length         = length;
+    record.fileLength     = file_length;
+    record.functionLength = function_length;
+
+    char *dest = m_buffer + offset;
+    memcpy(dest, &record, sizeof(LogRecord));
+    dest += sizeof(LogRecord);
+    memcpy(dest, message, length);
+    dest[length] = '\0';
+    dest += length + 1;
+    memcpy(dest, file, file_length);
+    dest[file_length] = '\0';
+    dest += file_length + 1;
+    memcpy(dest, function, function_length);
+    dest[function_length] = '\0';
+
+    m_head.storeRelease((int)(head + needed));
+
+    return true;
+}
+
+/// \brief Returns the oldest record in the ring without removing it, or
+///        NULL if the ring is empty.
+const LogRecord *LogRingBuffer::Peek(void)
+{
+    uint tail = (uint)m_tail.load();
+    uint head = (uint)m_head.loadAcquire();
+
+    while (tail != head)
+    {
+        uint offset     = tail & m_mask;
+        uint contiguous = m_size - offset;
+
+        const LogRecord *record = (const LogRecord *)(m_buffer + offset);
+
+        if ((contiguous >= sizeof(LogRecord)) && (record->size != 0))
+            return record;
+
+        // Padding up to the end of the buffer
+        tail += contiguous;
+        m_tail.storeRelease((int)tail);
+    }
+
+    return NULL;
+}
+
+/// \brief Removes the record last returned by Peek()
+void LogRingBuffer::Pop(void)
+{
+    uint tail = (uint)m_tail.load();
+    const LogRecord *record = (const LogRecord *)(m_buffer + (tail & m_mask));
+
+    m_tail.storeRelease((int)(tail + record->size));
+}
+
+bool LogRingBuffer::IsEmpty(void) const
+{
+    return m_head.loadAcquire() == m_tail.loadAcquire();
+}
+
+/*
+ * vim:ts=4:sw=4:ai:et:si:sts=4
+ */
@@ -0,0 +1,85 @@
+#ifndef LOGRINGBUFFER_H_
+#define LOGRINGBUFFER_H_
+
+#include <QAtomicInt>
+
+#include <stdint.h>
+
+#include "mythbaseexp.h"
+
+/// \brief Fixed part of a log message as stored in a LogRingBuffer.  The
+///        text of the message follows it, then the file and function names.
+///        The names are copied because the code that logged them, e.g. a
+///        plugin, may be unloaded before the logging thread reads them.
+struct LogRecord
+{
+    qint64      nsecs;      ///< Time since the logging clock was started
+    int32_t     line;
+    int16_t     level;      ///< LogLevel_t
+    uint16_t    type;       ///< LoggingType flags
+    uint32_t    size;       ///< Size of the whole record, 0 for padding
+    uint32_t    length;     ///< Length of the message text
+    uint16_t    fileLength;     ///< Length of the __FILE__ of the LOG()
+    uint16_t    functionLength; ///< Length of the __FUNCTION__ of the LOG()
+};
+
+/** \class LogRingBuffer
+ *  \brief Lock free ring of log records written by one thread and read by
+ *         the logging thread.
+ *
+ *  Each thread that logs has its own ring, so producers never contend
+ *  with each other.  Records are variable length, so short messages take
+ *  little room.  When the ring is full the record is dropped and counted
+ *  rather than making the producing thread wait for the logging thread.
+ */
+class MBASE_PUBLIC LogRingBuffer
+{
+  public:
+    static const uint kDefaultSize = 64 * 1024;
+
+    /// \param threadId QThread::currentThreadId() of the owning thread
+    /// \param tid      Operating system id of the owning thread
+    /// \param size     Size in bytes, rounded up to a power of two
+    LogRingBuffer(uint64_t threadId, int64_t tid, uint size = kDefaultSize);
+    ~LogRingBuffer();
+
+    uint64_t ThreadId(void) const { return m_threadId; }
+    int64_t  Tid(void) const      { return m_tid; }
+
+    // Producer side, called only by the thread that owns the ring
+    bool Push(LogRecord &record, const char *message, uint length,
+              const char *file, const char *function);
+
+    // Consumer side, called only by one thread at a time
+    const LogRecord *Peek(void);
+    void Pop(void);
+    uint TakeDropped(void) { return m_dropped.fetchAndStoreOrdered(0); }
+
+    bool IsEmpty(void) const;
+    void Close(void)          { m_closed.storeRelease(1); }
+    bool IsClosed(void) const { return m_closed.loadAcquire(); }
+
+    static const char *Message(const LogRecord *record)
+        { return (const char *)(record + 1); }
+    static const char *File(const LogRecord *record)
+        { return Message(record) + record->length + 1; }
+    static const char *Function(const LogRecord *record)
+        { return File(record) + record->fileLength + 1; }
+
+  private:
+    uint64_t    m_threadId;
+    int64_t     m_tid;
+    char       *m_buffer;
+    uint        m_size;
+    uint        m_mask;
+    QAtomicInt  m_head;     ///< Written by the producer only
+    QAtomicInt  m_tail;     ///< Written by the consumer only
+    QAtomicInt  m_dropped;
+    QAtomicInt  m_closed;
+};
+
+#endif
+
+/*
+ * vim:ts=4:sw=4:ai:et:si:sts=4
+ */
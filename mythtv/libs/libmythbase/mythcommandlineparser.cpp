@@ -67,6 +67,7 @@ using namespace std;
 #include "logging.h"
 #include "mythmiscutil.h"
 #include "mythdate.h"
+#include "mythtrace.h"
 
 #define TERMWIDTH 79
 
@@ -2379,8 +2380,8 @@ void MythCommandLineParser::addUPnP(void)
 }
 
 /** \brief Canned argument definition for all logging options, including
- *  --verbose, --logpath, --quiet, --loglevel, --syslog, --enable-dblog
- *  and --disable-mythlogserver
+ *  --verbose, --logpath, --quiet, --loglevel, --syslog, --enable-dblog,
+ *  --trace-file and --disable-mythlogserver
  */
 void MythCommandLineParser::addLogging(
     const QString &defaultVerbosity, LogLevel_t defaultLogLevel)
@@ -2438,6 +2439,12 @@ void MythCommandLineParser::addLogging(
                 ->SetDeprecated("this is now the default, see --enable-dblog");
     add("--enable-dblog", "enabledblog", false, "Enable logging to database.", "")
                 ->SetGroup("Logging");
+    add("--trace-file", "tracefile", "",
+        "Record a timeline of traced operations and write it to this file "
+        "on exit, in the Chrome trace event format.",
+        "The file can be loaded in chrome://tracing or "
+        "https://ui.perfetto.dev to analyze e.g. playback start-up.")
+                ->SetGroup("Logging");
 
     add(QStringList( QStringList() << "-l" << "--logfile" ),
         "logfile", "", "", "")
@@ -2633,6 +2640,10 @@ int MythCommandLineParser::ConfigureLogging(QString mask, unsigned int progress)
 
     logStart(logfile, progress, quiet, facility, level, dblog, propagate, noserver);
 
+    QString tracefile = toString("tracefile");
+    if (!tracefile.isEmpty())
+        MythTrace::Start(tracefile);
+
     return GENERIC_EXIT_OK;
 }
 
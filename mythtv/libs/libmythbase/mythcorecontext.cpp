@@ -47,6 +47,7 @@ using namespace std;
 #include "serverpool.h"
 #include "mythdate.h"
 #include "mythplugin.h"
+#include "mythtrace.h"
 
 #define LOC      QString("MythCoreContext::%1(): ").arg(__func__)
 
@@ -162,6 +163,8 @@ static void delete_sock(QMutexLocker &locker, MythSocket **s)
 
 MythCoreContextPrivate::~MythCoreContextPrivate()
 {
+    MythTrace::Finish();
+
     MThreadPool::StopAllPools();
 
     {
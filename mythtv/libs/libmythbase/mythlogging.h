@@ -32,8 +32,9 @@ extern "C" {
 // There are two LOG macros now.  One for use with Qt/C++, one for use
 // without Qt.
 //
-// Neither of them will lock the calling thread other than momentarily to put
-// the log message onto a queue.
+// Neither of them will lock the calling thread.  The log message is copied
+// into a ring buffer belonging to the calling thread, and everything else is
+// done by the logging thread.
 #ifdef __cplusplus
 #define LOG(_MASK_, _LEVEL_, _STRING_)                                  \
     do {                                                                \
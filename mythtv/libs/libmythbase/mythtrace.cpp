@@ -0,0 +1,306 @@
+// Qt headers
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QSharedPointer>
+#include <QThreadStorage>
+#include <QAtomicInt>
+#include <QThread>
+#include <QVector>
+#include <QMutex>
+#include <QFile>
+#include <QList>
+
+// MythTV headers
+#include "mythtrace.h"
+#include "mythlogging.h"
+
+#define LOC QString("MythTrace: ")
+
+/// Number of spans kept per thread before the oldest are overwritten.
+static const int kTraceRingSize = 8192;
+/// Rings of threads that have exited are dropped beyond this many rings.
+static const int kTraceMaxRings = 256;
+
+namespace
+{
+    class TraceEvent
+    {
+      public:
+        const char *name;
+        const char *category;
+        qint64      start;
+        qint64      duration; ///< -1 for instant events
+    };
+
+    class TraceRing
+    {
+      public:
+        TraceRing(int _tid, const QString &_name) :
+            tid(_tid), name(_name), next(0), count(0), finished(false)
+        {
+            events.resize(kTraceRingSize);
+        }
+
+        void Add(const char *ev_name, const char *ev_category,
+                 qint64 start, qint64 duration)
+        {
+            QMutexLocker locker(&lock);
+            TraceEvent &ev = events[next];
+            ev.name     = ev_name;
+            ev.category = ev_category;
+            ev.start    = start;
+            ev.duration = duration;
+            next = (next + 1) % kTraceRingSize;
+            if (count < kTraceRingSize)
+                count++;
+        }
+
+        QMutex              lock;
+        QVector<TraceEvent> events;
+        int                 tid;
+        QString             name;
+        int                 next;
+        int                 count;
+        bool                finished;
+    };
+
+    typedef QSharedPointer<TraceRing> TraceRingPtr;
+
+    /// Owned by QThreadStorage, marks the ring finished on thread exit.
+    class TraceRingHolder
+    {
+      public:
+        explicit TraceRingHolder(TraceRingPtr r) : ring(r) {}
+        ~TraceRingHolder()
+        {
+            QMutexLocker locker(&ring->lock);
+            ring->finished = true;
+        }
+
+        TraceRingPtr ring;
+    };
+}
+
+static QAtomicInt                       s_traceEnabled(0);
+static QMutex                           s_traceLock;
+static QList<TraceRingPtr>              s_traceRings;
+static int                              s_traceNextTid = 1;
+static QString                          s_traceFilename;
+static QThreadStorage<TraceRingHolder*> s_traceThreadRing;
+
+static TraceRing *GetThreadRing(void)
+{
+    if (s_traceThreadRing.hasLocalData())
+        return s_traceThreadRing.localData()->ring.data();
+
+    QString name = QThread::currentThread()->objectName();
+
+    QMutexLocker locker(&s_traceLock);
+
+    int tid = s_traceNextTid++;
+    if (name.isEmpty())
+        name = QString("Thread %1").arg(tid);
+
+    // Forget the oldest rings belonging to threads that have exited
+    QList<TraceRingPtr>::iterator it = s_traceRings.begin();
+    while ((s_traceRings.size() >= kTraceMaxRings) &&
+           (it != s_traceRings.end()))
+    {
+        bool finished;
+        {
+            QMutexLocker ringLocker(&(*it)->lock);
+            finished = (*it)->finished;
+        }
+        if (finished)
+            it = s_traceRings.erase(it);
+        else
+            ++it;
+    }
+
+    TraceRingPtr ring(new TraceRing(tid, name));
+    s_traceRings.push_back(ring);
+    s_traceThreadRing.setLocalData(new TraceRingHolder(ring));
+
+    return ring.data();
+}
+
+static QByteArray JsonString(const QString &str)
+{
+    QByteArray in = str.toUtf8();
+    QByteArray out;
+    out.reserve(in.size() + 2);
+    out += '"';
+    for (int i = 0; i < in.size(); i++)
+    {
+        char c = in[i];
+        if (c == '"' || c == '\\')
+        {
+            out += '\\';
+            out += c;
+        }
+        else if ((unsigned char)c < 0x20)
+        {
+            out += QString("\\u%1").arg((int)(unsigned char)c, 4, 16,
+                                        QChar('0')).toLatin1();
+        }
+        else
+        {
+            out += c;
+        }
+    }
+    out += '"';
+    return out;
+}
+
+/** \brief Enables recording, and if filename is not empty arranges for
+ *         the trace to be written to it by Finish().
+ */
+void MythTrace::Start(const QString &filename)
+{
+    {
+        QMutexLocker locker(&s_traceLock);
+        s_traceFilename = filename;
+    }
+
+    LOG(VB_GENERAL, LOG_INFO, LOC + "Tracing enabled" +
+        (filename.isEmpty() ? QString() : QString(", writing to ") + filename));
+
+    SetEnabled(true);
+}
+
+void MythTrace::SetEnabled(bool enable)
+{
+    s_traceEnabled.fetchAndStoreOrdered(enable ? 1 : 0);
+}
+
+bool MythTrace::IsEnabled(void)
+{
+    return s_traceEnabled.loadAcquire();
+}
+
+/** \brief Stops recording and writes the trace to the file passed to
+ *         Start(), if any.
+ */
+void MythTrace::Finish(void)
+{
+    SetEnabled(false);
+
+    QString filename;
+    {
+        QMutexLocker locker(&s_traceLock);
+        filename = s_traceFilename;
+        s_traceFilename.clear();
+    }
+
+    if (!filename.isEmpty())
+        Dump(filename);
+}
+
+/// \brief Discards all recorded spans.
+void MythTrace::Clear(void)
+{
+    QMutexLocker locker(&s_traceLock);
+    QList<TraceRingPtr>::iterator it = s_traceRings.begin();
+    for (; it != s_traceRings.end(); ++it)
+    {
+        QMutexLocker ringLocker(&(*it)->lock);
+        (*it)->next  = 0;
+        (*it)->count = 0;
+    }
+}
+
+/// \brief Microseconds since the trace clock was first used.
+qint64 MythTrace::NowUsecs(void)
+{
+    static QElapsedTimer clock;
+    static bool started = (clock.start(), true);
+    (void) started;
+    return clock.nsecsElapsed() / 1000;
+}
+
+void MythTrace::AddSpan(const char *name, const char *category,
+                        qint64 start_us, qint64 duration_us)
+{
+    if (!IsEnabled())
+        return;
+    GetThreadRing()->Add(name, category, start_us, duration_us);
+}
+
+void MythTrace::AddInstant(const char *name, const char *category)
+{
+    if (!IsEnabled())
+        return;
+    GetThreadRing()->Add(name, category, NowUsecs(), -1);
+}
+
+/** \brief Returns the recorded spans of all threads in the Chrome trace
+ *         event JSON format.
+ */
+QByteArray MythTrace::ToChromeTrace(void)
+{
+    QByteArray json("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+    bool first = true;
+
+    QMutexLocker locker(&s_traceLock);
+    QList<TraceRingPtr>::const_iterator it = s_traceRings.begin();
+    for (; it != s_traceRings.end(); ++it)
+    {
+        TraceRing *ring = it->data();
+        QMutexLocker ringLocker(&ring->lock);
+        QByteArray tid = QByteArray::number(ring->tid);
+
+        if (!first)
+            json += ',';
+        first = false;
+        json += "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + pid +
+                ",\"tid\":" + tid + ",\"args\":{\"name\":" +
+                JsonString(ring->name) + "}}";
+
+        int idx = (ring->next - ring->count + kTraceRingSize) % kTraceRingSize;
+        for (int i = 0; i < ring->count; i++)
+        {
+            const TraceEvent &ev = ring->events[(idx + i) % kTraceRingSize];
+            json += ",\n{\"name\":" + JsonString(ev.name) +
+                    ",\"cat\":" + JsonString(ev.category) +
+                    ",\"pid\":" + pid + ",\"tid\":" + tid +
+                    ",\"ts\":" + QByteArray::number(ev.start);
+            if (ev.duration < 0)
+                json += ",\"ph\":\"i\",\"s\":\"t\"}";
+            else
+                json += ",\"ph\":\"X\",\"dur\":" +
+                        QByteArray::number(ev.duration) + "}";
+        }
+    }
+
+    json += "\n]}\n";
+    return json;
+}
+
+/// \brief Writes the trace to filename in the Chrome trace event format.
+bool MythTrace::Dump(const QString &filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Unable to open '%1' for writing").arg(filename));
+        return false;
+    }
+
+    QByteArray json = ToChromeTrace();
+    if (file.write(json) != json.size())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Failed to write trace to '%1'").arg(filename));
+        return false;
+    }
+
+    LOG(VB_GENERAL, LOG_INFO, LOC + QString("Wrote trace to '%1'")
+        .arg(filename));
+    return true;
+}
+
+/*
+ * vim:ts=4:sw=4:ai:et:si:sts=4
+ */
@@ -0,0 +1,82 @@
+#ifndef MYTHTRACE_H_
+#define MYTHTRACE_H_
+
+#include <QString>
+#include <QByteArray>
+
+#include "mythbaseexp.h"
+
+/** \class MythTrace
+ *  \brief Low overhead timeline tracer for analyzing serial start-up paths.
+ *
+ *  Spans are recorded per thread into a fixed size ring buffer, so when
+ *  the buffer fills the oldest spans are overwritten. Recording is off by
+ *  default; when it is off a MythTraceSpan costs a single atomic load.
+ *
+ *  The recorded timeline can be written as Chrome trace event JSON, which
+ *  can be loaded in chrome://tracing or https://ui.perfetto.dev. Tracing
+ *  is enabled from the command line with --trace-file, in which case the
+ *  trace is written when the application exits, or at run time through
+ *  the frontend network control "set trace" command.
+ *
+ *  Span names and categories are stored as pointers and must be string
+ *  literals or otherwise outlive the trace.
+ */
+class MBASE_PUBLIC MythTrace
+{
+  public:
+    static void Start(const QString &filename = QString());
+    static void SetEnabled(bool enable);
+    static bool IsEnabled(void);
+    static void Finish(void);
+    static void Clear(void);
+
+    static void AddSpan(const char *name, const char *category,
+                        qint64 start_us, qint64 duration_us);
+    static void AddInstant(const char *name, const char *category);
+
+    static qint64 NowUsecs(void);
+
+    static QByteArray ToChromeTrace(void);
+    static bool Dump(const QString &filename);
+};
+
+/** \class MythTraceSpan
+ *  \brief Records the lifetime of the enclosing scope as a trace span.
+ */
+class MBASE_PUBLIC MythTraceSpan
+{
+  public:
+    MythTraceSpan(const char *name, const char *category)
+        : m_name(name), m_category(category),
+          m_start(MythTrace::IsEnabled() ? MythTrace::NowUsecs() : -1) {}
+   ~MythTraceSpan()
+    {
+        if (m_start >= 0)
+            MythTrace::AddSpan(m_name, m_category, m_start,
+                               MythTrace::NowUsecs() - m_start);
+    }
+
+  private:
+    const char *m_name;
+    const char *m_category;
+    qint64      m_start;
+};
+
+#define MYTH_TRACE_CONCAT_(a, b) a##b
+#define MYTH_TRACE_CONCAT(a, b) MYTH_TRACE_CONCAT_(a, b)
+
+/// Traces the rest of the enclosing scope under name and category.
+#define MYTH_TRACE_SCOPE(name, category) \
+    MythTraceSpan MYTH_TRACE_CONCAT(myth_trace_span_, __LINE__)(name, category)
+
+/// Marks a single point in time, e.g. the first frame being displayed.
+#define MYTH_TRACE_INSTANT(name, category) \
+    do { if (MythTrace::IsEnabled()) \
+             MythTrace::AddInstant(name, category); } while (0)
+
+#endif
+
+/*
+ * vim:ts=4:sw=4:ai:et:si:sts=4
+ */
@@ -44,8 +44,8 @@
  *       http://www.mythtv.org/wiki/Category:Myth_Protocol_Commands
  *       http://www.mythtv.org/wiki/Category:Myth_Protocol
  */
-#define MYTH_PROTO_VERSION "91"
-#define MYTH_PROTO_TOKEN "BuzzOff"
+#define MYTH_PROTO_VERSION "93"
+#define MYTH_PROTO_TOKEN "BlueHeron"
 
 /** \brief Increment this whenever the MythTV core database schema changes.
  *
@@ -64,7 +64,7 @@
  *      mythtv/bindings/php/MythBackend.php
  */
 
-#define MYTH_DATABASE_VERSION "1348"
+#define MYTH_DATABASE_VERSION "1349"
 
 
  MBASE_PUBLIC  const char *GetMythSourceVersion();
@@ -0,0 +1,3 @@
+#include "test_logging.h"
+
+QTEST_GUILESS_MAIN(TestLogging)
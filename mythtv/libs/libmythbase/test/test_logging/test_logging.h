@@ -0,0 +1,202 @@
+/*
+ *  Class TestLogging
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+#include <QMutex>
+#include <QQueue>
+#include <QRegExp>
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "mythlogging.h"
+#include "logging.h"
+#include "logringbuffer.h"
+
+class TestLogging: public QObject
+{
+    Q_OBJECT
+
+    static bool Push(LogRingBuffer &ring, qint64 nsecs, const QByteArray &msg)
+    {
+        LogRecord record;
+        record.nsecs    = nsecs;
+        record.line     = __LINE__;
+        record.level    = LOG_INFO;
+        record.type     = kMessage;
+        return ring.Push(record, msg.constData(), msg.size(),
+                         __FILE__, __FUNCTION__);
+    }
+
+    /// The work LogPrintLine() used to do on the calling thread for each
+    /// message, before log rings: allocate and fill a LoggingItem, escape
+    /// and format the message, then queue it under a global mutex.
+    static void LegacyLogPrintLine(QMutex &mutex, QQueue<LoggingItem *> &queue,
+                                   const char *file, int line,
+                                   const char *function,
+                                   const char *format, ...)
+    {
+        static QRegExp escape("[%]{1,2}");
+
+        LoggingItem *item = LoggingItem::create(file, function, line,
+                                                (LogLevel_t)LOG_INFO,
+                                                kMessage);
+        char *formatcopy = NULL;
+        if (strchr(format, '%'))
+        {
+            QString string(format);
+            formatcopy = strdup(string.replace(escape, "%%").toLocal8Bit()
+                                .constData());
+            format = formatcopy;
+        }
+
+        char message[LOGLINE_MAX + 1];
+        va_list arguments;
+        va_start(arguments, format);
+        vsnprintf(message, LOGLINE_MAX, format, arguments);
+        va_end(arguments);
+        item->setMessage(message);
+
+        free(formatcopy);
+
+        QMutexLocker locker(&mutex);
+        queue.enqueue(item);
+    }
+
+  private slots:
+    void initTestCase(void)
+    {
+        verboseMask |= VB_GENERAL;
+        logLevel = LOG_INFO;
+
+        // No console output and no mythlogserver, only the logging thread
+        logStart("", 0, 1, -1, LOG_INFO, false, false, true);
+    }
+
+    void cleanupTestCase(void)
+    {
+        logStop();
+    }
+
+    void RingKeepsOrderAndText(void)
+    {
+        LogRingBuffer ring(0, 0, 4096);
+        QVERIFY(ring.IsEmpty());
+        QVERIFY(ring.Peek() == NULL);
+
+        QVERIFY(Push(ring, 1, "first"));
+        QVERIFY(Push(ring, 2, ""));
+        QVERIFY(Push(ring, 3, "third"));
+
+        const LogRecord *record = ring.Peek();
+        QVERIFY(record != NULL);
+        QCOMPARE(record->nsecs, (qint64)1);
+        QCOMPARE(QByteArray(LogRingBuffer::Message(record)), QByteArray("first"));
+        QCOMPARE(QByteArray(LogRingBuffer::File(record)), QByteArray(__FILE__));
+        QCOMPARE(QByteArray(LogRingBuffer::Function(record)),
+                 QByteArray("Push"));
+        ring.Pop();
+
+        record = ring.Peek();
+        QCOMPARE(record->nsecs, (qint64)2);
+        QCOMPARE(record->length, (uint32_t)0);
+        ring.Pop();
+
+        record = ring.Peek();
+        QCOMPARE(record->nsecs, (qint64)3);
+        QCOMPARE(QByteArray(LogRingBuffer::Message(record)), QByteArray("third"));
+        ring.Pop();
+
+        QVERIFY(ring.IsEmpty());
+        QCOMPARE(ring.TakeDropped(), 0u);
+    }
+
+    void FullRingDrops(void)
+    {
+        LogRingBuffer ring(0, 0, 4096);
+        QByteArray msg(1000, 'x');
+
+        int pushed = 0;
+        for (int i = 0; i < 10; i++)
+            if (Push(ring, i, msg))
+                pushed++;
+
+        QVERIFY(pushed > 0);
+        QVERIFY(pushed < 10);
+        QCOMPARE(ring.TakeDropped(), (uint)(10 - pushed));
+        QCOMPARE(ring.TakeDropped(), 0u);
+
+        // The records that made it in are intact
+        for (int i = 0; i < pushed; i++)
+        {
+            const LogRecord *record = ring.Peek();
+            QVERIFY(record != NULL);
+            QCOMPARE(record->nsecs, (qint64)i);
+            QCOMPARE(QByteArray(LogRingBuffer::Message(record)), msg);
+            ring.Pop();
+        }
+        QVERIFY(ring.IsEmpty());
+    }
+
+    void RingWrapsAround(void)
+    {
+        LogRingBuffer ring(0, 0, 4096);
+
+        // Sizes that don't divide the ring, so records end up being moved
+        // to the start of the buffer
+        for (int i = 0; i < 1000; i++)
+        {
+            QByteArray msg(100 + (i * 37) % 900, 'a' + i % 26);
+            QVERIFY(Push(ring, i, msg));
+
+            const LogRecord *record = ring.Peek();
+            QVERIFY(record != NULL);
+            QCOMPARE(record->nsecs, (qint64)i);
+            QCOMPARE(QByteArray(LogRingBuffer::Message(record)), msg);
+            ring.Pop();
+        }
+        QVERIFY(ring.IsEmpty());
+    }
+
+    void benchmarkLog(void)
+    {
+        QBENCHMARK
+        {
+            LOG(VB_GENERAL, LOG_INFO, "Benchmark message with 100% of "
+                "the usual length for a log message");
+        }
+    }
+
+    void benchmarkLegacyLog(void)
+    {
+        QMutex                mutex;
+        QQueue<LoggingItem *> queue;
+
+        QBENCHMARK
+        {
+            LegacyLogPrintLine(mutex, queue, __FILE__, __LINE__, __FUNCTION__,
+                               QString("Benchmark message with 100% of "
+                                       "the usual length for a log message")
+                               .toLocal8Bit().constData());
+        }
+
+        while (!queue.isEmpty())
+            queue.dequeue()->DecrRef();
+    }
+};
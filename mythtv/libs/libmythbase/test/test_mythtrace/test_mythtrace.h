@@ -0,0 +1,133 @@
+/*
+ *  Class TestMythTrace
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+#include "mythtrace.h"
+
+class TestMythTrace: public QObject
+{
+    Q_OBJECT
+
+    static QJsonArray Events(void)
+    {
+        QJsonDocument doc = QJsonDocument::fromJson(MythTrace::ToChromeTrace());
+        return doc.object()["traceEvents"].toArray();
+    }
+
+    static int Count(const QJsonArray &events, const QString &ph)
+    {
+        int count = 0;
+        for (int i = 0; i < events.size(); i++)
+            if (events[i].toObject()["ph"].toString() == ph)
+                count++;
+        return count;
+    }
+
+  private slots:
+    void init(void)
+    {
+        MythTrace::SetEnabled(false);
+        MythTrace::Clear();
+    }
+
+    void DisabledRecordsNothing(void)
+    {
+        {
+            MYTH_TRACE_SCOPE("span", "test");
+        }
+        MYTH_TRACE_INSTANT("instant", "test");
+        QCOMPARE(Count(Events(), "X"), 0);
+        QCOMPARE(Count(Events(), "i"), 0);
+    }
+
+    void SpanIsRecorded(void)
+    {
+        MythTrace::SetEnabled(true);
+        {
+            MYTH_TRACE_SCOPE("span", "test");
+            QTest::qSleep(5);
+        }
+        QJsonArray events = Events();
+        QCOMPARE(Count(events, "X"), 1);
+        for (int i = 0; i < events.size(); i++)
+        {
+            QJsonObject ev = events[i].toObject();
+            if (ev["ph"].toString() != "X")
+                continue;
+            QCOMPARE(ev["name"].toString(), QString("span"));
+            QCOMPARE(ev["cat"].toString(), QString("test"));
+            QVERIFY(ev["dur"].toDouble() >= 4000);
+        }
+    }
+
+    void InstantIsRecorded(void)
+    {
+        MythTrace::SetEnabled(true);
+        MYTH_TRACE_INSTANT("instant", "test");
+        QCOMPARE(Count(Events(), "i"), 1);
+    }
+
+    void ThreadNameIsRecorded(void)
+    {
+        MythTrace::SetEnabled(true);
+        MYTH_TRACE_INSTANT("instant", "test");
+        QVERIFY(Count(Events(), "M") >= 1);
+    }
+
+    void RingOverwritesOldestSpans(void)
+    {
+        MythTrace::SetEnabled(true);
+        for (int i = 0; i < 20000; i++)
+            MythTrace::AddSpan("span", "test", i, 1);
+        QJsonArray events = Events();
+        int spans = Count(events, "X");
+        QVERIFY(spans > 0);
+        QVERIFY(spans < 20000);
+
+        // the newest span must have survived
+        bool found = false;
+        for (int i = 0; i < events.size(); i++)
+            if (events[i].toObject()["ts"].toDouble() == 19999)
+                found = true;
+        QVERIFY(found);
+    }
+
+    void NamesAreEscaped(void)
+    {
+        MythTrace::SetEnabled(true);
+        MythTrace::AddSpan("quote\" back\\slash\ttab", "test", 0, 1);
+
+        QByteArray json = MythTrace::ToChromeTrace();
+        QVERIFY(json.contains(
+                    "\"name\":\"quote\\\" back\\\\slash\\u0009tab\""));
+
+        QJsonArray events = Events();
+        QCOMPARE(Count(events, "X"), 1);
+        for (int i = 0; i < events.size(); i++)
+        {
+            QJsonObject ev = events[i].toObject();
+            if (ev["ph"].toString() == "X")
+                QCOMPARE(ev["name"].toString(),
+                         QString("quote\" back\\slash\ttab"));
+        }
+    }
+};
@@ -1,5 +1,8 @@
 #include <map>
 
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
 #include <QDir>
 #include <QUrl>
 
@@ -9,6 +12,7 @@
 #include "remoteutil.h"
 #include "mythcontext.h"
 #include "mythlogging.h"
+#include "mythdirs.h"
 #include "videoutils.h"
 #include "storagegroup.h"
 
@@ -16,6 +20,185 @@ DirectoryHandler::~DirectoryHandler()
 {
 }
 
+namespace
+{
+    const quint32 kDirCacheMagic   = 0x4d564443; // MVDC
+    const quint32 kDirCacheVersion = 2;
+
+    /// How long before its entries were read a directory must have been
+    /// modified for them to be trusted by the next scan
+    const qint64  kDirCacheSettleMS = 2000;
+}
+
+QString VideoDirCache::DefaultFilename(void)
+{
+    return GetConfDir() + "/videodirs.cache";
+}
+
+bool VideoDirCache::Load(const QString &filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic = 0, version = 0, count = 0;
+    stream >> magic >> version >> count;
+    if (magic != kDirCacheMagic || version != kDirCacheVersion)
+    {
+        LOG(VB_GENERAL, LOG_INFO,
+            QString("Ignoring old video directory cache %1").arg(filename));
+        return false;
+    }
+
+    QHash<QString, Entry> entries;
+    entries.reserve(count);
+
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i)
+    {
+        QString path;
+        Entry entry;
+        stream >> path >> entry.mtime >> entry.readTime >> entry.isDisc
+               >> entry.files >> entry.dirs;
+        entries.insert(path, entry);
+    }
+
+    if (stream.status() != QDataStream::Ok)
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            QString("Video directory cache %1 is damaged, ignoring it")
+                .arg(filename));
+        return false;
+    }
+
+    QMutexLocker locker(&m_lock);
+    m_entries = entries;
+    m_seen.clear();
+
+    return true;
+}
+
+/// Write the cache to a temporary file and rename it over filename, so a
+/// scan that is interrupted never leaves half a cache behind
+bool VideoDirCache::Save(const QString &filename) const
+{
+    QString tmpname = filename + ".tmp";
+    QFile file(tmpname);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        LOG(VB_GENERAL, LOG_ERR,
+            QString("Unable to write video directory cache %1").arg(tmpname));
+        return false;
+    }
+
+    {
+        QDataStream stream(&file);
+        stream.setVersion(QDataStream::Qt_5_0);
+
+        QMutexLocker locker(&m_lock);
+
+        stream << kDirCacheMagic << kDirCacheVersion
+               << (quint32)m_entries.size();
+
+        QHash<QString, Entry>::const_iterator it = m_entries.constBegin();
+        for (; it != m_entries.constEnd(); ++it)
+        {
+            stream << it.key() << it->mtime << it->readTime << it->isDisc
+                   << it->files << it->dirs;
+        }
+    }
+
+    file.close();
+
+    if (file.error() != QFile::NoError)
+    {
+        file.remove();
+        return false;
+    }
+
+    QFile::remove(filename);
+    return QFile::rename(tmpname, filename);
+}
+
+/// Start a scan, from now on only entries for directories that are seen
+/// again survive Prune()
+void VideoDirCache::BeginScan(void)
+{
+    QMutexLocker locker(&m_lock);
+    m_seen.clear();
+}
+
+/**
+ *  \brief Returns the cached entries of path in entry, if the directory
+ *         hasn't been modified since they were read.
+ *
+ *  Entries read within kDirCacheSettleMS of the directory being modified
+ *  aren't returned, a file added later in the same mtime tick wouldn't
+ *  change the mtime.
+ */
+bool VideoDirCache::Lookup(const QString &path, qint64 mtime, Entry &entry)
+{
+    QMutexLocker locker(&m_lock);
+
+    QHash<QString, Entry>::const_iterator it = m_entries.constFind(path);
+    if (it == m_entries.constEnd() || it->mtime != mtime ||
+        it->readTime - it->mtime < kDirCacheSettleMS)
+    {
+        return false;
+    }
+
+    entry = *it;
+    m_seen.insert(path);
+
+    return true;
+}
+
+void VideoDirCache::Store(const QString &path, const Entry &entry)
+{
+    QMutexLocker locker(&m_lock);
+    m_entries.insert(path, entry);
+    m_seen.insert(path);
+}
+
+/// Forget the directories in root that weren't seen since BeginScan()
+void VideoDirCache::Prune(const QString &root)
+{
+    QString prefix = root.endsWith("/") ? root : root + "/";
+
+    QMutexLocker locker(&m_lock);
+
+    QHash<QString, Entry>::iterator it = m_entries.begin();
+    while (it != m_entries.end())
+    {
+        if ((it.key() == root || it.key().startsWith(prefix)) &&
+            !m_seen.contains(it.key()))
+        {
+            it = m_entries.erase(it);
+        }
+        else
+            ++it;
+    }
+}
+
+/// All the directories that were scanned, except the insides of discs
+QStringList VideoDirCache::Directories(void) const
+{
+    QStringList dirs;
+
+    QMutexLocker locker(&m_lock);
+
+    QHash<QString, Entry>::const_iterator it = m_entries.constBegin();
+    for (; it != m_entries.constEnd(); ++it)
+    {
+        if (!it->isDisc)
+            dirs.append(it.key());
+    }
+
+    return dirs;
+}
+
 namespace
 {
     class ext_lookup
@@ -114,6 +297,94 @@ namespace
         return true;
     }
 
+    /// Get the entries of path, from cache if it is unchanged since they
+    /// were read, otherwise from disk
+    bool read_dir(const QString &path, VideoDirCache *cache,
+                  VideoDirCache::Entry &entry)
+    {
+        QFileInfo info(path);
+        if (!info.isDir())
+            return false;
+
+        qint64 mtime = info.lastModified().toMSecsSinceEpoch();
+        if (cache->Lookup(path, mtime, entry))
+            return true;
+
+        qint64 read_time = QDateTime::currentMSecsSinceEpoch();
+
+        QDir d(path);
+        d.setFilter(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
+        QFileInfoList list = d.entryInfoList();
+
+        entry = VideoDirCache::Entry();
+        entry.mtime = mtime;
+        entry.readTime = read_time;
+
+        for (QFileInfoList::iterator p = list.begin(); p != list.end(); ++p)
+        {
+            if (p->isDir())
+                entry.dirs.append(p->fileName());
+            else
+                entry.files.append(p->fileName());
+        }
+
+        entry.isDisc = entry.dirs.contains("VIDEO_TS") ||
+                       entry.dirs.contains("BDMV");
+
+        cache->Store(path, entry);
+
+        return true;
+    }
+
+    /// The same walk as scan_dir(), but only directories that changed since
+    /// the last scan are read
+    bool scan_cached_dir(const QString &start_path, DirectoryHandler *handler,
+                         const ext_lookup &ext_settings, VideoDirCache *cache)
+    {
+        VideoDirCache::Entry entry;
+
+        // Return a fail if directory doesn't exist.
+        if (!read_dir(start_path, cache, entry))
+            return false;
+
+        QDir d(start_path);
+
+        for (QStringList::const_iterator p = entry.dirs.begin();
+             p != entry.dirs.end(); ++p)
+        {
+            QString fq_name = d.absoluteFilePath(*p);
+            VideoDirCache::Entry sub;
+
+            // Same as scan_dir(), failing to read a subdirectory is fine
+            if (!read_dir(fq_name, cache, sub))
+                continue;
+
+            if (sub.isDisc)
+            {
+                handler->handleFile(*p, fq_name, QFileInfo(*p).suffix(), "");
+                continue;
+            }
+
+            DirectoryHandler *dh = handler->newDir(*p, fq_name);
+            (void) scan_cached_dir(fq_name, dh, ext_settings, cache);
+        }
+
+        for (QStringList::const_iterator p = entry.files.begin();
+             p != entry.files.end(); ++p)
+        {
+            if (*p == "Thumbs.db")
+                continue;
+
+            QString suffix = QFileInfo(*p).suffix();
+            if (ext_settings.extension_ignored(suffix))
+                continue;
+
+            handler->handleFile(*p, d.absoluteFilePath(*p), suffix, "");
+        }
+
+        return true;
+    }
+
     bool scan_sg_dir(const QString &start_path, const QString &host,
                      const QString &base_path, DirectoryHandler *handler,
                      const ext_lookup &ext_settings, bool isMaster = false)
@@ -229,7 +500,7 @@ namespace
 
 bool ScanVideoDirectory(const QString &start_path, DirectoryHandler *handler,
         const FileAssociations::ext_ignore_list &ext_disposition,
-        bool list_unknown_extensions)
+        bool list_unknown_extensions, VideoDirCache *cache)
 {
     ext_lookup extlookup(ext_disposition, list_unknown_extensions);
 
@@ -241,12 +512,22 @@ bool ScanVideoDirectory(const QString &start_path, DirectoryHandler *handler,
             QString("MythVideo::ScanVideoDirectory Scanning (%1)")
                 .arg(start_path));
 
-        if (!scan_dir(start_path, handler, extlookup))
+        if (cache)
+        {
+            QString root = QDir(start_path).absolutePath();
+
+            pathScanned = scan_cached_dir(root, handler, extlookup, cache);
+            if (pathScanned)
+                cache->Prune(root);
+        }
+        else
+            pathScanned = scan_dir(start_path, handler, extlookup);
+
+        if (!pathScanned)
         {
             LOG(VB_GENERAL, LOG_ERR,
                 QString("MythVideo::ScanVideoDirectory failed to scan %1")
                     .arg(start_path));
-            pathScanned = false;
         }
     }
     else
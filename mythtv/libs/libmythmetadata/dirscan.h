@@ -1,6 +1,12 @@
 #ifndef DIRSCAN_H_
 #define DIRSCAN_H_
 
+#include <QStringList>
+#include <QString>
+#include <QMutex>
+#include <QHash>
+#include <QSet>
+
 #include "mythmetaexp.h"
 
 class META_PUBLIC DirectoryHandler
@@ -15,8 +21,53 @@ class META_PUBLIC DirectoryHandler
                             const QString &host) = 0;
 };
 
+/** \class VideoDirCache
+ *  \brief Remembers what each local video directory contained, and when it
+ *         was last modified, so a rescan only lists the directories that
+ *         changed.
+ *
+ *  Adding, removing or renaming an entry changes the modification time of
+ *  the directory it is in, so a directory with the same time as last scan
+ *  still has the same entries.  Its subdirectories still have to be checked
+ *  themselves, but that's one stat each instead of reading every directory
+ *  and every file in the tree.  Directories modified just before they were
+ *  read aren't trusted on the next scan, as more may have changed within
+ *  the same clock tick.
+ */
+class META_PUBLIC VideoDirCache
+{
+  public:
+    struct Entry
+    {
+        Entry() : mtime(0), readTime(0), isDisc(false) {}
+
+        qint64      mtime;    ///< Modification time, msecs since the epoch
+        qint64      readTime; ///< When the entries were read, ditto
+        bool        isDisc;   ///< Holds a VIDEO_TS or BDMV directory
+        QStringList files;    ///< Names of everything but directories
+        QStringList dirs;     ///< Names of the subdirectories
+    };
+
+    static QString DefaultFilename(void);
+
+    bool Load(const QString &filename);
+    bool Save(const QString &filename) const;
+
+    void BeginScan(void);
+    bool Lookup(const QString &path, qint64 mtime, Entry &entry);
+    void Store(const QString &path, const Entry &entry);
+    void Prune(const QString &root);
+
+    QStringList Directories(void) const;
+
+  private:
+    mutable QMutex        m_lock;
+    QHash<QString, Entry> m_entries;
+    QSet<QString>         m_seen;       ///< Looked up or stored this scan
+};
+
 META_PUBLIC bool ScanVideoDirectory(const QString &start_path, DirectoryHandler *handler,
         const FileAssociations::ext_ignore_list &ext_disposition,
-        bool list_unknown_extensions);
+        bool list_unknown_extensions, VideoDirCache *cache = NULL);
 
 #endif // DIRSCAN_H_
@@ -179,6 +179,12 @@ public:
     static QString GetAbsThumbPath(const QString &devPath, const QString &path)
     { return QString("%1/" TEMP_SUBDIR "/%2/%3").arg(GetConfDir(), devPath, path); }
 
+    //! Get absolute filepath of a thumbnail that is shared by all images with
+    //! the same content, or of the dir of all such thumbnails
+    static QString GetContentThumbPath(const QString &key = QString())
+    { return GetAbsThumbPath(THUMBNAIL_SUBDIR "/.content",
+                             key.isEmpty() ? key : key.left(2) + "/" + key); }
+
     //! Thumbnails of videos are a JPEG snapshot with jpg suffix appended
     static QString ThumbPath(const ImageItem &im)
     { return im.m_type != kVideoFile ? im.m_filePath : im.m_filePath + ".jpg"; }
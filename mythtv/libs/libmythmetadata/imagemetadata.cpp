@@ -12,8 +12,10 @@
 // file.  Using image.hpp instead seems to work.
 #ifdef _MSC_VER
 #include <exiv2/src/image.hpp>
+#include <exiv2/src/preview.hpp>
 #else
 #include <exiv2/image.hpp>
+#include <exiv2/preview.hpp>
 #endif
 
 // To read FFMPEG Metadata
@@ -255,6 +257,58 @@ QString Orientation::AsText(int orientation)
 }
 
 
+/*!
+   \brief Get the smallest preview embedded in a picture that is big enough to
+   make a thumbnail of the given size
+   \details Cameras embed JPEG previews in their files, which are much quicker
+   to decode than the picture itself. Previews have the orientation of the
+   picture.
+   \param filePath Absolute image path
+   \param minSize Size of the thumbnail
+   \return QImage The preview, or a null image if there's none big enough
+ */
+QImage ImageMetaData::GetPreview(const QString &filePath, const QSize &minSize)
+{
+    try
+    {
+        Exiv2::Image::AutoPtr image =
+                Exiv2::ImageFactory::open(filePath.toStdString());
+        if (!image.get())
+            return QImage();
+
+        image->readMetadata();
+
+        Exiv2::PreviewManager previews(*image);
+        Exiv2::PreviewPropertiesList list = previews.getPreviewProperties();
+
+        // Previews are listed smallest first
+        Exiv2::PreviewPropertiesList::const_iterator it;
+        for (it = list.begin(); it != list.end(); ++it)
+        {
+            // Don't scale up, it's good enough if it fills either dimension
+            if ((int)it->width_ < minSize.width()
+                    && (int)it->height_ < minSize.height())
+                continue;
+
+            Exiv2::PreviewImage preview = previews.getPreviewImage(*it);
+
+            QImage result;
+            if (result.loadFromData(preview.pData(), preview.size()))
+            {
+                LOG(VB_FILE, LOG_DEBUG, LOC + QString("Using %1x%2 preview of %3")
+                    .arg(it->width_).arg(it->height_).arg(filePath));
+                return result;
+            }
+        }
+    }
+    catch (Exiv2::Error &e)
+    {
+        LOG(VB_FILE, LOG_DEBUG, LOC + QString("Exiv2 exception %1").arg(e.what()));
+    }
+    return QImage();
+}
+
+
 //! Reads Exif metadata from a picture using libexiv2
 class PictureMetaData : public ImageMetaData
 {
@@ -13,6 +13,7 @@
 #include <QStringBuilder>
 #include <QStringList>
 #include <QDateTime>
+#include <QImage>
 
 #include "mythmetaexp.h"
 
@@ -98,6 +99,7 @@ class META_PUBLIC ImageMetaData
 public:
     static ImageMetaData* FromPicture(const QString &filePath);
     static ImageMetaData* FromVideo(const QString &filePath);
+    static QImage GetPreview(const QString &filePath, const QSize &minSize);
 
     virtual ~ImageMetaData() {}
 
@@ -1,9 +1,17 @@
 #include "imagethumbs.h"
 
+#include <QImageReader>
+#include <QCryptographicHash>
 #include <QDir>
 #include <QStringList>
 
+#ifndef _WIN32
+#include <sys/stat.h>         // for stat
+#include <unistd.h>           // for link
+#endif
+
 #include "mythlogging.h"
+#include "mythtimer.h"
 #include "mythcorecontext.h"  // for events
 #include "mythsystemlegacy.h" // for previewgen
 #include "mythdirs.h"         // for previewgen
@@ -12,16 +20,96 @@
 
 #include "imagemetadata.h"
 
+//! Size thumbnails of pictures are scaled to fit
+static const QSize kThumbSize(240, 180);
+
+
+/*!
+ \brief Digest of the whole content of a file
+ \return QString Hex SHA-1 of the file, empty if it can't be read
+*/
+static QString ContentHash(const QString &path)
+{
+    QFile file(path);
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    if (!file.open(QIODevice::ReadOnly) || !hash.addData(&file))
+        return QString();
+
+    return QString(hash.result().toHex());
+}
+
+
+/*!
+ \brief Number of hard links to a file
+ \return int Links, 0 if the file doesn't exist
+*/
+static int LinkCount(const QString &path)
+{
+#ifndef _WIN32
+    struct stat st;
+    if (stat(path.toLocal8Bit().constData(), &st) == 0)
+        return st.st_nlink;
+#endif
+    return 0;
+}
+
+
+/*!
+ \brief Removes the thumbnails kept by content that no image links to anymore
+ \param dir Directory of thumbnails kept by content
+*/
+static void PruneContentThumbs(const QString &dir)
+{
+    QFileInfoList files = QDir(dir).entryInfoList(QDir::Files);
+
+    foreach (const QFileInfo &file, files)
+    {
+        // The only link left is the one in the store
+        if (LinkCount(file.absoluteFilePath()) == 1
+                && QFile::remove(file.absoluteFilePath()))
+            LOG(VB_FILE, LOG_DEBUG,
+                QString("Removed unused thumbnail %1")
+                .arg(file.absoluteFilePath()));
+    }
+}
+
+
+/*!
+ \brief Processes tasks of the generator until there are none it can take
+*/
+template <class DBFS>
+void ThumbWorker<DBFS>::run()
+{
+    RunProlog();
+
+    setPriority(QThread::LowestPriority);
+
+    m_generator->ProcessTasks();
+
+    RunEpilog();
+}
+
+
 /*!
  \brief Constructor
  \param name Thread name
  \param dbfs Filesystem/Database adapter
+ \param workers Size of the worker pool
 */
 template <class DBFS>
-ThumbThread<DBFS>::ThumbThread(const QString &name, DBFS *const dbfs)
-    : MThread(name), m_dbfs(*dbfs),
-      m_requestQ(), m_backgroundQ(), m_doBackground(true)
-{}
+ThumbThread<DBFS>::ThumbThread(const QString &name, DBFS *const dbfs,
+                               int workers)
+    : m_dbfs(*dbfs),
+      m_requestQ(), m_backgroundQ(), m_doBackground(true),
+      m_running(0), m_busy(0), m_exclusive(false)
+{
+    workers = qMax(workers, 1);
+    for (int i = 0; i < workers; ++i)
+        m_workers.append(new ThumbWorker<DBFS>(
+                             workers == 1 ? name : name + QString::number(i),
+                             this));
+}
 
 
 /*!
@@ -31,12 +119,15 @@ template <class DBFS>
 ThumbThread<DBFS>::~ThumbThread()
 {
     cancel();
-    wait();
+
+    // Workers wait for their current task to finish
+    qDeleteAll(m_workers);
+    m_workers.clear();
 }
 
 
 /*!
- \brief Clears all queues so that the thread will terminate.
+ \brief Clears all queues so that the workers will terminate.
 */
 template <class DBFS>
 void ThumbThread<DBFS>::cancel()
@@ -48,6 +139,17 @@ void ThumbThread<DBFS>::cancel()
 }
 
 
+/*!
+ \brief Whether any worker is processing tasks
+*/
+template <class DBFS>
+bool ThumbThread<DBFS>::isRunning()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_running > 0;
+}
+
+
 /*!
  \brief Queues a Create request
  \param task The request
@@ -65,9 +167,35 @@ void ThumbThread<DBFS>::Enqueue(const TaskPtr &task)
         else
             m_requestQ.insert(task->m_priority, task);
 
-        // restart if not already running
-        if ((m_doBackground || !background) && !this->isRunning())
-            this->start();
+        // start workers if not already running
+        StartWorkers();
+    }
+}
+
+
+/*!
+ \brief Starts idle workers for the tasks that can be processed now
+ \note Generator mutex must be held
+*/
+template <class DBFS>
+void ThumbThread<DBFS>::StartWorkers()
+{
+    int queued = m_requestQ.size() + (m_doBackground ? m_backgroundQ.size() : 0);
+    int wanted = qMin(m_busy + queued, m_workers.size()) - m_running;
+
+    for (int i = 0; wanted > 0 && i < m_workers.size(); ++i)
+    {
+        ThumbWorker<DBFS> *worker = m_workers.at(i);
+        if (worker->m_active)
+            continue;
+
+        // It has left ProcessTasks but its thread may not have finished yet
+        worker->wait();
+
+        worker->m_active = true;
+        ++m_running;
+        --wanted;
+        worker->start();
     }
 }
 
@@ -97,9 +225,15 @@ void ThumbThread<DBFS>::AbortDevice(int devId, const QString &action)
     QMutexLocker locker(&m_mutex);
     RemoveTasks(m_requestQ, devId);
     RemoveTasks(m_backgroundQ, devId);
-    if (isRunning())
-        // Wait until current task is complete - it may be using the device
-        m_taskDone.wait(&m_mutex, 3000);
+
+    // Wait until current tasks are complete - they may be using the device
+    MythTimer timer(MythTimer::kStartRunning);
+    while (m_busy > 0)
+    {
+        int remaining = 3000 - timer.elapsed();
+        if (remaining <= 0 || !m_taskDone.wait(&m_mutex, remaining))
+            break;
+    }
 }
 
 
@@ -124,122 +258,188 @@ void ThumbThread<DBFS>::RemoveTasks(ThumbQueue &queue, int devId)
 
 /*!
  \brief  Handles thumbnail requests by priority
- \details Repeatedly processes next request from highest priority queue until all
-  queues are empty, then quits. For Create requests an event is broadcast once the
-  thumbnail exists. Dirs are only deleted if empty
+ \details Repeatedly processes next request from highest priority queue until
+  there are none this worker can take, then quits.
 */
 template <class DBFS>
-void ThumbThread<DBFS>::run()
+void ThumbThread<DBFS>::ProcessTasks()
 {
-    RunProlog();
-
-    setPriority(QThread::LowestPriority);
-
     while (true)
     {
-        // Signal previous task is complete (its files have been closed)
-        m_taskDone.wakeAll();
-
         // Do all we can to run in background
         QThread::yieldCurrentThread();
 
         // process next highest-priority task
-        TaskPtr task;
+        TaskPtr task = TakeTask();
+        if (!task)
+            break;
+
+        RunTask(task);
+
+        QMutexLocker locker(&m_mutex);
+        --m_busy;
+        if (m_exclusive)
         {
-            QMutexLocker locker(&m_mutex);
-            if (!m_requestQ.isEmpty())
-                task = m_requestQ.take(m_requestQ.constBegin().key());
-            else if (m_doBackground && !m_backgroundQ.isEmpty())
-                task = m_backgroundQ.take(m_backgroundQ.constBegin().key());
-            else
-                // quit when both queues exhausted
-                break;
+            // Other workers may have given up whilst it ran
+            m_exclusive = false;
+            StartWorkers();
         }
 
-        // Shouldn't receive empty requests
-        if (task->m_images.isEmpty())
-            continue;
+        // Signal task is complete (its files have been closed)
+        m_taskDone.wakeAll();
+    }
+}
+
+
+/*!
+ \brief Takes the next task to process, retiring the calling worker if there
+ isn't one
+ \details Delete & move tasks must run alone. When one is next the workers
+ retire as they finish, and the last one processes it.
+ \return TaskPtr The task, or a null task if the worker should quit
+*/
+template <class DBFS>
+TaskPtr ThumbThread<DBFS>::TakeTask()
+{
+    QMutexLocker locker(&m_mutex);
 
-        if (task->m_action == "CREATE")
+    ThumbQueue *queue = NULL;
+    if (m_exclusive)
+        queue = NULL;
+    else if (!m_requestQ.isEmpty())
+        queue = &m_requestQ;
+    else if (m_doBackground && !m_backgroundQ.isEmpty())
+        queue = &m_backgroundQ;
+
+    if (queue)
+    {
+        TaskPtr task = queue->constBegin().value();
+        bool exclusive = task->m_action != "CREATE";
+
+        if (!exclusive || m_busy == 0)
         {
-            ImagePtrK im = task->m_images.at(0);
+            queue->erase(queue->begin());
+            ++m_busy;
+            m_exclusive = exclusive;
+            return task;
+        }
+    }
 
-            QString err = CreateThumbnail(im, task->m_priority);
+    // quit when there's nothing for this worker
+    for (int i = 0; i < m_workers.size(); ++i)
+        if (m_workers.at(i)->qthread() == QThread::currentThread())
+            m_workers.at(i)->m_active = false;
+    --m_running;
 
-            if (!err.isEmpty())
-            {
-                LOG(VB_GENERAL, LOG_ERR,  QString("%1").arg(err));
-            }
-            else if (task->m_notify)
-            {
-                // notify clients when done
-                m_dbfs.Notify("THUMB_AVAILABLE",
-                              QStringList(QString::number(im->m_id)));
-            }
+    return TaskPtr();
+}
+
+
+/*!
+ \brief Processes a request
+ \details For Create requests an event is broadcast once the thumbnail exists.
+ Dirs are only deleted if empty
+*/
+template <class DBFS>
+void ThumbThread<DBFS>::RunTask(const TaskPtr &task)
+{
+    // Shouldn't receive empty requests
+    if (task->m_images.isEmpty())
+        return;
+
+    if (task->m_action == "CREATE")
+    {
+        ImagePtrK im = task->m_images.at(0);
+
+        QString err = CreateThumbnail(im, task->m_priority);
+
+        if (!err.isEmpty())
+        {
+            LOG(VB_GENERAL, LOG_ERR,  QString("%1").arg(err));
         }
-        else if (task->m_action == "DELETE")
+        else if (task->m_notify)
         {
-            foreach(ImagePtrK im, task->m_images)
-            {
-                QString thumbnail = im->m_thumbPath;
-                if (!QDir::root().remove(thumbnail))
-                {
-                    LOG(VB_FILE, LOG_WARNING,
-                        QString("Failed to delete thumbnail %1").arg(thumbnail));
-                    continue;
-                }
-                LOG(VB_FILE, LOG_DEBUG,
-                    QString("Deleted thumbnail %1").arg(thumbnail));
+            // notify clients when done
+            m_dbfs.Notify("THUMB_AVAILABLE",
+                          QStringList(QString::number(im->m_id)));
+        }
+    }
+    else if (task->m_action == "DELETE")
+    {
+        // Whether a thumbnail kept by content may have lost its last image
+        bool shared = false;
 
-                // Clean up empty dirs
-                QString path = QFileInfo(thumbnail).path();
-                if (QDir::root().rmpath(path))
-                    LOG(VB_FILE, LOG_DEBUG,
-                        QString("Cleaned up path %1").arg(path));
+        foreach(ImagePtrK im, task->m_images)
+        {
+            QString thumbnail = im->m_thumbPath;
+            int     links     = LinkCount(thumbnail);
+
+            if (!QDir::root().remove(thumbnail))
+            {
+                LOG(VB_FILE, LOG_WARNING,
+                    QString("Failed to delete thumbnail %1").arg(thumbnail));
+                continue;
             }
+            LOG(VB_FILE, LOG_DEBUG,
+                QString("Deleted thumbnail %1").arg(thumbnail));
+
+            if (links == 2)
+                shared = true;
+
+            // Clean up empty dirs
+            QString path = QFileInfo(thumbnail).path();
+            if (QDir::root().rmpath(path))
+                LOG(VB_FILE, LOG_DEBUG,
+                    QString("Cleaned up path %1").arg(path));
         }
-        else if (task->m_action == "MOVE")
+
+        // Deletes run alone, so no thumbnail is being linked meanwhile
+        if (shared)
+            PruneContentThumbs(m_dbfs.GetContentThumbPath());
+    }
+    else if (task->m_action == "MOVE")
+    {
+        foreach(ImagePtrK im, task->m_images)
         {
-            foreach(ImagePtrK im, task->m_images)
+            // Build new thumb path
+            QString newThumbPath =
+                    m_dbfs.GetAbsThumbPath(m_dbfs.ThumbDir(im->m_device),
+                                           m_dbfs.ThumbPath(*im.data()));
+
+            // Ensure path exists
+            if (QDir::root().mkpath(QFileInfo(newThumbPath).path())
+                    && QFile::rename(im->m_thumbPath, newThumbPath))
+            {
+                LOG(VB_FILE, LOG_DEBUG, QString("Moved thumbnail %1 -> %2")
+                    .arg(im->m_thumbPath, newThumbPath));
+            }
+            else
             {
-                // Build new thumb path
-                QString newThumbPath =
-                        m_dbfs.GetAbsThumbPath(m_dbfs.ThumbDir(im->m_device),
-                                               m_dbfs.ThumbPath(*im.data()));
-
-                // Ensure path exists
-                if (QDir::root().mkpath(QFileInfo(newThumbPath).path())
-                        && QFile::rename(im->m_thumbPath, newThumbPath))
-                {
-                    LOG(VB_FILE, LOG_DEBUG, QString("Moved thumbnail %1 -> %2")
-                        .arg(im->m_thumbPath, newThumbPath));
-                }
-                else
-                {
-                    LOG(VB_FILE, LOG_WARNING,
-                        QString("Failed to rename thumbnail %1 -> %2")
-                        .arg(im->m_thumbPath, newThumbPath));
-                    continue;
-                }
-
-                // Clean up empty dirs
-                QString path = QFileInfo(im->m_thumbPath).path();
-                if (QDir::root().rmpath(path))
-                    LOG(VB_FILE, LOG_DEBUG,
-                        QString("Cleaned up path %1").arg(path));
+                LOG(VB_FILE, LOG_WARNING,
+                    QString("Failed to rename thumbnail %1 -> %2")
+                    .arg(im->m_thumbPath, newThumbPath));
+                continue;
             }
+
+            // Clean up empty dirs
+            QString path = QFileInfo(im->m_thumbPath).path();
+            if (QDir::root().rmpath(path))
+                LOG(VB_FILE, LOG_DEBUG,
+                    QString("Cleaned up path %1").arg(path));
         }
-        else
-            LOG(VB_GENERAL, LOG_ERR,
-                QString("Unknown task %1").arg(task->m_action));
     }
-
-    RunEpilog();
+    else
+        LOG(VB_GENERAL, LOG_ERR,
+            QString("Unknown task %1").arg(task->m_action));
 }
 
 
 /*!
- \brief Generate thumbnail for an image
+ \brief Provide thumbnail for an image
+ \details Thumbnails of pictures are also kept by a digest of the image
+ content, so a picture that is a copy of another, or has been moved, gets the
+ existing thumbnail rather than being decoded again. Videos aren't, reading
+ all of a video costs more than previewgen.
  \param im Image
  \param thumbPriority 
  */
@@ -263,14 +463,76 @@ QString ThumbThread<DBFS>::CreateThumbnail(ImagePtrK im, int thumbPriority)
     // Ensure path exists
     QDir::root().mkpath(QFileInfo(im->m_thumbPath).path());
 
+    // Thumbnails are orientated, so the orientation is part of the key
+    QString contentPath;
+#ifndef _WIN32
+    QString hash;
+    if (im->m_type == kImageFile)
+        hash = ContentHash(imagePath);
+    if (!hash.isEmpty())
+        contentPath = m_dbfs.GetContentThumbPath(
+                    QString("%1_%2.%3").arg(hash).arg(im->m_orientation)
+                    .arg(QFileInfo(im->m_thumbPath).suffix()));
+#endif
+
+    if (!contentPath.isEmpty() && ReuseThumbnail(contentPath, im->m_thumbPath))
+    {
+        LOG(VB_FILE, LOG_INFO,  QString("[%2] Reused %1")
+            .arg(im->m_thumbPath).arg(thumbPriority));
+        return QString();
+    }
+
+    QString err = GenerateThumbnail(im, imagePath, thumbPriority);
+
+    if (err.isEmpty() && !contentPath.isEmpty())
+        ShareThumbnail(im->m_thumbPath, contentPath);
+
+    return err;
+}
+
+
+/*!
+ \brief Generate thumbnail for an image
+ \details Pictures are decoded at reduced size when their format allows (JPEG
+ decoding scales in the DCT domain), else from an embedded preview when there's
+ one big enough, and only decoded in full as a last resort.
+ \param im Image
+ \param imagePath Absolute path of image
+ \param thumbPriority 
+ */
+template <class DBFS>
+QString ThumbThread<DBFS>::GenerateThumbnail(ImagePtrK im,
+                                             const QString &imagePath,
+                                             int thumbPriority)
+{
     QImage image;
+    // Whether the image was loaded by Qt from the file itself
+    bool fromFile = true;
+
     if (im->m_type == kImageFile)
     {
-        if (!image.load(imagePath))
+        QImageReader reader(imagePath);
+        QSize size = reader.size();
+
+        if (size.isValid()
+                && reader.supportsOption(QImageIOHandler::ScaledSize))
+        {
+            // Leave a little for the smooth scale to work with
+            QSize decode = size.scaled(kThumbSize * 2, Qt::KeepAspectRatio);
+            if (decode.width() < size.width())
+                reader.setScaledSize(decode);
+        }
+        else
+        {
+            image = ImageMetaData::GetPreview(imagePath, kThumbSize);
+            fromFile = image.isNull();
+        }
+
+        if (fromFile && !reader.read(&image))
             return QString("Failed to open image %1").arg(imagePath);
 
         // Resize to optimise load/display time by FE's
-        image = image.scaled(QSize(240,180), Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        image = image.scaled(kThumbSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
     }
     else if (im->m_type == kVideoFile)
     {
@@ -307,7 +569,7 @@ QString ThumbThread<DBFS>::CreateThumbnail(ImagePtrK im, int thumbPriority)
 
     // Compensate for any Qt auto-orientation
     int orientBy = Orientation(im->m_orientation)
-            .GetCurrent(im->m_type == kImageFile);
+            .GetCurrent(im->m_type == kImageFile && fromFile);
 
     // Orientate now to optimise load/display time - no orientation
     // is required when displaying thumbnails
@@ -323,6 +585,52 @@ QString ThumbThread<DBFS>::CreateThumbnail(ImagePtrK im, int thumbPriority)
 }
 
 
+/*!
+ \brief Makes a thumbnail from the thumbnail of the same image content
+ \details The thumbnail is hard-linked, so it takes no space.
+ \param contentPath Thumbnail kept by content
+ \param thumbPath Thumbnail to create
+ \return bool True if the thumbnail was created
+*/
+template <class DBFS>
+bool ThumbThread<DBFS>::ReuseThumbnail(const QString &contentPath,
+                                       const QString &thumbPath)
+{
+#ifndef _WIN32
+    return link(contentPath.toLocal8Bit().constData(),
+                thumbPath.toLocal8Bit().constData()) == 0;
+#else
+    return false;
+#endif
+}
+
+
+/*!
+ \brief Keeps a new thumbnail by the digest of its image content
+ \details The store only holds hard links, a thumbnail that can't be linked
+ isn't kept rather than taking the space twice. It is removed once no image
+ links to it.
+ \param thumbPath New thumbnail
+ \param contentPath Thumbnail to keep by content
+*/
+template <class DBFS>
+void ThumbThread<DBFS>::ShareThumbnail(const QString &thumbPath,
+                                       const QString &contentPath)
+{
+    // Another worker may have made the same thumbnail meanwhile
+    if (!QDir::root().mkpath(QFileInfo(contentPath).path())
+            || QFile::exists(contentPath))
+        return;
+
+#ifndef _WIN32
+    if (link(thumbPath.toLocal8Bit().constData(),
+             contentPath.toLocal8Bit().constData()) != 0)
+#endif
+        LOG(VB_FILE, LOG_WARNING,
+            QString("Failed to keep thumbnail %1").arg(contentPath));
+}
+
+
 /*!
   \brief Pauses or restarts processing of background tasks (scanner requests)
  */
@@ -332,9 +640,8 @@ void ThumbThread<DBFS>::PauseBackground(bool pause)
     QMutexLocker locker(&m_mutex);
     m_doBackground = !pause;
 
-    // restart if not already running
-    if (m_doBackground && !this->isRunning())
-        this->start();
+    // start workers if not already running
+    StartWorkers();
 }
 
 
@@ -344,7 +651,8 @@ void ThumbThread<DBFS>::PauseBackground(bool pause)
 template <class DBFS>
 ImageThumb<DBFS>::ImageThumb(DBFS *const dbfs)
     : m_dbfs(*dbfs),
-      m_imageThread(new ThumbThread<DBFS>("ImageThumbs", dbfs)),
+      m_imageThread(new ThumbThread<DBFS>("ImageThumbs", dbfs,
+                                          QThread::idealThreadCount())),
       m_videoThread(new ThumbThread<DBFS>("VideoThumbs", dbfs))
 {}
 
@@ -379,6 +687,12 @@ void ImageThumb<DBFS>::ClearThumbs(int devId, const QString &action)
 
     // Remove devices now they are not in use
     QStringList mountPaths = m_dbfs.CloseDevices(devId, action);
+
+    // Thumbnails kept by content are only shared with the ones just removed
+    if (action == "DEVICE CLEAR ALL")
+        QDir(m_dbfs.GetContentThumbPath()).removeRecursively();
+    else if (!mountPaths.isEmpty())
+        PruneContentThumbs(m_dbfs.GetContentThumbPath());
 //    if (mountPaths.isEmpty())
 //        return;
 
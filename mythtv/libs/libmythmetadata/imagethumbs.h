@@ -1,10 +1,14 @@
 //! \file
 //! \brief Creates and manages thumbnails
-//! \details Uses two worker threads to process thumbnail requests that are queued
+//! \details Uses two worker pools to process thumbnail requests that are queued
 //! from the scanner and UI.
-//! One thread generates picture thumbs; the other video thumbs, which are delegated
-//! to previewgenerator and time-consuming.
-//! Both background threads are low-priority to avoid recording issues.
+//! One pool generates picture thumbs, with a thread per core; the other video
+//! thumbs, which are delegated to previewgenerator and time-consuming, with a
+//! single thread.
+//! All worker threads are low-priority to avoid recording issues.
+//! Pictures are decoded at reduced size where the format allows it, or replaced by
+//! an embedded preview, and every thumbnail is also kept under a hash of its image
+//! content so that copies and moved images reuse it rather than decoding again.
 //! Requests are handled by client-assigned priority so that UI display requests
 //! are serviced before background scanner requests.
 //! When images are removed, their thumbnails are also deleted (thumbnail cache is
@@ -78,29 +82,65 @@ public:
 typedef QSharedPointer<ThumbTask> TaskPtr;
 
 
-//! A generator worker thread
+template <class DBFS> class ThumbThread;
+
+//! A worker thread of a generator
 template <class DBFS>
-class ThumbThread : public MThread
+class ThumbWorker : public MThread
 {
 public:
-    ThumbThread(const QString &name, DBFS *const dbfs);
+    ThumbWorker(const QString &name, ThumbThread<DBFS> *generator)
+        : MThread(name), m_generator(generator), m_active(false) {}
+    ~ThumbWorker() { wait(); }
+
+protected:
+    void run();
+
+private:
+    Q_DISABLE_COPY(ThumbWorker)
+    friend class ThumbThread<DBFS>;
+
+    ThumbThread<DBFS> *m_generator;
+    //! Set whilst processing tasks, guarded by the generator mutex
+    bool m_active;
+};
+
+
+//! A generator: a task queue serviced by a pool of worker threads
+//! \details Create tasks run concurrently, each worker taking the next task by
+//! priority. Delete and move tasks run on their own, so that they never race
+//! with the creation of the thumbnail they affect.
+template <class DBFS>
+class ThumbThread
+{
+public:
+    ThumbThread(const QString &name, DBFS *const dbfs, int workers = 1);
     ~ThumbThread();
 
     void cancel();
     void Enqueue(const TaskPtr &task);
     void AbortDevice(int devId, const QString &action);
     void PauseBackground(bool pause);
-
-protected:
-    void run();
+    bool isRunning();
 
 private:
     Q_DISABLE_COPY(ThumbThread)
+    friend class ThumbWorker<DBFS>;
 
     //! A priority queue where 0 is highest priority
     typedef QMultiMap<int, TaskPtr> ThumbQueue;
 
+    void    ProcessTasks();
+    TaskPtr TakeTask();
+    void    RunTask(const TaskPtr &task);
+    void    StartWorkers();
     QString CreateThumbnail(ImagePtrK im, int thumbPriority);
+    QString GenerateThumbnail(ImagePtrK im, const QString &imagePath,
+                              int thumbPriority);
+    static bool ReuseThumbnail(const QString &contentPath,
+                               const QString &thumbPath);
+    static void ShareThumbnail(const QString &thumbPath,
+                               const QString &contentPath);
     static void RemoveTasks(ThumbQueue &queue, int devId);
 
     DBFS &m_dbfs;               //!< Database/filesystem adapter
@@ -110,6 +150,11 @@ private:
     ThumbQueue m_backgroundQ;   //!< Priority queue of background tasks
     bool m_doBackground;       //!< Whether to process background tasks
     QMutex m_mutex;            //!< Queue protection
+
+    QList<ThumbWorker<DBFS> *> m_workers; //!< Worker pool
+    int  m_running;            //!< Number of active workers
+    int  m_busy;               //!< Number of tasks being processed
+    bool m_exclusive;          //!< Whether a delete/move task is being processed
 };
 
 
@@ -140,9 +185,9 @@ private:
 
     //! Db/filesystem adapter
     DBFS              &m_dbfs;
-    //! Thread generating picture thumbnails
+    //! Generator of picture thumbnails
     ThumbThread<DBFS> *m_imageThread;
-    //! Thread generating video previews
+    //! Generator of video previews
     ThumbThread<DBFS> *m_videoThread;
 };
 
@@ -49,7 +49,7 @@ QEvent::Type MetadataFactoryVideoChanges::kEventType =
     (QEvent::Type) QEvent::registerEventType();
 
 MetadataFactory::MetadataFactory(QObject *parent) :
-    QObject(parent), m_scanning(false),
+    QObject(parent), m_videowatcher(NULL), m_scanning(false),
     m_returnList(), m_sync(false)
 {
     m_lookupthread = new MetadataDownload(this);
@@ -75,6 +75,9 @@ MetadataFactory::~MetadataFactory()
         m_imagedownload = NULL;
     }
 
+    delete m_videowatcher;
+    m_videowatcher = NULL;
+
     if (m_videoscanner && m_videoscanner->wait())
         delete m_videoscanner;
 
@@ -82,6 +85,20 @@ MetadataFactory::~MetadataFactory()
     m_mlm = NULL;
 }
 
+/**
+ *  \brief Rescans the video directories when they change, if this host
+ *         has "VideoScanWatchDirs" set.
+ *
+ *  Only the backend should do this, a factory is made for every screen
+ *  that looks up metadata.
+ */
+void MetadataFactory::WatchVideoDirectories(void)
+{
+    if (!m_videowatcher &&
+        gCoreContext->GetNumSetting("VideoScanWatchDirs", 0))
+        m_videowatcher = new VideoScanWatcher(m_videoscanner, this);
+}
+
 void MetadataFactory::Lookup(RecordingRule *recrule, bool automatic,
                              bool getimages, bool allowgeneric)
 {
@@ -621,6 +638,13 @@ void MetadataFactory::customEvent(QEvent *levent)
         }
         m_videoscanner->ResetCounts();
     }
+    else if (levent->type() == VideoScanWatcher::kEventType)
+    {
+        if (IsRunning())
+            m_videowatcher->Retry();
+        else
+            VideoScan();
+    }
 }
 
 // These functions exist to determine if we have enough
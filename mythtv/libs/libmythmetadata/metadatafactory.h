@@ -120,6 +120,7 @@ class META_PUBLIC MetadataFactory : public QObject
 
     void VideoScan();
     void VideoScan(QStringList hosts);
+    void WatchVideoDirectories(void);
 
     bool IsRunning() { return m_lookupthread->isRunning() ||
                               m_imagedownload->isRunning() ||
@@ -142,6 +143,7 @@ class META_PUBLIC MetadataFactory : public QObject
     MetadataImageDownload *m_imagedownload;
 
     VideoScannerThread *m_videoscanner;
+    VideoScanWatcher *m_videowatcher;
     VideoMetadataListManager *m_mlm;
     bool m_scanning;
 
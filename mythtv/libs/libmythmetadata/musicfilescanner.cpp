@@ -4,8 +4,12 @@
 
 // Qt headers
 #include <QDir>
+#include <QRunnable>
+#include <QThread>
 
 // MythTV headers
+#include <mthreadpool.h>
+#include <mythtimer.h>
 #include <mythdate.h>
 #include <mythdb.h>
 #include <mythcontext.h>
@@ -13,6 +17,47 @@
 #include <metaio.h>
 #include <musicfilescanner.h>
 
+/// Number of tracks whose tags are read before they are written to the
+/// database in one transaction, and the most rows removed by one statement
+static const int kTrackBatchSize = 256;
+
+/// Reads the tags of the tracks in a batch, on a pool thread.  Each reader
+/// takes the next unread track until there are none left.
+class MusicFileScanner::TagReader : public QRunnable
+{
+  public:
+    TagReader(TrackBatch &batch, QAtomicInt &next) :
+        m_batch(batch), m_next(next) {}
+
+    void run(void)
+    {
+        int i;
+        while ((i = m_next.fetchAndAddOrdered(1)) < m_batch.size())
+            MusicFileScanner::ReadTrack(m_batch[i]);
+    }
+
+  private:
+    TrackBatch &m_batch;
+    QAtomicInt &m_next;
+};
+
+/*
+ * Group the statements that follow into one transaction on this thread's
+ * database connection.  The connection is shared with every other query
+ * made by this thread for as long as query exists.
+ */
+static void begin_batch(MSqlQuery &query)
+{
+    if (!query.exec("START TRANSACTION"))
+        MythDB::DBError("MusicFileScanner - start transaction", query);
+}
+
+static void end_batch(MSqlQuery &query)
+{
+    if (!query.exec("COMMIT"))
+        MythDB::DBError("MusicFileScanner - commit transaction", query);
+}
+
 MusicFileScanner::MusicFileScanner():
     m_tracksTotal(0), m_tracksUnchanged(0), m_tracksAdded (0), m_tracksRemoved(0),
     m_tracksUpdated(0), m_coverartTotal(0), m_coverartUnchanged(0), m_coverartAdded(0),
@@ -142,6 +187,7 @@ void MusicFileScanner::BuildFileList(QString &directory, MusicLoadedMap &music_f
                 MusicFileData fdata;
                 fdata.startDir = m_startDirs.last();
                 fdata.location = MusicFileScanner::kFileSystem;
+                fdata.modified = fi->lastModified();
                 music_files[filename] = fdata;
             }
             else
@@ -230,19 +276,19 @@ int MusicFileScanner::GetDirectoryId(const QString &directory, const int &parent
  * \brief Check if file has been modified since given date/time
  *
  * \param filename File to examine
+ * \param modified When the file was last modified, as found by BuildFileList
  * \param date_modified Date to use in comparison
  *
  * \returns True if file has been modified, otherwise false
  */
 bool MusicFileScanner::HasFileChanged(
-    const QString &filename, const QString &date_modified)
+    const QString &filename, const QDateTime &modified,
+    const QString &date_modified)
 {
-    QFileInfo fi(filename);
-    QDateTime dt = fi.lastModified();
-    if (dt.isValid())
+    if (modified.isValid())
     {
         QDateTime old_dt = MythDate::fromString(date_modified);
-        return !old_dt.isValid() || (dt > old_dt);
+        return !old_dt.isValid() || (modified > old_dt);
     }
     else
     {
@@ -253,123 +299,171 @@ bool MusicFileScanner::HasFileChanged(
 }
 
 /*!
- * \brief Insert file details into database.
- *        If it is an audio file, read the metadata and insert
- *        that information at the same time.
- *
- *        If it is an image file, just insert the filename and
- *        type.
+ * \brief Read the tags of a music file, and for a new file any images
+ *        embedded in them.  Safe to call from any thread.
  *
- * \param filename Full path to file.
- * \param startDir The starting directory fir the search. This will be
- *                 removed making the stored name relative to the
- *                 storage directory where it was found.
+ * \param track The file to read. On success track.data is set.
  *
  * \returns Nothing.
  */
-void MusicFileScanner::AddFileToDB(const QString &filename, const QString &startDir)
+void MusicFileScanner::ReadTrack(TrackData &track)
 {
-    QString extension = filename.section( '.', -1 ) ;
-    QString directory = filename;
-    directory.remove(0, startDir.length());
-    directory = directory.section( '/', 0, -2);
+    LOG(VB_FILE, LOG_INFO, QString("Reading metadata from %1")
+        .arg(track.filename));
 
-    QString nameFilter = gCoreContext->GetSetting("AlbumArtFilter", "*.png;*.jpg;*.jpeg;*.gif;*.bmp");
+    track.data = MetaIO::readMetadata(track.filename);
+    if (!track.data)
+        return;
 
-    // If this file is an image, insert the details into the music_albumart table
-    if (nameFilter.indexOf(extension.toLower()) > -1)
-    {
-        QString name = filename.section( '/', -1);
+    track.data->setFileSize((quint64)QFileInfo(track.filename).size());
 
-        MSqlQuery query(MSqlQuery::InitCon());
-        query.prepare("INSERT INTO music_albumart "
-                       "SET filename = :FILE, directory_id = :DIRID, "
-                       "imagetype = :TYPE, hostname = :HOSTNAME;");
+    // Embedded images are only added with the track
+    if (track.file.location != kFileSystem)
+        return;
 
-        query.bindValue(":FILE", name);
-        query.bindValue(":DIRID", m_directoryid[directory]);
-        query.bindValue(":TYPE", AlbumArtImages::guessImageType(name));
-        query.bindValue(":HOSTNAME", gCoreContext->GetHostName());
+    MetaIO *tagger = MetaIO::createTagger(track.filename);
 
-        if (!query.exec() || query.numRowsAffected() <= 0)
+    if (tagger)
+    {
+        if (tagger->supportsEmbeddedImages())
         {
-            MythDB::DBError("music insert artwork", query);
+            track.art = tagger->getAlbumArtList(track.data->Filename());
+            track.embeddedArt = true;
         }
-
-        ++m_coverartAdded;
-
-        return;
+        delete tagger;
     }
+}
 
-    if (extension.isEmpty() || !MetaIO::ValidFileExtensions.contains(extension.toLower()))
+/*!
+ * \brief Read the tags of all the tracks in a batch, using a thread for
+ *        each processor since most of the time goes on reading and
+ *        parsing the files.
+ *
+ * \param batch The tracks to read
+ *
+ * \returns Nothing.
+ */
+void MusicFileScanner::ReadTracks(TrackBatch &batch)
+{
+    int threads = qMin(QThread::idealThreadCount(), batch.size());
+    if (threads <= 1)
     {
-        LOG(VB_GENERAL, LOG_WARNING, QString("Ignoring filename with unsupported filename: '%1'").arg(filename));
+        for (int i = 0; i < batch.size(); ++i)
+            ReadTrack(batch[i]);
         return;
     }
 
-    LOG(VB_FILE, LOG_INFO, QString("Reading metadata from %1").arg(filename));
-    MusicMetadata *data = MetaIO::readMetadata(filename);
-    if (data)
-    {
-        data->setFileSize((quint64)QFileInfo(filename).size());
-        data->setHostname(gCoreContext->GetHostName());
+    QAtomicInt next(0);
 
-        QString album_cache_string;
+    MThreadPool pool("MusicTagReader");
+    pool.setMaxThreadCount(threads);
 
-        // Set values from cache
-        int did = m_directoryid[directory];
-        if (did >= 0)
-            data->setDirectoryId(did);
+    for (int i = 0; i < threads; ++i)
+        pool.start(new TagReader(batch, next), "MusicTagReader");
 
-        int aid = m_artistid[data->Artist().toLower()];
-        if (aid > 0)
-        {
-            data->setArtistId(aid);
+    pool.waitForDone();
+}
+
+/*!
+ * \brief Insert the details of an image file into the database.
+ *
+ * \param filename Full path to file.
+ * \param startDir The starting directory fir the search. This will be
+ *                 removed making the stored name relative to the
+ *                 storage directory where it was found.
+ *
+ * \returns Nothing.
+ */
+void MusicFileScanner::AddArtToDB(const QString &filename, const QString &startDir)
+{
+    QString directory = filename;
+    directory.remove(0, startDir.length());
+    directory = directory.section( '/', 0, -2);
 
-            // The album cache depends on the artist id
-            album_cache_string = QString::number(data->getArtistId()) + "#"
-                + data->Album().toLower();
+    QString name = filename.section( '/', -1);
 
-            if (m_albumid[album_cache_string] > 0)
-                data->setAlbumId(m_albumid[album_cache_string]);
-        }
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare("INSERT INTO music_albumart "
+                   "SET filename = :FILE, directory_id = :DIRID, "
+                   "imagetype = :TYPE, hostname = :HOSTNAME;");
+
+    query.bindValue(":FILE", name);
+    query.bindValue(":DIRID", m_directoryid[directory]);
+    query.bindValue(":TYPE", AlbumArtImages::guessImageType(name));
+    query.bindValue(":HOSTNAME", gCoreContext->GetHostName());
+
+    if (!query.exec() || query.numRowsAffected() <= 0)
+    {
+        MythDB::DBError("music insert artwork", query);
+    }
+
+    ++m_coverartAdded;
+}
+
+/*!
+ * \brief Insert a track, and any images embedded in its tags, into
+ *        the database.
+ *
+ * \param track A new track whose tags have been read by ReadTrack()
+ *
+ * \returns Nothing.
+ */
+void MusicFileScanner::AddTrackToDB(TrackData &track)
+{
+    MusicMetadata *data = track.data;
 
-        int gid = m_genreid[data->Genre().toLower()];
-        if (gid > 0)
-            data->setGenreId(gid);
+    QString directory = track.filename;
+    directory.remove(0, track.file.startDir.length());
+    directory = directory.section( '/', 0, -2);
 
-        // Commit track info to database
-        data->dumpToDatabase();
+    data->setHostname(gCoreContext->GetHostName());
 
-        // Update the cache
-        m_artistid[data->Artist().toLower()] =
-            data->getArtistId();
+    QString album_cache_string;
 
-        m_genreid[data->Genre().toLower()] =
-            data->getGenreId();
+    // Set values from cache
+    int did = m_directoryid[directory];
+    if (did >= 0)
+        data->setDirectoryId(did);
 
+    int aid = m_artistid[data->Artist().toLower()];
+    if (aid > 0)
+    {
+        data->setArtistId(aid);
+
+        // The album cache depends on the artist id
         album_cache_string = QString::number(data->getArtistId()) + "#"
             + data->Album().toLower();
-        m_albumid[album_cache_string] = data->getAlbumId();
 
-        // read any embedded images from the tag
-        MetaIO *tagger = MetaIO::createTagger(filename);
+        if (m_albumid[album_cache_string] > 0)
+            data->setAlbumId(m_albumid[album_cache_string]);
+    }
+
+    int gid = m_genreid[data->Genre().toLower()];
+    if (gid > 0)
+        data->setGenreId(gid);
 
-        if (tagger)
-        {
-            if (tagger->supportsEmbeddedImages())
-            {
-                AlbumArtList artList = tagger->getAlbumArtList(data->Filename());
-                data->setEmbeddedAlbumArt(artList);
-                data->getAlbumArtImages()->dumpToDatabase();
-            }
-            delete tagger;
-        }
+    // Commit track info to database
+    data->dumpToDatabase();
 
-        delete data;
+    // Update the cache
+    m_artistid[data->Artist().toLower()] =
+        data->getArtistId();
 
-        ++m_tracksAdded;
+    m_genreid[data->Genre().toLower()] =
+        data->getGenreId();
+
+    album_cache_string = QString::number(data->getArtistId()) + "#"
+        + data->Album().toLower();
+    m_albumid[album_cache_string] = data->getAlbumId();
+
+    // the embedded images need the id of the track
+    if (track.embeddedArt)
+    {
+        data->setEmbeddedAlbumArt(track.art);
+        data->getAlbumArtImages()->dumpToDatabase();
     }
+
+    ++m_tracksAdded;
 }
 
 /*!
@@ -506,141 +600,180 @@ void MusicFileScanner::cleanDB()
 }
 
 /*!
- * \brief Removes a file from the database.
+ * \brief Removes rows from the database, a batch at a time.
  *
- * \param filename Full path to file.
- * \param startDir The starting directory fir the search. This will be
- *                 removed making the stored name relative to the
- *                 storage directory where it was found.
+ * \param table The table to delete from
+ * \param idColumn The column holding the ids
+ * \param ids The ids of the rows to remove
  *
  * \returns Nothing.
  */
-void MusicFileScanner::RemoveFileFromDB(const QString &filename, const QString &startDir)
+void MusicFileScanner::RemoveFromDB(const QString &table, const QString &idColumn,
+                                    const QList<int> &ids)
 {
-    QString sqlfilename(filename);
-    sqlfilename.remove(0, startDir.length());
-    // We know that the filename will not contain :// as the SQL limits this
-    QString directory = sqlfilename.section( '/', 0, -2 ) ;
-    sqlfilename = sqlfilename.section( '/', -1 ) ;
+    MSqlQuery query(MSqlQuery::InitCon());
 
-    QString extension = sqlfilename.section( '.', -1 ) ;
+    for (int x = 0; x < ids.size(); x += kTrackBatchSize)
+    {
+        QStringList idList;
+        for (int y = x; y < ids.size() && y < x + kTrackBatchSize; y++)
+            idList.append(QString::number(ids[y]));
 
-    QString nameFilter = gCoreContext->GetSetting("AlbumArtFilter",
-                                              "*.png;*.jpg;*.jpeg;*.gif;*.bmp");
+        query.prepare(QString("DELETE FROM %1 WHERE %2 IN (%3);")
+                      .arg(table).arg(idColumn).arg(idList.join(",")));
 
-    if (nameFilter.indexOf(extension.toLower()) > -1)
+        if (!query.exec())
+            MythDB::DBError(QString("MusicFileScanner::RemoveFromDB - "
+                                    "deleting %1").arg(table), query);
+    }
+}
+
+/*!
+ * \brief Updates a track in the database, keeping the rating and
+ *        play count already stored for it.
+ *
+ * \param track A changed track whose tags have been read by ReadTrack()
+ *
+ * \returns Nothing.
+ */
+void MusicFileScanner::UpdateTrackInDB(TrackData &track)
+{
+    MusicMetadata *disk_meta = track.data;
+
+    if (track.file.id <= 0)
     {
-        MSqlQuery query(MSqlQuery::InitCon());
-        query.prepare("DELETE FROM music_albumart WHERE filename= :FILE AND "
-                      "directory_id= :DIRID;");
-        query.bindValue(":FILE", sqlfilename);
-        query.bindValue(":DIRID", m_directoryid[directory]);
+        LOG(VB_GENERAL, LOG_ERR, QString("Asked to update track with "
+                                            "invalid ID - %1")
+                                        .arg(track.file.id));
+        return;
+    }
 
-        if (!query.exec() || query.numRowsAffected() <= 0)
-        {
-            MythDB::DBError("music delete artwork", query);
-        }
+    QString directory = track.filename;
+    directory.remove(0, track.file.startDir.length());
+    directory = directory.section( '/', 0, -2);
 
-        ++m_coverartRemoved;
+    disk_meta->setID(track.file.id);
+    disk_meta->setRating(track.file.rating);
+    if (track.file.playCount > disk_meta->PlayCount())
+        disk_meta->setPlaycount(track.file.playCount);
 
-        return;
+    QString album_cache_string;
+
+    // Set values from cache
+    int did = m_directoryid[directory];
+    if (did > 0)
+        disk_meta->setDirectoryId(did);
+
+    int aid = m_artistid[disk_meta->Artist().toLower()];
+    if (aid > 0)
+    {
+        disk_meta->setArtistId(aid);
+
+        // The album cache depends on the artist id
+        album_cache_string = QString::number(disk_meta->getArtistId()) + "#" +
+            disk_meta->Album().toLower();
+
+        if (m_albumid[album_cache_string] > 0)
+            disk_meta->setAlbumId(m_albumid[album_cache_string]);
     }
 
-    MSqlQuery query(MSqlQuery::InitCon());
-    query.prepare("DELETE FROM music_songs WHERE filename = :NAME ;");
-    query.bindValue(":NAME", sqlfilename);
-    if (!query.exec())
-        MythDB::DBError("MusicFileScanner::RemoveFileFromDB - deleting music_songs",
-                        query);
+    int gid = m_genreid[disk_meta->Genre().toLower()];
+    if (gid > 0)
+        disk_meta->setGenreId(gid);
 
-    ++m_tracksRemoved;
+    disk_meta->setHostname(gCoreContext->GetHostName());
+
+    // Commit track info to database
+    disk_meta->dumpToDatabase();
+
+    // Update the cache
+    m_artistid[disk_meta->Artist().toLower()]
+        = disk_meta->getArtistId();
+    m_genreid[disk_meta->Genre().toLower()]
+        = disk_meta->getGenreId();
+    album_cache_string = QString::number(disk_meta->getArtistId()) + "#" +
+        disk_meta->Album().toLower();
+    m_albumid[album_cache_string] = disk_meta->getAlbumId();
 }
 
 /*!
- * \brief Updates a file in the database.
+ * \brief Adds, updates and removes the tracks found by ScanMusic().
  *
- * \param filename Full path to file.
- * \param startDir The starting directory fir the search. This will be
- *                 removed making the stored name relative to the
- *                 storage directory where it was found.
+ *        The tags of new and changed tracks are read a batch at a time
+ *        by a pool of threads, then the batch is written to the database
+ *        in one transaction by this thread.  Removed tracks are deleted
+ *        by id at the end.
+ *
+ * \param music_files The tracks to update
+ * \param readTime Incremented by the milliseconds spent reading tags
+ * \param writeTime Incremented by the milliseconds spent writing to the
+ *                  database
  *
  * \returns Nothing.
  */
-void MusicFileScanner::UpdateFileInDB(const QString &filename, const QString &startDir)
+void MusicFileScanner::UpdateTracks(MusicLoadedMap &music_files, int &readTime,
+                                    int &writeTime)
 {
-    QString dbFilename = filename;
-    dbFilename.remove(0, startDir.length());
-
-    QString directory = filename;
-    directory.remove(0, startDir.length());
-    directory = directory.section( '/', 0, -2);
+    MythTimer timer;
+    QList<int> removed;
+    TrackBatch batch;
 
-    MusicMetadata *db_meta   = MetaIO::getMetadata(dbFilename);
-    MusicMetadata *disk_meta = MetaIO::readMetadata(filename);
+    batch.reserve(kTrackBatchSize);
 
-    if (db_meta && disk_meta)
+    MusicLoadedMap::Iterator iter = music_files.begin();
+    while (iter != music_files.end())
     {
-        if (db_meta->ID() <= 0)
+        for (; iter != music_files.end() && batch.size() < kTrackBatchSize; ++iter)
         {
-            LOG(VB_GENERAL, LOG_ERR, QString("Asked to update track with "
-                                                "invalid ID - %1")
-                                            .arg(db_meta->ID()));
-            delete disk_meta;
-            delete db_meta;
-            return;
+            if ((*iter).location == MusicFileScanner::kDatabase)
+                removed.append((*iter).id);
+            else if ((*iter).location == MusicFileScanner::kFileSystem ||
+                     (*iter).location == MusicFileScanner::kNeedUpdate)
+            {
+                TrackData track;
+                track.filename = iter.key();
+                track.file = *iter;
+                batch.append(track);
+            }
         }
 
-        disk_meta->setID(db_meta->ID());
-        disk_meta->setRating(db_meta->Rating());
-        if (db_meta->PlayCount() > disk_meta->PlayCount())
-            disk_meta->setPlaycount(db_meta->Playcount());
+        if (batch.isEmpty())
+            continue;
 
-        QString album_cache_string;
+        timer.start();
+        ReadTracks(batch);
+        readTime += timer.restart();
 
-        // Set values from cache
-        int did = m_directoryid[directory];
-        if (did > 0)
-            disk_meta->setDirectoryId(did);
+        MSqlQuery query(MSqlQuery::InitCon());
+        begin_batch(query);
 
-        int aid = m_artistid[disk_meta->Artist().toLower()];
-        if (aid > 0)
+        for (int x = 0; x < batch.size(); x++)
         {
-            disk_meta->setArtistId(aid);
+            TrackData &track = batch[x];
 
-            // The album cache depends on the artist id
-            album_cache_string = QString::number(disk_meta->getArtistId()) + "#" +
-                disk_meta->Album().toLower();
+            if (track.file.location == MusicFileScanner::kNeedUpdate)
+            {
+                if (track.data)
+                    UpdateTrackInDB(track);
+                ++m_tracksUpdated;
+            }
+            else if (track.data)
+                AddTrackToDB(track);
 
-            if (m_albumid[album_cache_string] > 0)
-                disk_meta->setAlbumId(m_albumid[album_cache_string]);
+            qDeleteAll(track.art);
+            delete track.data;
         }
 
-        int gid = m_genreid[disk_meta->Genre().toLower()];
-        if (gid > 0)
-            disk_meta->setGenreId(gid);
-
-        disk_meta->setFileSize((quint64)QFileInfo(filename).size());
-
-        disk_meta->setHostname(gCoreContext->GetHostName());
+        end_batch(query);
+        writeTime += timer.elapsed();
 
-        // Commit track info to database
-        disk_meta->dumpToDatabase();
-
-        // Update the cache
-        m_artistid[disk_meta->Artist().toLower()]
-            = disk_meta->getArtistId();
-        m_genreid[disk_meta->Genre().toLower()]
-            = disk_meta->getGenreId();
-        album_cache_string = QString::number(disk_meta->getArtistId()) + "#" +
-            disk_meta->Album().toLower();
-        m_albumid[album_cache_string] = disk_meta->getAlbumId();
+        batch.clear();
     }
 
-    if (disk_meta)
-        delete disk_meta;
-
-    if (db_meta)
-        delete db_meta;
+    timer.start();
+    RemoveFromDB("music_songs", "song_id", removed);
+    m_tracksRemoved += removed.size();
+    writeTime += timer.elapsed();
 }
 
 /*!
@@ -700,6 +833,9 @@ void MusicFileScanner::SearchDirs(const QStringList &dirList)
     MusicLoadedMap art_files;
     MusicLoadedMap::Iterator iter;
 
+    MythTimer timer;
+    timer.start();
+
     for (int x = 0; x < dirList.count(); x++)
     {
         QString startDir = dirList[x];
@@ -709,56 +845,63 @@ void MusicFileScanner::SearchDirs(const QStringList &dirList)
         BuildFileList(startDir, music_files, art_files, 0);
     }
 
+    int walkTime = timer.restart();
+
     m_tracksTotal = music_files.count();
     m_coverartTotal = art_files.count();
 
     ScanMusic(music_files);
     ScanArtwork(art_files);
 
+    int checkTime = timer.restart();
+
     LOG(VB_GENERAL, LOG_INFO, "Updating database");
 
-        /*
-        This can be optimised quite a bit by consolidating all commands
-        via a lot of refactoring.
+    int readTime = 0;
+    int writeTime = 0;
 
-        1) group all files of the same decoder type, and don't
-        create/delete a Decoder pr. AddFileToDB. Or make Decoders be
-        singletons, it should be a fairly simple change.
+    UpdateTracks(music_files, readTime, writeTime);
 
-        2) RemoveFileFromDB should group the remove into one big SQL.
+    timer.start();
 
-        3) UpdateFileInDB, same as 1.
-        */
+    QList<int> removedArt;
+    int added = 0;
 
-    for (iter = music_files.begin(); iter != music_files.end(); iter++)
     {
-        if ((*iter).location == MusicFileScanner::kFileSystem)
-            AddFileToDB(iter.key(), (*iter).startDir);
-        else if ((*iter).location == MusicFileScanner::kDatabase)
-            RemoveFileFromDB(iter.key(), (*iter).startDir);
-        else if ((*iter).location == MusicFileScanner::kNeedUpdate)
-        {
-            UpdateFileInDB(iter.key(), (*iter).startDir);
-            ++m_tracksUpdated;
-        }
-    }
+        MSqlQuery query(MSqlQuery::InitCon());
+        begin_batch(query);
 
-    for (iter = art_files.begin(); iter != art_files.end(); iter++)
-    {
-        if ((*iter).location == MusicFileScanner::kFileSystem)
-            AddFileToDB(iter.key(), (*iter).startDir);
-        else if ((*iter).location == MusicFileScanner::kDatabase)
-            RemoveFileFromDB(iter.key(), (*iter).startDir);
-        else if ((*iter).location == MusicFileScanner::kNeedUpdate)
+        for (iter = art_files.begin(); iter != art_files.end(); iter++)
         {
-            UpdateFileInDB(iter.key(), (*iter).startDir);
-            ++m_coverartUpdated;
+            if ((*iter).location == MusicFileScanner::kFileSystem)
+            {
+                AddArtToDB(iter.key(), (*iter).startDir);
+
+                if (++added % kTrackBatchSize == 0)
+                {
+                    end_batch(query);
+                    begin_batch(query);
+                }
+            }
+            else if ((*iter).location == MusicFileScanner::kDatabase)
+                removedArt.append((*iter).id);
+            else if ((*iter).location == MusicFileScanner::kNeedUpdate)
+                ++m_coverartUpdated;
         }
+
+        end_batch(query);
     }
 
+    RemoveFromDB("music_albumart", "albumart_id", removedArt);
+    m_coverartRemoved += removedArt.size();
+
+    writeTime += timer.restart();
+
     // Cleanup orphaned entries from the database
     cleanDB();
 
+    int cleanTime = timer.elapsed();
+
     QString trackStatus = QString("total tracks found: %1 (unchanged: %2, added: %3, removed: %4, updated %5)")
                                   .arg(m_tracksTotal).arg(m_tracksUnchanged).arg(m_tracksAdded)
                                   .arg(m_tracksRemoved).arg(m_tracksUpdated);
@@ -767,16 +910,26 @@ void MusicFileScanner::SearchDirs(const QStringList &dirList)
                                      .arg(m_coverartRemoved).arg(m_coverartUpdated);
 
 
+    QString timeStatus = QString("time taken: %1s (searching: %2s, checking: %3s, "
+                                 "reading tags: %4s, updating database: %5s, "
+                                 "cleaning database: %6s)")
+        .arg((walkTime + checkTime + readTime + writeTime + cleanTime) / 1000.0, 0, 'f', 1)
+        .arg(walkTime / 1000.0, 0, 'f', 1).arg(checkTime / 1000.0, 0, 'f', 1)
+        .arg(readTime / 1000.0, 0, 'f', 1).arg(writeTime / 1000.0, 0, 'f', 1)
+        .arg(cleanTime / 1000.0, 0, 'f', 1);
+
     LOG(VB_GENERAL, LOG_INFO, "Music file scanner finished ");
     LOG(VB_GENERAL, LOG_INFO, trackStatus);
     LOG(VB_GENERAL, LOG_INFO, coverartStatus);
+    LOG(VB_GENERAL, LOG_INFO, timeStatus);
 
     gCoreContext->SendMessage(QString("MUSIC_SCANNER_FINISHED %1 %2 %3 %4 %5")
                                       .arg(host).arg(m_tracksTotal).arg(m_tracksAdded)
                                       .arg(m_coverartTotal).arg(m_coverartAdded));
 
     updateLastRunEnd();
-    status = QString("success - %1 - %2").arg(trackStatus).arg(coverartStatus);
+    status = QString("success - %1 - %2 - %3").arg(trackStatus).arg(coverartStatus)
+                                               .arg(timeStatus);
     updateLastRunStatus(status);
 }
 
@@ -792,7 +945,8 @@ void MusicFileScanner::ScanMusic(MusicLoadedMap &music_files)
     MusicLoadedMap::Iterator iter;
 
     MSqlQuery query(MSqlQuery::InitCon());
-    query.prepare("SELECT CONCAT_WS('/', path, filename), date_modified "
+    query.prepare("SELECT CONCAT_WS('/', path, filename), date_modified, "
+                  "song_id, rating, numplays "
                   "FROM music_songs LEFT JOIN music_directories ON "
                   "music_songs.directory_id=music_directories.directory_id "
                   "WHERE filename NOT LIKE BINARY ('%://%') "
@@ -820,10 +974,16 @@ void MusicFileScanner::ScanMusic(MusicLoadedMap &music_files)
 
             if (iter != music_files.end())
             {
-                if (music_files[name].location == MusicFileScanner::kDatabase)
+                if ((*iter).location == MusicFileScanner::kDatabase)
                     continue;
-                else if (HasFileChanged(name, query.value(1).toString()))
-                    music_files[name].location = MusicFileScanner::kNeedUpdate;
+                else if (HasFileChanged(name, (*iter).modified,
+                                        query.value(1).toString()))
+                {
+                    (*iter).location = MusicFileScanner::kNeedUpdate;
+                    (*iter).id = query.value(2).toInt();
+                    (*iter).rating = query.value(3).toInt();
+                    (*iter).playCount = query.value(4).toInt();
+                }
                 else
                 {
                     ++m_tracksUnchanged;
@@ -831,7 +991,10 @@ void MusicFileScanner::ScanMusic(MusicLoadedMap &music_files)
                 }
             }
             else
+            {
                 music_files[name].location = MusicFileScanner::kDatabase;
+                music_files[name].id = query.value(2).toInt();
+            }
         }
     }
 }
@@ -848,7 +1011,7 @@ void MusicFileScanner::ScanArtwork(MusicLoadedMap &music_files)
     MusicLoadedMap::Iterator iter;
 
     MSqlQuery query(MSqlQuery::InitCon());
-    query.prepare("SELECT CONCAT_WS('/', path, filename) "
+    query.prepare("SELECT CONCAT_WS('/', path, filename), albumart_id "
                   "FROM music_albumart "
                   "LEFT JOIN music_directories ON music_albumart.directory_id=music_directories.directory_id "
                   "WHERE music_albumart.embedded = 0 "
@@ -887,6 +1050,7 @@ void MusicFileScanner::ScanArtwork(MusicLoadedMap &music_files)
             else
             {
                 music_files[name].location = MusicFileScanner::kDatabase;
+                music_files[name].id = query.value(1).toInt();
             }
         }
     }
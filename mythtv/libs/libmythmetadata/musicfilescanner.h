@@ -6,6 +6,11 @@
 
 // Qt headers
 #include <QCoreApplication>
+#include <QDateTime>
+#include <QVector>
+
+// MythTV
+#include "musicmetadata.h"
 
 typedef QMap<QString, int> IdCache;
 
@@ -23,11 +28,34 @@ class META_PUBLIC MusicFileScanner
 
     struct MusicFileData
     {
+        MusicFileData() : location(kFileSystem), id(0), rating(0),
+            playCount(0) {}
+
         QString startDir;
         MusicFileLocation location;
+        QDateTime modified;     ///< Last modified, as seen by BuildFileList
+        int id;                 ///< song_id or albumart_id from the database
+        int rating;             ///< Values kept when a track is updated
+        int playCount;
     };
 
     typedef QMap <QString, MusicFileData> MusicLoadedMap;
+
+    /// A music file and the tags read from it
+    struct TrackData
+    {
+        TrackData() : data(NULL), embeddedArt(false) {}
+
+        QString        filename;
+        MusicFileData  file;
+        MusicMetadata *data;
+        AlbumArtList   art;
+        bool           embeddedArt;
+    };
+
+    typedef QVector<TrackData> TrackBatch;
+
+    class TagReader;
     public:
         MusicFileScanner(void);
         ~MusicFileScanner(void);
@@ -39,10 +67,17 @@ class META_PUBLIC MusicFileScanner
     private:
         void BuildFileList(QString &directory, MusicLoadedMap &music_files, MusicLoadedMap &art_files, int parentid);
         int  GetDirectoryId(const QString &directory, const int &parentid);
-        bool HasFileChanged(const QString &filename, const QString &date_modified);
-        void AddFileToDB(const QString &filename, const QString &startDir);
-        void RemoveFileFromDB (const QString &filename, const QString &startDir);
-        void UpdateFileInDB(const QString &filename, const QString &startDir);
+        bool HasFileChanged(const QString &filename, const QDateTime &modified,
+                            const QString &date_modified);
+        static void ReadTrack(TrackData &track);
+        void ReadTracks(TrackBatch &batch);
+        void AddArtToDB(const QString &filename, const QString &startDir);
+        void AddTrackToDB(TrackData &track);
+        void UpdateTrackInDB(TrackData &track);
+        void RemoveFromDB(const QString &table, const QString &idColumn,
+                          const QList<int> &ids);
+        void UpdateTracks(MusicLoadedMap &music_files, int &readTime,
+                          int &writeTime);
         void ScanMusic(MusicLoadedMap &music_files);
         void ScanArtwork(MusicLoadedMap &music_files);
         void cleanDB();
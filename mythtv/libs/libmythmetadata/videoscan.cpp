@@ -1,14 +1,18 @@
 
 #include "videoscan.h"
 
+#include <QFileSystemWatcher>
 #include <QImageReader>
+#include <QRunnable>
 #include <QApplication>
+#include <QTimer>
 #include <QUrl>
 
 // libmythbase
 #include "mythevent.h"
 #include "mythlogging.h"
 #include "mythdate.h"
+#include "mthreadpool.h"
 
 // libmyth
 #include "mythcontext.h"
@@ -30,6 +34,9 @@
 QEvent::Type VideoScanChanges::kEventType =
     (QEvent::Type) QEvent::registerEventType();
 
+QEvent::Type VideoScanWatcher::kEventType =
+    (QEvent::Type) QEvent::registerEventType();
+
 namespace
 {
     template <typename DirListType>
@@ -83,10 +90,41 @@ namespace
 class VideoMetadataListManager;
 class MythUIProgressDialog;
 
+/// Builds the file list for one video directory, on a pool thread
+class VideoScannerThread::ScanTask : public QRunnable
+{
+  public:
+    ScanTask(VideoScannerThread *scanner, const QString &directory,
+             const QStringList &imageExtensions,
+             const FileAssociations::ext_ignore_list &extList) :
+        m_scanner(scanner), m_directory(directory),
+        m_imageExtensions(imageExtensions), m_extList(extList), m_ok(false)
+    {
+        setAutoDelete(false);
+    }
+
+    void run(void)
+    {
+        m_ok = m_scanner->buildFileList(m_directory, m_imageExtensions,
+                                        m_extList, m_files);
+
+        if (m_scanner->m_HasGUI)
+            m_scanner->SendProgressEvent(
+                m_scanner->m_dirsScanned.fetchAndAddOrdered(1) + 1);
+    }
+
+    VideoScannerThread                      *m_scanner;
+    QString                                  m_directory;
+    const QStringList                       &m_imageExtensions;
+    const FileAssociations::ext_ignore_list &m_extList;
+    FileCheckList                            m_files;
+    bool                                     m_ok;
+};
+
 VideoScannerThread::VideoScannerThread(QObject *parent) :
     MThread("VideoScanner"),
     m_RemoveAll(false), m_KeepAll(false), m_dialog(NULL),
-    m_DBDataChanged(false)
+    m_DBDataChanged(false), m_dirCacheLoaded(false)
 {
     m_parent = parent;
     m_dbmetadata = new VideoMetadataListManager;
@@ -173,33 +211,63 @@ void VideoScannerThread::run()
 
     LOG(VB_GENERAL, LOG_INFO, QString("Beginning Video Scan."));
 
-    uint counter = 0;
+    FileAssociations::ext_ignore_list ext_list;
+    FileAssociations::getFileAssociation().getExtensionIgnoreList(ext_list);
+
+    LoadDirCache();
+    m_dirCache.BeginScan();
+
     FileCheckList fs_files;
 
+    m_dirsScanned.fetchAndStoreOrdered(0);
     if (m_HasGUI)
-        SendProgressEvent(counter, (uint)m_directories.size(),
+        SendProgressEvent(0, (uint)m_directories.size(),
                           tr("Searching for video files"));
+
+    // Each directory is usually a different disk, share or backend, so
+    // they are walked at the same time rather than one after another
+    MThreadPool pool("VideoScanPool");
+    pool.setMaxThreadCount(kMaxScanThreads);
+
+    QList<ScanTask *> tasks;
     for (QStringList::const_iterator iter = m_directories.begin();
          iter != m_directories.end(); ++iter)
     {
-        if (!buildFileList(*iter, imageExtensions, fs_files))
+        ScanTask *task = new ScanTask(this, *iter, imageExtensions, ext_list);
+        tasks.append(task);
+        pool.start(task, "VideoDirScan");
+    }
+    pool.waitForDone();
+
+    // Merge in the order the directories were given, so a file found
+    // through more than one of them ends up with the same host as before
+    for (QList<ScanTask *>::iterator it = tasks.begin();
+         it != tasks.end(); ++it)
+    {
+        ScanTask *task = *it;
+
+        if (!task->m_ok && task->m_directory.startsWith("myth://"))
         {
-            if (iter->startsWith("myth://"))
-            {
-                QUrl sgurl = *iter;
-                QString host = sgurl.host().toLower();
-                QString path = sgurl.path();
+            QUrl sgurl = task->m_directory;
+            QString host = sgurl.host().toLower();
 
-                m_liveSGHosts.removeAll(host);
+            m_liveSGHosts.removeAll(host);
 
-                LOG(VB_GENERAL, LOG_ERR,
-                    QString("Failed to scan :%1:").arg(*iter));
-            }
+            LOG(VB_GENERAL, LOG_ERR,
+                QString("Failed to scan :%1:").arg(task->m_directory));
         }
-        if (m_HasGUI)
-            SendProgressEvent(++counter);
+
+        for (FileCheckList::const_iterator p = task->m_files.begin();
+             p != task->m_files.end(); ++p)
+        {
+            fs_files[p->first] = p->second;
+        }
+
+        delete task;
     }
 
+    m_dirCache.Save(VideoDirCache::DefaultFilename());
+
     PurgeList db_remove;
     verifyFiles(fs_files, db_remove);
     m_DBDataChanged = updateDB(fs_files, db_remove);
@@ -390,8 +458,9 @@ bool VideoScannerThread::updateDB(const FileCheckList &add, const PurgeList &rem
 }
 
 bool VideoScannerThread::buildFileList(const QString &directory,
-                                       const QStringList &imageExtensions,
-                                       FileCheckList &filelist)
+                       const QStringList &imageExtensions,
+                       const FileAssociations::ext_ignore_list &ext_list,
+                       FileCheckList &filelist)
 {
     // TODO: FileCheckList is a std::map, keyed off the filename. In the event
     // multiple backends have access to shared storage, the potential exists
@@ -401,11 +470,27 @@ bool VideoScannerThread::buildFileList(const QString &directory,
 
     LOG(VB_GENERAL,LOG_INFO, QString("buildFileList directory = %1")
                                  .arg(directory));
-    FileAssociations::ext_ignore_list ext_list;
-    FileAssociations::getFileAssociation().getExtensionIgnoreList(ext_list);
 
     dirhandler<FileCheckList> dh(filelist, imageExtensions);
-    return ScanVideoDirectory(directory, &dh, ext_list, m_ListUnknown);
+    return ScanVideoDirectory(directory, &dh, ext_list, m_ListUnknown,
+                              &m_dirCache);
+}
+
+void VideoScannerThread::LoadDirCache(void)
+{
+    if (m_dirCacheLoaded)
+        return;
+
+    m_dirCacheLoaded = true;
+    m_dirCache.Load(VideoDirCache::DefaultFilename());
+}
+
+/// The local directories seen by the last scan, only call this while the
+/// scanner isn't running
+QStringList VideoScannerThread::GetLocalDirs(void)
+{
+    LoadDirCache();
+    return m_dirCache.Directories();
 }
 
 void VideoScannerThread::SendProgressEvent(uint progress, uint total,
@@ -475,6 +560,93 @@ void VideoScanner::doScanAll()
     doScan(GetVideoDirs());
 }
 
+VideoScanWatcher::VideoScanWatcher(VideoScannerThread *scanner,
+                                   QObject *parent) :
+    QObject(parent), m_scanner(scanner),
+    m_watcher(new QFileSystemWatcher(this)), m_timer(new QTimer(this)),
+    m_pending(false)
+{
+    m_timer->setSingleShot(true);
+    m_timer->setInterval(kBatchDelayMS);
+
+    connect(m_watcher, SIGNAL(directoryChanged(const QString&)),
+            SLOT(DirectoryChanged(const QString&)));
+    connect(m_timer, SIGNAL(timeout()), SLOT(RequestRescan()));
+    connect(m_scanner->qthread(), SIGNAL(finished()), SLOT(ScanFinished()));
+
+    Watch(m_scanner->GetLocalDirs());
+}
+
+void VideoScanWatcher::Watch(const QStringList &dirs)
+{
+    QStringList add = dirs;
+    if (add.size() > kMaxWatches)
+    {
+        LOG(VB_GENERAL, LOG_WARNING,
+            QString("VideoScanWatcher: %1 video directories, only watching "
+                    "the first %2").arg(add.size()).arg(kMaxWatches));
+        add.sort();
+        add = add.mid(0, kMaxWatches);
+    }
+
+    QSet<QString> wanted = add.toSet();
+    QStringList   remove;
+
+    QStringList watched = m_watcher->directories();
+    for (QStringList::const_iterator it = watched.begin();
+         it != watched.end(); ++it)
+    {
+        if (!wanted.remove(*it))
+            remove.append(*it);
+    }
+
+    if (!remove.isEmpty())
+        m_watcher->removePaths(remove);
+    if (!wanted.isEmpty())
+        m_watcher->addPaths(wanted.toList());
+
+    LOG(VB_GENERAL, LOG_INFO,
+        QString("VideoScanWatcher: watching %1 video directories")
+            .arg(m_watcher->directories().size()));
+}
+
+void VideoScanWatcher::DirectoryChanged(const QString &path)
+{
+    LOG(VB_FILE, LOG_DEBUG,
+        QString("VideoScanWatcher: %1 changed").arg(path));
+
+    if (!m_timer->isActive())
+        m_timer->start();
+}
+
+void VideoScanWatcher::RequestRescan(void)
+{
+    // Anything that changes during a scan may have been missed by it
+    if (m_scanner->isRunning())
+    {
+        m_pending = true;
+        return;
+    }
+
+    m_pending = false;
+    QCoreApplication::postEvent(parent(), new QEvent(kEventType));
+}
+
+/// Ask again later, for when the parent was too busy to rescan
+void VideoScanWatcher::Retry(void)
+{
+    if (!m_timer->isActive())
+        m_timer->start();
+}
+
+void VideoScanWatcher::ScanFinished(void)
+{
+    Watch(m_scanner->GetLocalDirs());
+
+    if (m_pending && !m_timer->isActive())
+        m_timer->start();
+}
+
 void VideoScanner::finishedScan()
 {
     QStringList failedHosts = m_scanThread->GetOfflineSGHosts();
@@ -7,14 +7,19 @@
 
 #include <QObject> // for moc
 #include <QStringList>
+#include <QAtomicInt>
 #include <QEvent>
 #include <QCoreApplication>
 
 #include "mythmetaexp.h"
 #include "mthread.h"
 #include "mythprogressdialog.h"
+#include "dbaccess.h"
+#include "dirscan.h"
 
 class VideoMetadataListManager;
+class QFileSystemWatcher;
+class QTimer;
 
 class META_PUBLIC VideoScanner : public QObject
 {
@@ -68,10 +73,15 @@ class META_PUBLIC VideoScannerThread : public MThread
     void SetProgressDialog(MythUIProgressDialog *dialog) { m_dialog = dialog; };
     QStringList GetOfflineSGHosts(void) { return m_offlineSGHosts; };
     bool getDataChanged() { return m_DBDataChanged; };
+    QStringList GetLocalDirs(void);
 
     void ResetCounts() { m_addList.clear(); m_movList.clear(); m_delList.clear(); };
 
   private:
+    class ScanTask;
+
+    /// Most directories scanned at the same time, the rest wait their turn
+    static const int kMaxScanThreads = 4;
 
     struct CheckStruct
     {
@@ -87,8 +97,10 @@ class META_PUBLIC VideoScannerThread : public MThread
     void verifyFiles(FileCheckList &files, PurgeList &remove);
     bool updateDB(const FileCheckList &add, const PurgeList &remove);
     bool buildFileList(const QString &directory,
-                                        const QStringList &imageExtensions,
-                                        FileCheckList &filelist);
+                       const QStringList &imageExtensions,
+                       const FileAssociations::ext_ignore_list &ext_list,
+                       FileCheckList &filelist);
+    void LoadDirCache(void);
 
     void SendProgressEvent(uint progress, uint total = 0,
             QString messsage = QString());
@@ -110,6 +122,51 @@ class META_PUBLIC VideoScannerThread : public MThread
     QList<int> m_movList; // intids moved to new filename
     QList<int> m_delList; // orphaned/deleted intids
     bool m_DBDataChanged;
+
+    VideoDirCache m_dirCache;
+    bool          m_dirCacheLoaded;
+    QAtomicInt    m_dirsScanned;
+};
+
+/** \class VideoScanWatcher
+ *  \brief Watches the local video directories for changes, and asks its
+ *         parent for a rescan when there are some.
+ *
+ *  Changes are collected for a while before the rescan is asked for, so
+ *  copying in a season of episodes causes one incremental scan and one
+ *  VIDEO_LIST_CHANGE rather than one per file.  The directories watched are
+ *  the ones the last scan found.  Directories on other backends can't be
+ *  watched, they are still only picked up by a scan.
+ */
+class META_PUBLIC VideoScanWatcher : public QObject
+{
+    Q_OBJECT
+
+  public:
+    VideoScanWatcher(VideoScannerThread *scanner, QObject *parent);
+
+    void Retry(void);
+
+    /// Posted to the parent when a rescan is needed
+    static QEvent::Type kEventType;
+
+  private slots:
+    void DirectoryChanged(const QString &path);
+    void ScanFinished(void);
+    void RequestRescan(void);
+
+  private:
+    void Watch(const QStringList &dirs);
+
+    /// How long changes are collected before asking for a rescan
+    static const int kBatchDelayMS = 10000;
+    /// inotify watches are a limited resource shared by the whole system
+    static const int kMaxWatches   = 8192;
+
+    VideoScannerThread *m_scanner;
+    QFileSystemWatcher *m_watcher;
+    QTimer             *m_timer;
+    bool                m_pending;
 };
 
 #endif
@@ -26,7 +26,7 @@ namespace DTC
 class SERVICE_PUBLIC ProgramList : public QObject
 {
     Q_OBJECT
-    Q_CLASSINFO( "version", "1.0" );
+    Q_CLASSINFO( "version", "1.1" );
 
     // Q_CLASSINFO Used to augment Metadata for properties. 
     // See datacontracthelper.h for details
@@ -37,6 +37,7 @@ class SERVICE_PUBLIC ProgramList : public QObject
     Q_PROPERTY( int          StartIndex     READ StartIndex      WRITE setStartIndex     )
     Q_PROPERTY( int          Count          READ Count           WRITE setCount          )
     Q_PROPERTY( int          TotalAvailable READ TotalAvailable  WRITE setTotalAvailable )
+    Q_PROPERTY( QString      NextCursor     READ NextCursor      WRITE setNextCursor     )
     Q_PROPERTY( QDateTime    AsOf           READ AsOf            WRITE setAsOf           )
     Q_PROPERTY( QString      Version        READ Version         WRITE setVersion        )
     Q_PROPERTY( QString      ProtoVer       READ ProtoVer        WRITE setProtoVer       )
@@ -46,6 +47,7 @@ class SERVICE_PUBLIC ProgramList : public QObject
     PROPERTYIMP       ( int         , StartIndex      )
     PROPERTYIMP       ( int         , Count           )
     PROPERTYIMP       ( int         , TotalAvailable  )    
+    PROPERTYIMP       ( QString     , NextCursor      )
     PROPERTYIMP       ( QDateTime   , AsOf            )
     PROPERTYIMP       ( QString     , Version         )
     PROPERTYIMP       ( QString     , ProtoVer        )
@@ -69,6 +71,7 @@ class SERVICE_PUBLIC ProgramList : public QObject
             m_StartIndex    = src->m_StartIndex     ;
             m_Count         = src->m_Count          ;
             m_TotalAvailable= src->m_TotalAvailable ;
+            m_NextCursor    = src->m_NextCursor     ;
             m_AsOf          = src->m_AsOf           ;
             m_Version       = src->m_Version        ;
             m_ProtoVer      = src->m_ProtoVer       ;
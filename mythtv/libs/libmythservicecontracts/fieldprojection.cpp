@@ -0,0 +1,243 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: fieldprojection.cpp
+//
+// Purpose     : Property projection for the Fields= service parameter
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "fieldprojection.h"
+
+#include <QMetaType>
+#include <QStringList>
+
+// Data contracts nest only a few levels deep
+#define MAX_PROJECTION_DEPTH 6
+
+namespace DTC
+{
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+FieldProjection::FieldProjection( const QString &sFields )
+{
+    QStringList fields = sFields.split( ',', QString::SkipEmptyParts );
+
+    for (int nIdx = 0; nIdx < fields.size(); ++nIdx)
+    {
+        QString sName = fields[ nIdx ].trimmed().toLower();
+
+        if (!sName.isEmpty())
+            m_fields.insert( sName );
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+bool FieldProjection::Contains( const QString &sName ) const
+{
+    return m_fields.contains( sName.toLower() );
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Returns true if the property pszPropName of pObject is to be
+ *        returned, either because it was named or because something inside
+ *        it was.
+ */
+bool FieldProjection::Includes( const QObject *pObject,
+                                const char    *pszPropName ) const
+{
+    if (IsEmpty() || Contains( pszPropName ))
+        return true;
+
+    const QMetaObject *pMeta = pObject->metaObject();
+    int                nIdx  = pMeta->indexOfProperty( pszPropName );
+
+    if (nIdx < 0)
+        return false;
+
+    QMetaProperty prop = pMeta->property( nIdx );
+
+    return Includes( pObject, prop, prop.read( pObject ));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Returns true if value, the value of prop of pObject, is an object or
+ *        a list of objects containing a named property.
+ */
+bool FieldProjection::Includes( const QObject       *pObject,
+                                const QMetaProperty &prop,
+                                const QVariant      &value ) const
+{
+    if (IsEmpty())
+        return true;
+
+    // A missing child tells us nothing about its type, don't cache that
+
+    if (value.canConvert< QObject* >() && value.value< QObject* >() == NULL)
+        return false;
+
+    QPair< const QMetaObject *, int > key( pObject->metaObject(),
+                                           prop.propertyIndex() );
+
+    QHash< QPair< const QMetaObject *, int >, bool >::const_iterator it =
+        m_cache.find( key );
+
+    if (it != m_cache.end())
+        return *it;
+
+    MetaPath path;
+    path.append( pObject->metaObject() );
+
+    bool bIncludes = IncludesValue( pObject, prop, value, path );
+
+    m_cache[ key ] = bIncludes;
+
+    return bIncludes;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+bool FieldProjection::IncludesValue( const QObject       *pParent,
+                                     const QMetaProperty &prop,
+                                     const QVariant      &value,
+                                     MetaPath            &path ) const
+{
+    // Child objects are declared as QObject*, so their type can only be
+    // found from an instance. Use the first entry of lists for the same
+    // reason, and fall back to the "type=" class info for empty ones.
+
+    if (value.canConvert< QObject* >())
+        return IncludesObject( value.value< QObject* >(), path );
+
+    if (value.type() == QVariant::List)
+    {
+        const QVariantList list = value.toList();
+
+        if (!list.isEmpty() && list.first().canConvert< QObject* >())
+            return IncludesObject( list.first().value< QObject* >(), path );
+
+        return IncludesMeta( ContainedType( pParent->metaObject(), prop ),
+                             path );
+    }
+
+    return false;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+bool FieldProjection::IncludesObject( const QObject *pObject,
+                                      MetaPath      &path ) const
+{
+    if (pObject == NULL)
+        return false;
+
+    const QMetaObject *pMeta = pObject->metaObject();
+
+    if (path.contains( pMeta ) || (path.size() > MAX_PROJECTION_DEPTH))
+        return false;
+
+    path.append( pMeta );
+
+    bool bIncludes = false;
+
+    for (int nIdx = 0; !bIncludes && nIdx < pMeta->propertyCount(); ++nIdx)
+    {
+        QMetaProperty prop = pMeta->property( nIdx );
+
+        if (Contains( prop.name() ))
+            bIncludes = true;
+        else
+            bIncludes = IncludesValue( pObject, prop, prop.read( pObject ),
+                                       path );
+    }
+
+    path.removeLast();
+
+    return bIncludes;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+bool FieldProjection::IncludesMeta( const QMetaObject *pMeta,
+                                    MetaPath          &path ) const
+{
+    if ((pMeta == NULL) || path.contains( pMeta ) ||
+        (path.size() > MAX_PROJECTION_DEPTH))
+        return false;
+
+    path.append( pMeta );
+
+    bool bIncludes = false;
+
+    for (int nIdx = 0; !bIncludes && nIdx < pMeta->propertyCount(); ++nIdx)
+    {
+        QMetaProperty prop = pMeta->property( nIdx );
+
+        if (Contains( prop.name() ))
+            bIncludes = true;
+        else
+            bIncludes = IncludesMeta( ContainedType( pMeta, prop ), path );
+    }
+
+    path.removeLast();
+
+    return bIncludes;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Returns the meta object of the data contract held by prop, either
+ *        directly or, for collections, as given by its "type=" class info.
+ */
+const QMetaObject *FieldProjection::ContainedType( const QMetaObject   *pMeta,
+                                                   const QMetaProperty &prop )
+{
+    const QMetaObject *pChild = QMetaType::metaObjectForType( prop.userType() );
+
+    if (pChild != NULL)
+        return pChild;
+
+    int nIdx = pMeta->indexOfClassInfo( prop.name() );
+
+    if (nIdx < 0)
+        return NULL;
+
+    QStringList sOptions = QString( pMeta->classInfo( nIdx ).value() ).split( ';' );
+
+    for (int nOpt = 0; nOpt < sOptions.size(); ++nOpt)
+    {
+        if (sOptions[ nOpt ].startsWith( "type=" ))
+        {
+            QByteArray sType = sOptions[ nOpt ].mid( 5 ).toLatin1() + "*";
+
+            return QMetaType::metaObjectForType( QMetaType::type( sType ));
+        }
+    }
+
+    return NULL;
+}
+
+} // namespace DTC
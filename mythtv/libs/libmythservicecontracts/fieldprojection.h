@@ -0,0 +1,85 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: fieldprojection.h
+//
+// Purpose     : Property projection for the Fields= service parameter
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef FIELDPROJECTION_H_
+#define FIELDPROJECTION_H_
+
+#include <QMetaObject>
+#include <QMetaProperty>
+#include <QVariant>
+#include <QString>
+#include <QHash>
+#include <QPair>
+#include <QVector>
+#include <QSet>
+
+#include "serviceexp.h"
+
+namespace DTC
+{
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+/** \class FieldProjection
+ *  \brief The set of data contract properties a client asked for with the
+ *         Fields= parameter, e.g. "Fields=Title,StartTime,ChanId".
+ *
+ *  Names are matched case insensitively against property names at any
+ *  depth. A named property is returned complete, including any objects it
+ *  contains. An object or list property that isn't named is only returned
+ *  if something inside it was named, so "ChanId" returns the Channel of a
+ *  Program holding only its ChanId.
+ *
+ *  Child objects are only declared as QObject*, so what they contain is
+ *  found by looking at an instance. Types that refer back to each other
+ *  (a Program's Channel holds Programs) are only followed once. The answer
+ *  is cached for each property of each type, so asking about many objects
+ *  of the same type is cheap.
+ *
+ *  An empty projection includes everything.
+ */
+class SERVICE_PUBLIC FieldProjection
+{
+    public:
+
+        explicit FieldProjection( const QString &sFields = QString() );
+
+        bool IsEmpty    () const { return m_fields.isEmpty(); }
+        bool Contains   ( const QString &sName ) const;
+
+        bool Includes   ( const QObject *pObject, const char *pszPropName ) const;
+        bool Includes   ( const QObject       *pObject,
+                          const QMetaProperty &prop,
+                          const QVariant      &value ) const;
+
+        static const QMetaObject *ContainedType( const QMetaObject   *pMeta,
+                                                 const QMetaProperty &prop );
+
+    private:
+
+        typedef QVector< const QMetaObject * > MetaPath;
+
+        bool IncludesValue  ( const QObject       *pParent,
+                              const QMetaProperty &prop,
+                              const QVariant      &value,
+                              MetaPath            &path ) const;
+        bool IncludesObject ( const QObject *pObject, MetaPath &path ) const;
+        bool IncludesMeta   ( const QMetaObject *pMeta, MetaPath &path ) const;
+
+        QSet< QString >                                     m_fields; // lowercase
+
+        // Keyed by the type holding the property and the property's index
+        mutable QHash< QPair< const QMetaObject *, int >, bool > m_cache;
+};
+
+} // namespace DTC
+
+#endif
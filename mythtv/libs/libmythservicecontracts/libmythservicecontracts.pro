@@ -18,7 +18,7 @@ LIBS += -L../libmythbase -lmythbase-$${LIBVERSION}
 
 # Input
 
-HEADERS += serviceexp.h service.h datacontracthelper.h
+HEADERS += serviceexp.h service.h datacontracthelper.h fieldprojection.h
 
 HEADERS += services/mythServices.h    services/guideServices.h
 HEADERS += services/contentServices.h services/dvrServices.h
@@ -65,7 +65,7 @@ HEADERS += datacontracts/musicMetadataInfo.h     datacontracts/musicMetadataInfo
 
 HEADERS += enums/recStatus.h
 
-SOURCES += service.cpp
+SOURCES += service.cpp fieldprojection.cpp
 SOURCES += enums/recStatus.cpp
 
 INCLUDEPATH += ./enums
@@ -81,7 +81,7 @@ SOURCES += ../libmyth/programtypes.cpp ../libmyth/recordingtypes.cpp
 INCLUDEPATH += $$DEPENDPATH
 
 inc.path = $${PREFIX}/include/mythtv/libmythservicecontracts/
-inc.files = serviceexp.h service.h datacontracthelper.h
+inc.files = serviceexp.h service.h datacontracthelper.h fieldprojection.h
 
 incServices.path = $${PREFIX}/include/mythtv/libmythservicecontracts/services/
 incServices.files  = services/mythServices.h    services/guideServices.h
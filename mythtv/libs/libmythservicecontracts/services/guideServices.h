@@ -40,7 +40,7 @@
 class SERVICE_PUBLIC GuideServices : public Service  //, public QScriptable ???
 {
     Q_OBJECT
-    Q_CLASSINFO( "version"    , "2.3" )
+    Q_CLASSINFO( "version"    , "2.4" )
 
     public:
 
@@ -63,7 +63,8 @@ class SERVICE_PUBLIC GuideServices : public Service  //, public QScriptable ???
                                                           bool             Details,
                                                           int              ChannelGroupId,
                                                           int              StartIndex,
-                                                          int              Count) = 0;
+                                                          int              Count,
+                                                          const QString   &Fields ) = 0;
 
         virtual DTC::ProgramList*   GetProgramList      ( int              StartIndex,
                                                           int              Count,
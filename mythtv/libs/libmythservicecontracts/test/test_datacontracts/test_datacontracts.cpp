@@ -24,6 +24,7 @@
 #include "datacontracts/programList.h"
 #include "datacontracts/recRule.h"
 #include "datacontracts/recording.h"
+#include "fieldprojection.h"
 
 void TestDataContracts::initTestCase(void)
 {
@@ -174,6 +175,33 @@ void TestDataContracts::test_recordinginfo(void)
     QCOMPARE(pRecording->EndTs(), pRecording2->EndTs());
 }
 
-
+void TestDataContracts::test_fieldprojection(void)
+{
+    DTC::Program program;
+
+    // Nothing asked for, everything is returned
+    DTC::FieldProjection all;
+    QVERIFY(all.IsEmpty());
+    QVERIFY(all.Includes(&program, "Channel"));
+    QVERIFY(all.Includes(&program, "Cast"));
+
+    // Only properties of the program itself
+    DTC::FieldProjection title("Title, StartTime");
+    QVERIFY(title.Contains("title"));
+    QVERIFY(title.Contains("STARTTIME"));
+    QVERIFY(!title.Contains("EndTime"));
+    QVERIFY(!title.Includes(&program, "Channel"));
+    QVERIFY(!title.Includes(&program, "Cast"));
+
+    // A property of a child object brings in the child
+    DTC::FieldProjection chanid("title,chanid");
+    QVERIFY(chanid.Includes(&program, "Channel"));
+    QVERIFY(!chanid.Includes(&program, "Cast"));
+
+    // A named child is returned whole
+    DTC::FieldProjection channel("Channel");
+    QVERIFY(channel.Includes(&program, "Channel"));
+    QVERIFY(!channel.Includes(&program, "Recording"));
+}
 
 QTEST_APPLESS_MAIN(TestDataContracts)
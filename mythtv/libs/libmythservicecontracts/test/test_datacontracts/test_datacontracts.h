@@ -32,4 +32,5 @@ private slots:
     void test_programlist(void);
     void test_recrule(void);
     void test_recordinginfo(void);
+    void test_fieldprojection(void);
 };
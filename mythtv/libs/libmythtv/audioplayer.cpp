@@ -4,6 +4,7 @@
 #include "mythplayer.h"
 #include "audiooutput.h"
 #include "mythnotificationcenter.h"
+#include "mythtrace.h"
 
 #define LOC QString("AudioPlayer: ")
 
@@ -108,6 +109,8 @@ void AudioPlayer::DeleteOutput(void)
 
 QString AudioPlayer::ReinitAudio(void)
 {
+    MYTH_TRACE_SCOPE("AudioPlayer::ReinitAudio", "mythplayer");
+
     bool want_audio = m_parent->IsAudioNeeded();
     QString errMsg = QString::null;
     QMutexLocker lock(&m_lock);
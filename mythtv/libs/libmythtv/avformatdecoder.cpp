@@ -11,6 +11,7 @@ using namespace std;
 
 #include <QTextCodec>
 #include <QFileInfo>
+#include <QDataStream>
 
 // MythTV headers
 #include "mythtvexp.h"
@@ -25,6 +26,8 @@ using namespace std;
 #include "programinfo.h"
 #include "mythcorecontext.h"
 #include "mythdbcon.h"
+#include "mythtrace.h"
+#include "recordingfile.h"
 #include "iso639.h"
 #include "mpegtables.h"
 #include "atscdescriptors.h"
@@ -987,13 +990,259 @@ extern "C" void HandleStreamChange(void *data)
     decoder->m_streams_changed = true;
 }
 
+/// Bump when the layout written by SerializeProbeSnapshot() changes
+static const quint32 kProbeSnapshotVersion = 1;
+/// Analysis limits used when a probe snapshot supplies stream parameters
+static const int64_t kProbeSnapshotAnalyzeDuration = AV_TIME_BASE / 2;
+static const int64_t kProbeSnapshotProbeSize       = 1024 * 1024;
+
+/** \brief Serializes the parameters of every probed stream in ic.
+ *
+ *  Returns an empty array unless every stream has complete parameters,
+ *  so that only a fully successful probe is ever cached.
+ */
+static QByteArray SerializeProbeSnapshot(AVFormatContext *ic)
+{
+    QByteArray snapshot;
+    QDataStream out(&snapshot, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_0);
+
+    out << kProbeSnapshotVersion << (quint32)ic->nb_streams;
+    for (uint i = 0; i < ic->nb_streams; i++)
+    {
+        AVStream *st = ic->streams[i];
+        const AVCodecParameters *par = st->codecpar;
+        if (!has_codec_parameters(st))
+            return QByteArray();
+
+        out << (qint32)st->id << (qint32)par->codec_type
+            << (qint32)par->codec_id << (quint32)par->codec_tag
+            << (qint32)par->format << (qint32)par->profile
+            << (qint32)par->level << (qint32)par->width
+            << (qint32)par->height
+            << (qint32)par->sample_aspect_ratio.num
+            << (qint32)par->sample_aspect_ratio.den
+            << (qint32)par->field_order << (qint32)par->video_delay
+            << (quint64)par->channel_layout << (qint32)par->channels
+            << (qint32)par->sample_rate << (qint32)par->block_align
+            << (qint32)par->frame_size
+            << (qint32)par->bits_per_coded_sample
+            << (qint64)par->bit_rate
+            << (qint32)st->avg_frame_rate.num << (qint32)st->avg_frame_rate.den
+            << (qint32)st->r_frame_rate.num << (qint32)st->r_frame_rate.den
+            << QByteArray((const char *)par->extradata, par->extradata_size);
+    }
+
+    return snapshot;
+}
+
+/// One stream's parameters as written by SerializeProbeSnapshot()
+struct ProbeSnapshotStream
+{
+    qint32 id, codec_type, codec_id, format, profile, level;
+    qint32 width, height, sar_num, sar_den, field_order, video_delay;
+    qint32 channels, sample_rate, block_align, frame_size, bits;
+    qint32 avg_num, avg_den, r_num, r_den;
+    quint32 codec_tag;
+    quint64 channel_layout;
+    qint64 bit_rate;
+    QByteArray extradata;
+};
+
+/// Reads the streams in a probe snapshot, returns false if it is unreadable
+static bool ReadProbeSnapshot(const QByteArray &snapshot,
+                              vector<ProbeSnapshotStream> &streams)
+{
+    QDataStream in(snapshot);
+    in.setVersion(QDataStream::Qt_5_0);
+
+    quint32 version, nb_streams;
+    in >> version >> nb_streams;
+    if (in.status() != QDataStream::Ok || version != kProbeSnapshotVersion)
+        return false;
+
+    streams.resize(nb_streams);
+    for (uint i = 0; i < nb_streams; i++)
+    {
+        ProbeSnapshotStream &s = streams[i];
+        in >> s.id >> s.codec_type >> s.codec_id >> s.codec_tag >> s.format
+           >> s.profile >> s.level >> s.width >> s.height >> s.sar_num
+           >> s.sar_den >> s.field_order >> s.video_delay >> s.channel_layout
+           >> s.channels >> s.sample_rate >> s.block_align >> s.frame_size
+           >> s.bits >> s.bit_rate >> s.avg_num >> s.avg_den >> s.r_num
+           >> s.r_den >> s.extradata;
+        if (in.status() != QDataStream::Ok)
+            return false;
+    }
+
+    return true;
+}
+
+/** \brief Returns true if the snapshot streams can be matched to the
+ *         streams in ic by AVStream::id.
+ *
+ *  The id is the container's own stream id (the PID for MPEG-TS). It
+ *  is only usable if the ids in ic are distinct and at least one of
+ *  them is in the snapshot. A remux or transcode assigns new ids, and
+ *  some demuxers leave every id at 0.
+ */
+static bool ProbeSnapshotIdsMatch(AVFormatContext *ic,
+                                  const vector<ProbeSnapshotStream> &streams)
+{
+    bool found = false;
+    for (uint i = 0; i < ic->nb_streams; i++)
+    {
+        for (uint j = i + 1; j < ic->nb_streams; j++)
+        {
+            if (ic->streams[i]->id == ic->streams[j]->id)
+                return false;
+        }
+        for (uint j = 0; j < streams.size() && !found; j++)
+            found = (streams[j].id == ic->streams[i]->id);
+    }
+    return found;
+}
+
+/** \brief Copies stream parameters from a probe snapshot into ic.
+ *
+ *  Streams are matched by id when ProbeSnapshotIdsMatch() says the ids
+ *  line up, and otherwise by index, and must then have the same codec.
+ *  Only streams the demuxer has not yet described are touched. When
+ *  update_codec is set, the deprecated AVStream::codec context is
+ *  refreshed as well, because the rest of the decoder still uses it.
+ *
+ *  \return false if the snapshot is unreadable or describes a stream
+ *          that does not match one in ic, i.e. the file has changed.
+ */
+static bool ApplyProbeSnapshot(AVFormatContext *ic, const QByteArray &snapshot,
+                               bool update_codec)
+{
+    vector<ProbeSnapshotStream> streams;
+    if (!ReadProbeSnapshot(snapshot, streams))
+        return false;
+
+    bool by_id = ProbeSnapshotIdsMatch(ic, streams);
+
+    for (uint i = 0; i < streams.size(); i++)
+    {
+        const ProbeSnapshotStream &s = streams[i];
+
+        AVStream *st = NULL;
+        if (by_id)
+        {
+            for (uint j = 0; j < ic->nb_streams && !st; j++)
+            {
+                if (ic->streams[j]->id == s.id)
+                    st = ic->streams[j];
+            }
+        }
+        else if (i < ic->nb_streams)
+        {
+            st = ic->streams[i];
+        }
+        if (!st)
+            continue; // the demuxer may not have found it yet
+
+        AVCodecParameters *par = st->codecpar;
+        if (par->codec_type == AVMEDIA_TYPE_UNKNOWN)
+            continue; // still being probed by the demuxer
+        if (par->codec_type != (AVMediaType)s.codec_type ||
+            (par->codec_id != AV_CODEC_ID_NONE &&
+             par->codec_id != (AVCodecID)s.codec_id))
+        {
+            return false;
+        }
+
+        if (has_codec_parameters(st))
+            continue;
+
+        par->codec_id              = (AVCodecID)s.codec_id;
+        par->codec_tag             = s.codec_tag;
+        par->format                = s.format;
+        par->profile               = s.profile;
+        par->level                 = s.level;
+        par->width                 = s.width;
+        par->height                = s.height;
+        par->sample_aspect_ratio   = av_make_q(s.sar_num, s.sar_den);
+        par->field_order           = (AVFieldOrder)s.field_order;
+        par->video_delay           = s.video_delay;
+        par->channel_layout        = s.channel_layout;
+        par->channels              = s.channels;
+        par->sample_rate           = s.sample_rate;
+        par->block_align           = s.block_align;
+        par->frame_size            = s.frame_size;
+        par->bits_per_coded_sample = s.bits;
+        par->bit_rate              = s.bit_rate;
+        if (!st->avg_frame_rate.num)
+            st->avg_frame_rate = av_make_q(s.avg_num, s.avg_den);
+        if (!st->r_frame_rate.num)
+            st->r_frame_rate = av_make_q(s.r_num, s.r_den);
+
+        if (!par->extradata && !s.extradata.isEmpty())
+        {
+            par->extradata = (uint8_t *)av_mallocz(
+                s.extradata.size() + AV_INPUT_BUFFER_PADDING_SIZE);
+            if (par->extradata)
+            {
+                memcpy(par->extradata, s.extradata.constData(),
+                       s.extradata.size());
+                par->extradata_size = s.extradata.size();
+            }
+        }
+
+        if (update_codec)
+            avcodec_parameters_to_context(st->codec, par);
+    }
+
+    return true;
+}
+
 int AvFormatDecoder::FindStreamInfo(void)
 {
+    MYTH_TRACE_SCOPE("avformat_find_stream_info", "avformatdecoder");
     QMutexLocker lock(avcodeclock);
+
+    // With parameters from an earlier probe of this recording we only
+    // need to read far enough to sync to the streams.
+    bool use_snapshot = !m_probeSnapshot.isEmpty() &&
+        ApplyProbeSnapshot(ic, m_probeSnapshot, false);
+    int64_t max_analyze_duration = ic->max_analyze_duration;
+    int64_t probesize = ic->probesize;
+    if (use_snapshot)
+    {
+        ic->max_analyze_duration = kProbeSnapshotAnalyzeDuration;
+        ic->probesize = kProbeSnapshotProbeSize;
+    }
+
     // Suppress ffmpeg logging unless "-v libav --loglevel debug"
     if (!VERBOSE_LEVEL_CHECK(VB_LIBAV, LOG_DEBUG))
         silence_ffmpeg_logging = true;
     int retval = avformat_find_stream_info(ic, NULL);
+
+    if (use_snapshot)
+    {
+        ic->max_analyze_duration = max_analyze_duration;
+        ic->probesize = probesize;
+
+        bool complete = (retval >= 0) &&
+            ApplyProbeSnapshot(ic, m_probeSnapshot, true);
+        for (uint i = 0; complete && i < ic->nb_streams; i++)
+            complete = has_codec_parameters(ic->streams[i]);
+
+        if (complete)
+        {
+            LOG(VB_PLAYBACK, LOG_INFO, LOC +
+                "Stream parameters taken from probe snapshot");
+        }
+        else
+        {
+            // The file no longer matches the snapshot, probe it fully
+            LOG(VB_PLAYBACK, LOG_INFO, LOC +
+                "Probe snapshot is stale, probing streams");
+            m_probeSnapshot.clear();
+            retval = avformat_find_stream_info(ic, NULL);
+        }
+    }
     silence_ffmpeg_logging = false;
     // ffmpeg 3.0 is returning -1 code when there is a channel
     // change or some encoding error just after the start
@@ -1022,6 +1271,8 @@ int AvFormatDecoder::OpenFile(RingBuffer *rbuffer, bool novideo,
                               char testbuf[kDecoderProbeBufferSize],
                               int testbufsize)
 {
+    MYTH_TRACE_SCOPE("AvFormatDecoder::OpenFile", "avformatdecoder");
+
     CloseContext();
 
     ringBuffer = rbuffer;
@@ -1070,6 +1321,14 @@ int AvFormatDecoder::OpenFile(RingBuffer *rbuffer, bool novideo,
         }
     }
 
+    // Reuse the stream parameters found by an earlier probe of this
+    // recording, typically by the backend's preview generator.
+    m_probeSnapshot.clear();
+    uint recordingId = m_playbackinfo ? m_playbackinfo->GetRecordingID() : 0;
+    if (recordingId && !is_db_ignored && !ringBuffer->IsDisc())
+        m_probeSnapshot = RecordingFile::LoadProbeSnapshot(recordingId);
+    bool had_snapshot = !m_probeSnapshot.isEmpty();
+
     int err = 0;
     bool found = false;
     bool scanned = false;
@@ -1200,6 +1459,16 @@ int AvFormatDecoder::OpenFile(RingBuffer *rbuffer, bool novideo,
         }
     }
 
+    // Cache the result of a full probe for the next playback. A snapshot
+    // that was used successfully is still in m_probeSnapshot.
+    if (recordingId && !is_db_ignored && !ringBuffer->IsDisc() &&
+        m_probeSnapshot.isEmpty())
+    {
+        QByteArray snapshot = SerializeProbeSnapshot(ic);
+        if (!snapshot.isEmpty() || had_snapshot)
+            RecordingFile::SaveProbeSnapshot(recordingId, snapshot);
+    }
+
     ic->streams_changed = HandleStreamChange;
     ic->stream_change_data = this;
 
@@ -2018,6 +2287,8 @@ void AvFormatDecoder::ScanDSMCCStreams(void)
 
 int AvFormatDecoder::ScanStreams(bool novideo)
 {
+    MYTH_TRACE_SCOPE("AvFormatDecoder::ScanStreams", "avformatdecoder");
+
     bool unknownbitrate = false;
     int scanerror = 0;
     bitrate       = 0;
@@ -2585,6 +2856,7 @@ int AvFormatDecoder::ScanStreams(bool novideo)
 
 bool AvFormatDecoder::OpenAVCodec(AVCodecContext *avctx, const AVCodec *codec)
 {
+    MYTH_TRACE_SCOPE("avcodec_open2", "avformatdecoder");
     QMutexLocker locker(avcodeclock);
 
     int ret = avcodec_open2(avctx, codec, NULL);
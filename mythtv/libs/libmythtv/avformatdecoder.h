@@ -4,6 +4,7 @@
 
 #include <stdint.h>
 
+#include <QByteArray>
 #include <QString>
 #include <QMap>
 #include <QList>
@@ -275,6 +276,10 @@ class AvFormatDecoder : public DecoderBase
 
     bool is_db_ignored;
 
+    /// Stream parameters stored after an earlier full probe of this
+    /// recording, used to shorten avformat_find_stream_info().
+    QByteArray m_probeSnapshot;
+
     H264Parser *m_h264_parser;
 
     AVFormatContext *ic;
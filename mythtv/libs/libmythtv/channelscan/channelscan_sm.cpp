@@ -113,6 +113,54 @@ class ScannedChannelInfo
     sdt_map_t         sdts;
 };
 
+/// Called by each scanner before it starts scanning
+void ChannelScanGroup::Join(void)
+{
+    QMutexLocker locker(&m_lock);
+    ++m_scanners;
+}
+
+/// \return true if this was the last scanner still scanning
+bool ChannelScanGroup::Leave(void)
+{
+    QMutexLocker locker(&m_lock);
+    if (m_scanners)
+        --m_scanners;
+    return !m_scanners;
+}
+
+/// \return false if another scanner has already claimed the transport
+bool ChannelScanGroup::Claim(const TransportScanItem &item)
+{
+    QString key = QString("%1 %2").arg(item.freq_offset(0))
+        .arg(item.tuning.polarity.toString());
+
+    QMutexLocker locker(&m_lock);
+    if (m_claimed.contains(key))
+        return false;
+    m_claimed.insert(key);
+    return true;
+}
+
+void ChannelScanGroup::TransportScanned(void)
+{
+    QMutexLocker locker(&m_lock);
+    ++m_transportsScanned;
+}
+
+/**
+ *  \param transports The number of transports on the scanner's list,
+ *                    which grows as transports are found in the NIT.
+ */
+int ChannelScanGroup::PercentComplete(uint transports)
+{
+    QMutexLocker locker(&m_lock);
+    m_transportCount = max(m_transportCount, transports);
+    if (!m_transportCount)
+        return 0;
+    return min(m_transportsScanned * 100 / m_transportCount, 100U);
+}
+
 /** \class ChannelScanSM
  *  \brief Scanning class for cards that support a SignalMonitor class.
  *
@@ -156,6 +204,7 @@ ChannelScanSM::ChannelScanSM(ScanMonitor *_scan_monitor,
       m_extendScanList(false),
       // Optional state
       m_scanDTVTunerType(DTVTunerType::kTunerTypeUnknown),
+      m_scanGroup(NULL),
       // State
       m_scanning(false),
       m_threadExit(false),
@@ -246,6 +295,17 @@ ChannelScanSM::~ChannelScanSM(void)
     teardown_frequency_tables();
 }
 
+/**
+ *  \brief Shares the transports of the next scan with the other scanners
+ *         in group.  Must be called before any of them start scanning.
+ */
+void ChannelScanSM::SetScanGroup(ChannelScanGroup *group)
+{
+    m_scanGroup = group;
+    if (m_scanGroup)
+        m_scanGroup->Join();
+}
+
 void ChannelScanSM::SetAnalog(bool is_analog)
 {
     m_signalMonitor->RemoveListener(m_analogSignalHandler);
@@ -385,6 +445,8 @@ void ChannelScanSM::HandlePAT(const ProgramAssociationTable *pat)
         if (pat->ProgramPID(i)) // don't add NIT "program", MPEG/ATSC safe.
             sd->AddListeningPID(pat->ProgramPID(i));
     }
+
+    UpdateChannelInfo(true);
 }
 
 void ChannelScanSM::HandlePMT(uint, const ProgramMapTable *pmt)
@@ -398,6 +460,10 @@ void ChannelScanSM::HandlePMT(uint, const ProgramMapTable *pmt)
     if (!m_currentTestingDecryption &&
         pmt->IsEncrypted(GetDTVChannel()->GetSIStandard()))
         m_currentEncryptionStatus[pmt->ProgramNumber()] = kEncUnknown;
+
+    // The last PMT completes a transport without SI tables.  DVB and
+    // ATSC transports still wait for their SI tables
+    UpdateChannelInfo(true);
 }
 
 void ChannelScanSM::HandleVCT(uint, const VirtualChannelTable *vct)
@@ -866,13 +932,22 @@ bool ChannelScanSM::UpdateChannelInfo(bool wait_until_complete)
     if (transport_tune_complete)
     {
         transport_tune_complete &= !m_currentInfo->pmts.empty();
-        if (sd->HasCachedMGT() || sd->HasCachedAnyVCTs())
+
+        // The PAT and PMT repeat far more often than the SI tables, so
+        // wait for the tables the transport's standard requires even if
+        // none of them have been seen yet.
+        QString si_std = GetDTVChannel() ?
+            GetDTVChannel()->GetSIStandard() : QString("mpeg");
+
+        if (si_std == "atsc" ||
+            sd->HasCachedMGT() || sd->HasCachedAnyVCTs())
         {
             transport_tune_complete &= sd->HasCachedMGT();
             transport_tune_complete &=
                 (!m_currentInfo->tvcts.empty() || !m_currentInfo->cvcts.empty());
         }
-        if (sd->HasCachedAnyNIT() || sd->HasCachedAnySDTs())
+        if (si_std == "dvb" ||
+            sd->HasCachedAnyNIT() || sd->HasCachedAnySDTs())
         {
             transport_tune_complete &= !m_currentInfo->nits.empty();
             transport_tune_complete &= !m_currentInfo->sdts.empty();
@@ -1026,6 +1101,8 @@ bool ChannelScanSM::UpdateChannelInfo(bool wait_until_complete)
         if (m_scanning)
         {
             m_transportsScanned++;
+            if (m_scanGroup)
+                m_scanGroup->TransportScanned();
             UpdateScanPercentCompleted();
             m_waitingForTables = false;
             m_nextIt = m_current.nextTransport();
@@ -1686,7 +1763,17 @@ void ChannelScanSM::HandleActiveScan(void)
     m_current = m_nextIt; // Increment current
     m_dvbt2Tried = false;
 
-    if (m_current != m_scanTransports.end())
+    if (m_current != m_scanTransports.end() && m_scanGroup &&
+        0 == m_current.offset() && !m_scanGroup->Claim(*m_current))
+    {
+        // Another tuner is scanning this one, skip all of its offsets
+        LOG(VB_CHANSCAN, LOG_DEBUG, LOC + QString("%1 claimed by another tuner")
+            .arg((*m_current).FriendlyName));
+        m_dvbt2Tried = true;
+        m_waitingForTables = false;
+        m_nextIt = m_current.nextTransport();
+    }
+    else if (m_current != m_scanTransports.end())
     {
         ScanTransport(m_current);
 
@@ -1717,7 +1804,9 @@ void ChannelScanSM::HandleActiveScan(void)
     }
     else
     {
-        m_scanMonitor->ScanComplete();
+        // With other tuners the last one to finish reports it
+        if (!m_scanGroup || m_scanGroup->Leave())
+            m_scanMonitor->ScanComplete();
         m_scanning = false;
         m_current = m_nextIt = m_scanTransports.end();
     }
@@ -67,6 +67,36 @@ typedef QPair<transport_scan_items_it_t, ScannedChannelInfo*> ChannelListItem;
 typedef QList<ChannelListItem> ChannelList;
 
 class ChannelScanSM;
+
+/** \class ChannelScanGroup
+ *  \brief Shares the transports of one scan out between the ChannelScanSM
+ *         of each tuner scanning the same video source.
+ *
+ *   Every scanner works through its own copy of the transport list, but
+ *   only tunes the transports no other scanner has claimed, so a tuner
+ *   moves on to the next unclaimed transport as soon as it is done with
+ *   the last one.  The last scanner to finish reports the scan complete.
+ */
+class ChannelScanGroup
+{
+  public:
+    ChannelScanGroup() :
+        m_transportCount(0), m_transportsScanned(0), m_scanners(0) { }
+
+    void Join(void);
+    bool Leave(void);
+    bool Claim(const TransportScanItem &item);
+    void TransportScanned(void);
+    int  PercentComplete(uint transports);
+
+  private:
+    QMutex          m_lock;
+    QSet<QString>   m_claimed;
+    uint            m_transportCount;
+    uint            m_transportsScanned;
+    uint            m_scanners;
+};
+
 class AnalogSignalHandler : public SignalMonitorListener
 {
   public:
@@ -120,6 +150,7 @@ class ChannelScanSM : public MPEGStreamListener,
     void SetSignalTimeout(uint val)    { m_signalTimeout = val; }
     void SetChannelTimeout(uint val)   { m_channelTimeout = val; }
     void SetScanDTVTunerType(DTVTunerType t) { m_scanDTVTunerType = t; }
+    void SetScanGroup(ChannelScanGroup *group);
 
     uint GetSignalTimeout(void)  const { return m_signalTimeout; }
     uint GetChannelTimeout(void) const { return m_channelTimeout; }
@@ -218,6 +249,8 @@ class ChannelScanSM : public MPEGStreamListener,
 
     // Optional info
     DTVTunerType      m_scanDTVTunerType;
+    /// Set when other tuners are scanning the same transports, not owned
+    ChannelScanGroup *m_scanGroup;
 
     /// The big lock
     mutable QMutex    m_lock;
@@ -256,6 +289,13 @@ class ChannelScanSM : public MPEGStreamListener,
 
 inline void ChannelScanSM::UpdateScanPercentCompleted(void)
 {
+    if (m_scanGroup)
+    {
+        m_scanMonitor->ScanPercentComplete(m_scanGroup->PercentComplete(
+            m_scanTransports.size() + m_extendTransports.size()));
+        return;
+    }
+
     int tmp = (m_transportsScanned * 100) /
               (m_scanTransports.size() + m_extendTransports.size());
     m_scanMonitor->ScanPercentComplete(tmp);
@@ -44,11 +44,81 @@ using namespace std;
 #include "iptvchannel.h"
 #include "ExternalChannel.h"
 #include "cardutil.h"
+#include "mythcorecontext.h"
+#include "mythdbcon.h"
 
 #define LOC QString("ChScan: ")
 
+/// The type of tuner the scan is for, if the scan type says
+static DTVTunerType scan_tuner_type(int scantype)
+{
+    switch (scantype)
+    {
+        case ScanTypeSetting::FullScan_ATSC:
+            return DTVTunerType::kTunerTypeATSC;
+        case ScanTypeSetting::FullScan_DVBC:
+            return DTVTunerType::kTunerTypeDVBC;
+        case ScanTypeSetting::FullScan_DVBT:
+            return DTVTunerType::kTunerTypeDVBT;
+        case ScanTypeSetting::FullScan_DVBT2:
+            return DTVTunerType::kTunerTypeDVBT2;
+        case ScanTypeSetting::NITAddScan_DVBT:
+            return DTVTunerType::kTunerTypeDVBT;
+        case ScanTypeSetting::NITAddScan_DVBT2:
+            return DTVTunerType::kTunerTypeDVBT2;
+        case ScanTypeSetting::NITAddScan_DVBS:
+            return DTVTunerType::kTunerTypeDVBS1;
+        case ScanTypeSetting::NITAddScan_DVBS2:
+            return DTVTunerType::kTunerTypeDVBS2;
+        case ScanTypeSetting::NITAddScan_DVBC:
+            return DTVTunerType::kTunerTypeDVBC;
+        default:
+            return DTVTunerType::kTunerTypeUnknown;
+    }
+}
+
+static ChannelBase *create_channel(const QString &card_type,
+                                   const QString &device)
+{
+#ifdef USING_DVB
+    if ("DVB" == card_type)
+        return new DVBChannel(device);
+#endif
+
+#ifdef USING_V4L2
+    if (("V4L" == card_type) || ("MPEG" == card_type))
+        return new V4LChannel(NULL, device);
+#endif
+
+#ifdef USING_HDHOMERUN
+    if ("HDHOMERUN" == card_type)
+        return new HDHRChannel(NULL, device);
+#endif // USING_HDHOMERUN
+
+#ifdef USING_ASI
+    if ("ASI" == card_type)
+        return new ASIChannel(NULL, device);
+#endif // USING_ASI
+
+#ifdef USING_IPTV
+    if ("FREEBOX" == card_type)
+        return new IPTVChannel(NULL, device);
+#endif
+
+#ifdef USING_VBOX
+    if ("VBOX" == card_type)
+        return new IPTVChannel(NULL, device);
+#endif
+
+    if ("EXTERNAL" == card_type)
+        return new ExternalChannel(NULL, device);
+
+    return NULL;
+}
+
 ChannelScanner::ChannelScanner() :
-    scanMonitor(NULL), channel(NULL), sigmonScanner(NULL), iptvScanner(NULL),
+    scanMonitor(NULL), channel(NULL), sigmonScanner(NULL), scanGroup(NULL),
+    iptvScanner(NULL),
 #ifdef USING_VBOX
     vboxScanner(NULL),
 #endif
@@ -69,12 +139,24 @@ ChannelScanner::~ChannelScanner()
 
 void ChannelScanner::Teardown(void)
 {
+    while (!helperScanners.empty())
+        delete helperScanners.takeLast();
+
+    while (!helperChannels.empty())
+        delete helperChannels.takeLast();
+
     if (sigmonScanner)
     {
         delete sigmonScanner;
         sigmonScanner = NULL;
     }
 
+    if (scanGroup)
+    {
+        delete scanGroup;
+        scanGroup = NULL;
+    }
+
     if (channel)
     {
         delete channel;
@@ -139,6 +221,16 @@ void ChannelScanner::Scan(
         return;
     }
 
+    // Share the transports of a full scan with the other free tuners
+    if ((ScanTypeSetting::FullScan_ATSC     == scantype) ||
+        (ScanTypeSetting::FullScan_DVBC     == scantype) ||
+        (ScanTypeSetting::FullScan_DVBT     == scantype) ||
+        (ScanTypeSetting::FullScan_DVBT2    == scantype) ||
+        (ScanTypeSetting::FullTransportScan == scantype))
+    {
+        AddScanHelpers(scantype, cardid, sourceid, do_test_decryption);
+    }
+
     sigmonScanner->StartScanner();
     scanMonitor->ScanUpdateStatusText("");
 
@@ -166,6 +258,17 @@ void ChannelScanner::Scan(
 
         ok = sigmonScanner->ScanTransports(
             sourceid, freq_std, mod, tbl, tbl_start, tbl_end);
+
+        for (int i = 0; ok && i < helperScanners.size(); ++i)
+        {
+            ChannelScanSM *helper = helperScanners[i];
+            helper->SetSignalTimeout(sigmonScanner->GetSignalTimeout());
+            helper->SetAnalog(false);
+            helper->StartScanner();
+            if (!helper->ScanTransports(
+                    sourceid, freq_std, mod, tbl, tbl_start, tbl_end))
+                scanGroup->Leave();
+        }
     }
     else if ((ScanTypeSetting::NITAddScan_DVBT  == scantype) ||
              (ScanTypeSetting::NITAddScan_DVBT2 == scantype) ||
@@ -183,6 +286,15 @@ void ChannelScanner::Scan(
                 .arg(sourceid));
 
         ok = sigmonScanner->ScanExistingTransports(sourceid, do_follow_nit);
+
+        for (int i = 0; ok && i < helperScanners.size(); ++i)
+        {
+            ChannelScanSM *helper = helperScanners[i];
+            helper->StartScanner();
+            if (!helper->ScanExistingTransports(sourceid, do_follow_nit))
+                scanGroup->Leave();
+        }
+
         if (ok)
         {
             scanMonitor->ScanPercentComplete(0);
@@ -405,48 +517,7 @@ void ChannelScanner::PreScanCommon(
         channel_timeout = max(channel_timeout, need_nit * 7 * 1000U);
     }
 
-#ifdef USING_DVB
-    if ("DVB" == card_type)
-        channel = new DVBChannel(device);
-#endif
-
-#ifdef USING_V4L2
-    if (("V4L" == card_type) || ("MPEG" == card_type))
-        channel = new V4LChannel(NULL, device);
-#endif
-
-#ifdef USING_HDHOMERUN
-    if ("HDHOMERUN" == card_type)
-    {
-        channel = new HDHRChannel(NULL, device);
-    }
-#endif // USING_HDHOMERUN
-
-#ifdef USING_ASI
-    if ("ASI" == card_type)
-    {
-        channel = new ASIChannel(NULL, device);
-    }
-#endif // USING_ASI
-
-#ifdef USING_IPTV
-    if ("FREEBOX" == card_type)
-    {
-        channel = new IPTVChannel(NULL, device);
-    }
-#endif
-
-#ifdef USING_VBOX
-    if ("VBOX" == card_type)
-    {
-        channel = new IPTVChannel(NULL, device);
-    }
-#endif
-
-    if ("EXTERNAL" == card_type)
-    {
-        channel = new ExternalChannel(NULL, device);
-    }
+    channel = create_channel(card_type, device);
 
     if (!channel)
     {
@@ -475,38 +546,9 @@ void ChannelScanner::PreScanCommon(
     // If we know the channel types we can give the signal montior a hint.
     // Since we unfortunately do not record this info in the DB, we cannot
     // do this for the other scan types and have to guess later on...
-    switch (scantype)
-    {
-        case ScanTypeSetting::FullScan_ATSC:
-            sigmonScanner->SetScanDTVTunerType(DTVTunerType::kTunerTypeATSC);
-            break;
-        case ScanTypeSetting::FullScan_DVBC:
-            sigmonScanner->SetScanDTVTunerType(DTVTunerType::kTunerTypeDVBC);
-            break;
-        case ScanTypeSetting::FullScan_DVBT:
-            sigmonScanner->SetScanDTVTunerType(DTVTunerType::kTunerTypeDVBT);
-            break;
-        case ScanTypeSetting::FullScan_DVBT2:
-            sigmonScanner->SetScanDTVTunerType(DTVTunerType::kTunerTypeDVBT2);
-            break;
-        case ScanTypeSetting::NITAddScan_DVBT:
-            sigmonScanner->SetScanDTVTunerType(DTVTunerType::kTunerTypeDVBT);
-            break;
-        case ScanTypeSetting::NITAddScan_DVBT2:
-            sigmonScanner->SetScanDTVTunerType(DTVTunerType::kTunerTypeDVBT2);
-            break;
-        case ScanTypeSetting::NITAddScan_DVBS:
-            sigmonScanner->SetScanDTVTunerType(DTVTunerType::kTunerTypeDVBS1);
-            break;
-        case ScanTypeSetting::NITAddScan_DVBS2:
-            sigmonScanner->SetScanDTVTunerType(DTVTunerType::kTunerTypeDVBS2);
-            break;
-        case ScanTypeSetting::NITAddScan_DVBC:
-            sigmonScanner->SetScanDTVTunerType(DTVTunerType::kTunerTypeDVBC);
-            break;
-        default:
-            break;
-    }
+    DTVTunerType tuner_type = scan_tuner_type(scantype);
+    if (tuner_type != DTVTunerType::kTunerTypeUnknown)
+        sigmonScanner->SetScanDTVTunerType(tuner_type);
 
     // Signal Meters are connected here
     SignalMonitor *mon = sigmonScanner->GetSignalMonitor();
@@ -524,3 +566,121 @@ void ChannelScanner::PreScanCommon(
 
     MonitorProgress(mon, mon, dvbm, using_rotor);
 }
+
+/**
+ *  \brief Creates a scanner for each of the other tuners on the video
+ *         source that aren't in use, to share the transports of the scan
+ *         with sigmonScanner.
+ */
+void ChannelScanner::AddScanHelpers(
+    int scantype, uint cardid, uint sourceid, bool do_test_decryption)
+{
+    QString card_type = CardUtil::GetRawInputType(cardid);
+    QStringList devices(CardUtil::GetVideoDevice(cardid));
+
+    // Inputs of the same tuner share its device
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare(
+        "SELECT cardid, videodevice, inputname "
+        "FROM capturecard "
+        "WHERE sourceid = :SOURCEID AND "
+        "      cardid  <> :CARDID   AND "
+        "      cardtype = :CARDTYPE AND "
+        "      hostname = :HOSTNAME AND "
+        "      parentid = 0 "
+        "ORDER BY cardid");
+    query.bindValue(":SOURCEID", sourceid);
+    query.bindValue(":CARDID",   cardid);
+    query.bindValue(":CARDTYPE", card_type);
+    query.bindValue(":HOSTNAME", gCoreContext->GetHostName());
+
+    if (!query.exec())
+    {
+        MythDB::DBError("ChannelScanner::AddScanHelpers", query);
+        return;
+    }
+
+    while (query.next())
+    {
+        uint    inputid   = query.value(0).toUInt();
+        QString device    = query.value(1).toString();
+        QString inputname = query.value(2).toString();
+
+        if (devices.contains(device))
+            continue;
+
+        ChannelBase *helper_channel = create_channel(card_type, device);
+        if (!helper_channel)
+            continue;
+
+        helper_channel->SetInputID(inputid);
+
+        // Fails if the backend is using the tuner
+        if (!helper_channel->Open())
+        {
+            LOG(VB_CHANSCAN, LOG_INFO, LOC +
+                QString("Not scanning with input %1, %2 is in use")
+                .arg(inputid).arg(device));
+            delete helper_channel;
+            continue;
+        }
+
+        ChannelScanSM *helper = new ChannelScanSM(
+            scanMonitor, card_type, helper_channel, sourceid,
+            sigmonScanner->GetSignalTimeout(),
+            sigmonScanner->GetChannelTimeout(),
+            inputname, do_test_decryption);
+
+        DTVTunerType tuner_type = scan_tuner_type(scantype);
+        if (tuner_type != DTVTunerType::kTunerTypeUnknown)
+            helper->SetScanDTVTunerType(tuner_type);
+
+        devices.push_back(device);
+        helperChannels.push_back(helper_channel);
+        helperScanners.push_back(helper);
+    }
+
+    if (helperScanners.empty())
+        return;
+
+    LOG(VB_CHANSCAN, LOG_INFO, LOC +
+        QString("Scanning with %1 tuners: %2")
+        .arg(devices.size()).arg(devices.join(", ")));
+
+    scanGroup = new ChannelScanGroup();
+    sigmonScanner->SetScanGroup(scanGroup);
+    for (int i = 0; i < helperScanners.size(); ++i)
+        helperScanners[i]->SetScanGroup(scanGroup);
+}
+
+/**
+ *  \brief Stops sigmonScanner and the scanners helping it, and merges
+ *         the transports they found.
+ */
+ScanDTVTransportList ChannelScanner::StopScanners(void)
+{
+    sigmonScanner->StopScanner();
+    for (int i = 0; i < helperScanners.size(); ++i)
+        helperScanners[i]->StopScanner();
+
+    ScanDTVTransportList transports = sigmonScanner->GetChannelList();
+
+    for (int i = 0; i < helperScanners.size(); ++i)
+    {
+        ScanDTVTransportList list = helperScanners[i]->GetChannelList();
+        for (uint j = 0; j < list.size(); ++j)
+        {
+            // A transport found in the NIT may be scanned by two tuners
+            bool found = false;
+            for (uint k = 0; !found && k < transports.size(); ++k)
+            {
+                found = (transports[k].frequency == list[j].frequency &&
+                         transports[k].polarity  == list[j].polarity);
+            }
+            if (!found)
+                transports.push_back(list[j]);
+        }
+    }
+
+    return transports;
+}
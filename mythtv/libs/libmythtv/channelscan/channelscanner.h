@@ -47,6 +47,7 @@
 class ScanMonitor;
 class IPTVChannelFetcher;
 class ChannelScanSM;
+class ChannelScanGroup;
 class ChannelBase;
 
 // Not (yet?) implemented from old scanner
@@ -98,6 +99,10 @@ class MTV_PUBLIC ChannelScanner
         uint sourceid, bool do_ignore_signal_timeout,
         bool do_test_decryption);
 
+    void AddScanHelpers(int scantype, uint cardid, uint sourceid,
+                        bool do_test_decryption);
+    ScanDTVTransportList StopScanners(void);
+
     virtual void MonitorProgress(
         bool /*lock*/, bool /*strength*/, bool /*snr*/, bool /*rotor*/) { }
 
@@ -110,6 +115,10 @@ class MTV_PUBLIC ChannelScanner
 
     // Low level channel scanners
     ChannelScanSM      *sigmonScanner;
+    /// Scanners for the other free tuners on the video source
+    QList<ChannelScanSM*> helperScanners;
+    QList<ChannelBase*> helperChannels;
+    ChannelScanGroup   *scanGroup;
     IPTVChannelFetcher *iptvScanner;
 
     /// imported channels
@@ -62,10 +62,7 @@ void ChannelScannerCLI::HandleEvent(const ScannerEvent *scanEvent)
 
         ScanDTVTransportList transports;
         if (sigmonScanner)
-        {
-            sigmonScanner->StopScanner();
-            transports = sigmonScanner->GetChannelList();
-        }
+            transports = StopScanners();
 
         Teardown();
 
@@ -82,10 +82,7 @@ void ChannelScannerGUI::HandleEvent(const ScannerEvent *scanEvent)
     {
         ScanDTVTransportList transports;
         if (sigmonScanner)
-        {
-            sigmonScanner->StopScanner();
-            transports = sigmonScanner->GetChannelList();
-        }
+            transports = StopScanners();
 
 #ifdef USING_VBOX
         bool success = (iptvScanner != NULL || vboxScanner != NULL);
@@ -3405,6 +3405,17 @@ NULL
             return false;
     }
 
+    if (dbver == "1348")
+    {
+        const char *updates[] = {
+            "ALTER TABLE recordedfile "
+            "ADD COLUMN probe_snapshot MEDIUMBLOB NULL DEFAULT NULL;",
+            NULL
+        };
+        if (!performActualUpdate(updates, "1349", dbver))
+            return false;
+    }
+
     return true;
 }
 
@@ -18,6 +18,7 @@
 #include "mythconfig.h" // gives us HAVE_POSIX_FADVISE
 #include "mythtimer.h"
 #include "mythdate.h"
+#include "mythtrace.h"
 #include "compat.h"
 #include "mythcorecontext.h"
 
@@ -44,7 +45,7 @@ static int posix_fadvise(int, off_t, off_t, int) { return 0; }
 
 FileRingBuffer::FileRingBuffer(const QString &lfilename,
                                bool write, bool readahead, int timeout_ms)
-  : RingBuffer(kRingBuffer_File)
+  : RingBuffer(kRingBuffer_File), fadvisepos(0)
 {
     startreadahead = readahead;
     safefilename = lfilename;
@@ -181,6 +182,8 @@ static QString local_sub_filename(QFileInfo &fileInfo)
 
 bool FileRingBuffer::OpenFile(const QString &lfilename, uint retry_ms)
 {
+    MYTH_TRACE_SCOPE("FileRingBuffer::OpenFile", "ringbuffer");
+
     LOG(VB_PLAYBACK, LOG_INFO, LOC + QString("OpenFile(%1, %2 ms)")
             .arg(lfilename).arg(retry_ms));
 
@@ -553,6 +556,28 @@ int FileRingBuffer::safe_read(int /*fd*/, void *data, uint sz)
         if (tot < sz)
             usleep(60000);
     }
+
+    // Ask the OS to prefetch the window the read ahead controller expects
+    // to need next, once the previous window is half consumed.
+    if (tot > 0 && readaheadwindow > 0)
+    {
+        long long pos = internalreadpos + tot;
+        if (pos > fadvisepos || pos < fadvisepos - readaheadwindow)
+            fadvisepos = pos;
+        if (pos + readaheadwindow / 2 >= fadvisepos)
+        {
+#ifndef _MSC_VER
+            if (posix_fadvise(fd2, fadvisepos, readaheadwindow,
+                              POSIX_FADV_WILLNEED) < 0)
+            {
+                LOG(VB_FILE, LOG_DEBUG, LOC +
+                    "safe_read(): fadvise willneed failed: " + ENO);
+            }
+#endif
+            fadvisepos += readaheadwindow;
+        }
+    }
+
     return tot;
 }
 
@@ -39,4 +39,7 @@ class MTV_PUBLIC FileRingBuffer : public RingBuffer
     int safe_read(RemoteFile *rf, void *data, uint sz);
     virtual long long GetRealFileSizeInternal(void) const;
     virtual long long SeekInternal(long long pos, int whence);
+
+    /// End of the range last passed to posix_fadvise() by safe_read()
+    long long fadvisepos;
 };
@@ -730,12 +730,14 @@ using_backend {
     HEADERS += recorders/HLS/HLSPlaylistWorker.h
     HEADERS += recorders/HLS/HLSReader.h
     HEADERS += recorders/HLS/HLSSegment.h
+    HEADERS += recorders/HLS/HLSSegmentFetcher.h
     HEADERS += recorders/HLS/HLSStream.h
     HEADERS += recorders/HLS/HLSStreamWorker.h
 
     SOURCES += recorders/HLS/HLSPlaylistWorker.cpp
     SOURCES += recorders/HLS/HLSReader.cpp
     SOURCES += recorders/HLS/HLSSegment.cpp
+    SOURCES += recorders/HLS/HLSSegmentFetcher.cpp
     SOURCES += recorders/HLS/HLSStream.cpp
     SOURCES += recorders/HLS/HLSStreamWorker.cpp
 
@@ -818,6 +820,7 @@ using_backend {
     HEADERS += recorders/ExternalRecorder.h
     SOURCES += recorders/ExternalRecorder.cpp
     HEADERS += recorders/ExternalStreamHandler.h
+    HEADERS += recorders/ExternalRing.h
     SOURCES += recorders/ExternalStreamHandler.cpp
     HEADERS += recorders/ExternalSignalMonitor.h
     SOURCES += recorders/ExternalSignalMonitor.cpp
@@ -5,9 +5,182 @@
 #include "programinfo.h"
 #include "mythsocket.h"
 #include "cardutil.h"
+#include "mthreadpool.h"
+
+#include <QRunnable>
+#include <QWaitCondition>
 
 #define LOC QString("LiveTVChain(%1): ").arg(m_id)
 
+static void entry_to_stringlist(const LiveTVChainEntry &entry,
+                                QStringList &list)
+{
+    list << QString::number(entry.chanid);
+    list << entry.starttime.toString(Qt::ISODate);
+    list << entry.endtime.toString(Qt::ISODate);
+    list << QString::number(entry.discontinuity);
+    list << entry.hostprefix;
+    list << entry.inputtype;
+    list << entry.channum;
+    list << entry.inputname;
+}
+
+static bool entry_from_stringlist(const QStringList &list, int &idx,
+                                  LiveTVChainEntry &entry)
+{
+    if (idx + 8 > list.size())
+        return false;
+
+    bool ok, discont_ok;
+    entry.chanid = list[idx++].toUInt(&ok);
+    entry.starttime = QDateTime::fromString(list[idx++], Qt::ISODate);
+    entry.endtime = QDateTime::fromString(list[idx++], Qt::ISODate);
+    entry.discontinuity = list[idx++].toInt(&discont_ok);
+    entry.hostprefix = list[idx++];
+    entry.inputtype = list[idx++];
+    entry.channum = list[idx++];
+    entry.inputname = list[idx++];
+
+    return ok && discont_ok &&
+        entry.starttime.isValid() && entry.endtime.isValid();
+}
+
+/*
+  Changes to the tvchain table are written by a pool thread, in the
+  order they were made, so that a program switch doesn't wait on the
+  database.  The frontends are sent the changes directly.
+ */
+struct ChainWrite
+{
+    enum { kInsert, kEndTime, kDiscontinuity, kDelete, kDestroy } type;
+    QString          chainid;
+    int              chainpos;
+    LiveTVChainEntry entry;
+};
+
+static QMutex            s_chainWriteLock;
+static QWaitCondition    s_chainWriteWait;
+static QList<ChainWrite> s_chainWrites;
+static bool              s_chainWriterRunning = false;
+
+static void write_chain(const ChainWrite &write)
+{
+    MSqlQuery query(MSqlQuery::InitCon());
+
+    switch (write.type)
+    {
+        case ChainWrite::kInsert:
+            query.prepare(
+                "INSERT INTO tvchain (chanid, starttime, endtime, chainid,"
+                " chainpos, discontinuity, watching, hostprefix, cardtype, "
+                " channame, input) "
+                "VALUES(:CHANID, :START, :END, :CHAINID, :CHAINPOS, "
+                " :DISCONT, :WATCHING, :PREFIX, :INPUTTYPE, :CHANNAME, "
+                " :INPUT );");
+            query.bindValue(":CHANID", write.entry.chanid);
+            query.bindValue(":START", write.entry.starttime);
+            query.bindValue(":END", write.entry.endtime);
+            query.bindValue(":CHAINID", write.chainid);
+            query.bindValue(":CHAINPOS", write.chainpos);
+            query.bindValue(":DISCONT", write.entry.discontinuity);
+            query.bindValue(":WATCHING", 0);
+            query.bindValue(":PREFIX", write.entry.hostprefix);
+            query.bindValue(":INPUTTYPE", write.entry.inputtype);
+            query.bindValue(":CHANNAME", write.entry.channum);
+            query.bindValue(":INPUT", write.entry.inputname);
+            if (!query.exec() || !query.isActive())
+                MythDB::DBError("Chain: AppendNewProgram", query);
+            break;
+
+        case ChainWrite::kEndTime:
+            query.prepare("UPDATE tvchain SET endtime = :END "
+                          "WHERE chanid = :CHANID AND starttime = :START ;");
+            query.bindValue(":END", write.entry.endtime);
+            query.bindValue(":CHANID", write.entry.chanid);
+            query.bindValue(":START", write.entry.starttime);
+            if (!query.exec() || !query.isActive())
+                MythDB::DBError("Chain: FinishedRecording", query);
+            else
+                LOG(VB_RECORD, LOG_INFO,
+                    QString("Chain: Updated endtime for '%1_%2' to %3")
+                    .arg(write.entry.chanid)
+                    .arg(MythDate::toString(write.entry.starttime,
+                                            MythDate::kFilename))
+                    .arg(MythDate::toString(write.entry.endtime,
+                                            MythDate::kFilename)));
+            break;
+
+        case ChainWrite::kDiscontinuity:
+            query.prepare("UPDATE tvchain SET discontinuity = :DISCONT "
+                          "WHERE chanid = :CHANID AND starttime = :START "
+                          "AND chainid = :CHAINID ;");
+            query.bindValue(":CHANID", write.entry.chanid);
+            query.bindValue(":START", write.entry.starttime);
+            query.bindValue(":CHAINID", write.chainid);
+            query.bindValue(":DISCONT", true);
+            if (!query.exec())
+                MythDB::DBError("LiveTVChain::DeleteProgram -- "
+                                "discontinuity", query);
+            break;
+
+        case ChainWrite::kDelete:
+            query.prepare("DELETE FROM tvchain WHERE chanid = :CHANID "
+                          "AND starttime = :START AND chainid = :CHAINID ;");
+            query.bindValue(":CHANID", write.entry.chanid);
+            query.bindValue(":START", write.entry.starttime);
+            query.bindValue(":CHAINID", write.chainid);
+            if (!query.exec())
+                MythDB::DBError("LiveTVChain::DeleteProgram -- delete", query);
+            break;
+
+        case ChainWrite::kDestroy:
+            query.prepare("DELETE FROM tvchain WHERE chainid = :CHAINID ;");
+            query.bindValue(":CHAINID", write.chainid);
+            if (!query.exec())
+                MythDB::DBError("LiveTVChain::DestroyChain", query);
+            break;
+    }
+}
+
+class LiveTVChainWriter : public QRunnable
+{
+  public:
+    void run(void)
+    {
+        QMutexLocker locker(&s_chainWriteLock);
+        while (!s_chainWrites.empty())
+        {
+            ChainWrite write = s_chainWrites.front();
+            locker.unlock();
+            write_chain(write);
+            locker.relock();
+            // Only now, so wait_for_chain_writes() waits for this one
+            s_chainWrites.pop_front();
+        }
+        s_chainWriterRunning = false;
+        s_chainWriteWait.wakeAll();
+    }
+};
+
+static void queue_chain_write(const ChainWrite &write)
+{
+    QMutexLocker locker(&s_chainWriteLock);
+    s_chainWrites.push_back(write);
+    if (!s_chainWriterRunning)
+    {
+        s_chainWriterRunning = true;
+        MThreadPool::globalInstance()->start(
+            new LiveTVChainWriter(), "LiveTVChainWriter");
+    }
+}
+
+static void wait_for_chain_writes(void)
+{
+    QMutexLocker locker(&s_chainWriteLock);
+    while (s_chainWriterRunning)
+        s_chainWriteWait.wait(&s_chainWriteLock);
+}
+
 static inline void clear(LiveTVChainEntry &entry)
 {
     entry.chanid = 0;
@@ -75,59 +248,38 @@ void LiveTVChain::AppendNewProgram(ProgramInfo *pginfo, QString channum,
     newent.channum = channum;
     newent.inputname = inputname;
 
+    // The frontends only append it if it follows on from their last entry
+    QStringList data;
+    data << QString::number(m_maxpos + 1);
+    if (m_chain.empty())
+        data << "0" << QString();
+    else
+        data << QString::number(m_chain.back().chanid)
+             << m_chain.back().starttime.toString(Qt::ISODate);
+    entry_to_stringlist(newent, data);
+
     m_chain.append(newent);
 
-    MSqlQuery query(MSqlQuery::InitCon());
-    query.prepare("INSERT INTO tvchain (chanid, starttime, endtime, chainid,"
-                  " chainpos, discontinuity, watching, hostprefix, cardtype, "
-                  " channame, input) "
-                  "VALUES(:CHANID, :START, :END, :CHAINID, :CHAINPOS, "
-                  " :DISCONT, :WATCHING, :PREFIX, :INPUTTYPE, :CHANNAME, "
-                  " :INPUT );");
-    query.bindValue(":CHANID", pginfo->GetChanID());
-    query.bindValue(":START", pginfo->GetRecordingStartTime());
-    query.bindValue(":END", pginfo->GetRecordingEndTime());
-    query.bindValue(":CHAINID", m_id);
-    query.bindValue(":CHAINPOS", m_maxpos);
-    query.bindValue(":DISCONT", discont);
-    query.bindValue(":WATCHING", 0);
-    query.bindValue(":PREFIX", m_hostprefix);
-    query.bindValue(":INPUTTYPE", m_inputtype);
-    query.bindValue(":CHANNAME", channum);
-    query.bindValue(":INPUT", inputname);
-
-    if (!query.exec() || !query.isActive())
-        MythDB::DBError("Chain: AppendNewProgram", query);
-    else
-        LOG(VB_RECORD, LOG_INFO, QString("Chain: Appended@%3 '%1_%2'")
-            .arg(newent.chanid)
-            .arg(MythDate::toString(newent.starttime, MythDate::kFilename))
-            .arg(m_maxpos));
+    ChainWrite write;
+    write.type     = ChainWrite::kInsert;
+    write.chainid  = m_id;
+    write.chainpos = m_maxpos;
+    write.entry    = newent;
+    queue_chain_write(write);
+
+    LOG(VB_RECORD, LOG_INFO, QString("Chain: Appended@%3 '%1_%2'")
+        .arg(newent.chanid)
+        .arg(MythDate::toString(newent.starttime, MythDate::kFilename))
+        .arg(m_maxpos));
 
     m_maxpos++;
-    BroadcastUpdate();
+    BroadcastUpdate("APPEND", data);
 }
 
 void LiveTVChain::FinishedRecording(ProgramInfo *pginfo)
 {
     QMutexLocker lock(&m_lock);
 
-    MSqlQuery query(MSqlQuery::InitCon());
-    query.prepare("UPDATE tvchain SET endtime = :END "
-                  "WHERE chanid = :CHANID AND starttime = :START ;");
-    query.bindValue(":END", pginfo->GetRecordingEndTime());
-    query.bindValue(":CHANID", pginfo->GetChanID());
-    query.bindValue(":START", pginfo->GetRecordingStartTime());
-
-    if (!query.exec() || !query.isActive())
-        MythDB::DBError("Chain: FinishedRecording", query);
-    else
-        LOG(VB_RECORD, LOG_INFO,
-            QString("Chain: Updated endtime for '%1_%2' to %3")
-                .arg(pginfo->GetChanID())
-                .arg(pginfo->GetRecordingStartTime(MythDate::kFilename))
-                .arg(pginfo->GetRecordingEndTime(MythDate::kFilename)));
-
     QList<LiveTVChainEntry>::iterator it;
     for (it = m_chain.begin(); it != m_chain.end(); ++it)
     {
@@ -137,7 +289,21 @@ void LiveTVChain::FinishedRecording(ProgramInfo *pginfo)
             (*it).endtime = pginfo->GetRecordingEndTime();
         }
     }
-    BroadcastUpdate();
+
+    ChainWrite write;
+    write.type            = ChainWrite::kEndTime;
+    write.chainid         = m_id;
+    write.chainpos        = 0;
+    write.entry.chanid    = pginfo->GetChanID();
+    write.entry.starttime = pginfo->GetRecordingStartTime();
+    write.entry.endtime   = pginfo->GetRecordingEndTime();
+    queue_chain_write(write);
+
+    QStringList data;
+    data << QString::number(pginfo->GetChanID())
+         << pginfo->GetRecordingStartTime().toString(Qt::ISODate)
+         << pginfo->GetRecordingEndTime().toString(Qt::ISODate);
+    BroadcastUpdate("ENDTIME", data);
 }
 
 void LiveTVChain::DeleteProgram(ProgramInfo *pginfo)
@@ -153,42 +319,51 @@ void LiveTVChain::DeleteProgram(ProgramInfo *pginfo)
             del = it;
             ++it;
 
-            MSqlQuery query(MSqlQuery::InitCon());
+            ChainWrite write;
+            write.chainid  = m_id;
+            write.chainpos = 0;
+
             if (it != m_chain.end())
             {
                 (*it).discontinuity = true;
-                query.prepare("UPDATE tvchain SET discontinuity = :DISCONT "
-                              "WHERE chanid = :CHANID AND starttime = :START "
-                              "AND chainid = :CHAINID ;");
-                query.bindValue(":CHANID", (*it).chanid);
-                query.bindValue(":START", (*it).starttime);
-                query.bindValue(":CHAINID", m_id);
-                query.bindValue(":DISCONT", true);
-                if (!query.exec())
-                    MythDB::DBError("LiveTVChain::DeleteProgram -- "
-                                    "discontinuity", query);
+                write.type  = ChainWrite::kDiscontinuity;
+                write.entry = *it;
+                queue_chain_write(write);
             }
 
-            query.prepare("DELETE FROM tvchain WHERE chanid = :CHANID "
-                          "AND starttime = :START AND chainid = :CHAINID ;");
-            query.bindValue(":CHANID", (*del).chanid);
-            query.bindValue(":START", (*del).starttime);
-            query.bindValue(":CHAINID", m_id);
-            if (!query.exec())
-                MythDB::DBError("LiveTVChain::DeleteProgram -- delete", query);
+            write.type  = ChainWrite::kDelete;
+            write.entry = *del;
+            queue_chain_write(write);
+
+            QStringList data;
+            data << QString::number((*del).chanid)
+                 << (*del).starttime.toString(Qt::ISODate);
 
             m_chain.erase(del);
 
-            BroadcastUpdate();
+            BroadcastUpdate("DELETE", data);
             break;
         }
     }
 }
 
-void LiveTVChain::BroadcastUpdate(void)
+/**
+ *  \brief Waits until the changes to every chain have been written to the
+ *         database, for readers in other processes that only look there.
+ */
+void LiveTVChain::WaitForWrites(void)
+{
+    wait_for_chain_writes();
+}
+
+/**
+ *  \brief Sends the change to the chain to the frontends, which apply it
+ *         to their copy with ApplyUpdate().
+ */
+void LiveTVChain::BroadcastUpdate(const QString &kind, const QStringList &data)
 {
-    QString message = QString("LIVETV_CHAIN UPDATE %1").arg(m_id);
-    MythEvent me(message, entriesToStringList());
+    QString message = QString("LIVETV_CHAIN %1 %2").arg(kind).arg(m_id);
+    MythEvent me(message, data);
     gCoreContext->dispatch(me);
 }
 
@@ -198,12 +373,11 @@ void LiveTVChain::DestroyChain(void)
 
     m_chain.clear();
 
-    MSqlQuery query(MSqlQuery::InitCon());
-    query.prepare("DELETE FROM tvchain WHERE chainid = :CHAINID ;");
-    query.bindValue(":CHAINID", m_id);
-
-    if (!query.exec())
-        MythDB::DBError("LiveTVChain::DestroyChain", query);
+    ChainWrite write;
+    write.type     = ChainWrite::kDestroy;
+    write.chainid  = m_id;
+    write.chainpos = 0;
+    queue_chain_write(write);
 }
 
 void LiveTVChain::ReloadAll(const QStringList &data)
@@ -213,6 +387,9 @@ void LiveTVChain::ReloadAll(const QStringList &data)
     int prev_size = m_chain.size();
     if (data.isEmpty() || !entriesFromStringList(data))
     {
+        // Make sure our own changes have reached the database
+        wait_for_chain_writes();
+
         m_chain.clear();
 
         MSqlQuery query(MSqlQuery::InitCon());
@@ -245,6 +422,105 @@ void LiveTVChain::ReloadAll(const QStringList &data)
         }
     }
 
+    UpdatePositions(prev_size);
+}
+
+/**
+ *  \brief Applies a change sent by the backend's BroadcastUpdate().
+ *
+ *  "UPDATE" carries the whole chain, the others just the change.  If a
+ *  change doesn't follow on from our copy of the chain, because we
+ *  missed an earlier one, the chain is reloaded from the database.
+ */
+void LiveTVChain::ApplyUpdate(const QString &kind, const QStringList &data)
+{
+    QMutexLocker lock(&m_lock);
+
+    if (kind == "UPDATE")
+    {
+        ReloadAll(data);
+        return;
+    }
+
+    int prev_size = m_chain.size();
+    if (!ApplyDelta(kind, data))
+    {
+        LOG(VB_PLAYBACK, LOG_INFO, LOC +
+            QString("Unable to apply %1, reloading").arg(kind));
+        ReloadAll();
+        return;
+    }
+
+    UpdatePositions(prev_size);
+}
+
+bool LiveTVChain::ApplyDelta(const QString &kind, const QStringList &data)
+{
+    int idx = 0;
+
+    if (kind == "APPEND")
+    {
+        bool ok;
+        int maxpos = data.value(idx++).toInt(&ok);
+        uint prev_chanid = data.value(idx++).toUInt();
+        QDateTime prev_start =
+            QDateTime::fromString(data.value(idx++), Qt::ISODate);
+
+        LiveTVChainEntry entry;
+        if (!ok || !entry_from_stringlist(data, idx, entry))
+            return false;
+
+        if (ProgramIsAt(entry.chanid, entry.starttime) >= 0)
+            return true; // already have it
+
+        if (prev_chanid)
+        {
+            if (m_chain.empty() || m_chain.back().chanid != prev_chanid ||
+                m_chain.back().starttime != prev_start)
+                return false;
+        }
+        else if (!m_chain.empty())
+        {
+            return false;
+        }
+
+        m_chain.append(entry);
+        m_maxpos = maxpos;
+        return true;
+    }
+
+    uint chanid = data.value(idx++).toUInt();
+    QDateTime starttime =
+        QDateTime::fromString(data.value(idx++), Qt::ISODate);
+    if (!chanid || !starttime.isValid())
+        return false;
+    int pos = ProgramIsAt(chanid, starttime);
+
+    if (kind == "ENDTIME")
+    {
+        QDateTime endtime =
+            QDateTime::fromString(data.value(idx++), Qt::ISODate);
+        if (pos < 0 || !endtime.isValid())
+            return false;
+        m_chain[pos].endtime = endtime;
+        return true;
+    }
+
+    if (kind == "DELETE")
+    {
+        if (pos < 0)
+            return true; // already gone
+        if (pos + 1 < m_chain.size())
+            m_chain[pos + 1].discontinuity = true;
+        m_chain.removeAt(pos);
+        return true;
+    }
+
+    return false;
+}
+
+void LiveTVChain::UpdatePositions(int prev_size)
+{
     m_curpos = ProgramIsAt(m_cur_chanid, m_cur_startts);
     if (m_curpos < 0)
         m_curpos = 0;
@@ -255,14 +531,14 @@ void LiveTVChain::ReloadAll(const QStringList &data)
     if (prev_size > m_chain.size())
     {
         LOG(VB_PLAYBACK, LOG_INFO, LOC +
-            QString("ReloadAll(): Removed %1 recording(s)")
+            QString("Removed %1 recording(s)")
             .arg(prev_size - m_chain.size()));
         LOG(VB_PLAYBACK, LOG_INFO, LOC + toString());
     }
     else if (prev_size < m_chain.size())
     {
         LOG(VB_PLAYBACK, LOG_INFO, LOC +
-            QString("ReloadAll(): Added %1 recording(s)")
+            QString("Added %1 recording(s)")
             .arg(m_chain.size() - prev_size));
         LOG(VB_PLAYBACK, LOG_INFO, LOC + toString());
     }
@@ -750,16 +1026,7 @@ QStringList LiveTVChain::entriesToStringList() const
     QStringList ret;
     ret << QString::number(m_maxpos);
     for (int i = 0; i < m_chain.size(); i++)
-    {
-        ret << QString::number(m_chain[i].chanid);
-        ret << m_chain[i].starttime.toString(Qt::ISODate);
-        ret << m_chain[i].endtime.toString(Qt::ISODate);
-        ret << QString::number(m_chain[i].discontinuity);
-        ret << m_chain[i].hostprefix;
-        ret << m_chain[i].inputtype;
-        ret << m_chain[i].channum;
-        ret << m_chain[i].inputname;
-    }
+        entry_to_stringlist(m_chain[i], ret);
     return ret;
 }
 
@@ -775,30 +1042,7 @@ bool LiveTVChain::entriesFromStringList(const QStringList &items)
     while (ok && itemIdx < numItems)
     {
         LiveTVChainEntry entry;
-        if (ok && itemIdx < numItems)
-            entry.chanid = items[itemIdx++].toUInt(&ok);
-        if (ok && itemIdx < numItems)
-        {
-            entry.starttime =
-                QDateTime::fromString(items[itemIdx++], Qt::ISODate);
-            ok = entry.starttime.isValid();
-        }
-        if (ok && itemIdx < numItems)
-        {
-            entry.endtime =
-                QDateTime::fromString(items[itemIdx++], Qt::ISODate);
-            ok = entry.endtime.isValid();
-        }
-        if (ok && itemIdx < numItems)
-            entry.discontinuity = items[itemIdx++].toInt(&ok);
-        if (ok && itemIdx < numItems)
-            entry.hostprefix = items[itemIdx++];
-        if (ok && itemIdx < numItems)
-            entry.inputtype = items[itemIdx++];
-        if (ok && itemIdx < numItems)
-            entry.channum = items[itemIdx++];
-        if (ok && itemIdx < numItems)
-            entry.inputname = items[itemIdx++];
+        ok = entry_from_stringlist(items, itemIdx, entry);
         if (ok)
             chain.append(entry);
     }
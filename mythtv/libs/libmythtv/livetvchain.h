@@ -45,8 +45,10 @@ class MTV_PUBLIC LiveTVChain : public ReferenceCounter
                           QString inputname, bool discont);
     void FinishedRecording(ProgramInfo *pginfo);
     void DeleteProgram(ProgramInfo *pginfo);
+    static void WaitForWrites(void);
 
     void ReloadAll(const QStringList &data = QStringList());
+    void ApplyUpdate(const QString &kind, const QStringList &data);
 
     // const gets
     QString GetID(void)  const { return m_id; }
@@ -96,7 +98,9 @@ class MTV_PUBLIC LiveTVChain : public ReferenceCounter
     bool entriesFromStringList(const QStringList &items);
 
   private:
-    void BroadcastUpdate();
+    void BroadcastUpdate(const QString &kind, const QStringList &data);
+    bool ApplyDelta(const QString &kind, const QStringList &data);
+    void UpdatePositions(int prev_size);
     void GetEntryAt(int at, LiveTVChainEntry &entry) const;
     static ProgramInfo *EntryToProgram(const LiveTVChainEntry &entry);
     ProgramInfo *DoGetNextProgram(bool up, int curpos, int &newid,
@@ -258,6 +258,20 @@ bool DVBStreamData::HandleTables(uint pid, const PSIPTable &psip)
             _sdt_status.SetSectionSeen(tsid, psip.Version(), psip.Section(),
                                         psip.LastSection());
 
+            if (tsid == _desired_tsid)
+            {
+                // Keep the section describing the desired service
+                ServiceDescriptionTable sdt(psip);
+                for (uint i = 0; i < sdt.ServiceCount(); ++i)
+                {
+                    if (sdt.ServiceID(i) == (uint)_desired_program)
+                    {
+                        SavePSI(pid, psip);
+                        break;
+                    }
+                }
+            }
+
             if (_cache_tables)
             {
                 ServiceDescriptionTable *sdt =
@@ -839,6 +853,14 @@ bool DVBStreamData::DeleteCachedTable(PSIPTable *psip) const
     return true;
 }
 
+void DVBStreamData::ClearTableVersion(const PSIPTable &psip)
+{
+    if (TableID::SDT == psip.TableID())
+        SetVersionSDT(psip.TableIDExtension(), -1, 0);
+    else
+        MPEGStreamData::ClearTableVersion(psip);
+}
+
 void DVBStreamData::CacheNIT(NetworkInformationTable *nit)
 {
     QMutexLocker locker(&_cache_lock);
@@ -111,6 +111,7 @@ class MTV_PUBLIC DVBStreamData : virtual public MPEGStreamData
     void CacheSDT(ServiceDescriptionTable*);
   protected:
     virtual bool DeleteCachedTable(PSIPTable *psip) const;
+    virtual void ClearTableVersion(const PSIPTable &psip);
 
   private:
     /// DVB table monitoring
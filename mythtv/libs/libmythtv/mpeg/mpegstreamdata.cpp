@@ -22,6 +22,14 @@ using namespace std;
 //#define DEBUG_MPEG_RADIO // uncomment to strip video streams from TS stream
 #define LOC QString("MPEGStream[%1](0x%2): ").arg(_cardid).arg((intptr_t)this, QT_POINTER_SIZE, 16)
 
+/// Table ID to the PID and contents of the last good section seen
+typedef QMap<uint, QPair<uint, QByteArray> > psi_sections_t;
+typedef QPair<uint, uint>                     psi_key_t; // mplexid, program
+
+static QMutex                             s_psi_lock;
+static QMap<psi_key_t, psi_sections_t>    s_psi_cache;
+static const int                          kPSICacheMax = 1024;
+
 /** \class MPEGStreamData
  *  \brief Encapsulates data about MPEG stream and emits events for each table.
  */
@@ -49,6 +57,7 @@ MPEGStreamData::MPEGStreamData(int desiredProgram, int cardnum,
       _listening_disabled(false),
       _encryption_lock(QMutex::Recursive), _listener_lock(QMutex::Recursive),
       _cache_tables(cacheTables), _cache_lock(QMutex::Recursive),
+      _psi_mplexid(0),
       // Single program stuff
       _desired_program(desiredProgram),
       _recording_type("all"),
@@ -175,6 +184,10 @@ void MPEGStreamData::Reset(int desiredProgram)
 
     _pmt_status.clear();
 
+    // Set again by ApplyCachedPSI() once the program is known
+    _psi_mplexid = 0;
+    _psi_unverified.clear();
+
     {
         QMutexLocker locker(&_cache_lock);
 
@@ -693,6 +706,9 @@ bool MPEGStreamData::IsRedundant(uint pid, const PSIPTable &psip) const
  */
 bool MPEGStreamData::HandleTables(uint pid, const PSIPTable &psip)
 {
+    if (!_psi_unverified.empty())
+        VerifyCachedPSI(psip);
+
     if (IsRedundant(pid, psip))
         return true;
 
@@ -710,6 +726,9 @@ bool MPEGStreamData::HandleTables(uint pid, const PSIPTable &psip)
             if (_cache_tables)
                 CachePAT(&pat);
 
+            if (_desired_program >= 0 && pat.FindPID(_desired_program))
+                SavePSI(pid, pat);
+
             ProcessPAT(&pat);
 
             return true;
@@ -738,6 +757,9 @@ bool MPEGStreamData::HandleTables(uint pid, const PSIPTable &psip)
             if (_cache_tables)
                 CachePMT(&pmt);
 
+            if ((int)prog_num == _desired_program && !pmt.LastSection())
+                SavePSI(pid, pmt);
+
             ProcessPMT(&pmt);
 
             return true;
@@ -971,9 +993,6 @@ void MPEGStreamData::HandleTSTables(const TSPacket* tspacket)
 
 int MPEGStreamData::ProcessData(const unsigned char *buffer, int len)
 {
-    int pos = 0;
-    bool resync = false;
-
     if (!_ps_listeners.empty())
     {
 
@@ -983,6 +1002,27 @@ int MPEGStreamData::ProcessData(const unsigned char *buffer, int len)
         return 0;
     }
 
+    // Let the writers hold on to the packets until the end of the buffer
+    _listener_lock.lock();
+    ts_listener_vec_t writers = _ts_writing_listeners;
+    _listener_lock.unlock();
+
+    for (uint j = 0; j < writers.size(); ++j)
+        writers[j]->BeginTSPacketBatch(buffer, len);
+
+    int remainder = ProcessTSPackets(buffer, len);
+
+    for (uint j = 0; j < writers.size(); ++j)
+        writers[j]->EndTSPacketBatch();
+
+    return remainder;
+}
+
+int MPEGStreamData::ProcessTSPackets(const unsigned char *buffer, int len)
+{
+    int pos = 0;
+    bool resync = false;
+
     while (pos + int(TSPacket::kSize) <= len)
     { // while we have a whole packet left...
         if (buffer[pos] != SYNC_BYTE || resync)
@@ -1607,6 +1647,107 @@ void MPEGStreamData::CachePMT(const ProgramMapTable *_pmt)
     _cached_pmts[key] = pmt;
 }
 
+/** \brief Processes the tables last seen for the desired program on
+ *         the multiplex, as though they had just been received.
+ *
+ *  This lets the signal monitor and recorder start without waiting for
+ *  the PAT and PMT (and SDT on DVB) to come around.  The tables on air
+ *  are still checked, see VerifyCachedPSI().  Must be called after the
+ *  desired program is set, and before any packets are processed.
+ *
+ *  \param mplexid The multiplex tuned, or 0 to stop caching tables
+ */
+void MPEGStreamData::ApplyCachedPSI(uint mplexid)
+{
+    _psi_mplexid = mplexid;
+    _psi_unverified.clear();
+
+    if (!_psi_mplexid || _desired_program < 0)
+        return;
+
+    psi_sections_t sections;
+    {
+        QMutexLocker locker(&s_psi_lock);
+        sections = s_psi_cache.value(
+            psi_key_t(_psi_mplexid, _desired_program));
+    }
+
+    if (sections.empty())
+        return;
+
+    LOG(VB_RECORD, LOG_INFO, LOC +
+        QString("Using %1 cached tables for program %2 on multiplex %3")
+        .arg(sections.size()).arg(_desired_program).arg(_psi_mplexid));
+
+    // In table ID order, so the PAT is processed before the PMT
+    psi_sections_t::const_iterator it = sections.begin();
+    for (; it != sections.end(); ++it)
+    {
+        PSIPTable psip((const unsigned char*)(*it).second.constData());
+        if (!psip.IsGood())
+            continue;
+
+        HandleTables((*it).first, psip);
+        _psi_unverified[it.key()] = (*it).second;
+    }
+}
+
+/// Keeps a copy of a table the desired program needs for the next tune
+void MPEGStreamData::SavePSI(uint pid, const PSIPTable &psip)
+{
+    if (!_psi_mplexid || _desired_program < 0)
+        return;
+
+    psi_key_t key(_psi_mplexid, _desired_program);
+    QByteArray section((const char*)psip.pesdata(), psip.SectionLength());
+
+    QMutexLocker locker(&s_psi_lock);
+
+    if (!s_psi_cache.contains(key) && s_psi_cache.size() >= kPSICacheMax)
+        s_psi_cache.erase(s_psi_cache.begin());
+
+    s_psi_cache[key][psip.TableID()] = qMakePair(pid, section);
+}
+
+/** \brief Compares the first section seen on air with the one applied
+ *         from the cache.
+ *
+ *  If they differ, but have the same version, the table on air would
+ *  be dropped as redundant, so its version is cleared to have it
+ *  processed.  Listeners such as the recorder then see the new table
+ *  just as they would after a version change.
+ */
+void MPEGStreamData::VerifyCachedPSI(const PSIPTable &psip)
+{
+    QMap<uint, QByteArray>::iterator it = _psi_unverified.find(psip.TableID());
+    if (it == _psi_unverified.end())
+        return;
+
+    PSIPTable cached((const unsigned char*)(*it).constData());
+    if (cached.TableIDExtension() != psip.TableIDExtension() ||
+        cached.Section() != psip.Section())
+        return;
+
+    if (cached.CRC() != psip.CRC())
+    {
+        LOG(VB_RECORD, LOG_INFO, LOC +
+            QString("Cached table 0x%1 differs from the one on air")
+            .arg(psip.TableID(), 0, 16));
+        ClearTableVersion(psip);
+    }
+
+    _psi_unverified.erase(it);
+}
+
+/// Forgets the version of a table, so the next section seen is processed
+void MPEGStreamData::ClearTableVersion(const PSIPTable &psip)
+{
+    if (TableID::PAT == psip.TableID())
+        SetVersionPAT(psip.TableIDExtension(), -1, 0);
+    else if (TableID::PMT == psip.TableID())
+        SetVersionPMT(psip.TableIDExtension(), -1, 0);
+}
+
 void MPEGStreamData::AddMPEGListener(MPEGStreamListener *val)
 {
     QMutexLocker locker(&_listener_lock);
@@ -12,6 +12,7 @@ using namespace std;
 
 // Qt
 #include <QMap>
+#include <QByteArray>
 
 #include "tspacket.h"
 #include "mythtimer.h"
@@ -216,6 +217,9 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
     virtual void ReturnCachedPMTTables(pmt_vec_t&) const;
     virtual void ReturnCachedPMTTables(pmt_map_t&) const;
 
+    // Tables kept across channel changes
+    void ApplyCachedPSI(uint mplexid);
+
     // Encryption Monitoring
     void AddEncryptionTestPID(uint pnum, uint pid, bool isvideo);
     void RemoveEncryptionTestPIDs(uint pnum);
@@ -301,6 +305,7 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
     void ProcessPMT(const ProgramMapTable *pmt);
     void ProcessEncryptedPacket(const TSPacket&);
 
+    int ProcessTSPackets(const unsigned char *buffer, int len);
     static int ResyncStream(const unsigned char *buffer, int curr_pos, int len);
 
     void UpdateTimeOffset(uint64_t si_utc_time);
@@ -312,6 +317,11 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
     void CacheCAT(const ConditionalAccessTable *pat);
     void CachePMT(const ProgramMapTable *pmt);
 
+    // Tables kept across channel changes
+    void SavePSI(uint pid, const PSIPTable &psip);
+    void VerifyCachedPSI(const PSIPTable &psip);
+    virtual void ClearTableVersion(const PSIPTable &psip);
+
   protected:
     int                       _cardid;
     QString                   _sistandard;
@@ -366,6 +376,12 @@ class MTV_PUBLIC MPEGStreamData : public EITSource
     mutable psip_refcnt_map_t        _cached_ref_cnt;
     mutable psip_refcnt_map_t        _cached_slated_for_deletion;
 
+    // Tables kept across channel changes
+    uint                      _psi_mplexid;
+    /// Sections applied from the cache that haven't been seen on air yet,
+    /// by table ID
+    QMap<uint, QByteArray>    _psi_unverified;
+
     // Single program variables
     int                       _desired_program;
     QString                   _recording_type;
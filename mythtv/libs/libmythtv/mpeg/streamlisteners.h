@@ -64,6 +64,12 @@ class TSPacketListener
   public:
     virtual bool ProcessTSPacket(const TSPacket& tspacket) = 0;
 
+    /// Called before MPEGStreamData::ProcessData() passes on the packets
+    /// in buffer.  They stay valid until EndTSPacketBatch() is called.
+    virtual void BeginTSPacketBatch(const unsigned char * /*buffer*/,
+                                    int /*len*/) {}
+    virtual void EndTSPacketBatch(void) {}
+
   protected:
     virtual ~TSPacketListener() { }
 };
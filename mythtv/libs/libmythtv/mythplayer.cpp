@@ -43,6 +43,7 @@ using namespace std;
 #include "interactivetv.h"
 #include "mythsystemevent.h"
 #include "mythlogging.h"
+#include "mythtrace.h"
 #include "mythmiscutil.h"
 #include "icringbuffer.h"
 #include "audiooutput.h"
@@ -479,6 +480,8 @@ bool MythPlayer::IsPlaying(uint wait_in_msec, bool wait_for) const
 
 bool MythPlayer::InitVideo(void)
 {
+    MYTH_TRACE_SCOPE("MythPlayer::InitVideo", "mythplayer");
+
     if (!player_ctx)
         return false;
 
@@ -889,6 +892,8 @@ void MythPlayer::CreateDecoder(char *testbuf, int testreadsize)
 
 int MythPlayer::OpenFile(uint retries)
 {
+    MYTH_TRACE_SCOPE("MythPlayer::OpenFile", "mythplayer");
+
     // Disable hardware acceleration for second PBP
     if (player_ctx && (player_ctx->IsPBP() && !player_ctx->IsPrimaryPBP()) &&
         FlagIsSet(kDecodeAllowGPU))
@@ -1965,6 +1970,8 @@ void MythPlayer::AVSync(VideoFrame *buffer, bool limit_delay)
         //currentaudiotime = AVSyncGetAudiotime();
         LOG(VB_PLAYBACK | VB_TIMESTAMP, LOG_INFO, LOC + "AVSync show");
         videoOutput->Show(ps);
+        if (!framesPlayed)
+            MYTH_TRACE_INSTANT("First frame displayed", "mythplayer");
 
         if (videoOutput->IsErrored())
         {
@@ -2627,6 +2634,8 @@ void MythPlayer::SwitchToProgram(void)
     if (!IsReallyNearEnd())
         return;
 
+    MYTH_TRACE_SCOPE("MythPlayer::SwitchToProgram", "mythplayer");
+
     LOG(VB_PLAYBACK, LOG_INFO, LOC + "SwitchToProgram - start");
     bool discontinuity = false, newtype = false;
     int newid = -1;
@@ -2761,6 +2770,8 @@ void MythPlayer::FileChangedCallback(void)
 
 void MythPlayer::JumpToProgram(void)
 {
+    MYTH_TRACE_SCOPE("MythPlayer::JumpToProgram", "mythplayer");
+
     LOG(VB_PLAYBACK, LOG_INFO, LOC + "JumpToProgram - start");
     bool discontinuity = false, newtype = false;
     int newid = -1;
@@ -2891,6 +2902,8 @@ void MythPlayer::JumpToProgram(void)
 
 bool MythPlayer::StartPlaying(void)
 {
+    MYTH_TRACE_SCOPE("MythPlayer::StartPlaying", "mythplayer");
+
     if (OpenFile() < 0)
     {
         LOG(VB_GENERAL, LOG_ERR, LOC + "Unable to open video file.");
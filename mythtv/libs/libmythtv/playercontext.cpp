@@ -16,6 +16,7 @@
 #include "videometadatautil.h"
 #include "metadataimagehelper.h"
 #include "mythlogging.h"
+#include "mythtrace.h"
 #include "DVD/mythdvdplayer.h"
 #include "Bluray/mythbdplayer.h"
 #include "channelutil.h"
@@ -376,6 +377,8 @@ bool PlayerContext::CreatePlayer(TV *tv, QWidget *widget,
                                  bool embed, const QRect &embedbounds,
                                  bool muted)
 {
+    MYTH_TRACE_SCOPE("PlayerContext::CreatePlayer", "tv_play");
+
     if (HasPlayer())
     {
         LOG(VB_GENERAL, LOG_ERR, LOC +
@@ -493,12 +496,13 @@ void PlayerContext::StopPlaying(void)
         player->StopPlaying();
 }
 
-void PlayerContext::UpdateTVChain(const QStringList &data)
+void PlayerContext::UpdateTVChain(const QStringList &data,
+                                  const QString &kind)
 {
     QMutexLocker locker(&deletePlayerLock);
     if (tvchain && player)
     {
-        tvchain->ReloadAll(data);
+        tvchain->ApplyUpdate(kind, data);
         player->CheckTVChain();
     }
 }
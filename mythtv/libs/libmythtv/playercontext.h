@@ -60,7 +60,8 @@ class MTV_PUBLIC PlayerContext
     void TeardownPlayer(void);
     bool StartPlaying(int maxWait = -1);
     void StopPlaying(void);
-    void UpdateTVChain(const QStringList &data = QStringList());
+    void UpdateTVChain(const QStringList &data = QStringList(),
+                       const QString &kind = "UPDATE");
     bool ReloadTVChain(void);
     void CreatePIPWindow(const QRect&, int pos = -1, 
                         QWidget *widget = NULL);
@@ -12,6 +12,11 @@ using namespace std;
 #ifndef _WIN32
 #include <sys/poll.h>
 #endif
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#endif
 
 /// Set this to 1 to report on statistics
 #define REPORT_RING_STATS 0
@@ -22,6 +27,7 @@ DeviceReadBuffer::DeviceReadBuffer(
     DeviceReaderCB *cb, bool use_poll, bool error_exit_on_poll_timeout)
     : MThread("DeviceReadBuffer"),
       videodevice(""),              _stream_fd(-1),
+      wake_eventfd(false),
       readerCB(cb),
 
       // Data for managing the device ringbuffer
@@ -38,11 +44,14 @@ DeviceReadBuffer::DeviceReadBuffer(
 
       buffer(NULL),                 readPtr(NULL),
       writePtr(NULL),               endPtr(NULL),
+      mirrored(false),              peekBuffer(NULL),
+      peekBufferSize(0),
 
       // statistics
       max_used(0),                  avg_used(0),
       avg_buf_write_cnt(0),         avg_buf_read_cnt(0),
-      avg_buf_sleep_cnt(0)
+      avg_buf_sleep_cnt(0),         dev_read_cnt(0),
+      dev_read_bytes(0)
 {
     for (int i = 0; i < 2; i++)
     {
@@ -64,11 +73,7 @@ DeviceReadBuffer::DeviceReadBuffer(
 DeviceReadBuffer::~DeviceReadBuffer()
 {
     Stop();
-    if (buffer)
-    {
-        delete[] buffer;
-        buffer = NULL;
-    }
+    FreeBuffer();
 }
 
 bool DeviceReadBuffer::Setup(const QString &streamName, int streamfd,
@@ -77,8 +82,7 @@ bool DeviceReadBuffer::Setup(const QString &streamName, int streamfd,
 {
     QMutexLocker locker(&lock);
 
-    if (buffer)
-        delete[] buffer;
+    FreeBuffer();
 
     videodevice   = streamName;
     videodevice   = (videodevice == QString::null) ? "" : videodevice;
@@ -100,20 +104,18 @@ bool DeviceReadBuffer::Setup(const QString &streamName, int streamfd,
         min(dev_read_size, (size_t)deviceBufferSize) : dev_read_size;
     readThreshold = read_quanta * 128;
 
-    buffer        = new (nothrow) unsigned char[size + dev_read_size];
-    readPtr       = buffer;
-    writePtr      = buffer;
-    endPtr        = buffer + size;
-
     // Initialize buffer, if it exists
-    if (!buffer)
+    if (!AllocateBuffer())
     {
         LOG(VB_GENERAL, LOG_ERR, LOC +
             QString("Failed to allocate buffer of size %1 = %2 + %3")
                 .arg(size+dev_read_size).arg(size).arg(dev_read_size));
         return false;
     }
-    memset(buffer, 0xFF, size + read_quanta);
+    readPtr       = buffer;
+    writePtr      = buffer;
+    endPtr        = buffer + size;
+    memset(buffer, 0xFF, mirrored ? size : size + read_quanta);
 
     // Initialize statistics
     max_used      = 0;
@@ -121,13 +123,82 @@ bool DeviceReadBuffer::Setup(const QString &streamName, int streamfd,
     avg_buf_write_cnt = 0;
     avg_buf_read_cnt  = 0;
     avg_buf_sleep_cnt = 0;
+    dev_read_cnt      = 0;
+    dev_read_bytes    = 0;
     lastReport.start();
 
-    LOG(VB_RECORD, LOG_INFO, LOC + QString("buffer size %1 KB").arg(size/1024));
+    LOG(VB_RECORD, LOG_INFO, LOC + QString("buffer size %1 KB%2")
+        .arg(size/1024).arg(mirrored ? ", mirrored" : ""));
 
     return true;
 }
 
+/** \fn DeviceReadBuffer::AllocateBuffer(void)
+ *  \brief Allocates the ring buffer.
+ *
+ *  On Linux the ring is a memfd mapped twice, back to back, so bytes
+ *  written past endPtr land at the start of the ring and a span starting
+ *  anywhere in the ring is contiguous for up to size bytes.  This rounds
+ *  size up to a whole number of pages.  Otherwise the ring is followed
+ *  by dev_read_size bytes of slack, which run() copies back to the start.
+ */
+bool DeviceReadBuffer::AllocateBuffer(void)
+{
+#if defined(__linux__) && defined(__NR_memfd_create)
+    size_t page = sysconf(_SC_PAGESIZE);
+    size_t len  = (size + page - 1) / page * page;
+
+    int fd = syscall(__NR_memfd_create, "devicereadbuffer", 0);
+    if (fd >= 0 && ftruncate(fd, len) == 0)
+    {
+        unsigned char *addr = reinterpret_cast<unsigned char*>(
+            mmap(NULL, 2 * len, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS,
+                 -1, 0));
+        if (addr != MAP_FAILED)
+        {
+            void *first  = mmap(addr, len, PROT_READ | PROT_WRITE,
+                                MAP_SHARED | MAP_FIXED, fd, 0);
+            void *second = mmap(addr + len, len, PROT_READ | PROT_WRITE,
+                                MAP_SHARED | MAP_FIXED, fd, 0);
+            if (first == addr && second == addr + len)
+            {
+                close(fd);
+                buffer   = addr;
+                size     = len;
+                mirrored = true;
+                return true;
+            }
+            munmap(addr, 2 * len);
+        }
+    }
+    if (fd >= 0)
+        close(fd);
+
+    LOG(VB_RECORD, LOG_INFO, LOC + "Unable to mirror the buffer" + ENO);
+#endif
+
+    buffer   = new (nothrow) unsigned char[size + dev_read_size];
+    mirrored = false;
+    return buffer;
+}
+
+void DeviceReadBuffer::FreeBuffer(void)
+{
+#ifdef __linux__
+    if (mirrored && buffer)
+        munmap(buffer, 2 * size);
+    else
+#endif
+        delete[] buffer;
+
+    buffer   = NULL;
+    mirrored = false;
+
+    delete[] peekBuffer;
+    peekBuffer     = NULL;
+    peekBufferSize = 0;
+}
+
 void DeviceReadBuffer::Start(void)
 {
     LOG(VB_RECORD, LOG_INFO, LOC + "Start() -- begin");
@@ -205,12 +276,13 @@ void DeviceReadBuffer::SetPaused(bool val)
 // The WakePoll code is copied from MythSocketThread::WakeReadyReadThread()
 void DeviceReadBuffer::WakePoll(void) const
 {
-    char buf[1];
-    buf[0] = '0';
+    // An eventfd needs an 8 byte count, a pipe any byte will do
+    uint64_t buf = 1;
+    size_t   buflen = wake_eventfd ? sizeof(buf) : 1;
     ssize_t wret = 0;
     while (isRunning() && (wret <= 0) && (wake_pipe[1] >= 0))
     {
-        wret = ::write(wake_pipe[1], &buf, 1);
+        wret = ::write(wake_pipe[1], &buf, buflen);
         if ((wret < 0) && (EAGAIN != errno) && (EINTR != errno))
         {
             LOG(VB_GENERAL, LOG_ERR, LOC + "WakePoll failed.");
@@ -226,7 +298,9 @@ void DeviceReadBuffer::ClosePipes(void) const
     {
         if (wake_pipe[i] >= 0)
         {
-            ::close(wake_pipe[i]);
+            // Both ends are the same eventfd, close it once
+            if (i == 0 || !wake_eventfd)
+                ::close(wake_pipe[i]);
             wake_pipe[i] = -1;
             wake_pipe_flags[i] = 0;
         }
@@ -320,10 +394,11 @@ void DeviceReadBuffer::IncrReadPointer(uint len)
     QMutexLocker locker(&lock);
     used    -= len;
     readPtr += len;
-    readPtr  = (readPtr == endPtr) ? buffer : readPtr;
+    readPtr  = (readPtr >= endPtr) ? buffer + (readPtr - endPtr) : readPtr;
 #if REPORT_RING_STATS
     ++avg_buf_read_cnt;
 #endif
+    spaceWait.wakeAll();
 }
 
 void DeviceReadBuffer::run(void)
@@ -343,7 +418,19 @@ void DeviceReadBuffer::run(void)
     lock.unlock();
 
     if (using_poll)
-        setup_pipe(wake_pipe, wake_pipe_flags);
+    {
+#ifdef __linux__
+        int efd = eventfd(0, EFD_NONBLOCK);
+        wake_eventfd = (efd >= 0);
+        if (wake_eventfd)
+        {
+            wake_pipe[0] = wake_pipe[1] = efd;
+            wake_pipe_flags[0] = wake_pipe_flags[1] = O_NONBLOCK;
+        }
+        else
+#endif
+            setup_pipe(wake_pipe, wake_pipe_flags);
+    }
 
     while (dorun)
     {
@@ -386,11 +473,15 @@ void DeviceReadBuffer::run(void)
                 errcnt = 0;
 
                 // if we wrote past the official end of the buffer,
-                // copy to start
-                if (writePtr + len > endPtr)
+                // copy to start, unless the mirror has done that for us
+                if (!mirrored && writePtr + len > endPtr)
                     memcpy(buffer, endPtr, writePtr + len - endPtr);
                 IncrWritePointer(len);
                 total += len;
+#if REPORT_RING_STATS
+                ++dev_read_cnt;
+                dev_read_bytes += len;
+#endif
             }
         }
         if (errcnt > 5)
@@ -402,6 +493,7 @@ void DeviceReadBuffer::run(void)
     }
 
     ClosePipes();
+    wake_eventfd = false;
 
     lock.lock();
     eof     = true;
@@ -680,26 +772,81 @@ uint DeviceReadBuffer::Read(unsigned char *buf, const uint count)
     return cnt;
 }
 
+/** \fn DeviceReadBuffer::Peek(unsigned char*&, uint)
+ *  \brief Returns up to count buffered bytes without copying them.
+ *
+ *  The bytes stay in the buffer until they are released with Consume(),
+ *  so any that can't be used yet can be left there and will be at the
+ *  start of the next Peek().  If the buffer isn't mirrored and the bytes
+ *  wrap around the end of the ring, they are copied to keep them
+ *  contiguous.
+ *
+ *  \param buf    Set to the start of the bytes
+ *  \param count  Maximum number of bytes wanted
+ *  \return number of bytes at buf
+ */
+uint DeviceReadBuffer::Peek(unsigned char *&buf, uint count)
+{
+    uint avail = WaitForUsed(min(count, (uint)readThreshold), 20);
+    size_t cnt = min(count, avail);
+
+    buf = readPtr;
+    if (!cnt || mirrored || readPtr + cnt <= endPtr)
+        return cnt;
+
+    if (peekBufferSize < cnt)
+    {
+        delete[] peekBuffer;
+        peekBufferSize = max(cnt, (size_t)count);
+        peekBuffer = new unsigned char[peekBufferSize];
+    }
+
+    size_t len = endPtr - readPtr;
+    memcpy(peekBuffer, readPtr, len);
+    memcpy(peekBuffer + len, buffer, cnt - len);
+    buf = peekBuffer;
+
+    return cnt;
+}
+
+/** \fn DeviceReadBuffer::Consume(uint)
+ *  \brief Releases count bytes returned by Peek() back to the buffer.
+ */
+void DeviceReadBuffer::Consume(uint count)
+{
+    // The buffer may have been Reset() since the Peek()
+    count = min(count, GetUsed());
+    if (!count)
+        return;
+
+    IncrReadPointer(count);
+
+#if REPORT_RING_STATS
+    ReportStats();
+#endif
+}
+
 /** \fn DeviceReadBuffer::WaitForUnused(uint) const
  *  \param needed Number of bytes we want to write
  *  \return bytes available for writing
  */
 uint DeviceReadBuffer::WaitForUnused(uint needed) const
 {
-    size_t unused = GetUnused();
+    QMutexLocker locker(&lock);
+    size_t unused = size - used;
 
     if (unused > read_quanta)
     {
         while (unused < needed)
         {
-            unused = GetUnused();
-            if (IsPauseRequested() || !IsOpen() || !dorun)
+            if (request_pause || !IsOpen() || !dorun)
                 return 0;
-            usleep(5000);
+            // Woken by IncrReadPointer() as soon as there is room
+            spaceWait.wait(locker.mutex(), 5);
+            unused = size - used;
         }
-        if (IsPauseRequested() || !IsOpen() || !dorun)
+        if (request_pause || !IsOpen() || !dorun)
             return 0;
-        unused = GetUnused();
     }
 
     return unused;
@@ -740,12 +887,17 @@ void DeviceReadBuffer::ReportStats(void)
         msg         += QString("fill max(%1%) ").arg(max_used*rsize,5,'f',2);
         msg         += QString("writes/sec(%1) ").arg(avg_buf_write_cnt*d1_s);
         msg         += QString("reads/sec(%1) ").arg(avg_buf_read_cnt*d1_s);
-        msg         += QString("sleeps/sec(%1)").arg(avg_buf_sleep_cnt*d1_s);
+        msg         += QString("sleeps/sec(%1) ").arg(avg_buf_sleep_cnt*d1_s);
+        msg         += QString("device read avg(%1 KB)")
+            .arg(dev_read_cnt ? dev_read_bytes / dev_read_cnt / 1024.0 : 0.0,
+                 0, 'f', 1);
 
         avg_used    = 0;
         avg_buf_write_cnt = 0;
         avg_buf_read_cnt = 0;
         avg_buf_sleep_cnt = 0;
+        dev_read_cnt = 0;
+        dev_read_bytes = 0;
         max_used    = 0;
         lastReport.start();
 
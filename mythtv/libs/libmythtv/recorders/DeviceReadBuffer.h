@@ -29,6 +29,9 @@ class DeviceReaderCB
  *  This allows us to read the device regularly even in the presence
  *  of long blocking conditions on writing to disk or accessing the
  *  database.
+ *
+ *  Where possible the ring is mapped twice, back to back, so that both
+ *  device reads and Peek() always see the data as one contiguous span.
  */
 class DeviceReadBuffer : protected MThread
 {
@@ -58,6 +61,8 @@ class DeviceReadBuffer : protected MThread
     bool IsRunning(void) const;
 
     uint Read(unsigned char *buf, uint count);
+    uint Peek(unsigned char *&buf, uint count);
+    void Consume(uint count);
     uint GetUsed(void) const;
 
   private:
@@ -79,6 +84,9 @@ class DeviceReadBuffer : protected MThread
     uint GetUnused(void) const;
     uint GetContiguousUnused(void) const;
 
+    bool AllocateBuffer(void);
+    void FreeBuffer(void);
+
     bool CheckForErrors(ssize_t read_len, size_t requested_len, uint &err_cnt);
     void ReportStats(void);
 
@@ -86,6 +94,7 @@ class DeviceReadBuffer : protected MThread
     int              _stream_fd;
     mutable int      wake_pipe[2];
     mutable long     wake_pipe_flags[2];
+    bool             wake_eventfd;
 
     DeviceReaderCB  *readerCB;
 
@@ -110,8 +119,12 @@ class DeviceReadBuffer : protected MThread
     unsigned char   *readPtr;
     unsigned char   *writePtr;
     unsigned char   *endPtr;
+    bool             mirrored;      ///< buffer is mapped twice, see Setup()
+    unsigned char   *peekBuffer;    ///< Peek() copies here if not mirrored
+    size_t           peekBufferSize;
 
     mutable QWaitCondition dataWait;
+    mutable QWaitCondition spaceWait;
     QWaitCondition   runWait;
     QWaitCondition   pauseWait;
     QWaitCondition   unpauseWait;
@@ -122,6 +135,8 @@ class DeviceReadBuffer : protected MThread
     size_t           avg_buf_write_cnt;
     size_t           avg_buf_read_cnt;
     size_t           avg_buf_sleep_cnt;
+    size_t           dev_read_cnt;
+    size_t           dev_read_bytes;
     MythTimer        lastReport;
 };
 
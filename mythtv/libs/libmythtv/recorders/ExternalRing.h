@@ -0,0 +1,40 @@
+// -*- Mode: c++ -*-
+
+#ifndef _External_Ring_H_
+#define _External_Ring_H_
+
+#include <stdint.h>
+
+/*
+  Shared memory transport
+
+  Before the external app is started, a memfd holding an ExternRing and
+  two eventfds are created, and the app is started with them as fds 3, 4
+  and 5.  After the capabilities are gathered, the app is sent
+  "SharedMemory:3:4:5:<size>".  An app that doesn't understand it
+  replies with an error and the TS stays on stdout.  An app that replies
+  "OK" writes the TS into the ring instead:
+
+   - The data ring of 'size' bytes starts kExternRingData bytes into the
+     memfd.  Byte N of the stream is at offset (N % size) in the ring.
+   - The app copies the data in, then publishes it by storing the new
+     write_pos (release), then adds 1 to the data eventfd (fd 4).
+   - We store read_pos (release) after consuming data, then add 1 to the
+     space eventfd (fd 5).  When the ring is full, the app waits on fd 5
+     rather than overwriting, incrementing writer_waits each time.
+ */
+struct ExternRing
+{
+    uint32_t          magic;        ///< kExternRingMagic
+    uint32_t          version;      ///< kExternRingVersion
+    uint64_t          size;         ///< Size of the data ring in bytes
+    volatile uint64_t write_pos;    ///< Bytes written by the app
+    volatile uint64_t read_pos;     ///< Bytes read by us
+    volatile uint64_t writer_waits; ///< Times the app found the ring full
+};
+
+static const uint32_t kExternRingMagic   = 0x4d544852; // "MTHR"
+static const uint32_t kExternRingVersion = 1;
+static const uint32_t kExternRingData    = 4096;
+
+#endif // _External_Ring_H_
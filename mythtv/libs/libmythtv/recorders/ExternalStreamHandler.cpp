@@ -11,6 +11,11 @@
 #ifdef ANDROID
 #include <sys/wait.h>
 #endif
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#endif
 
 // Qt headers
 #include <QString>
@@ -34,8 +39,10 @@ ExternIO::ExternIO(const QString & app,
     : m_appin(-1), m_appout(-1), m_apperr(-1),
       m_pid(-1), m_bufsize(0), m_buffer(NULL),
       m_status(&m_status_buf, QIODevice::ReadWrite),
-      m_errcnt(0)
-
+      m_errcnt(0),
+      m_ringfd(-1), m_datafd(-1), m_spacefd(-1),
+      m_ring(NULL), m_ringdata(NULL), m_ring_active(false),
+      m_ring_bytes(0), m_ring_reads(0), m_ring_maxfill(0)
 {
     m_app  = (app);
 
@@ -71,6 +78,17 @@ ExternIO::~ExternIO(void)
     close(m_appout);
     close(m_apperr);
 
+    if (m_ring_active)
+    {
+        LOG(VB_RECORD, LOG_INFO,
+            QString("ExternIO: Read %1 MB from shared memory in %2 reads, "
+                    "max fill %3%, app waited for space %4 times")
+            .arg(m_ring_bytes >> 20).arg(m_ring_reads)
+            .arg(m_ring_maxfill * 100 / m_ring->size)
+            .arg(m_ring->writer_waits));
+    }
+    DestroyRing();
+
     // waitpid(m_pid, &status, 0);
     delete[] m_buffer;
 }
@@ -118,6 +136,9 @@ int ExternIO::Read(QByteArray & buffer, int maxlen, int timeout)
         return 0;
     }
 
+    if (m_ring_active)
+        return ReadRing(buffer, maxlen, timeout);
+
     if (!Ready(m_appout, timeout, "data"))
         return 0;
 
@@ -166,6 +187,175 @@ int ExternIO::Read(QByteArray & buffer, int maxlen, int timeout)
     return len;
 }
 
+/**
+ *  \brief Appends up to maxlen bytes from the shared memory ring to
+ *         buffer, waiting up to timeout msecs for the app to write some.
+ */
+int ExternIO::ReadRing(QByteArray & buffer, int maxlen, int timeout)
+{
+#ifdef __linux__
+    uint64_t write_pos = __atomic_load_n(&m_ring->write_pos, __ATOMIC_ACQUIRE);
+    uint64_t read_pos  = m_ring->read_pos;
+
+    if (write_pos == read_pos)
+    {
+        // Wait for the app, or for it to exit
+        struct pollfd fds[2];
+        memset(fds, 0, sizeof(fds));
+        fds[0].fd = m_datafd;
+        fds[0].events = POLLIN;
+        fds[1].fd = m_appout;
+        fds[1].events = POLLIN;
+
+        if (poll(fds, 2, timeout) <= 0)
+            return 0;
+
+        if (fds[1].revents & POLLHUP)
+        {
+            m_error = "data poll eof (POLLHUP)";
+            return 0;
+        }
+
+        uint64_t count;
+        if (read(m_datafd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+        {
+            m_error = "Failed to read data eventfd: " + ENO;
+            return 0;
+        }
+
+        write_pos = __atomic_load_n(&m_ring->write_pos, __ATOMIC_ACQUIRE);
+        if (write_pos == read_pos)
+            return 0;
+    }
+
+    uint64_t avail = write_pos - read_pos;
+    if (avail > m_ring->size)
+    {
+        m_error = QString("Shared memory ring is corrupt, %1 bytes available "
+                          "in a %2 byte ring").arg(avail).arg(m_ring->size);
+        LOG(VB_RECORD, LOG_ERR, "ExternIO: " + m_error);
+        return 0;
+    }
+    m_ring_maxfill = max(m_ring_maxfill, avail);
+
+    int len = min(avail, (uint64_t)maxlen);
+    uint offset = read_pos % m_ring->size;
+    uint first  = min((uint64_t)len, m_ring->size - offset);
+
+    buffer.append(m_ringdata + offset, first);
+    if (first < (uint)len)
+        buffer.append(m_ringdata, len - first);
+
+    __atomic_store_n(&m_ring->read_pos, read_pos + len, __ATOMIC_RELEASE);
+
+    uint64_t one = 1;
+    if (write(m_spacefd, &one, sizeof(one)) < 0 && errno != EAGAIN)
+        LOG(VB_RECORD, LOG_WARNING,
+            "ExternIO: Failed to write space eventfd: " + ENO);
+
+    m_ring_bytes += len;
+    ++m_ring_reads;
+
+    LOG(VB_RECORD, LOG_DEBUG,
+        QString("ExternIO::ReadRing '%1' bytes, buffer size %2")
+        .arg(len).arg(buffer.size()));
+
+    return len;
+#else
+    Q_UNUSED(buffer);
+    Q_UNUSED(maxlen);
+    Q_UNUSED(timeout);
+    return 0;
+#endif // __linux__
+}
+
+/**
+ *  \brief Creates the memfd holding the ring and the eventfds used to
+ *         signal it, to be passed to the app.
+ */
+bool ExternIO::CreateRing(void)
+{
+#if defined(__linux__) && defined(__NR_memfd_create)
+    size_t mapsize = kExternRingData + kRingSize;
+
+    m_ringfd  = syscall(__NR_memfd_create, "mythexternring", 0);
+    m_datafd  = eventfd(0, EFD_NONBLOCK);
+    m_spacefd = eventfd(0, EFD_NONBLOCK);
+
+    if (m_ringfd < 0 || m_datafd < 0 || m_spacefd < 0 ||
+        ftruncate(m_ringfd, mapsize) < 0)
+    {
+        LOG(VB_RECORD, LOG_INFO,
+            "ExternIO: Shared memory not available: " + ENO);
+        DestroyRing();
+        return false;
+    }
+
+    void *map = mmap(NULL, mapsize, PROT_READ | PROT_WRITE, MAP_SHARED,
+                     m_ringfd, 0);
+    if (map == MAP_FAILED)
+    {
+        LOG(VB_RECORD, LOG_INFO,
+            "ExternIO: Failed to map shared memory: " + ENO);
+        DestroyRing();
+        return false;
+    }
+
+    m_ring = reinterpret_cast<ExternRing*>(map);
+    m_ringdata = reinterpret_cast<char*>(map) + kExternRingData;
+
+    memset(m_ring, 0, sizeof(*m_ring));
+    m_ring->magic   = kExternRingMagic;
+    m_ring->version = kExternRingVersion;
+    m_ring->size    = kRingSize;
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+void ExternIO::DestroyRing(void)
+{
+#ifdef __linux__
+    if (m_ring)
+        munmap(m_ring, kExternRingData + kRingSize);
+    if (m_ringfd >= 0)
+        close(m_ringfd);
+    if (m_datafd >= 0)
+        close(m_datafd);
+    if (m_spacefd >= 0)
+        close(m_spacefd);
+#endif
+
+    m_ring = NULL;
+    m_ringdata = NULL;
+    m_ringfd = m_datafd = m_spacefd = -1;
+    m_ring_active = false;
+}
+
+/**
+ *  \return The command offering the app the shared memory ring, or an
+ *          empty string if there isn't one.
+ */
+QString ExternIO::SharedMemoryCommand(void) const
+{
+    if (!m_ring)
+        return QString();
+
+    // The app has them as fds 3, 4 and 5, see Fork()
+    return QString("SharedMemory:3:4:5:%1").arg(kRingSize);
+}
+
+/// Read from the ring if the app accepted it, otherwise release it.
+void ExternIO::UseSharedMemory(bool use)
+{
+    if (use && m_ring)
+        m_ring_active = true;
+    else
+        DestroyRing();
+}
+
 QString ExternIO::GetStatus(int timeout)
 {
     if (Error())
@@ -323,6 +513,8 @@ void ExternIO::Fork(void)
 
     LOG(VB_RECORD, LOG_INFO, QString("ExternIO::Fork '%1'").arg(full_command));
 
+    CreateRing();
+
     int in[2]  = {-1, -1};
     int out[2] = {-1, -1};
     int err[2] = {-1, -1};
@@ -362,6 +554,12 @@ void ExternIO::Fork(void)
         close(in[0]);
         close(out[1]);
         close(err[1]);
+        // Only the app needs the memfd now that it is mapped
+        if (m_ringfd >= 0)
+        {
+            close(m_ringfd);
+            m_ringfd = -1;
+        }
         m_appin  = in[1];
         m_appout = out[0];
         m_apperr = err[0];
@@ -403,8 +601,25 @@ void ExternIO::Fork(void)
         _exit(GENERIC_EXIT_PIPE_FAILURE);
     }
 
-    /* Close all open file descriptors except stdin/stdout/stderr */
-    for (int i = sysconf(_SC_OPEN_MAX) - 1; i > 2; --i)
+    /* Pass the shared memory ring as fds 3, 4 and 5.  Move them out of
+     * the way first, in case they are already numbered 3 to 5. */
+    int lastfd = 2;
+    if (m_ring)
+    {
+        int ringfd  = fcntl(m_ringfd,  F_DUPFD, 10);
+        int datafd  = fcntl(m_datafd,  F_DUPFD, 10);
+        int spacefd = fcntl(m_spacefd, F_DUPFD, 10);
+        if (ringfd >= 0 && datafd >= 0 && spacefd >= 0 &&
+            dup2(ringfd, 3) >= 0 && dup2(datafd, 4) >= 0 &&
+            dup2(spacefd, 5) >= 0)
+        {
+            lastfd = 5;
+        }
+    }
+
+    /* Close all open file descriptors except stdin/stdout/stderr
+     * and the shared memory ring */
+    for (int i = sysconf(_SC_OPEN_MAX) - 1; i > lastfd; --i)
         close(i);
 
     /* Set the process group id to be the same as the pid of this
@@ -813,14 +1028,21 @@ bool ExternalStreamHandler::OpenApp(void)
     m_poll_mode = ProcessCommand("FlowControl?", 2500, result) &&
                   result.startsWith("OK:Poll");
 
+    /* Have the TS written to shared memory, if the app supports it */
+    QString shm_cmd = m_IO->SharedMemoryCommand();
+    m_IO->UseSharedMemory(!shm_cmd.isEmpty() &&
+                          ProcessCommand(shm_cmd, 2500, result));
+
     LOG(VB_RECORD, LOG_INFO, LOC + "App opened successfully");
     LOG(VB_RECORD, LOG_INFO, LOC +
         QString("Capabilities: tuner(%1) "
                 "Picture attributes(%2) "
-                "Flow control(%3)")
+                "Flow control(%3) "
+                "Transport(%4)")
         .arg(m_hasTuner ? "yes" : "no")
         .arg(m_hasPictureAttributes ? "yes" : "no")
         .arg(m_poll_mode ? "Polling" : "XON/XOFF")
+        .arg(m_IO->UsingSharedMemory() ? "shared memory" : "pipe")
         );
 
     /* Let the external app know how many bytes will read without blocking */
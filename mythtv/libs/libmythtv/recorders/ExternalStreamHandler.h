@@ -13,13 +13,14 @@ using namespace std;
 #include <stdint.h>
 
 #include "streamhandler.h"
+#include "ExternalRing.h"
 
 class DTVSignalMonitor;
 class ExternalChannel;
 
 class ExternIO
 {
-    enum constants { kMaxErrorCnt = 5 };
+    enum constants { kMaxErrorCnt = 5, kRingSize = 188 * 65536 };
 
   public:
     ExternIO(const QString & app, const QStringList & args);
@@ -35,10 +36,18 @@ class ExternIO
     QString ErrorString(void) const { return m_error; }
     void ClearError(void) { m_error.clear(); }
 
+    QString SharedMemoryCommand(void) const;
+    void UseSharedMemory(bool use);
+    bool UsingSharedMemory(void) const { return m_ring_active; }
+
   private:
     bool KillIfRunning(const QString & cmd);
     void Fork(void);
 
+    bool CreateRing(void);
+    void DestroyRing(void);
+    int  ReadRing(QByteArray & buffer, int maxlen, int timeout);
+
     QFileInfo   m_app;
     QStringList m_args;
     int     m_appin;
@@ -53,6 +62,17 @@ class ExternIO
     QString     m_status_buf;
     QTextStream m_status;
     int         m_errcnt;
+
+    // Shared memory transport
+    int         m_ringfd;
+    int         m_datafd;
+    int         m_spacefd;
+    ExternRing *m_ring;
+    char       *m_ringdata;
+    bool        m_ring_active;
+    uint64_t    m_ring_bytes;
+    uint64_t    m_ring_reads;
+    uint64_t    m_ring_maxfill;
 };
 
 // Note : This class always uses a TS reader.
@@ -1,6 +1,7 @@
-#include <sys/time.h>
 #include <unistd.h>
 
+#include <algorithm>
+
 #include "HLSReader.h"
 #include "HLS/m3u.h"
 
@@ -19,20 +20,14 @@ static QUrl RelativeURI (const QString& baseString, const QString& uriString)
     return base.resolved(uri);
 }
 
-static uint64_t MDate(void)
-{
-    timeval  t;
-    gettimeofday(&t, NULL);
-    return t.tv_sec * 1000000ULL + t.tv_usec;
-}
-
 HLSReader::HLSReader(void)
     : m_curstream(NULL), m_cur_seq(-1), m_bitrate_index(0),
       m_fatal(false), m_cancel(false),
       m_throttle(true), m_aesmsg(false),
       m_playlistworker(NULL), m_streamworker(NULL),
       m_playlist_size(0), m_bandwidthcheck(false), m_prebuffer_cnt(10),
-      m_debug(false), m_debug_cnt(0), m_slow_cnt(0)
+      m_debug(false), m_debug_cnt(0), m_slow_cnt(0),
+      m_last_delivery(0), m_early_bytes(0), m_throughput(0)
 {
 }
 
@@ -643,11 +638,14 @@ bool HLSReader::LoadMetaPlaylists(MythSingleDownload& downloader)
     {
         int buffered = PercentBuffered();
 
-        if (buffered < 15)
+        if (buffered < 15 || (buffered < 50 && !StreamFits(m_curstream)))
         {
             // It is taking too long to download the segments
             LOG(VB_RECORD, LOG_WARNING, LOC +
-                QString("Falling behind: only %1% buffered").arg(buffered));
+                QString("Falling behind: only %1% buffered, "
+                        "throughput %2kb/s for bitrate %3kb/s")
+                .arg(buffered).arg(m_throughput / 1000)
+                .arg(m_curstream->Bitrate() / 1000));
             LOG(VB_RECORD, LOG_DEBUG, LOC +
                 QString("playlist size %1, queued %2")
                 .arg(m_playlist_size).arg(m_segments.size()));
@@ -657,6 +655,7 @@ bool HLSReader::LoadMetaPlaylists(MythSingleDownload& downloader)
         }
         else if (buffered > 85)
         {
+            // Only switches to a stream that the throughput can sustain
             // Keeping up easily, raise the bitrate.
             LOG(VB_RECORD, LOG_DEBUG, LOC +
                 QString("Plenty of bandwidth, downloading %1 of %2")
@@ -699,20 +698,30 @@ void HLSReader::DecreaseBitrate(int progid)
     HLSRecStream *hls = NULL;
     uint64_t bitrate = m_curstream->Bitrate();
     uint64_t candidate = 0;
+    bool     candidate_fits = false;
     StreamContainer::const_iterator Istream;
 
+    // Pick the highest lower bitrate the measured throughput can
+    // sustain, or the lowest bitrate if none of them fit.
     for (Istream = m_streams.begin(); Istream != m_streams.end(); ++Istream)
     {
         if ((*Istream)->Id() != progid)
             continue;
-        if (bitrate > (*Istream)->Bitrate() &&
-            candidate < (*Istream)->Bitrate())
+        if (bitrate <= (*Istream)->Bitrate())
+            continue;
+
+        uint64_t rate = (*Istream)->Bitrate();
+        bool     fits = StreamFits(*Istream);
+        if (hls == NULL ||
+            (fits && (!candidate_fits || rate > candidate)) ||
+            (!fits && !candidate_fits && rate < candidate))
         {
             LOG(VB_RECORD, LOG_DEBUG, LOC +
                 QString("candidate stream '%1' bitrate %2 >= %3")
                 .arg(Istream.key()).arg(bitrate).arg((*Istream)->Bitrate()));
             hls = *Istream;
-            candidate = hls->Bitrate();
+            candidate = rate;
+            candidate_fits = fits;
         }
     }
 
@@ -742,7 +751,8 @@ void HLSReader::IncreaseBitrate(int progid)
         if ((*Istream)->Id() != progid)
             continue;
         if (bitrate < (*Istream)->Bitrate() &&
-            candidate > (*Istream)->Bitrate())
+            candidate > (*Istream)->Bitrate() &&
+            StreamFits(*Istream))
         {
             LOG(VB_RECORD, LOG_DEBUG, LOC +
                 QString("candidate stream '%1' bitrate %2 >= %3")
@@ -762,11 +772,43 @@ void HLSReader::IncreaseBitrate(int progid)
     else
     {
         LOG(VB_RECORD, LOG_DEBUG, LOC +
-            QString("Already at highest bitrate %1").arg(bitrate));
+            QString("Already at highest bitrate %1 for throughput %2")
+            .arg(bitrate).arg(m_throughput));
     }
 }
 
-bool HLSReader::LoadSegments(MythSingleDownload& downloader)
+/**
+ * Can the throughput measured over all the segment fetchers sustain
+ * the bitrate of hls, with 20% to spare?
+ *
+ * \note m_stream_lock must be held
+ */
+bool HLSReader::StreamFits(const HLSRecStream* hls) const
+{
+    if (m_throughput == 0)
+        return true;   // nothing measured yet
+    return hls->Bitrate() * 5 <= m_throughput * 4;
+}
+
+/// Abort the downloads still in progress and forget about them
+static void DiscardFetches(QList<HLSSegmentFetcher*>& inflight)
+{
+    QList<HLSSegmentFetcher*>::iterator Ifetch;
+    for (Ifetch = inflight.begin(); Ifetch != inflight.end(); ++Ifetch)
+        (*Ifetch)->Discard();
+    inflight.clear();
+}
+
+/**
+ * Download the queued segments into the stream buffer, in order.
+ *
+ * The segments following the current one are downloaded at the same
+ * time, one by each of the fetchers, so that the round trip to the
+ * server doesn't limit how fast the segments arrive.  Only one segment
+ * is downloaded at a time while throttled.
+ */
+bool HLSReader::LoadSegments(MythSingleDownload& downloader,
+                             QVector<HLSSegmentFetcher*>& fetchers)
 {
     LOG(VB_RECORD, LOG_DEBUG, LOC + "LoadSegment -- start");
 
@@ -780,31 +822,63 @@ bool HLSReader::LoadSegments(MythSingleDownload& downloader)
     HLSRecStream *hls;
     HLSRecSegment seg;
     long          throttle;
+    QList<HLSSegmentFetcher*> inflight;   // in sequence order
     for (;;)
     {
+        int window = m_throttle ? 1 : fetchers.size();
+
         m_seq_lock.lock();
-        if (m_cancel || m_segments.empty())
+        if (m_cancel || (m_segments.empty() && inflight.empty()))
+        {
+            m_seq_lock.unlock();
+            break;
+        }
+
+        // Give the idle fetchers the segments after those in flight
+        int64_t last = inflight.empty() ? -1 :
+                       inflight.back()->Segment().Sequence();
+        SegmentContainer::const_iterator Iseg = m_segments.begin();
+        for ( ; Iseg != m_segments.end() && inflight.size() < window; ++Iseg)
+        {
+            if (!inflight.empty() && (*Iseg).Sequence() <= last)
+                continue;
+
+            for (int idx = 0; idx < fetchers.size(); ++idx)
+            {
+                if (!inflight.contains(fetchers[idx]))
+                {
+                    fetchers[idx]->Fetch(*Iseg);
+                    inflight.push_back(fetchers[idx]);
+                    break;
+                }
+            }
+        }
+
+        if (inflight.empty())
         {
             m_seq_lock.unlock();
             break;
         }
 
-        seg = m_segments.front();
+        seg = inflight.front()->Segment();
         if (m_segments.size() > m_playlist_size)
         {
             LOG(VB_RECORD, (m_debug ? LOG_INFO : LOG_DEBUG), LOC +
-                QString("Downloading segment %1 (1 of %2) with %3 behind")
+                QString("Downloading segment %1 (1 of %2) with %3 behind, "
+                        "%4 in flight")
                 .arg(seg.Sequence())
                 .arg(m_segments.size() + m_playlist_size)
-                .arg(m_segments.size() - m_playlist_size));
+                .arg(m_segments.size() - m_playlist_size)
+                .arg(inflight.size()));
         }
         else
         {
             LOG(VB_RECORD, (m_debug ? LOG_INFO : LOG_DEBUG), LOC +
-                QString("Downloading segment %1 (%2 of %3)")
+                QString("Downloading segment %1 (%2 of %3), %4 in flight")
                 .arg(seg.Sequence())
                 .arg(m_playlist_size - m_segments.size() + 1)
-                .arg(m_playlist_size));
+                .arg(m_playlist_size)
+                .arg(inflight.size()));
         }
         m_seq_lock.unlock();
 
@@ -814,15 +888,20 @@ bool HLSReader::LoadSegments(MythSingleDownload& downloader)
         if (!hls)
         {
             LOG(VB_RECORD, LOG_DEBUG, LOC + "LoadSegment -- no current stream");
+            DiscardFetches(inflight);
             return false;
         }
 
-        throttle = DownloadSegmentData(downloader, hls,
-                                       seg, m_playlist_size);
+        HLSSegmentFetcher *fetcher = inflight.takeFirst();
+        throttle = DownloadSegmentData(downloader, hls, seg, *fetcher,
+                                       m_playlist_size);
 
-        m_seq_lock.lock();
         if (throttle < 0)
         {
+            // The segments after it are fetched again on the retry
+            DiscardFetches(inflight);
+
+            m_seq_lock.lock();
             if (m_segments.size() > m_playlist_size)
             {
                 SegmentContainer::iterator Iseg = m_segments.begin() +
@@ -832,12 +911,13 @@ bool HLSReader::LoadSegments(MythSingleDownload& downloader)
             m_seq_lock.unlock();
             return false;
         }
-        else
-        {
-            m_cur_seq = m_segments.front().Sequence();
-            m_segments.pop_front();
-        }
 
+        m_seq_lock.lock();
+        // The playlist worker may have skipped it while it was downloading
+        if (!m_segments.empty() &&
+            m_segments.front().Sequence() == seg.Sequence())
+            m_segments.pop_front();
+        m_cur_seq = seg.Sequence();
         m_seq_lock.unlock();
 
         if (m_throttle && throttle == 0)
@@ -868,6 +948,8 @@ bool HLSReader::LoadSegments(MythSingleDownload& downloader)
             --m_prebuffer_cnt;
     }
 
+    DiscardFetches(inflight);
+
     LOG(VB_RECORD, LOG_DEBUG, LOC + "LoadSegment -- end");
     return true;
 }
@@ -882,7 +964,9 @@ uint HLSReader::PercentBuffered(void) const
 
 int HLSReader::DownloadSegmentData(MythSingleDownload& downloader,
                                    HLSRecStream* hls,
-                                   HLSRecSegment& segment, int playlist_size)
+                                   HLSRecSegment& segment,
+                                   HLSSegmentFetcher& fetcher,
+                                   int playlist_size)
 {
     uint64_t bandwidth = hls->AverageBandwidth();
     int estimated_time = 0;
@@ -909,36 +993,17 @@ int HLSReader::DownloadSegmentData(MythSingleDownload& downloader,
     }
 
     QByteArray buffer;
-    uint64_t   start = MDate();
+    qint64     started;
+    qint64     finished;
 
-#ifdef HLS_USE_MYTHDOWNLOADMANAGER // MythDownloadManager leaks memory
-                                   // and can only handle six download at a time
-    if (!HLSReader::DownloadURL(segment.Url(), &buffer))
+    if (!fetcher.WaitForSegment(buffer, started, finished))
     {
         LOG(VB_RECORD, LOG_ERR, LOC +
             QString("%1 failed").arg(segment.Sequence()));
-        if (estimated_time * 2 < segment.Duration())
-        {
-            if (!HLSReader::DownloadURL(segment.Url(), &buffer))
-            {
-                LOG(VB_RECORD, LOG_ERR, LOC + QString("%1 failed")
-                    .arg(segment.Sequence()));
-                return -1;
-            }
-        }
-        else
-            return 0;
-    }
-#else
-    if (!downloader.DownloadURL(segment.Url(), &buffer))
-    {
-        LOG(VB_RECORD, LOG_ERR, LOC + QString("%1 failed: %2")
-            .arg(segment.Sequence()).arg(downloader.ErrorString()));
         return -1;
     }
-#endif
 
-    uint64_t downloadduration = (MDate() - start) / 1000;
+    uint64_t downloadduration = finished - started;
 
 #ifdef USING_LIBCRYPTO
     /* If the segment is encrypted, decode it */
@@ -964,6 +1029,7 @@ int HLSReader::DownloadSegmentData(MythSingleDownload& downloader,
         {
             m_slow_cnt = 15;
             m_fatal = true;
+            m_buflock.unlock();
             return -1;
         }
     }
@@ -999,6 +1065,28 @@ int HLSReader::DownloadSegmentData(MythSingleDownload& downloader,
                             ((static_cast<double>(segment_len) /
                               static_cast<double>(segment.Duration()))));
 
+    /*
+     * The throughput of all the fetchers together.  Segments download at
+     * the same time, so only count the time since the previous one
+     * arrived.  A segment that arrived before the one ahead of it is
+     * counted with the next one to arrive after it.
+     */
+    qint64 since = std::max(started, m_last_delivery);
+    if (finished > since)
+    {
+        uint64_t throughput =
+            (m_early_bytes + segment_len) * 8 * 1000ULL / (finished - since);
+        m_early_bytes = 0;
+        m_last_delivery = finished;
+
+        m_stream_lock.lock();
+        m_throughput = m_throughput ?
+                       (m_throughput * 3 + throughput) / 4 : throughput;
+        m_stream_lock.unlock();
+    }
+    else
+        m_early_bytes += segment_len;
+
     LOG(VB_RECORD, (m_debug ? LOG_INFO : LOG_DEBUG), LOC +
         QString("%1 took %3ms for %4 bytes: "
                 "bandwidth:%5kiB/s")
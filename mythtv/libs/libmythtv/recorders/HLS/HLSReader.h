@@ -28,6 +28,7 @@
 #include "HLSSegment.h"
 #include "HLSStream.h"
 #include "HLSStreamWorker.h"
+#include "HLSSegmentFetcher.h"
 #include "HLSPlaylistWorker.h"
 
 
@@ -70,7 +71,8 @@ class MTV_PUBLIC  HLSReader
 
   protected:
     void Cancel(bool quiet = false);
-    bool LoadSegments(MythSingleDownload& downloader);
+    bool LoadSegments(MythSingleDownload& downloader,
+                      QVector<HLSSegmentFetcher*>& fetchers);
     uint PercentBuffered(void) const;
     int  TargetDuration(void) const
     { return (m_curstream ? m_curstream->TargetDuration() : 0); }
@@ -89,7 +91,9 @@ class MTV_PUBLIC  HLSReader
     // Downloading
     bool LoadSegments(HLSRecStream & hlsstream);
     int DownloadSegmentData(MythSingleDownload& downloader, HLSRecStream* hls,
-			    HLSRecSegment& segment, int playlist_size);
+			    HLSRecSegment& segment, HLSSegmentFetcher& fetcher,
+			    int playlist_size);
+    bool StreamFits(const HLSRecStream* hls) const;
 
     // Debug
     void EnableDebugging(void);
@@ -128,6 +132,9 @@ class MTV_PUBLIC  HLSReader
 
     // Downloading
     int         m_slow_cnt;
+    qint64      m_last_delivery;  // when the last segment finished (msecs)
+    uint64_t    m_early_bytes;    // arrived before m_last_delivery
+    uint64_t    m_throughput;     // measured over all fetchers (bits/sec)
     QByteArray  m_buffer;
     QMutex      m_buflock;
 };
@@ -0,0 +1,166 @@
+#include <QDateTime>
+
+#include "HLSReader.h"
+#include "HLSSegmentFetcher.h"
+
+#define LOC QString("%1 fetcher %2: ").arg(m_parent->StreamURL().isEmpty() ? "Stream" : m_parent->StreamURL()).arg(m_id)
+
+HLSSegmentFetcher::HLSSegmentFetcher(HLSReader *parent, int id)
+    : MThread("HLSSegment"),
+      m_parent(parent), m_id(id), m_downloader(NULL),
+      m_ok(false), m_started(0), m_finished(0),
+      m_state(kIdle), m_cancel(false)
+{
+    LOG(VB_RECORD, LOG_DEBUG, LOC + "ctor");
+}
+
+HLSSegmentFetcher::~HLSSegmentFetcher(void)
+{
+    LOG(VB_RECORD, LOG_DEBUG, LOC + "dtor");
+}
+
+void HLSSegmentFetcher::Cancel(void)
+{
+    LOG(VB_RECORD, LOG_DEBUG, LOC + "Cancel -- begin");
+    m_lock.lock();
+    m_cancel = true;
+    m_waitcond.wakeAll();
+    m_lock.unlock();
+    CancelCurrentDownload();
+    wait();
+    LOG(VB_RECORD, LOG_DEBUG, LOC + "Cancel -- end");
+}
+
+void HLSSegmentFetcher::CancelCurrentDownload(void)
+{
+    QMutexLocker locker(&m_downloader_lock);
+    if (m_downloader)
+        m_downloader->Cancel();
+}
+
+/**
+ * Start downloading segment.  The fetcher must be idle, so the result
+ * of any earlier Fetch() must have been collected by WaitForSegment()
+ * or thrown away by Discard().
+ */
+void HLSSegmentFetcher::Fetch(const HLSRecSegment& segment)
+{
+    QMutexLocker locker(&m_lock);
+    if (m_state != kIdle)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Asked to fetch %1 while busy with %2")
+            .arg(segment.Sequence()).arg(m_segment.Sequence()));
+        return;
+    }
+
+    m_segment = segment;
+    m_buffer.clear();
+    m_ok = false;
+    m_state = kFetching;
+    m_waitcond.wakeAll();
+}
+
+/**
+ * Wait for the segment given to Fetch() to be downloaded.
+ *
+ * \param buffer   Set to the contents of the segment
+ * \param started  When the download started, in msecs since the epoch
+ * \param finished When the download finished, in msecs since the epoch
+ * \return true if the segment was downloaded
+ */
+bool HLSSegmentFetcher::WaitForSegment(QByteArray& buffer, qint64& started,
+                                       qint64& finished)
+{
+    QMutexLocker locker(&m_lock);
+    while (m_state == kFetching && !m_cancel)
+        m_waitcond.wait(&m_lock);
+
+    if (m_state != kFetched)
+        return false;
+
+    buffer = m_buffer;
+    m_buffer.clear();
+    started = m_started;
+    finished = m_finished;
+    m_state = kIdle;
+    return m_ok;
+}
+
+/// Abort the current download, and throw away what it fetched
+void HLSSegmentFetcher::Discard(void)
+{
+    CancelCurrentDownload();
+
+    QByteArray buffer;
+    qint64 started, finished;
+    WaitForSegment(buffer, started, finished);
+}
+
+HLSRecSegment HLSSegmentFetcher::Segment(void) const
+{
+    QMutexLocker locker(&m_lock);
+    return m_segment;
+}
+
+void HLSSegmentFetcher::run(void)
+{
+    LOG(VB_RECORD, LOG_DEBUG, LOC + "run -- begin");
+    RunProlog();
+
+    m_downloader_lock.lock();
+    m_downloader = new MythSingleDownload;
+    m_downloader_lock.unlock();
+
+    m_lock.lock();
+    while (!m_cancel)
+    {
+        if (m_state != kFetching)
+        {
+            m_waitcond.wait(&m_lock);
+            continue;
+        }
+        HLSRecSegment segment = m_segment;
+        m_lock.unlock();
+
+        QByteArray buffer;
+        qint64 started = QDateTime::currentMSecsSinceEpoch();
+
+#ifdef HLS_USE_MYTHDOWNLOADMANAGER // MythDownloadManager leaks memory
+        bool ok = HLSReader::DownloadURL(segment.Url().toString(), &buffer);
+#else
+        bool ok = m_downloader->DownloadURL(segment.Url(), &buffer);
+        if (!ok)
+        {
+            LOG(VB_RECORD, LOG_ERR, LOC + QString("%1 failed: %2")
+                .arg(segment.Sequence()).arg(m_downloader->ErrorString()));
+
+            // Asking QNetworkAccessManager to redownload after a
+            // failure seems to result in another failure, even if the
+            // segment is now available.  So, create a new instance.
+            m_downloader_lock.lock();
+            delete m_downloader;
+            m_downloader = new MythSingleDownload;
+            m_downloader_lock.unlock();
+        }
+#endif
+
+        m_lock.lock();
+        m_buffer = buffer;
+        m_ok = ok;
+        m_started = started;
+        m_finished = QDateTime::currentMSecsSinceEpoch();
+        m_state = kFetched;
+        m_waitcond.wakeAll();
+    }
+    m_lock.unlock();
+
+    m_downloader_lock.lock();
+    m_downloader->Cancel();
+    delete m_downloader;
+    m_downloader = NULL;
+    m_downloader_lock.unlock();
+
+    LOG(VB_RECORD, LOG_DEBUG, LOC + "run -- end");
+    RunEpilog();
+}
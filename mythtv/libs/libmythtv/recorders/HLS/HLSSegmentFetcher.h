@@ -0,0 +1,59 @@
+#ifndef _HLS_Segment_Fetcher_h_
+#define _HLS_Segment_Fetcher_h_
+
+#include <QByteArray>
+#include <QWaitCondition>
+#include <QMutex>
+
+#include "mthread.h"
+#include "HLSSegment.h"
+
+class HLSReader;
+class MythSingleDownload;
+
+/*
+  Downloads one segment at a time on its own thread.  The same
+  MythSingleDownload is used for every segment, so the connection to
+  the server is kept open between them.  HLSReader keeps several of
+  these busy, so the next segments are downloading while it is
+  waiting for the current one.
+*/
+class HLSSegmentFetcher : public MThread
+{
+  public:
+    HLSSegmentFetcher(HLSReader* parent, int id);
+    ~HLSSegmentFetcher(void);
+
+    void Cancel(void);
+    void CancelCurrentDownload(void);
+
+    void Fetch(const HLSRecSegment& segment);
+    bool WaitForSegment(QByteArray& buffer, qint64& started,
+                        qint64& finished);
+    void Discard(void);
+
+    HLSRecSegment Segment(void) const;
+
+  protected:
+    void run(void);
+
+  private:
+    enum State { kIdle, kFetching, kFetched };
+
+    // Class vars
+    HLSReader      *m_parent;
+    int             m_id;
+    MythSingleDownload *m_downloader;
+    HLSRecSegment   m_segment;
+    QByteArray      m_buffer;
+    bool            m_ok;
+    qint64          m_started;   // msecs since the epoch
+    qint64          m_finished;
+    State           m_state;
+    bool            m_cancel;
+    mutable QMutex  m_lock;
+    QMutex          m_downloader_lock;
+    QWaitCondition  m_waitcond;
+};
+
+#endif
@@ -1,5 +1,9 @@
 #include "HLSReader.h"
 #include "HLSStreamWorker.h"
+#include "HLSSegmentFetcher.h"
+
+// Number of segments that may be downloading at once
+static const int kSegmentFetchers = 4;
 
 #define LOC QString("%1 worker: ").arg(m_parent->StreamURL().isEmpty() ? "Stream" : m_parent->StreamURL())
 
@@ -31,6 +35,34 @@ void HLSStreamWorker::CancelCurrentDownload(void)
     QMutexLocker locker(&m_downloader_lock);
     if (m_downloader)
         m_downloader->Cancel();
+    for (int i = 0; i < m_fetchers.size(); ++i)
+        m_fetchers[i]->CancelCurrentDownload();
+}
+
+void HLSStreamWorker::StartFetchers(void)
+{
+    QMutexLocker locker(&m_downloader_lock);
+    for (int i = 0; i < kSegmentFetchers; ++i)
+    {
+        HLSSegmentFetcher *fetcher = new HLSSegmentFetcher(m_parent, i);
+        fetcher->start();
+        m_fetchers.push_back(fetcher);
+    }
+}
+
+void HLSStreamWorker::StopFetchers(void)
+{
+    QVector<HLSSegmentFetcher*> fetchers;
+
+    m_downloader_lock.lock();
+    fetchers.swap(m_fetchers);
+    m_downloader_lock.unlock();
+
+    for (int i = 0; i < fetchers.size(); ++i)
+    {
+        fetchers[i]->Cancel();
+        delete fetchers[i];
+    }
 }
 
 void HLSStreamWorker::run(void)
@@ -42,6 +74,8 @@ void HLSStreamWorker::run(void)
     m_downloader = new MythSingleDownload;
     m_downloader_lock.unlock();
 
+    StartFetchers();
+
     uint64_t delay;
     int retries = 0;
     while (!m_cancel)
@@ -51,7 +85,7 @@ void HLSStreamWorker::run(void)
             LOG(VB_GENERAL, LOG_CRIT, LOC + "Fatal error detected");
             break;
         }
-        if (!m_parent->LoadSegments(*m_downloader))
+        if (!m_parent->LoadSegments(*m_downloader, m_fetchers))
         {
             LOG(VB_RECORD, LOG_WARNING, LOC +
                 QString("download failed, retry #%1").arg(++retries));
@@ -94,6 +128,8 @@ void HLSStreamWorker::run(void)
         m_lock.unlock();
     }
 
+    StopFetchers();
+
     m_downloader->Cancel();
     delete m_downloader;
     m_downloader = NULL;
@@ -2,12 +2,14 @@
 #define _HLS_Segment_Worker_h_
 
 #include <QMap>
+#include <QVector>
 #include <QWaitCondition>
 #include <QMutex>
 
 #include "mthread.h"
 
 class HLSReader;
+class HLSSegmentFetcher;
 
 class HLSStreamWorker : public MThread
 {
@@ -24,10 +26,13 @@ class HLSStreamWorker : public MThread
 
   private:
     void Segment(void);
+    void StartFetchers(void);
+    void StopFetchers(void);
 
     // Class vars
     HLSReader      *m_parent;
     MythSingleDownload *m_downloader;
+    QVector<HLSSegmentFetcher*> m_fetchers;
     bool            m_cancel;
     bool            m_wokenup;
     mutable QMutex  m_lock;
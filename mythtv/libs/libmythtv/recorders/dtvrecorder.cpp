@@ -73,6 +73,8 @@ DTVRecorder::DTVRecorder(TVRec *rec) :
     // TS packet buffer
     // keyframe TS buffer
     _buffer_packets(false),
+    _batch_start(NULL),             _batch_end(NULL),
+    _pending_write(NULL),           _pending_write_size(0),
     // general recorder stuff
     _pid_lock(QMutex::Recursive),
     _input_pat(NULL),
@@ -165,6 +167,7 @@ void DTVRecorder::SetOptionsFromProfile(RecordingProfile *profile,
  */
 void DTVRecorder::FinishRecording(void)
 {
+    FlushPendingWrite();
     if (ringBuffer)
         ringBuffer->WriterFlush();
 
@@ -335,13 +338,48 @@ void DTVRecorder::BufferedWrite(const TSPacket &tspacket, bool insert)
         // we have to write them first...
         if (!_payload_buffer.empty())
         {
+            FlushPendingWrite();
             if (ringBuffer)
                 ringBuffer->Write(&_payload_buffer[0], _payload_buffer.size());
             _payload_buffer.clear();
         }
+
+        // Defer writing packets from the ProcessData() buffer, so a run
+        // of them can be written at once
+        const unsigned char *data = tspacket.data();
+        if (data >= _batch_start && data + TSPacket::kSize <= _batch_end)
+        {
+            if (_pending_write + _pending_write_size != data)
+            {
+                FlushPendingWrite();
+                _pending_write = data;
+            }
+            _pending_write_size += TSPacket::kSize;
+            return;
+        }
     }
 
-    if (ringBuffer && ringBuffer->Write(tspacket.data(), TSPacket::kSize) < 0 &&
+    FlushPendingWrite();
+    WritePackets(tspacket.data(), TSPacket::kSize);
+}
+
+/// Writes the packets deferred by BufferedWrite()
+void DTVRecorder::FlushPendingWrite(void)
+{
+    if (!_pending_write_size)
+        return;
+
+    const unsigned char *data = _pending_write;
+    uint size = _pending_write_size;
+    _pending_write = NULL;
+    _pending_write_size = 0;
+
+    WritePackets(data, size);
+}
+
+void DTVRecorder::WritePackets(const unsigned char *data, uint size)
+{
+    if (ringBuffer && ringBuffer->Write(data, size) < 0 &&
         curRecording && curRecording->GetRecordingStatus() != RecStatus::Failing)
     {
         LOG(VB_GENERAL, LOG_INFO, LOC +
@@ -352,6 +390,24 @@ void DTVRecorder::BufferedWrite(const TSPacket &tspacket, bool insert)
     }
 }
 
+void DTVRecorder::BeginTSPacketBatch(const unsigned char *buffer, int len)
+{
+    // Anything left over isn't valid any more
+    _pending_write = NULL;
+    _pending_write_size = 0;
+
+    _batch_start = buffer;
+    _batch_end   = buffer + len;
+}
+
+void DTVRecorder::EndTSPacketBatch(void)
+{
+    FlushPendingWrite();
+
+    _batch_start = NULL;
+    _batch_end   = NULL;
+}
+
 enum { kExtractPTS, kExtractDTS };
 static int64_t extract_timestamp(
     const uint8_t *bufptr, int bytes_left, int pts_or_dts)
@@ -813,6 +869,10 @@ bool DTVRecorder::FindOtherKeyframes(const TSPacket */*tspacket*/)
  */
 void DTVRecorder::HandleKeyframe(int64_t extra)
 {
+    // Write what came before the keyframe, before the position
+    // is taken, or we switch to a new file
+    FlushPendingWrite();
+
     if (!ringBuffer)
         return;
 
@@ -950,7 +1010,8 @@ bool DTVRecorder::FindH264Keyframes(const TSPacket *tspacket)
 
         uint32_t bytes_used = m_h264_parser.addBytes
                               (tspacket->data() + i, TSPacket::kSize - i,
-                               ringBuffer->GetWritePosition());
+                               ringBuffer->GetWritePosition() +
+                               _pending_write_size);
         i += (bytes_used - 1);
 
         if (m_h264_parser.stateChanged())
@@ -1049,6 +1110,10 @@ bool DTVRecorder::FindH264Keyframes(const TSPacket *tspacket)
  */
 void DTVRecorder::HandleH264Keyframe(void)
 {
+    // Write what came before the keyframe, before the position
+    // is taken, or we switch to a new file
+    FlushPendingWrite();
+
     // Perform ringbuffer switch if needed.
     CheckForRingBufferSwitch();
 
@@ -1520,6 +1585,7 @@ bool DTVRecorder::ProcessVideoTSPacket(const TSPacket &tspacket)
         if (_buffer_packets && _first_keyframe >= 0 && !_payload_buffer.empty())
         {
             // Flush the buffer
+            FlushPendingWrite();
             if (ringBuffer)
                 ringBuffer->Write(&_payload_buffer[0], _payload_buffer.size());
             _payload_buffer.clear();
@@ -1551,6 +1617,7 @@ bool DTVRecorder::ProcessAudioTSPacket(const TSPacket &tspacket)
         if (_buffer_packets && _first_keyframe >= 0 && !_payload_buffer.empty())
         {
             // Flush the buffer
+            FlushPendingWrite();
             if (ringBuffer)
                 ringBuffer->Write(&_payload_buffer[0], _payload_buffer.size());
             _payload_buffer.clear();
@@ -82,6 +82,8 @@ class DTVRecorder :
 
     // TSPacketListener
     bool ProcessTSPacket(const TSPacket &tspacket);
+    void BeginTSPacketBatch(const unsigned char *buffer, int len);
+    void EndTSPacketBatch(void);
 
     // TSPacketListenerAV
     bool ProcessVideoTSPacket(const TSPacket& tspacket);
@@ -101,6 +103,8 @@ class DTVRecorder :
     void UpdateFramesWritten(void);
 
     void BufferedWrite(const TSPacket &tspacket, bool insert = false);
+    void FlushPendingWrite(void);
+    void WritePackets(const unsigned char *data, uint size);
 
     // MPEG TS "audio only" support
     bool FindAudioKeyframes(const TSPacket *tspacket);
@@ -164,6 +168,13 @@ class DTVRecorder :
     bool                  _buffer_packets;
     vector<unsigned char> _payload_buffer;
 
+    // Packets in the buffer passed to MPEGStreamData::ProcessData() are
+    // written in place, as one write per run of contiguous packets
+    const unsigned char  *_batch_start;
+    const unsigned char  *_batch_end;
+    const unsigned char  *_pending_write;
+    uint                  _pending_write_size;
+
     // general recorder stuff
     mutable QMutex           _pid_lock;
     ProgramAssociationTable *_input_pat; ///< PAT on input side
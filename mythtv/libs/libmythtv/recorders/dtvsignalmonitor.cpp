@@ -147,6 +147,9 @@ QStringList DTVSignalMonitor::GetStatusList(void) const
 
 void DTVSignalMonitor::AddFlags(uint64_t _flags)
 {
+    // Hold statusLock so the monitoring thread woken by
+    // SignalMonitor::AddFlags() sees the updated values
+    QMutexLocker locker(&statusLock);
     SignalMonitor::AddFlags(_flags);
     UpdateMonitorValues();
 }
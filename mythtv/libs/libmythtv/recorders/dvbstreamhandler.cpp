@@ -213,10 +213,13 @@ void DVBStreamHandler::RunTS(void)
         UpdateFiltersFromStreamData();
 
         ssize_t len = 0;
+        unsigned char *data = buffer;
 
         if (drb)
         {
-            len = drb->Read(&(buffer[remainder]), buffer_size - remainder);
+            // Use the data in place; the remainder is left in the DRB
+            // and is at the start of the next Peek()
+            len = drb->Peek(data, buffer_size);
 
             // Check for DRB errors
             if (drb->IsErrored())
@@ -251,9 +254,9 @@ void DVBStreamHandler::RunTS(void)
                 std::this_thread::sleep_for(std::chrono::microseconds(100));
                 continue;
             }
-        }
 
-        len += remainder;
+            len += remainder;
+        }
 
         if (len < 10) // 10 bytes = 4 bytes TS header + 6 bytes PES header
         {
@@ -266,18 +269,25 @@ void DVBStreamHandler::RunTS(void)
         if (_stream_data_list.empty())
         {
             _listener_lock.unlock();
+            if (drb)
+            {
+                drb->Consume(len);
+                remainder = 0;
+            }
             continue;
         }
 
         StreamDataList::const_iterator sit = _stream_data_list.begin();
         for (; sit != _stream_data_list.end(); ++sit)
-            remainder = sit.key()->ProcessData(buffer, len);
+            remainder = sit.key()->ProcessData(data, len);
 
-        WriteMPTS(buffer, len - remainder);
+        WriteMPTS(data, len - remainder);
 
         _listener_lock.unlock();
 
-        if (remainder > 0 && (len > remainder)) // leftover bytes
+        if (drb)
+            drb->Consume(len - remainder);
+        else if (remainder > 0 && (len > remainder)) // leftover bytes
             memmove(buffer, &(buffer[len - remainder]), remainder);
     }
     LOG(VB_RECORD, LOG_DEBUG, LOC + "RunTS(): " + "shutdown");
@@ -8,6 +8,8 @@
 # include <sys/socket.h>
 # include <netinet/in.h>
 # include <netinet/ip.h>
+# include <unistd.h>
+# include <errno.h>
 #endif
 
 // Qt headers
@@ -28,6 +30,11 @@
 
 #define LOC QString("IPTVSH(%1): ").arg(_device)
 
+#ifdef __linux__
+/// Datagrams read from a socket by each recvmmsg() call
+static const int kReadBatchSize = 32;
+#endif
+
 QMap<QString,IPTVStreamHandler*> IPTVStreamHandler::s_iptvhandlers;
 QMap<QString,uint>               IPTVStreamHandler::s_iptvhandlers_refcnt;
 QMutex                           IPTVStreamHandler::s_iptvhandlers_lock;
@@ -223,9 +230,6 @@ void IPTVStreamHandler::run(void)
             // the requested server
             m_sender[i] = dest_addr;
         }
-        m_read_helpers[i] = new IPTVStreamHandlerReadHelper(
-            this, m_sockets[i], i);
-
         // we need to open the descriptor ourselves so we
         // can set some socket options
         int fd = socket(ipv6 ? AF_INET6 : AF_INET, SOCK_DGRAM, 0); // create IPv4 socket
@@ -235,6 +239,15 @@ void IPTVStreamHandler::run(void)
                 "Unable to create socket " + ENO);
             continue;
         }
+#ifdef SO_RXQ_OVFL
+        // report the number of datagrams dropped for want of buffer space
+        int on = 1;
+        if (setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, (char *)&on, sizeof(on)))
+        {
+            LOG(VB_RECORD, LOG_DEBUG, LOC +
+                "Unable to count dropped datagrams " + ENO);
+        }
+#endif
         int buf_size = 2 * 1024 * max(tuning.GetBitrate(i)/1000, 500U);
         if (!tuning.GetBitrate(i))
             buf_size = 2 * 1024 * 1024;
@@ -276,6 +289,9 @@ void IPTVStreamHandler::run(void)
         {
             m_rtcp_dest = dest_addr;
         }
+
+        m_read_helpers[i] = new IPTVStreamHandlerReadHelper(
+            this, m_sockets[i], i);
     }
 
     if (!error)
@@ -342,66 +358,250 @@ void IPTVStreamHandler::run(void)
 IPTVStreamHandlerReadHelper::IPTVStreamHandlerReadHelper(
     IPTVStreamHandler *p, QUdpSocket *s, uint stream) :
     m_parent(p), m_socket(s), m_sender(p->m_sender[stream]),
-    m_stream(stream)
+    m_stream(stream), m_fd(-1), m_notifier(NULL),
+    m_packets(0), m_rejected(0), m_overflows(0),
+    m_reordered(0), m_missing(0), m_last_sequence_number(-1)
 {
+#ifdef __linux__
+    // Read many datagrams per system call from a duplicate of the socket,
+    // so that QUdpSocket doesn't see the data being taken from under it.
+    int fd = m_socket->socketDescriptor();
+    if (fd >= 0)
+        m_fd = dup(fd);
+
+    if (m_fd >= 0)
+    {
+        m_notifier = new QSocketNotifier(m_fd, QSocketNotifier::Read, this);
+        connect(m_notifier, SIGNAL(activated(int)),
+                this,       SLOT(ReadPendingBatch()));
+        return;
+    }
+#endif
+
     connect(m_socket, SIGNAL(readyRead()),
             this,     SLOT(ReadPending()));
 }
 
 #define LOC_WH QString("IPTVSH(%1): ").arg(m_parent->_device)
 
+IPTVStreamHandlerReadHelper::~IPTVStreamHandlerReadHelper()
+{
+    delete m_notifier;
+    if (m_fd >= 0)
+        close(m_fd);
+
+    LOG(VB_RECORD, LOG_INFO, LOC_WH +
+        QString("Socket(%1) received %2 datagrams, rejected %3, "
+                "dropped by the kernel %4, RTP out of order %5, missing %6")
+        .arg(m_stream).arg(m_packets).arg(m_rejected).arg(m_overflows)
+        .arg(m_reordered).arg(m_missing));
+}
+
+/// Go back to reading one datagram at a time through m_socket
+void IPTVStreamHandlerReadHelper::UseQUdpSocket(void)
+{
+    // called from the notifier's own signal
+    m_notifier->setEnabled(false);
+    m_notifier->deleteLater();
+    m_notifier = NULL;
+    if (m_fd >= 0)
+        close(m_fd);
+    m_fd = -1;
+
+    connect(m_socket, SIGNAL(readyRead()),
+            this,     SLOT(ReadPending()));
+
+    // QUdpSocket only notifies again after a read
+    ReadPending();
+}
+
+void IPTVStreamHandlerReadHelper::PushPacket(const UDPPacket &packet)
+{
+    ++m_packets;
+
+    if (0 != m_stream)
+    {
+        m_parent->m_buffer->PushFECPacket(packet, m_stream - 1);
+        return;
+    }
+
+    const QByteArray &data = packet.GetDataReference();
+    if (m_parent->m_use_rtp_streaming && data.size() >= 4)
+    {
+        int seq = ((uchar)data[2] << 8) | (uchar)data[3];
+        if (m_last_sequence_number >= 0)
+        {
+            int delta = (int16_t)(seq - m_last_sequence_number);
+            if (delta <= 0)
+                ++m_reordered;
+            else
+                m_missing += delta - 1;
+        }
+        if (m_last_sequence_number < 0 ||
+            (int16_t)(seq - m_last_sequence_number) > 0)
+            m_last_sequence_number = seq;
+    }
+
+    m_parent->m_buffer->PushDataPacket(packet);
+}
+
 void IPTVStreamHandlerReadHelper::ReadPending(void)
 {
     QHostAddress sender;
     quint16 senderPort;
     bool sender_null = m_sender.isNull();
 
-    if (0 == m_stream)
+    while (m_socket->hasPendingDatagrams())
     {
-        while (m_socket->hasPendingDatagrams())
+        UDPPacket packet(m_parent->m_buffer->GetEmptyPacket());
+        QByteArray &data = packet.GetDataReference();
+        data.resize(m_socket->pendingDatagramSize());
+        m_socket->readDatagram(data.data(), data.size(),
+                               &sender, &senderPort);
+        if (sender_null || sender == m_sender)
         {
-            UDPPacket packet(m_parent->m_buffer->GetEmptyPacket());
-            QByteArray &data = packet.GetDataReference();
-            data.resize(m_socket->pendingDatagramSize());
-            m_socket->readDatagram(data.data(), data.size(),
-                                   &sender, &senderPort);
-            if (sender_null || sender == m_sender)
+            PushPacket(packet);
+        }
+        else
+        {
+            LOG(VB_RECORD, LOG_WARNING, LOC_WH +
+                QString("Received on socket(%1) %2 bytes from non expected "
+                        "sender:%3 (expected:%4) ignoring")
+                .arg(m_stream).arg(data.size())
+                .arg(sender.toString()).arg(m_sender.toString()));
+            ++m_rejected;
+            m_parent->m_buffer->FreePacket(packet);
+        }
+    }
+}
+
+/**
+ *  \brief Reads all the pending datagrams a batch at a time with
+ *         recvmmsg(), straight into packets from the PacketBuffer pool.
+ *
+ *  Falls back to ReadPending() if recvmmsg() isn't available, or if a
+ *  datagram is too big for a pooled packet.
+ */
+void IPTVStreamHandlerReadHelper::ReadPendingBatch(void)
+{
+#ifdef __linux__
+    struct mmsghdr          msgs[kReadBatchSize];
+    struct iovec            iovecs[kReadBatchSize];
+    struct sockaddr_storage addrs[kReadBatchSize];
+    char                    control[kReadBatchSize][CMSG_SPACE(sizeof(uint32_t))];
+    UDPPacket               packets[kReadBatchSize];
+
+    PacketBuffer *buffer = m_parent->m_buffer;
+    bool sender_null = m_sender.isNull();
+    bool too_big = false;
+    int count = kReadBatchSize;
+
+    while (count == kReadBatchSize && !too_big)
+    {
+        memset(msgs, 0, sizeof(msgs));
+        for (int i = 0; i < kReadBatchSize; ++i)
+        {
+            packets[i] = buffer->GetEmptyPacket();
+            QByteArray &data = packets[i].GetDataReference();
+            data.resize(PacketBuffer::kPacketSize);
+
+            iovecs[i].iov_base = data.data();
+            iovecs[i].iov_len  = data.size();
+            msgs[i].msg_hdr.msg_iov        = &iovecs[i];
+            msgs[i].msg_hdr.msg_iovlen     = 1;
+            msgs[i].msg_hdr.msg_name       = sender_null ? NULL : &addrs[i];
+            msgs[i].msg_hdr.msg_namelen    = sender_null ? 0 : sizeof(addrs[i]);
+            msgs[i].msg_hdr.msg_control    = control[i];
+            msgs[i].msg_hdr.msg_controllen = sizeof(control[i]);
+        }
+
+        count = recvmmsg(m_fd, msgs, kReadBatchSize, MSG_DONTWAIT, NULL);
+        if (count < 0)
+        {
+            if (errno == ENOSYS)
             {
-                m_parent->m_buffer->PushDataPacket(packet);
+                LOG(VB_RECORD, LOG_INFO, LOC_WH +
+                    "recvmmsg() is not supported, using QUdpSocket");
+                too_big = true;
             }
-            else
+            else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
             {
-                LOG(VB_RECORD, LOG_WARNING, LOC_WH +
-                    QString("Received on socket(%1) %2 bytes from non expected "
-                            "sender:%3 (expected:%4) ignoring")
-                    .arg(m_stream).arg(data.size())
-                    .arg(sender.toString()).arg(m_sender.toString()));
+                LOG(VB_RECORD, LOG_ERR, LOC_WH +
+                    QString("Reading socket(%1) failed ").arg(m_stream) + ENO);
             }
+            count = 0;
         }
-    }
-    else
-    {
-        while (m_socket->hasPendingDatagrams())
+
+        for (int i = 0; i < count; ++i)
         {
-            UDPPacket packet(m_parent->m_buffer->GetEmptyPacket());
-            QByteArray &data = packet.GetDataReference();
-            data.resize(m_socket->pendingDatagramSize());
-            m_socket->readDatagram(data.data(), data.size(),
-                                   &sender, &senderPort);
-            if (sender_null || sender == m_sender)
+            struct msghdr &hdr = msgs[i].msg_hdr;
+
+#ifdef SO_RXQ_OVFL
+            for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&hdr); cmsg;
+                 cmsg = CMSG_NXTHDR(&hdr, cmsg))
             {
-                m_parent->m_buffer->PushFECPacket(packet, m_stream - 1);
+                if (cmsg->cmsg_level != SOL_SOCKET ||
+                    cmsg->cmsg_type != SO_RXQ_OVFL)
+                    continue;
+
+                uint32_t overflows;
+                memcpy(&overflows, CMSG_DATA(cmsg), sizeof(overflows));
+                if (overflows != m_overflows)
+                {
+                    LOG(VB_RECORD, LOG_WARNING, LOC_WH +
+                        QString("Socket(%1) buffer overflowed, %2 datagrams "
+                                "dropped").arg(m_stream)
+                        .arg(overflows - m_overflows));
+                    m_overflows = overflows;
+                }
             }
-            else
+#endif
+
+            if (hdr.msg_flags & MSG_TRUNC)
             {
                 LOG(VB_RECORD, LOG_WARNING, LOC_WH +
-                    QString("Received on socket(%1) %2 bytes from non expected "
-                            "sender:%3 (expected:%4) ignoring")
-                    .arg(m_stream).arg(data.size())
-                    .arg(sender.toString()).arg(m_sender.toString()));
+                    QString("Datagram on socket(%1) is larger than %2 bytes, "
+                            "using QUdpSocket").arg(m_stream)
+                    .arg(PacketBuffer::kPacketSize));
+                ++m_rejected;
+                too_big = true;
+                buffer->FreePacket(packets[i]);
+                packets[i] = UDPPacket();
+                continue;
+            }
+
+            packets[i].GetDataReference().resize(msgs[i].msg_len);
+
+            if (!sender_null)
+            {
+                QHostAddress sender((struct sockaddr *)&addrs[i]);
+                if (sender != m_sender)
+                {
+                    LOG(VB_RECORD, LOG_WARNING, LOC_WH +
+                        QString("Received on socket(%1) %2 bytes from non "
+                                "expected sender:%3 (expected:%4) ignoring")
+                        .arg(m_stream).arg(msgs[i].msg_len)
+                        .arg(sender.toString()).arg(m_sender.toString()));
+                    ++m_rejected;
+                    buffer->FreePacket(packets[i]);
+                    packets[i] = UDPPacket();
+                    continue;
+                }
             }
+
+            PushPacket(packets[i]);
+        }
+
+        for (int i = count; i < kReadBatchSize; ++i)
+        {
+            buffer->FreePacket(packets[i]);
+            packets[i] = UDPPacket();
         }
     }
+
+    if (too_big)
+        UseQUdpSocket();
+#endif // __linux__
 }
 
 IPTVStreamHandlerWriteHelper::IPTVStreamHandlerWriteHelper(IPTVStreamHandler *p)
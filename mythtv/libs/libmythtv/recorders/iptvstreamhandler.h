@@ -6,6 +6,7 @@
 #include <vector>
 using namespace std;
 
+#include <QSocketNotifier>
 #include <QHostAddress>
 #include <QUdpSocket>
 #include <QString>
@@ -17,6 +18,7 @@ using namespace std;
 
 #include "channelutil.h"
 #include "streamhandler.h"
+#include "udppacket.h"
 
 #define IPTV_SOCKET_COUNT   3
 #define RTCP_TIMER          10
@@ -34,15 +36,34 @@ class IPTVStreamHandlerReadHelper : QObject
   public:
     IPTVStreamHandlerReadHelper(
         IPTVStreamHandler *p, QUdpSocket *s, uint stream);
+    ~IPTVStreamHandlerReadHelper();
 
   public slots:
     void ReadPending(void);
+    void ReadPendingBatch(void);
+
+  private:
+    void UseQUdpSocket(void);
+    void PushPacket(const UDPPacket &packet);
 
   private:
     IPTVStreamHandler *m_parent;
     QUdpSocket *m_socket;
     QHostAddress m_sender;
     uint m_stream;
+
+    /// Duplicate of the socket read with recvmmsg(), or -1 when reading
+    /// through m_socket
+    int m_fd;
+    QSocketNotifier *m_notifier;
+
+    // Statistics for this socket
+    uint64_t m_packets;     ///< Datagrams accepted
+    uint64_t m_rejected;    ///< Datagrams from the wrong sender or too big
+    uint     m_overflows;   ///< Datagrams dropped by the kernel
+    uint64_t m_reordered;   ///< RTP packets older than one already seen
+    uint64_t m_missing;     ///< RTP sequence numbers skipped
+    int      m_last_sequence_number;
 };
 
 class IPTVStreamHandlerWriteHelper : QObject
@@ -11,6 +11,9 @@
 #include "packetbuffer.h"
 #include "compat.h" // for random on windows
 
+/// Packets allocated up front, enough for the RTP reordering window
+static const int kInitialPackets = 512;
+
 PacketBuffer::PacketBuffer(unsigned int bitrate) :
     m_bitrate(bitrate),
     m_next_empty_packet_key(0ULL)
@@ -21,6 +24,15 @@ PacketBuffer::PacketBuffer(unsigned int bitrate) :
             (random() << 24) ^ (random() << 16) ^
             (random() << 8) ^ random();
     }
+
+    // Allocate the pool now rather than while the first packets arrive
+    m_empty_packets.reserve(kInitialPackets);
+    for (int i = 0; i < kInitialPackets; ++i)
+    {
+        UDPPacket packet(m_next_empty_packet_key++);
+        packet.GetDataReference().reserve(kPacketSize);
+        m_empty_packets.push_back(packet);
+    }
 }
 
 bool PacketBuffer::HasAvailablePacket(void) const
@@ -41,14 +53,16 @@ UDPPacket PacketBuffer::PopDataPacket(void)
 
 UDPPacket PacketBuffer::GetEmptyPacket(void)
 {
-    QMap<uint64_t, UDPPacket>::iterator it = m_empty_packets.begin();
-    if (it == m_empty_packets.end())
+    if (m_empty_packets.isEmpty())
     {
-        return UDPPacket(m_next_empty_packet_key++);
+        UDPPacket packet(m_next_empty_packet_key++);
+        packet.GetDataReference().reserve(kPacketSize);
+        return packet;
     }
 
-    UDPPacket packet(*it);
-    m_empty_packets.erase(it);
+    // The most recently freed packet is the most likely to be in cache
+    UDPPacket packet(m_empty_packets.back());
+    m_empty_packets.pop_back();
 
     return packet;
 }
@@ -57,5 +71,5 @@ void PacketBuffer::FreePacket(const UDPPacket &packet)
 {
     uint64_t top = packet.GetKey() & (0xFFFFFFFFULL<<32);
     if (top == (m_next_empty_packet_key & (0xFFFFFFFFULL<<32)))
-        m_empty_packets[packet.GetKey()] = packet;
+        m_empty_packets.push_back(packet);
 }
@@ -7,14 +7,19 @@
 #ifndef _PACKET_BUFFER_H_
 #define _PACKET_BUFFER_H_
 
-#include <QList>
-#include <QMap>
+#include <deque>
+
+#include <QVector>
 
 #include "udppacket.h"
 
 class PacketBuffer
 {
   public:
+    /// Room reserved in each packet, enough for any datagram that fits
+    /// in an Ethernet frame
+    static const int kPacketSize = 2048;
+
     explicit PacketBuffer(unsigned int bitrate);
     virtual ~PacketBuffer() { }
 
@@ -30,6 +35,7 @@ class PacketBuffer
     UDPPacket PopDataPacket(void);
 
     /// Gets a packet for use in PushDataPacket/PushFECPacket.
+    /// Its data has room for at least kPacketSize bytes.
     UDPPacket GetEmptyPacket(void);
 
     /** \brief Frees an RTPDataPacket returned by PopDataPacket.
@@ -45,12 +51,12 @@ class PacketBuffer
 
     /// Packets key to use for next empty packet
     uint64_t m_next_empty_packet_key;
-    
-    /// Packets ready for reuse
-    QMap<uint64_t, UDPPacket> m_empty_packets;
+
+    /// Packets ready for reuse, most recently freed last
+    QVector<UDPPacket> m_empty_packets;
 
     /// Ordered list of available packets
-    QList<UDPPacket> m_available_packets;
+    std::deque<UDPPacket> m_available_packets;
 };
 
 #endif // _PACKET_BUFFER_H_
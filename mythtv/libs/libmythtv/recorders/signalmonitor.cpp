@@ -18,6 +18,7 @@ extern "C" {
 #include "libavcodec/avcodec.h"
 }
 #include "mythdate.h"
+#include "mythtimer.h"
 
 #ifdef USING_DVB
 #   include "dvbsignalmonitor.h"
@@ -225,6 +226,7 @@ SignalMonitor::SignalMonitor(int _capturecardnum, ChannelBase *_channel,
       scriptStatus  (QCoreApplication::translate("(Common)", "Script Status"),
                      "script", 3, true, 0, 3, 0),
       running(false),                  exit(false),
+      update_pending(false),
       statusLock(QMutex::Recursive)
 {
     if (!channel->IsExternalChannelChangeInUse())
@@ -245,7 +247,12 @@ SignalMonitor::~SignalMonitor()
 void SignalMonitor::AddFlags(uint64_t _flags)
 {
     DBG_SM("AddFlags", sm_flags_to_string(_flags));
+    uint64_t added = _flags & ~flags;
     flags |= _flags;
+
+    // A table or state we were waiting for has arrived
+    if (added)
+        Notify();
 }
 
 void SignalMonitor::RemoveFlags(uint64_t _flags)
@@ -289,6 +296,7 @@ void SignalMonitor::Stop()
 
     QMutexLocker locker(&startStopLock);
     exit = true;
+    startStopWait.wakeAll();
     if (running)
     {
         locker.unlock();
@@ -298,6 +306,20 @@ void SignalMonitor::Stop()
     DBG_SM("Stop", "end");
 }
 
+/** \brief Wakes the monitoring thread to update the values now, rather
+ *         than at the next update_rate interval.
+ *
+ *   This is called from the stream handler's thread when a table the
+ *   monitor is waiting for arrives, so the all good message is sent
+ *   as soon as possible.
+ */
+void SignalMonitor::Notify(void)
+{
+    QMutexLocker locker(&startStopLock);
+    update_pending = true;
+    startStopWait.wakeAll();
+}
+
 /** \brief Returns QStringList containing all signals and their current
  *         values.
  *
@@ -329,10 +351,13 @@ void SignalMonitor::run(void)
     running = true;
     startStopWait.wakeAll();
 
+    MythTimer last_update;
     while (!exit)
     {
+        update_pending = false;
         locker.unlock();
 
+        last_update.start();
         UpdateValues();
 
         if (notify_frontend && capturecardnum>=0)
@@ -342,8 +367,21 @@ void SignalMonitor::run(void)
             gCoreContext->dispatch(me);
         }
 
+        // Events wake us up, so only poll now and then once all is good
+        int rate = IsAllGood() ? max(update_rate, (int)kAllGoodUpdateRate) :
+            update_rate;
+
         locker.relock();
-        startStopWait.wait(locker.mutex(), update_rate);
+        if (!update_pending && !exit)
+            startStopWait.wait(locker.mutex(), rate);
+
+        // Don't query the tuner more often than it allows
+        int elapsed = last_update.elapsed();
+        while (!exit && elapsed < (int)minimum_update_rate)
+        {
+            startStopWait.wait(locker.mutex(), minimum_update_rate - elapsed);
+            elapsed = last_update.elapsed();
+        }
     }
 
     // We need to send a last informational message because a
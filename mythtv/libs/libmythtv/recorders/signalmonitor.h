@@ -46,6 +46,7 @@ class SignalMonitor : protected MThread
 
     virtual void Start();
     virtual void Stop();
+    void Notify(void);
 
     // // // // // // // // // // // // // // // // // // // // // // // //
     // Flags // // // // // // // // // // // // // // // // // // // // //
@@ -100,7 +101,9 @@ class SignalMonitor : protected MThread
     /** \brief Sets the number of milliseconds between signal monitoring
      *         attempts in the signal monitoring thread.
      *
-     *   Defaults to 25 milliseconds.
+     *   Defaults to 25 milliseconds.  Once everything is good the
+     *   monitor slows down to kAllGoodUpdateRate, Notify() wakes it
+     *   sooner when something changes.
      *  \param msec Milliseconds between signal monitoring events.
      */
     void SetUpdateRate(int msec)
@@ -194,6 +197,9 @@ class SignalMonitor : protected MThread
     /// Wait for rotor to complete turning the antenna
     static const uint64_t kDVBSigMon_WaitForPos = 0x8000000000ULL;
 
+    /// Milliseconds between signal monitoring events once all is good
+    static const int kAllGoodUpdateRate = 500;
+
   protected:
     ChannelBase *channel;
     TVRec       *pParent;
@@ -217,6 +223,7 @@ class SignalMonitor : protected MThread
     QWaitCondition     startStopWait; // protected by startStopLock
     volatile bool      running;       // protected by startStopLock
     volatile bool      exit;          // protected by startStopLock
+    bool               update_pending; // protected by startStopLock
 
     mutable QMutex     statusLock;
     mutable QMutex     listenerLock;
@@ -175,3 +175,59 @@ QString RecordingFile::AVContainerToString(AVContainer format)
 }
 
 
+
+/** \brief Returns the stream probe snapshot stored for a recording's file,
+ *         or an empty array if there is none.
+ *
+ *  The snapshot is an opaque blob written by the decoder after it has
+ *  fully probed the file, see AvFormatDecoder::FindStreamInfo().
+ */
+QByteArray RecordingFile::LoadProbeSnapshot(uint recordingId)
+{
+    if (recordingId == 0)
+        return QByteArray();
+
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare("SELECT probe_snapshot "
+                  "FROM recordedfile "
+                  "WHERE recordedid = :RECORDEDID ");
+    query.bindValue(":RECORDEDID", recordingId);
+
+    if (!query.exec())
+    {
+        MythDB::DBError("RecordingFile::LoadProbeSnapshot()", query);
+        return QByteArray();
+    }
+
+    if (query.next())
+        return query.value(0).toByteArray();
+
+    return QByteArray();
+}
+
+/** \brief Stores the stream probe snapshot for a recording's file.
+ *
+ *  This only touches the snapshot column so that it never races with
+ *  the recorder updating the rest of the row through Save().
+ */
+bool RecordingFile::SaveProbeSnapshot(uint recordingId,
+                                      const QByteArray &snapshot)
+{
+    if (recordingId == 0)
+        return false;
+
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare("UPDATE recordedfile "
+                  "SET probe_snapshot = :SNAPSHOT "
+                  "WHERE recordedid = :RECORDEDID ");
+    query.bindValue(":SNAPSHOT", snapshot);
+    query.bindValue(":RECORDEDID", recordingId);
+
+    if (!query.exec())
+    {
+        MythDB::DBError("RecordingFile::SaveProbeSnapshot()", query);
+        return false;
+    }
+
+    return true;
+}
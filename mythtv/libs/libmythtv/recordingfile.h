@@ -1,6 +1,7 @@
 #ifndef _RECORDING_FILE_H_
 #define _RECORDING_FILE_H_
 
+#include <QByteArray>
 #include <QString>
 #include <QSize>
 
@@ -59,6 +60,9 @@ class MTV_PUBLIC RecordingFile
 
     static QString AVContainerToString(AVContainer format);
     static AVContainer AVContainerFromString(const QString &formatStr);
+
+    static QByteArray LoadProbeSnapshot(uint recordingId);
+    static bool SaveProbeSnapshot(uint recordingId, const QByteArray &snapshot);
 };
 
 #endif
@@ -31,6 +31,7 @@
 #include "mythdate.h"
 #include "mythtimer.h"
 #include "mythlogging.h"
+#include "mythtrace.h"
 #include "DVD/dvdringbuffer.h"
 #include "Bluray/bdringbuffer.h"
 #include "HLS/httplivestreambuffer.h"
@@ -41,6 +42,8 @@
 #define BUFFER_FACTOR_NETWORK  2
 #define BUFFER_FACTOR_BITRATE  2
 #define BUFFER_FACTOR_MATROSKA 2
+// upper bound for the adaptive read ahead controller
+#define BUFFER_SIZE_MAXIMUM 64 * 1024 * 1024
 
 const int  RingBuffer::kDefaultOpenTimeout = 2000; // ms
 const int  RingBuffer::kLiveTVOpenTimeout  = 10000;
@@ -113,6 +116,8 @@ RingBuffer *RingBuffer::Create(
     const QString &xfilename, bool write,
     bool usereadahead, int timeout_ms, bool stream_only)
 {
+    MYTH_TRACE_SCOPE("RingBuffer::Create", "ringbuffer");
+
     QString lfilename = xfilename;
     QString lower = lfilename.toLower();
 
@@ -240,7 +245,9 @@ RingBuffer::RingBuffer(RingBufferType rbtype) :
     setswitchtonext(false),
     rawbitrate(8000),         playspeed(1.0f),
     fill_threshold(65536),    fill_min(-1),
-    readblocksize(CHUNK),     wanttoread(0),
+    fill_min_static(-1),      readblocksize(CHUNK),
+    readaheadwindow(0),       adaptivebuffersize(0),
+    wanttoread(0),
     numfailures(0),           commserror(false),
     oldfile(false),           livetvchain(NULL),
     ignoreliveeof(false),     readAdjust(0),
@@ -462,6 +469,11 @@ void RingBuffer::CalcReadAheadThresh(void)
                                      "for low bitrate stream.");
     }
 
+    // the adaptive controller never buffers less than this
+    fill_min_static = fill_min;
+    // let the OS prefetch a few read blocks beyond the read position
+    readaheadwindow = max(fill_min, readblocksize) * 4;
+
     LOG(VB_FILE, LOG_INFO, LOC +
         QString("CalcReadAheadThresh(%1 Kb)\n\t\t\t -> "
                 "threshhold(%2 KB) min read(%3 KB) blk size(%4 KB)")
@@ -469,6 +481,67 @@ void RingBuffer::CalcReadAheadThresh(void)
             .arg(fill_min/1024).arg(readblocksize/1024));
 }
 
+/** \fn RingBuffer::AdaptReadAheadThresh(uint64_t, uint64_t)
+ *  \brief Adjusts fill_min and the OS read ahead window from the measured
+ *         rates at which the decoder consumes and the storage delivers data.
+ *
+ *   The static thresholds from CalcReadAheadThresh() only know the
+ *   estimated bitrate. When the storage is barely faster than the decoder,
+ *   e.g. a busy NFS server or fast forward through a high bitrate
+ *   recording, more data is buffered before reads are allowed so that a
+ *   short storage stall doesn't starve the decoder. When it is much
+ *   faster the thresholds fall back to the static values.
+ *
+ *   WARNING: Must be called with rwlock in write lock state.
+ *
+ *  \param consume_bps Bits per second read by the decoder
+ *  \param storage_bps Bits per second delivered by safe_read()
+ *  \return true if the read ahead buffer should be enlarged
+ */
+bool RingBuffer::AdaptReadAheadThresh(uint64_t consume_bps,
+                                      uint64_t storage_bps)
+{
+    if (low_buffers || fill_min_static < 0 || !consume_bps)
+        return false;
+
+    // seconds of buffering before allowing reads, from the headroom
+    // the storage has over the decoder
+    float secs_min = 0.3f;
+    if (storage_bps && storage_bps < consume_bps * 2)
+        secs_min = 2.0f;
+    else if (storage_bps && storage_bps < consume_bps * 4)
+        secs_min = 1.0f;
+
+    uint64_t bytes_min = (uint64_t) ((consume_bps * secs_min) * 0.125f);
+    bytes_min = ((bytes_min / CHUNK) + 1) * CHUNK;
+
+    int old_fill_min = fill_min;
+    fill_min = max((uint64_t)fill_min_static, bytes_min);
+    fill_min = min((uint)fill_min, bufferSize / 2);
+
+    // roughly four seconds of data for the OS to prefetch
+    readaheadwindow = (int) min(max((uint64_t)fill_min * 4,
+                                    (consume_bps >> 3) * 4),
+                                (uint64_t) BUFFER_SIZE_MINIMUM * 4);
+
+    if (fill_min != old_fill_min)
+    {
+        LOG(VB_FILE, LOG_INFO, LOC +
+            QString("AdaptReadAheadThresh(decoder %1 Kb, storage %2 Kb) "
+                    "-> min read(%3 KB) os read ahead(%4 KB)")
+                .arg(consume_bps / 1000).arg(storage_bps / 1000)
+                .arg(fill_min / 1024).arg(readaheadwindow / 1024));
+    }
+
+    // keep at least four times the minimum fill in the buffer
+    uint wanted = (uint) min(bytes_min * 4, (uint64_t) BUFFER_SIZE_MAXIMUM);
+    if (wanted <= bufferSize || wanted <= adaptivebuffersize)
+        return false;
+
+    adaptivebuffersize = wanted;
+    return true;
+}
+
 bool RingBuffer::IsNearEnd(double /*fps*/, uint vvf) const
 {
     QReadLocker lock(&rwlock);
@@ -880,6 +953,10 @@ void RingBuffer::CreateReadAheadBuffer(void)
             newsize *= BUFFER_FACTOR_BITRATE;
     }
 
+    // grow to what the adaptive read ahead controller asked for
+    while (newsize < adaptivebuffersize && newsize < BUFFER_SIZE_MAXIMUM)
+        newsize *= 2;
+
     // N.B. Don't try and make it smaller - bad things happen...
     if (readAheadBuffer && oldsize >= newsize)
     {
@@ -922,6 +999,12 @@ void RingBuffer::run(void)
     bool ignore_for_read_timing = true;
     int eofreads = 0;
 
+    // These variables drive the adaptive read ahead controller
+    MythTimer adapt_timer;
+    long long adapt_readpos = 0;
+    uint64_t consume_avg = 0;
+    uint64_t storage_avg = 0;
+
     gettimeofday(&lastread, NULL); // this is just to keep gcc happy
 
     CreateReadAheadBuffer();
@@ -940,6 +1023,7 @@ void RingBuffer::run(void)
     // such as reset and seek can take priority.
 
     rwlock.lockForRead();
+    adapt_timer.start();
 
     LOG(VB_FILE, LOG_INFO, LOC +
         QString("Initial readblocksize %1K & fill_min %2K")
@@ -1092,6 +1176,8 @@ void RingBuffer::run(void)
                 .arg(QString("(%1Mbps)").arg((double)bps / 1000000.0))
                 .arg(readtimeavg));
             UpdateStorageRate(bps);
+            if (read_return >= (int)CHUNK)
+                storage_avg = storage_avg ? (storage_avg * 7 + bps) / 8 : bps;
 
             if (read_return >= 0)
             {
@@ -1220,6 +1306,45 @@ void RingBuffer::run(void)
             eofreads = 0;
         }
 
+        // Feed the measured rates to the adaptive read ahead controller
+        // about once a second.
+        if (adapt_timer.elapsed() >= 1000)
+        {
+            poslock.lockForRead();
+            long long consumed = readpos - adapt_readpos;
+            adapt_readpos = readpos;
+            poslock.unlock();
+            int elapsed = adapt_timer.restart();
+
+            if (consumed > 0 && consumed < (long long)bufferSize &&
+                !paused && !ateof && !setswitchtonext)
+            {
+                uint64_t rate = (uint64_t) consumed * 8000 / max(elapsed, 1);
+                consume_avg = consume_avg ? (consume_avg * 3 + rate) / 4 : rate;
+
+                rwlock.unlock();
+                rwlock.lockForWrite();
+                bool grow = AdaptReadAheadThresh(consume_avg, storage_avg);
+                rwlock.unlock();
+                if (grow)
+                {
+                    // Recreating the buffer goes back to the static
+                    // thresholds, so adapt them again for the new size
+                    CreateReadAheadBuffer();
+                    rwlock.lockForWrite();
+                    AdaptReadAheadThresh(consume_avg, storage_avg);
+                    rwlock.unlock();
+                }
+                rwlock.lockForRead();
+                used = bufferSize - ReadBufFree();
+            }
+            else if (consumed != 0)
+            {
+                // a seek, start measuring the decoder again
+                consume_avg = 0;
+            }
+        }
+
         LOG(VB_FILE, LOG_DEBUG, LOC + "@ end of read ahead loop");
 
         if (!readsallowed || commserror || ateof || setswitchtonext ||
@@ -1307,16 +1432,21 @@ bool RingBuffer::WaitForReadsAllowed(void)
     MythTimer t;
     t.start();
 
-    while ((t.elapsed() < timeout_ms) && !check && !stopreads &&
-           !request_pause && !commserror && readaheadrunning)
+    if (!check)
     {
-        generalWait.wait(&rwlock, clamp(timeout_ms - t.elapsed(), 10, 100));
-        if (!check && t.elapsed() > 1000 && (count % 100) == 0)
+        MYTH_TRACE_SCOPE("RingBuffer::WaitForReadsAllowed", "ringbuffer");
+
+        while ((t.elapsed() < timeout_ms) && !check && !stopreads &&
+               !request_pause && !commserror && readaheadrunning)
         {
-            LOG(VB_GENERAL, LOG_WARNING, LOC +
-                "Taking too long to be allowed to read..");
+            generalWait.wait(&rwlock, clamp(timeout_ms - t.elapsed(), 10, 100));
+            if (!check && t.elapsed() > 1000 && (count % 100) == 0)
+            {
+                LOG(VB_GENERAL, LOG_WARNING, LOC +
+                    "Taking too long to be allowed to read..");
+            }
+            count++;
         }
-        count++;
     }
     if (t.elapsed() >= timeout_ms)
     {
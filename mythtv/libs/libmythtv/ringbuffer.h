@@ -176,6 +176,7 @@ class MTV_PUBLIC RingBuffer : protected MThread
     void run(void); // MThread
     void CreateReadAheadBuffer(void);
     void CalcReadAheadThresh(void);
+    bool AdaptReadAheadThresh(uint64_t consume_bps, uint64_t storage_bps);
     bool PauseAndWait(void);
     virtual int safe_read(void *data, uint sz) = 0;
 
@@ -246,7 +247,10 @@ class MTV_PUBLIC RingBuffer : protected MThread
     float     playspeed;          // protected by rwlock
     int       fill_threshold;     // protected by rwlock
     int       fill_min;           // protected by rwlock
+    int       fill_min_static;    // protected by rwlock
     int       readblocksize;      // protected by rwlock
+    int       readaheadwindow;    // protected by rwlock
+    uint      adaptivebuffersize; // protected by rwlock
     int       wanttoread;         // protected by rwlock
     int       numfailures;        // protected by rwlock (see note 1)
     bool      commserror;         // protected by rwlock
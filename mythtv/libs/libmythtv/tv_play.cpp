@@ -33,6 +33,7 @@ using namespace std;
 #include "mythdb.h"
 #include "mythcorecontext.h"
 #include "mythlogging.h"
+#include "mythtrace.h"
 #include "lcddevice.h"
 #include "compat.h"
 #include "mythdirs.h"
@@ -1021,6 +1022,7 @@ TV::TV(void)
       db_use_fixed_size(true),      db_browse_always(false),
       db_browse_all_tuners(false),
       db_use_channel_groups(false), db_remember_last_channel_group(false),
+      db_pretune(false),
 
       tryUnflaggedSkip(false),
       smartForward(false),
@@ -1146,6 +1148,7 @@ void TV::InitFromDB(void)
     kv["BrowseChannelGroup"]       = "0";
     kv["ChannelGroupDefault"]      = "-1";
     kv["ChannelGroupRememberLast"] = "0";
+    kv["LiveTVPreTune"]            = "0";
 
     kv["VbiFormat"]                = "";
     kv["DecodeVBIFormat"]          = "";
@@ -1192,6 +1195,7 @@ void TV::InitFromDB(void)
     db_use_channel_groups  = kv["BrowseChannelGroup"].toInt();
     db_remember_last_channel_group = kv["ChannelGroupRememberLast"].toInt();
     channelGroupId         = kv["ChannelGroupDefault"].toInt();
+    db_pretune             = kv["LiveTVPreTune"].toInt();
 
     QString beVBI          = kv["VbiFormat"];
     QString feVBI          = kv["DecodeVBIFormat"];
@@ -2244,6 +2248,8 @@ static QString tv_i18n(const QString &msg)
  */
 void TV::HandleStateChange(PlayerContext *mctx, PlayerContext *ctx)
 {
+    MYTH_TRACE_SCOPE("TV::HandleStateChange", "tv_play");
+
     LOG(VB_PLAYBACK, LOG_DEBUG, LOC + QString("(%1) -- begin")
             .arg(find_player_index(ctx)));
 
@@ -7658,6 +7664,8 @@ bool TV::CommitQueuedInput(PlayerContext *ctx)
 
 void TV::ChangeChannel(PlayerContext *ctx, ChannelChangeDirection direction)
 {
+    MYTH_TRACE_SCOPE("TV::ChangeChannel", "tv_play");
+
     if (db_use_channel_groups || (direction == CHANNEL_DIRECTION_FAVORITE))
     {
         uint old_chanid = 0;
@@ -7694,6 +7702,20 @@ void TV::ChangeChannel(PlayerContext *ctx, ChannelChangeDirection direction)
     if (direction == CHANNEL_DIRECTION_FAVORITE)
         direction = CHANNEL_DIRECTION_UP;
 
+    // If the backend has tuned another input to the channel the recorder
+    // would change to, switch to that input instead.
+    if (db_pretune && kPseudoNormalLiveTV == ctx->pseudoLiveTVState)
+    {
+        uint chanid = 0;
+        uint inputid = RemoteGetPreTunedInput(ctx->GetCardID(), direction,
+                                              chanid);
+        if (inputid && chanid && inputid != ctx->GetCardID())
+        {
+            ChangeChannel(ctx, chanid, "", inputid);
+            return;
+        }
+    }
+
     QString oldinputname = ctx->recorder->GetInput();
 
     if (ContextIsPaused(ctx, __FILE__, __LINE__))
@@ -7749,8 +7771,15 @@ static uint get_chanid(const PlayerContext *ctx,
     return chanid;
 }
 
-void TV::ChangeChannel(PlayerContext *ctx, uint chanid, const QString &chan)
+/**
+ *  \param pretuned_input An input the backend has already tuned to chanid,
+ *                        if the caller has asked, otherwise 0.
+ */
+void TV::ChangeChannel(PlayerContext *ctx, uint chanid, const QString &chan,
+                       uint pretuned_input)
 {
+    MYTH_TRACE_SCOPE("TV::ChangeChannel", "tv_play");
+
     LOG(VB_CHANNEL, LOG_INFO, LOC + QString("(%1, '%2')")
             .arg(chanid).arg(chan));
 
@@ -7760,6 +7789,7 @@ void TV::ChangeChannel(PlayerContext *ctx, uint chanid, const QString &chan)
     QString channum = chan;
     QStringList reclist;
     QSet<uint> tunable_on;
+    bool pretuned = false;
 
     QString oldinputname = ctx->recorder->GetInput();
 
@@ -7831,6 +7861,24 @@ void TV::ChangeChannel(PlayerContext *ctx, uint chanid, const QString &chan)
                     reclist.push_back(*it);
             }
         }
+        else if (db_pretune && kPseudoNormalLiveTV == ctx->pseudoLiveTVState)
+        {
+            // Switching to an input the backend has already tuned to
+            // this channel is quicker than retuning the current one.
+            if (!chanid)
+                chanid = get_chanid(ctx, ctx->GetCardID(), channum);
+            uint inputid = pretuned_input;
+            if (!inputid && chanid)
+                inputid = RemoteGetPreTunedInput(chanid);
+            if (inputid && inputid != ctx->GetCardID())
+            {
+                LOG(VB_CHANNEL, LOG_INFO, LOC +
+                    QString("Input %1 is pre-tuned to %2")
+                    .arg(inputid).arg(channum));
+                reclist.push_back(QString::number(inputid));
+                pretuned = true;
+            }
+        }
     }
 
     if (reclist.size())
@@ -7839,29 +7887,40 @@ void TV::ChangeChannel(PlayerContext *ctx, uint chanid, const QString &chan)
         testrec = RemoteRequestFreeRecorderFromList(reclist, ctx->GetCardID());
         if (!testrec || !testrec->IsValidRecorder())
         {
-            ClearInputQueues(ctx, true);
-            ShowNoRecorderDialog(ctx);
             if (testrec)
                 delete testrec;
-            return;
-        }
 
-        if (!ctx->prevChan.empty() && ctx->prevChan.back() == channum)
-        {
-            // need to remove it if the new channel is the same as the old.
-            ctx->prevChan.pop_back();
+            if (!pretuned)
+            {
+                ClearInputQueues(ctx, true);
+                ShowNoRecorderDialog(ctx);
+                return;
+            }
+
+            // The scheduler has taken the pre-tuned input since we
+            // asked, so tune the current input as usual.
+            LOG(VB_CHANNEL, LOG_INFO, LOC +
+                "Pre-tuned input is no longer free, retuning this one");
         }
+        else
+        {
+            if (!ctx->prevChan.empty() && ctx->prevChan.back() == channum)
+            {
+                // need to remove it if the new channel is the same as the old.
+                ctx->prevChan.pop_back();
+            }
 
-        uint new_cardid = testrec->GetRecorderNumber();
-        uint inputid = new_cardid;
+            uint new_cardid = testrec->GetRecorderNumber();
+            uint inputid = new_cardid;
 
-        // found the card on a different recorder.
-        delete testrec;
-        // Save the current channel if this is the first time
-        if (ctx->prevChan.empty())
-            ctx->PushPreviousChannel();
-        SwitchInputs(ctx, chanid, channum, inputid);
-        return;
+            // found the card on a different recorder.
+            delete testrec;
+            // Save the current channel if this is the first time
+            if (ctx->prevChan.empty())
+                ctx->PushPreviousChannel();
+            SwitchInputs(ctx, chanid, channum, inputid);
+            return;
+        }
     }
 
     if (getit || !ctx->recorder || !ctx->recorder->CheckChannel(channum))
@@ -9680,7 +9739,9 @@ void TV::customEvent(QEvent *e)
     if (message.startsWith("LIVETV_CHAIN"))
     {
         QString id = QString::null;
-        if ((tokens.size() >= 2) && tokens[1] == "UPDATE")
+        if ((tokens.size() >= 3) &&
+            (tokens[1] == "UPDATE" || tokens[1] == "APPEND" ||
+             tokens[1] == "ENDTIME" || tokens[1] == "DELETE"))
             id = tokens[2];
 
         PlayerContext *mctx = GetPlayerReadLock(0, __FILE__, __LINE__);
@@ -9690,7 +9751,7 @@ void TV::customEvent(QEvent *e)
             if (ctx->tvchain && ctx->tvchain->GetID() == id &&
                 find_player_index(ctx) >= 0)
             {
-                ctx->UpdateTVChain(me->ExtraDataList());
+                ctx->UpdateTVChain(me->ExtraDataList(), tokens[1]);
                 break;
             }
         }
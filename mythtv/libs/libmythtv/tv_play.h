@@ -516,7 +516,8 @@ class MTV_PUBLIC TV : public QObject, public MenuItemDisplayer
     void ToggleChannelFavorite(PlayerContext *ctx);
     void ToggleChannelFavorite(PlayerContext*, QString);
     void ChangeChannel(PlayerContext*, ChannelChangeDirection direction);
-    void ChangeChannel(PlayerContext*, uint chanid, const QString &channum);
+    void ChangeChannel(PlayerContext*, uint chanid, const QString &channum,
+                       uint pretuned_input = 0);
 
     void ShowPreviousChannel(PlayerContext*);
     void PopPreviousChannel(PlayerContext*, bool immediate_change);
@@ -799,6 +800,7 @@ class MTV_PUBLIC TV : public QObject, public MenuItemDisplayer
     bool    db_use_channel_groups;
     bool    db_remember_last_channel_group;
     ChannelGroupList db_channel_groups;
+    bool    db_pretune;
 
     CommSkipMode autoCommercialSkip;
     bool    tryUnflaggedSkip;
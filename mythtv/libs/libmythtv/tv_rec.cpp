@@ -1927,6 +1927,12 @@ bool TVRec::SetupDTVSignalMonitor(bool EITscan)
         return true;
     }
 
+    // The tables seen the last time this multiplex was tuned are used
+    // until they are seen again
+    uint mplexid = ChannelUtil::GetMplexID(dtvchan->GetSourceID(),
+                                           dtvchan->GetChannelName());
+    mplexid = (32767 == mplexid) ? 0 : mplexid;
+
     // Check if this is an DVB channel
     int progNum = dtvchan->GetProgramNumber();
     if ((progNum >= 0) && (tuningmode == "dvb") && (genOpt.inputtype != "VBOX"))
@@ -1965,6 +1971,8 @@ bool TVRec::SetupDTVSignalMonitor(bool EITscan)
             sm->IgnoreEncrypted(true);
         }
 
+        sd->ApplyCachedPSI(mplexid);
+
         LOG(VB_RECORD, LOG_INFO, LOC +
             "Successfully set up DVB table monitoring.");
         return true;
@@ -2002,6 +2010,8 @@ bool TVRec::SetupDTVSignalMonitor(bool EITscan)
             sm->IgnoreEncrypted(true);
         }
 
+        sd->ApplyCachedPSI(mplexid);
+
         LOG(VB_RECORD, LOG_INFO, LOC +
             "Successfully set up MPEG table monitoring.");
         return true;
@@ -2696,6 +2706,10 @@ void TVRec::SpawnLiveTV(LiveTVChain *newchain, bool pip, QString startchan)
 
     // Make sure StartRecording can't steal our tuner
     SetFlags(kFlagCancelNextRecording, __FILE__, __LINE__);
+
+    // The frontend reads the new chain from the database as soon as we
+    // reply, before any update to it is pushed
+    LiveTVChain::WaitForWrites();
 }
 
 /** \fn TVRec::GetChainID()
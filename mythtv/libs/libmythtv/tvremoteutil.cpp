@@ -386,6 +386,40 @@ bool RemoteIsBusy(uint inputid, InputInfo &busy_input)
     return state;
 }
 
+/**
+ *  \brief Returns an idle input the master backend has already tuned
+ *         to chanid for LiveTV, or 0 if there isn't one.
+ */
+uint RemoteGetPreTunedInput(uint chanid)
+{
+    QStringList strlist(QString("GET_PRETUNED_INPUT %1").arg(chanid));
+    if (!gCoreContext->SendReceiveStringList(strlist) || strlist.size() < 2)
+        return 0;
+
+    return strlist[0].toUInt();
+}
+
+/**
+ *  \brief Returns an idle input the master backend has already tuned
+ *         to the channel inputid would change to in direction, or 0 if
+ *         there isn't one.
+ *
+ *  \param chanid Set to the channel inputid would change to, the backend
+ *                works it out the same way as changing channel does.
+ */
+uint RemoteGetPreTunedInput(uint inputid, int direction, uint &chanid)
+{
+    chanid = 0;
+
+    QStringList strlist(QString("GET_PRETUNED_INPUT 0 %1 %2")
+                        .arg(inputid).arg(direction));
+    if (!gCoreContext->SendReceiveStringList(strlist) || strlist.size() < 2)
+        return 0;
+
+    chanid = strlist[1].toUInt();
+    return strlist[0].toUInt();
+}
+
 bool RemoteGetRecordingStatus(
     vector<TunerStatus> *tunerList, bool list_inactive)
 {
@@ -48,6 +48,9 @@ RemoteRequestFreeRecorderList(uint excluded_input);
 MTV_PUBLIC vector<uint>
 RemoteRequestFreeInputList(uint excluded_input);
 MTV_PUBLIC bool RemoteIsBusy(uint inputid, InputInfo &busy_input);
+MTV_PUBLIC uint RemoteGetPreTunedInput(uint chanid);
+MTV_PUBLIC uint RemoteGetPreTunedInput(uint inputid, int direction,
+                                       uint &chanid);
 
 MTV_PUBLIC bool RemoteGetRecordingStatus(
     vector<TunerStatus> *tunerList = NULL, bool list_inactive = false);
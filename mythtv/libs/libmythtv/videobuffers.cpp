@@ -131,15 +131,34 @@ YUVInfo::YUVInfo(uint w, uint h, uint sz, const int *p, const int *o,
  *        decoder (in the decode queue) then it is placed in the finished queue
  *        until the decoder is no longer using it (not in the decode queue).
  *
+ *  Every frame carries an ownership tag, a bitmask of the queues it is in,
+ *  which is kept in step by VideoFrameQueue. Moving a frame between queues
+ *  still happens under the VideoBuffers lock, since most transitions touch
+ *  several queues at once, but the queue sizes polled by the decoder and
+ *  display threads (Size(), EnoughFreeFrames() etc.) are read lock-free.
+ *
+ *  The time each frame is released to the used queue is recorded, and the
+ *  age of the frame when StartDisplayingFrame() picks it up is accumulated
+ *  in GetFrameAgeStats(). This is the decode to display latency, and it
+ *  is reset by Init() and ClearAfterSeek().
+ *
  * \see VideoOutput
  */
 
 VideoBuffers::VideoBuffers()
-    : needfreeframes(0), needprebufferframes(0),
+    : available(kVideoBuffer_avail, &frameTags),
+      used(kVideoBuffer_used, &frameTags),
+      limbo(kVideoBuffer_limbo, &frameTags),
+      pause(kVideoBuffer_pause, &frameTags),
+      displayed(kVideoBuffer_displayed, &frameTags),
+      decode(kVideoBuffer_decode, &frameTags),
+      finished(kVideoBuffer_finished, &frameTags),
+      needfreeframes(0), needprebufferframes(0),
       needprebufferframes_normal(0), needprebufferframes_small(0),
       keepprebufferframes(0), createdpauseframe(false), rpos(0), vpos(0),
       global_lock(QMutex::Recursive)
 {
+    ageClock.start();
 }
 
 VideoBuffers::~VideoBuffers()
@@ -175,6 +194,7 @@ void VideoBuffers::Init(uint numdecode, bool extra_for_pause,
     QMutexLocker locker(&global_lock);
 
     Reset();
+    ResetFrameAgeStats();
 
     uint numcreate = numdecode + ((extra_for_pause) ? 1 : 0);
 
@@ -230,6 +250,8 @@ void VideoBuffers::Reset()
     pause.clear();
     displayed.clear();
     vbufferMap.clear();
+    frameTags.clear();
+    releaseTimes.clear();
 }
 
 /**
@@ -325,6 +347,7 @@ void VideoBuffers::ReleaseFrame(VideoFrame *frame)
     if (frame->directrendering != 0)
         decode.enqueue(frame);
     used.enqueue(frame);
+    releaseTimes[frame] = ageClock.nsecsElapsed() / 1000;
 }
 
 /**
@@ -355,7 +378,18 @@ void VideoBuffers::DeLimboFrame(VideoFrame *frame)
 void VideoBuffers::StartDisplayingFrame(void)
 {
     QMutexLocker locker(&global_lock);
-    rpos = vbufferMap[used.head()];
+    VideoFrame *frame = used.head();
+    rpos = vbufferMap[frame];
+
+    frame_time_map_t::iterator it = releaseTimes.find(frame);
+    if (it != releaseTimes.end())
+    {
+        qint64 age = ageClock.nsecsElapsed() / 1000 - it->second;
+        releaseTimes.erase(it);
+        ageStats.count++;
+        ageStats.total_usecs += age;
+        ageStats.max_usecs = max(ageStats.max_usecs, age);
+    }
 }
 
 /**
@@ -395,11 +429,9 @@ void VideoBuffers::DiscardFrame(VideoFrame *frame)
     SafeEnqueue(kVideoBuffer_avail, frame);
 }
 
-frame_queue_t *VideoBuffers::Queue(BufferType type)
+VideoFrameQueue *VideoBuffers::Queue(BufferType type)
 {
-    QMutexLocker locker(&global_lock);
-
-    frame_queue_t *q = NULL;
+    VideoFrameQueue *q = NULL;
 
     if (type == kVideoBuffer_avail)
         q = &available;
@@ -419,11 +451,9 @@ frame_queue_t *VideoBuffers::Queue(BufferType type)
     return q;
 }
 
-const frame_queue_t *VideoBuffers::Queue(BufferType type) const
+const VideoFrameQueue *VideoBuffers::Queue(BufferType type) const
 {
-    QMutexLocker locker(&global_lock);
-
-    const frame_queue_t *q = NULL;
+    const VideoFrameQueue *q = NULL;
 
     if (type == kVideoBuffer_avail)
         q = &available;
@@ -447,7 +477,7 @@ VideoFrame *VideoBuffers::Dequeue(BufferType type)
 {
     QMutexLocker locker(&global_lock);
 
-    frame_queue_t *q = Queue(type);
+    VideoFrameQueue *q = Queue(type);
 
     if (!q)
         return NULL;
@@ -459,7 +489,7 @@ VideoFrame *VideoBuffers::Head(BufferType type)
 {
     QMutexLocker locker(&global_lock);
 
-    frame_queue_t *q = Queue(type);
+    VideoFrameQueue *q = Queue(type);
 
     if (!q)
         return NULL;
@@ -474,7 +504,7 @@ VideoFrame *VideoBuffers::Tail(BufferType type)
 {
     QMutexLocker locker(&global_lock);
 
-    frame_queue_t *q = Queue(type);
+    VideoFrameQueue *q = Queue(type);
 
     if (!q)
         return NULL;
@@ -490,14 +520,12 @@ void VideoBuffers::Enqueue(BufferType type, VideoFrame *frame)
     if (!frame)
         return;
 
-    frame_queue_t *q = Queue(type);
+    VideoFrameQueue *q = Queue(type);
     if (!q)
         return;
 
-    global_lock.lock();
-    q->remove(frame);
+    QMutexLocker locker(&global_lock);
     q->enqueue(frame);
-    global_lock.unlock();
 
     return;
 }
@@ -552,7 +580,7 @@ void VideoBuffers::SafeEnqueue(BufferType dst, VideoFrame* frame)
 frame_queue_t::iterator VideoBuffers::begin_lock(BufferType type)
 {
     global_lock.lock();
-    frame_queue_t *q = Queue(type);
+    VideoFrameQueue *q = Queue(type);
     if (q)
         return q->begin();
     else
@@ -564,7 +592,7 @@ frame_queue_t::iterator VideoBuffers::end(BufferType type)
     QMutexLocker locker(&global_lock);
 
     frame_queue_t::iterator it;
-    frame_queue_t *q = Queue(type);
+    VideoFrameQueue *q = Queue(type);
     if (q)
         it = q->end();
     else
@@ -573,13 +601,16 @@ frame_queue_t::iterator VideoBuffers::end(BufferType type)
     return it;
 }
 
+/**
+ * \fn VideoBuffers::Size(BufferType) const
+ *  Returns the number of frames in a queue. This does not take the
+ *  VideoBuffers lock, so the value may be stale by the time it is used.
+ */
 uint VideoBuffers::Size(BufferType type) const
 {
-    QMutexLocker locker(&global_lock);
-
-    const frame_queue_t *q = Queue(type);
+    const VideoFrameQueue *q = Queue(type);
     if (q)
-        return q->size();
+        return q->AtomicSize();
 
     return 0;
 }
@@ -588,7 +619,7 @@ bool VideoBuffers::Contains(BufferType type, VideoFrame *frame) const
 {
     QMutexLocker locker(&global_lock);
 
-    const frame_queue_t *q = Queue(type);
+    const VideoFrameQueue *q = Queue(type);
     if (q)
         return q->contains(frame);
 
@@ -686,6 +717,8 @@ void VideoBuffers::DiscardFrames(bool next_frame_keyframe)
         available.enqueue(*it);
     decode.clear();
 
+    releaseTimes.clear();
+
     LOG(VB_PLAYBACK, LOG_INFO,
         QString("VideoBuffers::DiscardFrames(%1): %2 -- done")
             .arg(next_frame_keyframe).arg(GetStatus()));
@@ -716,7 +749,12 @@ void VideoBuffers::ClearAfterSeek(void)
         {
             vpos = rpos = 0;
         }
+
+        releaseTimes.clear();
     }
+
+    // Measure the latency afresh from the new position
+    ResetFrameAgeStats();
 }
 
 bool VideoBuffers::CreateBuffers(VideoFrameType type, int width, int height)
@@ -818,6 +856,33 @@ void VideoBuffers::DeleteBuffers()
     for (uint i = 0; i < allocated_arrays.size(); i++)
         av_free(allocated_arrays[i]);
     allocated_arrays.clear();
+
+    VideoFrameAgeStats stats = GetFrameAgeStats();
+    if (stats.count)
+    {
+        LOG(VB_PLAYBACK, LOG_INFO,
+            QString("VideoBuffers: decode to display latency over %1 frames: "
+                    "avg %2 us, max %3 us")
+                .arg(stats.count).arg(stats.AvgUsecs()).arg(stats.max_usecs));
+    }
+}
+
+/**
+ * \fn VideoBuffers::GetFrameAgeStats(void) const
+ *  Returns the decode to display latency accumulated since the last
+ *  ResetFrameAgeStats(), measured from ReleaseFrame() to
+ *  StartDisplayingFrame().
+ */
+VideoFrameAgeStats VideoBuffers::GetFrameAgeStats(void) const
+{
+    QMutexLocker locker(&global_lock);
+    return ageStats;
+}
+
+void VideoBuffers::ResetFrameAgeStats(void)
+{
+    QMutexLocker locker(&global_lock);
+    ageStats = VideoFrameAgeStats();
 }
 
 static unsigned long long to_bitmap(const frame_queue_t& list, int);
@@ -7,6 +7,8 @@
 #include <map>
 using namespace std;
 
+#include <QAtomicInt>
+#include <QElapsedTimer>
 #include <QMutex>
 #include <QString>
 #include <QWaitCondition>
@@ -24,6 +26,8 @@ typedef vector<VideoFrame>                    frame_vector_t;
 typedef map<const unsigned char*, void*>      buffer_map_t;
 typedef map<const VideoFrame*, uint>          vbuffer_map_t;
 typedef map<const VideoFrame*, QMutex*>       frame_lock_map_t;
+typedef map<const VideoFrame*, uint>          frame_tag_map_t;
+typedef map<const VideoFrame*, qint64>        frame_time_map_t;
 typedef vector<unsigned char*>                uchar_vector_t;
 
 
@@ -44,6 +48,94 @@ enum BufferType
     kVideoBuffer_all       = 0x0000003F,
 };
 
+/** \class VideoFrameQueue
+ *  \brief A frame_queue_t that keeps the per-frame ownership tags and
+ *         an atomic element count in step with its contents.
+ *
+ *  Each frame carries a bitmask of the BufferType queues it is in, so
+ *  membership tests are an O(log n) map lookup instead of a linear
+ *  search of the queue. The element
+ *  count can be read without holding the VideoBuffers lock, which lets
+ *  the decoder and display threads poll queue depth without contending
+ *  on it. All mutation must still happen under the VideoBuffers lock.
+ */
+class VideoFrameQueue : public frame_queue_t
+{
+  public:
+    VideoFrameQueue(BufferType type, frame_tag_map_t *tags)
+        : m_type(type), m_tags(tags), m_size(0) {}
+
+    /// \brief Removes frame from the front of the queue and returns it.
+    VideoFrame *dequeue(void)
+    {
+        VideoFrame *frame = frame_queue_t::dequeue();
+        if (frame)
+            Untag(frame);
+        return frame;
+    }
+    /// \brief Adds frame to the back of the queue, moving it there if
+    ///        it is already queued.
+    void enqueue(VideoFrame *frame)
+    {
+        if (contains(frame))
+            frame_queue_t::remove(frame);
+        frame_queue_t::enqueue(frame);
+        (*m_tags)[frame] |= m_type;
+        m_size.fetchAndStoreOrdered(frame_queue_t::size());
+    }
+    /// \brief Removes frame from the queue if present.
+    void remove(VideoFrame *frame)
+    {
+        if (!contains(frame))
+            return;
+        frame_queue_t::remove(frame);
+        Untag(frame);
+    }
+    /// \brief Removes all frames from the queue.
+    void clear(void)
+    {
+        for (iterator it = begin(); it != end(); ++it)
+            (*m_tags)[*it] &= ~m_type;
+        frame_queue_t::clear();
+        m_size.fetchAndStoreOrdered(0);
+    }
+    /// \brief Returns true if frame is in the queue. O(log n).
+    bool contains(VideoFrame *frame) const
+    {
+        frame_tag_map_t::const_iterator it = m_tags->find(frame);
+        return (it != m_tags->end()) && (it->second & m_type);
+    }
+    /// \brief Returns the queue length, safe to call without the lock.
+    uint AtomicSize(void) const { return m_size.loadAcquire(); }
+
+  private:
+    void Untag(VideoFrame *frame)
+    {
+        (*m_tags)[frame] &= ~m_type;
+        m_size.fetchAndStoreOrdered(frame_queue_t::size());
+    }
+
+    uint             m_type;
+    frame_tag_map_t *m_tags;
+    QAtomicInt       m_size;
+};
+
+/// Decode to display latency, sampled when the display thread picks
+/// up a frame from the used queue.
+class MTV_PUBLIC VideoFrameAgeStats
+{
+  public:
+    VideoFrameAgeStats() : count(0), total_usecs(0), max_usecs(0) {}
+
+    qint64 AvgUsecs(void) const
+        { return (count) ? total_usecs / (qint64)count : 0; }
+
+  public:
+    quint64 count;
+    qint64  total_usecs;
+    qint64  max_usecs;
+};
+
 class YUVInfo
 {
   public:
@@ -128,13 +220,17 @@ class MTV_PUBLIC VideoBuffers
     uint AddBuffer(int width, int height, void* data,
                    VideoFrameType fmt);
 
+    VideoFrameAgeStats GetFrameAgeStats(void) const;
+    void ResetFrameAgeStats(void);
+
     QString GetStatus(int n=-1) const; // debugging method
   private:
-    frame_queue_t         *Queue(BufferType type);
-    const frame_queue_t   *Queue(BufferType type) const;
+    VideoFrameQueue       *Queue(BufferType type);
+    const VideoFrameQueue *Queue(BufferType type) const;
     VideoFrame            *GetNextFreeFrameInternal(BufferType enqueue_to);
 
-    frame_queue_t          available, used, limbo, pause, displayed, decode, finished;
+    frame_tag_map_t        frameTags; // must precede the queues
+    VideoFrameQueue        available, used, limbo, pause, displayed, decode, finished;
     vbuffer_map_t          vbufferMap; // videobuffers to buffer's index
     frame_vector_t         buffers;
     uchar_vector_t         allocated_arrays;  // for DeleteBuffers
@@ -149,6 +245,10 @@ class MTV_PUBLIC VideoBuffers
     uint                   rpos;
     uint                   vpos;
 
+    QElapsedTimer          ageClock;
+    frame_time_map_t       releaseTimes; // when frames entered used
+    VideoFrameAgeStats     ageStats;
+
     mutable QMutex         global_lock;
 };
 
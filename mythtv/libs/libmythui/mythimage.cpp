@@ -24,8 +24,6 @@
 #include "mythuihelper.h"
 #include "mythmainwindow.h"
 
-MythUIHelper *MythImage::s_ui = NULL;
-
 MythImage::MythImage(MythPainter *parent, const char *name) :
     ReferenceCounter(name)
 {
@@ -51,8 +49,6 @@ MythImage::MythImage(MythPainter *parent, const char *name) :
     m_FileName = "";
 
     m_cached = false;
-    if (!s_ui)
-        s_ui = GetMythUI();
 }
 
 MythImage::~MythImage()
@@ -63,26 +59,17 @@ MythImage::~MythImage()
 
 int MythImage::IncrRef(void)
 {
-    int cnt = ReferenceCounter::IncrRef();
-    if ((2 == cnt) && s_ui && m_cached)
-        s_ui->ExcludeFromCacheSize(this);
-    return cnt;
+    return ReferenceCounter::IncrRef();
 }
 
 int MythImage::DecrRef(void)
 {
     bool cached = m_cached;
     int cnt = ReferenceCounter::DecrRef();
-    if (cached)
+    if (cached && (0 == cnt))
     {
-        if (s_ui && (1 == cnt))
-            s_ui->IncludeInCacheSize(this);
-
-        if (0 == cnt)
-        {
-            LOG(VB_GENERAL, LOG_INFO,
-                "Image should be removed from cache prior to deletion.");
-        }
+        LOG(VB_GENERAL, LOG_INFO,
+            "Image should be removed from cache prior to deletion.");
     }
     return cnt;
 }
@@ -120,8 +120,6 @@ class MUI_PUBLIC MythImage : public QImage, public ReferenceCounter
     QString m_FileName;
 
     bool m_cached;
-
-    static MythUIHelper *s_ui;
 };
 
 #endif
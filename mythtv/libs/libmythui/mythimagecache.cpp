@@ -0,0 +1,294 @@
+#include "mythimagecache.h"
+
+// libmythbase
+#include "mythlogging.h"
+#include "mythdate.h"
+
+// libmythui
+#include "mythimage.h"
+
+#define LOC      QString("ImageCache: ")
+
+MythImageCache::MythImageCache(int maxBytes)
+    : m_bytes(0), m_maxBytes(maxBytes)
+{
+}
+
+MythImageCache::~MythImageCache()
+{
+    Clear();
+}
+
+int MythImageCache::GetCount(void) const
+{
+    int count = 0;
+
+    for (uint i = 0; i < kShardCount; ++i)
+    {
+        QMutexLocker locker(&m_shards[i].lock);
+        count += m_shards[i].entries.size();
+    }
+
+    return count;
+}
+
+void MythImageCache::Unlink(Shard &shard, Entry *entry)
+{
+    if (entry->prev)
+        entry->prev->next = entry->next;
+    else
+        shard.head = entry->next;
+
+    if (entry->next)
+        entry->next->prev = entry->prev;
+    else
+        shard.tail = entry->prev;
+
+    entry->prev = entry->next = NULL;
+}
+
+void MythImageCache::LinkFirst(Shard &shard, Entry *entry)
+{
+    entry->prev = NULL;
+    entry->next = shard.head;
+
+    if (shard.head)
+        shard.head->prev = entry;
+    else
+        shard.tail = entry;
+
+    shard.head = entry;
+}
+
+/**
+ *  \brief Make entry the most recently used in its shard, and pick up any
+ *         change in its size since it was cached.
+ */
+void MythImageCache::Touch(Shard &shard, Entry *entry)
+{
+    if (shard.head != entry)
+    {
+        Unlink(shard, entry);
+        LinkFirst(shard, entry);
+    }
+
+    int bytes = entry->image->byteCount();
+    if (bytes != entry->bytes)
+    {
+        m_bytes.fetchAndAddOrdered(bytes - entry->bytes);
+        entry->bytes = bytes;
+    }
+}
+
+/// Remove entry from the cache and drop the cache's reference to the image
+void MythImageCache::Release(Shard &shard, Entry *entry)
+{
+    Unlink(shard, entry);
+    shard.entries.remove(entry->key);
+    m_bytes.fetchAndAddOrdered(-entry->bytes);
+
+    entry->image->SetIsInCache(false);
+    entry->image->DecrRef();
+
+    delete entry;
+}
+
+/**
+ *  \brief Release the least recently used image in shard that is not
+ *         referenced outside the cache and isn't keep.
+ *  \return false if there was no such image
+ */
+bool MythImageCache::EvictOne(Shard &shard, const MythImage *keep)
+{
+    QMutexLocker locker(&shard.lock);
+
+    for (Entry *entry = shard.tail; entry; entry = entry->prev)
+    {
+        if (entry->image == keep)
+            continue;
+
+        // Images being displayed would only be loaded again
+        bool unused = (2 == entry->image->IncrRef());
+        entry->image->DecrRef();
+
+        if (!unused)
+            continue;
+
+        LOG(VB_GUI | VB_FILE, LOG_INFO, LOC +
+            QString("Cache too big (%1), removing :%2:")
+            .arg(m_bytes.loadAcquire()).arg(entry->key));
+
+        Release(shard, entry);
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ *  \brief Release unused images until the cache is within its limit, starting
+ *         with the shard that was just added to.  Only one shard is locked at
+ *         a time.
+ */
+void MythImageCache::Evict(uint firstShard, const MythImage *keep)
+{
+    uint exhausted = 0;
+    uint shard     = firstShard;
+
+    while ((m_bytes.loadAcquire() > m_maxBytes.loadAcquire()) &&
+           (exhausted < kShardCount))
+    {
+        if (EvictOne(m_shards[shard], keep))
+            exhausted = 0;
+        else
+        {
+            ++exhausted;
+            shard = (shard + 1) % kShardCount;
+        }
+    }
+}
+
+/**
+ *  \brief Returns the cached image for key, and marks it as just verified
+ *         against its source.
+ */
+MythImage *MythImageCache::Get(const QString &key)
+{
+    Shard &shard = ShardFor(key);
+    QMutexLocker locker(&shard.lock);
+
+    QHash<QString, Entry *>::iterator it = shard.entries.find(key);
+    if (it == shard.entries.end())
+        return NULL;
+
+    Entry *entry = *it;
+    Touch(shard, entry);
+    entry->verified = MythDate::current().toTime_t();
+    entry->image->IncrRef();
+
+    return entry->image;
+}
+
+/**
+ *  \brief Returns the cached image for key, but only if it was verified
+ *         against its source within the last few seconds.
+ */
+MythImage *MythImageCache::GetIfVerified(const QString &key, uint seconds)
+{
+    Shard &shard = ShardFor(key);
+    QMutexLocker locker(&shard.lock);
+
+    QHash<QString, Entry *>::iterator it = shard.entries.find(key);
+    if (it == shard.entries.end())
+        return NULL;
+
+    Entry *entry = *it;
+    if (entry->verified + seconds <= MythDate::current().toTime_t())
+        return NULL;
+
+    Touch(shard, entry);
+    entry->image->IncrRef();
+
+    return entry->image;
+}
+
+/**
+ *  \brief Add im to the cache under key, making room for it if needed.
+ *
+ *  If key is already cached the existing image is kept.
+ *  \return The cached image, without a reference added for the caller
+ */
+MythImage *MythImageCache::Insert(const QString &key, MythImage *im)
+{
+    if (!im)
+        return NULL;
+
+    uint   index = qHash(key) % kShardCount;
+    Shard &shard = m_shards[index];
+
+    {
+        QMutexLocker locker(&shard.lock);
+
+        QHash<QString, Entry *>::iterator it = shard.entries.find(key);
+        if (it != shard.entries.end())
+        {
+            Touch(shard, *it);
+            return (*it)->image;
+        }
+    }
+
+    // Make room before adding, so im itself is never a candidate
+    m_bytes.fetchAndAddOrdered(im->byteCount());
+    Evict(index, im);
+    m_bytes.fetchAndAddOrdered(-im->byteCount());
+
+    QMutexLocker locker(&shard.lock);
+
+    // Another thread may have cached the same image while we were evicting
+    QHash<QString, Entry *>::iterator it = shard.entries.find(key);
+    if (it != shard.entries.end())
+    {
+        Touch(shard, *it);
+        return (*it)->image;
+    }
+
+    Entry *entry    = new Entry;
+    entry->key      = key;
+    entry->image    = im;
+    entry->bytes    = im->byteCount();
+    entry->verified = MythDate::current().toTime_t();
+
+    im->IncrRef();
+    im->SetIsInCache(true);
+
+    shard.entries.insert(key, entry);
+    LinkFirst(shard, entry);
+    m_bytes.fetchAndAddOrdered(entry->bytes);
+
+    return im;
+}
+
+bool MythImageCache::Remove(const QString &key)
+{
+    Shard &shard = ShardFor(key);
+    QMutexLocker locker(&shard.lock);
+
+    QHash<QString, Entry *>::iterator it = shard.entries.find(key);
+    if (it == shard.entries.end())
+        return false;
+
+    Release(shard, *it);
+    return true;
+}
+
+bool MythImageCache::Contains(const QString &key) const
+{
+    Shard &shard = ShardFor(key);
+    QMutexLocker locker(&shard.lock);
+
+    return shard.entries.contains(key);
+}
+
+QStringList MythImageCache::Keys(void) const
+{
+    QStringList keys;
+
+    for (uint i = 0; i < kShardCount; ++i)
+    {
+        QMutexLocker locker(&m_shards[i].lock);
+        keys += m_shards[i].entries.keys();
+    }
+
+    return keys;
+}
+
+void MythImageCache::Clear(void)
+{
+    for (uint i = 0; i < kShardCount; ++i)
+    {
+        QMutexLocker locker(&m_shards[i].lock);
+
+        while (m_shards[i].head)
+            Release(m_shards[i], m_shards[i].head);
+    }
+}
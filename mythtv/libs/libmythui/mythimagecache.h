@@ -0,0 +1,84 @@
+#ifndef MYTHIMAGECACHE_H_
+#define MYTHIMAGECACHE_H_
+
+#include <QAtomicInt>
+#include <QStringList>
+#include <QString>
+#include <QMutex>
+#include <QHash>
+
+class MythImage;
+
+/** \class MythImageCache
+ *  \brief Memory cache of decoded images, keyed on the label generated for
+ *         each filename, size and set of effects.
+ *
+ *  The cache is split into shards by key, each with its own lock and its own
+ *  least recently used list, so image loader threads and the UI thread only
+ *  contend when they want the same shard.  The size of every cached image is
+ *  counted, whether or not it is also being displayed, and when the total
+ *  goes over the limit the least recently used images that nothing else
+ *  holds a reference to are released.
+ *
+ *  Images returned by Get() and GetIfVerified() have had a reference added
+ *  for the caller.
+ */
+class MythImageCache
+{
+  public:
+    explicit MythImageCache(int maxBytes = 30 * 1024 * 1024);
+   ~MythImageCache();
+
+    void SetMaxBytes(int maxBytes) { m_maxBytes.fetchAndStoreRelease(maxBytes); }
+    int  GetMaxBytes(void) const   { return m_maxBytes.loadAcquire(); }
+    int  GetBytes(void) const      { return m_bytes.loadAcquire(); }
+    int  GetCount(void) const;
+
+    MythImage *Get(const QString &key);
+    MythImage *GetIfVerified(const QString &key, uint seconds);
+    MythImage *Insert(const QString &key, MythImage *im);
+    bool       Remove(const QString &key);
+    bool       Contains(const QString &key) const;
+    QStringList Keys(void) const;
+    void       Clear(void);
+
+  private:
+    /// One cached image, linked into its shard's LRU list
+    struct Entry
+    {
+        QString    key;
+        MythImage *image;
+        int        bytes;      ///< byteCount() as last seen by the cache
+        uint       verified;   ///< When the source file was last checked
+        Entry     *prev;       ///< Towards the most recently used
+        Entry     *next;       ///< Towards the least recently used
+    };
+
+    struct Shard
+    {
+        Shard() : head(NULL), tail(NULL) {}
+
+        mutable QMutex          lock;
+        QHash<QString, Entry *> entries;
+        Entry                  *head;  ///< Most recently used
+        Entry                  *tail;  ///< Least recently used
+    };
+
+    static const uint kShardCount = 16;
+
+    Shard &ShardFor(const QString &key) const
+        { return m_shards[qHash(key) % kShardCount]; }
+
+    static void Unlink(Shard &shard, Entry *entry);
+    static void LinkFirst(Shard &shard, Entry *entry);
+    void Touch(Shard &shard, Entry *entry);
+    void Release(Shard &shard, Entry *entry);
+    bool EvictOne(Shard &shard, const MythImage *keep);
+    void Evict(uint firstShard, const MythImage *keep);
+
+    mutable Shard m_shards[kShardCount];
+    QAtomicInt    m_bytes;
+    QAtomicInt    m_maxBytes;
+};
+
+#endif
@@ -2,6 +2,8 @@
 
 #include <math.h>
 
+#include <algorithm>
+
 // QT headers
 #include <QCoreApplication>
 #include <QDomDocument>
@@ -100,6 +102,9 @@ void MythUIButtonList::Const(void)
 
     m_nextItemLoaded = 0;
 
+    m_provider       = NULL;
+    m_providerMargin = -1;
+
     SetCanTakeFocus(true);
 
     connect(this, SIGNAL(TakingFocus()), this, SLOT(Select()));
@@ -108,6 +113,8 @@ void MythUIButtonList::Const(void)
 
 MythUIButtonList::~MythUIButtonList()
 {
+    MythUIImage::CancelPrefetch(this);
+
     m_ButtonToItem.clear();
     m_clearing = true;
 
@@ -154,10 +161,15 @@ void MythUIButtonList::SetActive(bool active)
 
 /*!
  * \copydoc MythUIType::Reset()
+ *
+ * This also drops any provider given with SetProvider(), the list is
+ * left empty until items are added or a provider is set again.
  */
 void MythUIButtonList::Reset()
 {
     m_ButtonToItem.clear();
+    m_providerItems.clear();
+    m_provider = NULL;
 
     if (m_itemList.isEmpty())
         return;
@@ -252,7 +264,7 @@ MythUIGroup *MythUIButtonList::PrepareButton(int buttonIdx, int itemIdx,
 {
     MythUIStateType *realButton;
     MythUIGroup *buttonstate;
-    MythUIButtonListItem *buttonItem = m_itemList[itemIdx];
+    MythUIButtonListItem *buttonItem = ItemAt(itemIdx);
 
     buttonIdx += button_shift;
 
@@ -1349,8 +1361,8 @@ void MythUIButtonList::CalculateButtonPositions(void)
         }
     }
 
-    QList<MythUIButtonListItem *>::iterator it = m_itemList.begin() +
-                                                 m_topPosition;
+    // Items are looked up by position, with a provider most have no item
+    int curItem = m_topPosition;
 
     if (m_scrollStyle == ScrollCenter || m_scrollStyle == ScrollGroupCenter)
     {
@@ -1361,13 +1373,13 @@ void MythUIButtonList::CalculateButtonPositions(void)
             if (m_wrapStyle == WrapItems && button > 0 &&
                 m_itemCount >= (int)m_itemsVisible)
             {
-                it = m_itemList.end() - button;
+                curItem = m_itemCount - button;
                 button = 0;
             }
         }
         else if ((m_itemCount - m_selPosition) < (int)(m_itemsVisible / 2))
         {
-            it = m_itemList.begin() + m_selPosition - (m_itemsVisible / 2);
+            curItem = m_selPosition - (m_itemsVisible / 2);
         }
     }
     else if (m_drawFromBottom && m_itemCount < (int)m_itemsVisible)
@@ -1381,15 +1393,16 @@ void MythUIButtonList::CalculateButtonPositions(void)
     MythUIStateType *realButton = NULL;
     MythUIButtonListItem *buttonItem = NULL;
 
-    if (it < m_itemList.begin())
-        it = m_itemList.begin();
+    if (curItem < 0)
+        curItem = 0;
 
-    int curItem = it < m_itemList.end() ? GetItemPos(*it) : 0;
+    int firstItem = curItem;
+    int firstButton = button;
 
-    while (it < m_itemList.end() && button < (int)m_itemsVisible)
+    while (curItem < m_itemCount && button < (int)m_itemsVisible)
     {
         realButton = m_ButtonList[button];
-        buttonItem = *it;
+        buttonItem = ItemAt(curItem);
 
         if (!realButton || !buttonItem)
             break;
@@ -1406,25 +1419,85 @@ void MythUIButtonList::CalculateButtonPositions(void)
         buttonItem->SetToRealButton(realButton, selected);
         realButton->SetVisible(true);
 
-        if (m_wrapStyle == WrapItems && it == (m_itemList.end() - 1) &&
+        if (m_wrapStyle == WrapItems && curItem == m_itemCount - 1 &&
             m_itemCount >= (int)m_itemsVisible)
         {
-            it = m_itemList.begin();
             curItem = 0;
         }
         else
         {
-            ++it;
             ++curItem;
         }
 
         ++button;
     }
 
+    PrefetchImages(firstItem, button - firstButton);
+
     for (; button < (int)m_itemsVisible; ++button)
         m_ButtonList[button]->SetVisible(false);
 }
 
+/**
+ *  \brief Start loading the images of the items a page either side of the
+ *         itemCount items shown from firstItem, nearest first, so they are
+ *         in the image cache before they are scrolled into view.
+ */
+void MythUIButtonList::PrefetchImages(int firstItem, int itemCount)
+{
+    MythUIImage::CancelPrefetch(this);
+
+    if (m_ButtonList.isEmpty() || itemCount <= 0 || itemCount >= m_itemCount)
+        return;
+
+    // Items take their images from widgets copied from the same template,
+    // so any button can stand in for the one the item will end up in
+    QString state = m_active ? "active" : "inactive";
+    if (!m_ButtonList[0]->GetState(state))
+        state = "active";
+
+    MythUIGroup *buttonstate = dynamic_cast<MythUIGroup *>
+                               (m_ButtonList[0]->GetState(state));
+    if (!buttonstate)
+        return;
+
+    for (int distance = 1; distance <= itemCount; ++distance)
+    {
+        int positions[2] = { firstItem + itemCount - 1 + distance,
+                             firstItem - distance };
+
+        for (int i = 0; i < 2; ++i)
+        {
+            int pos = positions[i];
+
+            if (m_wrapStyle == WrapItems)
+                pos = (pos + m_itemCount) % m_itemCount;
+            else if (pos < 0 || pos >= m_itemCount)
+                continue;
+
+            MythUIButtonListItem *item = ItemAt(pos);
+            int priority = itemCount - distance;
+
+            if (!item->m_imageFilename.isEmpty())
+            {
+                MythUIImage *image = dynamic_cast<MythUIImage *>
+                                     (buttonstate->GetChild("buttonimage"));
+                if (image)
+                    image->Prefetch(item->m_imageFilename, this, priority);
+            }
+
+            InfoMap::const_iterator it = item->m_imageFilenames.begin();
+            for (; it != item->m_imageFilenames.end(); ++it)
+            {
+                MythUIImage *image = dynamic_cast<MythUIImage *>
+                                     (buttonstate->GetChild(it.key()));
+                if (image)
+                    image->Prefetch(it.value(), this, priority);
+            }
+        }
+    }
+}
+
 void MythUIButtonList::SanitizePosition(void)
 {
     if (m_selPosition < 0)
@@ -1464,6 +1537,9 @@ void MythUIButtonList::CalculateArrowStates()
     else
         DistributeButtons();
 
+    if (m_provider)
+        ReleaseItems();
+
     updateLCD();
 
     m_needsUpdate = false;
@@ -1501,6 +1577,13 @@ void MythUIButtonList::ItemVisible(MythUIButtonListItem *item)
 
 void MythUIButtonList::InsertItem(MythUIButtonListItem *item, int listPosition)
 {
+    if (m_provider)
+    {
+        LOG(VB_GENERAL, LOG_ERR, "MythUIButtonList: Items can't be added to a "
+            "list with a provider, add them to the provider instead");
+        return;
+    }
+
     bool wasEmpty = m_itemList.isEmpty();
 
     if (listPosition >= 0 && listPosition <= m_itemList.count())
@@ -1538,6 +1621,26 @@ void MythUIButtonList::RemoveItem(MythUIButtonListItem *item)
     if (curIndex == -1)
         return;
 
+    // The provider's entry stays, only its item goes, to be recreated by
+    // ItemAt() when it is next needed
+    if (m_provider)
+    {
+        m_itemList[curIndex] = NULL;
+        m_providerItems.remove(curIndex);
+
+        QMap<int, MythUIButtonListItem*>::iterator bit = m_ButtonToItem.begin();
+        while (bit != m_ButtonToItem.end())
+        {
+            if (bit.value() == item)
+                bit = m_ButtonToItem.erase(bit);
+            else
+                ++bit;
+        }
+
+        Update();
+        return;
+    }
+
     QMap<int, MythUIButtonListItem*>::iterator it = m_ButtonToItem.begin();
     while (it != m_ButtonToItem.end())
     {
@@ -1569,7 +1672,7 @@ void MythUIButtonList::RemoveItem(MythUIButtonListItem *item)
     Update();
 
     if (m_selPosition < m_itemCount)
-        emit itemSelected(m_itemList.at(m_selPosition));
+        emit itemSelected(ItemAt(m_selPosition));
     else
         emit itemSelected(NULL);
 
@@ -1577,6 +1680,169 @@ void MythUIButtonList::RemoveItem(MythUIButtonListItem *item)
         emit DependChanged(true);
 }
 
+/**
+ *  \brief Show the entries of provider instead of items added to the list.
+ *
+ *  Any items already in the list, and any previous provider, are dropped
+ *  as by Reset(); calling Reset() later drops this provider too. Items are
+ *  then only created, and filled in by the provider, for the entries that
+ *  are shown plus margin entries either side, or a page either side if
+ *  margin is negative. The list doesn't take ownership of the provider.
+ */
+void MythUIButtonList::SetProvider(MythUIButtonListProvider *provider,
+                                   int margin)
+{
+    Reset();
+
+    m_provider       = provider;
+    m_providerMargin = margin;
+
+    ReloadProvider(0);
+}
+
+/**
+ *  \brief Pick up a change to the provider's entries, e.g. after sorting or
+ *         filtering. Items are recreated as they are needed.
+ *
+ *  \param selectPos The entry to select, -1 to stay at the same position
+ */
+void MythUIButtonList::ReloadProvider(int selectPos)
+{
+    if (!m_provider)
+        return;
+
+    ReleaseItems(true);
+
+    bool wasEmpty = IsEmpty();
+
+    int count = m_provider->GetItemCount();
+
+    m_itemList.clear();
+    m_itemList.reserve(count);
+    for (int i = 0; i < count; ++i)
+        m_itemList.append(NULL);
+
+    m_itemCount = count;
+
+    if (selectPos >= 0)
+        m_selPosition = selectPos;
+
+    if (m_selPosition >= m_itemCount)
+        m_selPosition = qMax(m_itemCount - 1, 0);
+
+    if (m_topPosition > m_selPosition)
+        m_topPosition = m_selPosition;
+
+    Update();
+
+    emit itemSelected(GetItemCurrent());
+
+    if (wasEmpty != IsEmpty())
+        emit DependChanged(IsEmpty());
+}
+
+/**
+ *  \brief Select the first entry whose text starts with prefix, e.g. to jump
+ *         to a letter. Uses the provider's index if it has one.
+ */
+bool MythUIButtonList::JumpToPrefix(const QString &prefix)
+{
+    if (prefix.isEmpty() || IsEmpty())
+        return false;
+
+    int pos = MythUIButtonListProvider::kFindUnsupported;
+
+    if (m_provider)
+        pos = m_provider->FindPrefix(prefix);
+
+    if (pos == MythUIButtonListProvider::kFindUnsupported)
+    {
+        pos = -1;
+
+        for (int i = 0; i < m_itemCount && pos < 0; ++i)
+        {
+            if (ItemAt(i)->GetText().startsWith(prefix, Qt::CaseInsensitive))
+                pos = i;
+        }
+    }
+
+    if (pos < 0 || pos >= m_itemCount)
+        return false;
+
+    SetItemCurrent(pos);
+    return true;
+}
+
+/**
+ *  \brief Returns the item at pos, which must be a valid position. With a
+ *         provider the item is created and filled in when first needed.
+ */
+MythUIButtonListItem *MythUIButtonList::ItemAt(int pos) const
+{
+    MythUIButtonListItem *item = m_itemList.at(pos);
+
+    if (!item && m_provider)
+    {
+        item = new MythUIButtonListItem(const_cast<MythUIButtonList *>(this));
+        m_itemList[pos] = item;
+        m_providerItems.insert(pos);
+        m_provider->FillItem(item, pos);
+    }
+
+    return item;
+}
+
+/**
+ *  \brief Delete the items a provider list no longer needs, those more than
+ *         the margin away from what is shown. Nothing is deleted until there
+ *         are twice as many items as that, so scrolling back and forth
+ *         doesn't keep recreating the same ones.
+ *
+ *  \param all Delete every item, shown or not
+ */
+void MythUIButtonList::ReleaseItems(bool all)
+{
+    int margin = (m_providerMargin < 0) ? (int)m_itemsVisible
+                                        : m_providerMargin;
+    int first  = m_topPosition - margin;
+    int last   = m_topPosition + (int)m_itemsVisible + margin;
+
+    if (!all && m_providerItems.size() <= 2 * (last - first + 1))
+        return;
+
+    QSet<MythUIButtonListItem *> shown;
+    if (!all)
+    {
+        QMap<int, MythUIButtonListItem *>::const_iterator bit =
+            m_ButtonToItem.constBegin();
+        for (; bit != m_ButtonToItem.constEnd(); ++bit)
+            shown.insert(bit.value());
+    }
+    else
+        m_ButtonToItem.clear();
+
+    QSet<int>::iterator it = m_providerItems.begin();
+    while (it != m_providerItems.end())
+    {
+        int pos = *it;
+        MythUIButtonListItem *item = m_itemList[pos];
+
+        if (!all && ((pos >= first && pos <= last) ||
+                     pos == m_selPosition || shown.contains(item)))
+        {
+            ++it;
+            continue;
+        }
+
+        m_itemList[pos] = NULL;
+        it = m_providerItems.erase(it);
+
+        // Already out of the list, don't let it remove itself
+        item->m_parent = NULL;
+        delete item;
+    }
+}
+
 void MythUIButtonList::SetValueByData(QVariant data)
 {
     if (!m_initialized)
@@ -1584,11 +1850,11 @@ void MythUIButtonList::SetValueByData(QVariant data)
 
     for (int i = 0; i < m_itemList.size(); ++i)
     {
-        MythUIButtonListItem *item = m_itemList.at(i);
+        MythUIButtonListItem *item = ItemAt(i);
 
         if (item->GetData() == data)
         {
-            SetItemCurrent(item);
+            SetItemCurrent(i);
             return;
         }
     }
@@ -1608,7 +1874,7 @@ void MythUIButtonList::SetItemCurrent(int current, int topPosition)
     if (current == -1 || current >= m_itemList.size())
         return;
 
-    if (!m_itemList.at(current)->isEnabled())
+    if (!ItemAt(current)->isEnabled())
         return;
 
     if (current == m_selPosition &&
@@ -1633,7 +1899,7 @@ MythUIButtonListItem *MythUIButtonList::GetItemCurrent() const
         m_selPosition < 0)
         return NULL;
 
-    return m_itemList.at(m_selPosition);
+    return ItemAt(m_selPosition);
 }
 
 int MythUIButtonList::GetIntValue() const
@@ -1676,7 +1942,7 @@ MythRect MythUIButtonList::GetButtonArea(void) const
 MythUIButtonListItem *MythUIButtonList::GetItemFirst() const
 {
     if (!m_itemList.empty())
-        return m_itemList[0];
+        return ItemAt(0);
 
     return NULL;
 }
@@ -1684,12 +1950,12 @@ MythUIButtonListItem *MythUIButtonList::GetItemFirst() const
 MythUIButtonListItem *MythUIButtonList::GetItemNext(MythUIButtonListItem *item)
 const
 {
-    QListIterator<MythUIButtonListItem *> it(m_itemList);
+    int pos = GetItemPos(item);
 
-    if (!it.findNext(item))
-        return 0;
+    if (pos < 0)
+        return NULL;
 
-    return it.previous();
+    return GetItemAt(pos + 1);
 }
 
 int MythUIButtonList::GetCount() const
@@ -1721,7 +1987,7 @@ MythUIButtonListItem *MythUIButtonList::GetItemAt(int pos) const
     if (pos < 0 || pos >= m_itemList.size())
         return NULL;
 
-    return m_itemList.at(pos);
+    return ItemAt(pos);
 }
 
 MythUIButtonListItem *MythUIButtonList::GetItemByData(QVariant data)
@@ -1731,7 +1997,7 @@ MythUIButtonListItem *MythUIButtonList::GetItemByData(QVariant data)
 
     for (int i = 0; i < m_itemList.size(); ++i)
     {
-        MythUIButtonListItem *item = m_itemList.at(i);
+        MythUIButtonListItem *item = ItemAt(i);
 
         if (item->GetData() == data)
             return item;
@@ -1751,7 +2017,7 @@ int MythUIButtonList::GetItemPos(MythUIButtonListItem *item) const
 void MythUIButtonList::InitButton(int itemIdx, MythUIStateType* & realButton,
                                   MythUIButtonListItem* & buttonItem)
 {
-    buttonItem = m_itemList[itemIdx];
+    buttonItem = ItemAt(itemIdx);
 
     if (m_maxVisible == 0)
     {
@@ -2107,7 +2373,7 @@ bool MythUIButtonList::MoveUp(MovementUnit unit, uint amount)
 void MythUIButtonList::FindEnabledDown(MovementUnit unit)
 {
     if (m_selPosition < 0 || m_selPosition >= m_itemList.size() ||
-        m_itemList.at(m_selPosition)->isEnabled())
+        ItemAt(m_selPosition)->isEnabled())
         return;
 
     int step = (unit == MoveRow) ? m_columns : 1;
@@ -2117,32 +2383,32 @@ void MythUIButtonList::FindEnabledDown(MovementUnit unit)
     {
         while (m_selPosition < m_itemList.size() &&
                (m_selPosition + 1) % m_columns > 0 &&
-               !m_itemList.at(m_selPosition)->isEnabled())
+               !ItemAt(m_selPosition)->isEnabled())
             ++m_selPosition;
 
-        if (m_itemList.at(m_selPosition)->isEnabled())
+        if (ItemAt(m_selPosition)->isEnabled())
             return;
 
         if (m_wrapStyle > WrapNone)
         {
             m_selPosition = m_selPosition - (m_columns - 1);
             while ((m_selPosition + 1) % m_columns > 0 &&
-                   !m_itemList.at(m_selPosition)->isEnabled())
+                   !ItemAt(m_selPosition)->isEnabled())
                 ++m_selPosition;
         }
     }
     else
     {
-        while (!m_itemList.at(m_selPosition)->isEnabled() &&
+        while (!ItemAt(m_selPosition)->isEnabled() &&
                (m_selPosition < m_itemList.size() - step))
             m_selPosition += step;
 
-        if (!m_itemList.at(m_selPosition)->isEnabled() &&
+        if (!ItemAt(m_selPosition)->isEnabled() &&
             m_wrapStyle > WrapNone)
         {
             m_selPosition = (m_selPosition + step) % m_itemList.size();
 
-            while (!m_itemList.at(m_selPosition)->isEnabled() &&
+            while (!ItemAt(m_selPosition)->isEnabled() &&
                    (m_selPosition < m_itemList.size() - step))
                 m_selPosition += step;
         }
@@ -2152,7 +2418,7 @@ void MythUIButtonList::FindEnabledDown(MovementUnit unit)
 void MythUIButtonList::FindEnabledUp(MovementUnit unit)
 {
     if (m_selPosition < 0 || m_selPosition >= m_itemList.size() ||
-        m_itemList.at(m_selPosition)->isEnabled())
+        ItemAt(m_selPosition)->isEnabled())
         return;
 
     int step = (unit == MoveRow) ? m_columns : 1;
@@ -2161,33 +2427,33 @@ void MythUIButtonList::FindEnabledUp(MovementUnit unit)
     if (unit == MoveColumn)
     {
         while (m_selPosition > 0 && (m_selPosition - 1) % m_columns > 0 &&
-               !m_itemList.at(m_selPosition)->isEnabled())
+               !ItemAt(m_selPosition)->isEnabled())
             --m_selPosition;
 
-        if (m_itemList.at(m_selPosition)->isEnabled())
+        if (ItemAt(m_selPosition)->isEnabled())
             return;
 
         if (m_wrapStyle > WrapNone)
         {
             m_selPosition = m_selPosition + (m_columns - 1);
             while ((m_selPosition - 1) % m_columns > 0 &&
-                   !m_itemList.at(m_selPosition)->isEnabled())
+                   !ItemAt(m_selPosition)->isEnabled())
                 --m_selPosition;
         }
     }
     else
     {
-        while (!m_itemList.at(m_selPosition)->isEnabled() &&
+        while (!ItemAt(m_selPosition)->isEnabled() &&
                (m_selPosition - step >= 0))
             m_selPosition -= step;
 
-        if (!m_itemList.at(m_selPosition)->isEnabled() &&
+        if (!ItemAt(m_selPosition)->isEnabled() &&
             m_wrapStyle > WrapNone)
         {
             m_selPosition = m_itemList.size() - 1;
 
             while (m_selPosition > 0 &&
-                   !m_itemList.at(m_selPosition)->isEnabled() &&
+                   !ItemAt(m_selPosition)->isEnabled() &&
                    (m_selPosition - step >= 0))
                 m_selPosition -= step;
         }
@@ -2312,18 +2578,14 @@ bool MythUIButtonList::MoveToNamedPosition(const QString &position_name)
 
     bool found_it = false;
     int selectedPosition = 0;
-    QList<MythUIButtonListItem *>::iterator it = m_itemList.begin();
 
-    while (it != m_itemList.end())
+    for (; selectedPosition < m_itemCount; ++selectedPosition)
     {
-        if ((*it)->GetText() == position_name)
+        if (ItemAt(selectedPosition)->GetText() == position_name)
         {
             found_it = true;
             break;
         }
-
-        ++it;
-        ++selectedPosition;
     }
 
     if (!found_it || m_selPosition == selectedPosition)
@@ -2335,7 +2597,8 @@ bool MythUIButtonList::MoveToNamedPosition(const QString &position_name)
 
 bool MythUIButtonList::MoveItemUpDown(MythUIButtonListItem *item, bool up)
 {
-    if (GetItemCurrent() != item)
+    // The order of a provider's entries is up to the provider
+    if (m_provider || GetItemCurrent() != item)
         return false;
 
     if (item == m_itemList.first() && up)
@@ -2357,7 +2620,7 @@ bool MythUIButtonList::MoveItemUpDown(MythUIButtonListItem *item, bool up)
         else
             ++m_selPosition;
 
-        if (item == m_itemList.at(m_topPosition))
+        if (item == ItemAt(m_topPosition))
             ++m_topPosition;
     }
     else
@@ -2381,10 +2644,8 @@ bool MythUIButtonList::MoveItemUpDown(MythUIButtonListItem *item, bool up)
 
 void MythUIButtonList::SetAllChecked(MythUIButtonListItem::CheckState state)
 {
-    QMutableListIterator<MythUIButtonListItem *> it(m_itemList);
-
-    while (it.hasNext())
-        it.next()->setChecked(state);
+    for (int i = 0; i < m_itemCount; ++i)
+        ItemAt(i)->setChecked(state);
 }
 
 void MythUIButtonList::Init()
@@ -3203,6 +3464,21 @@ bool MythUIButtonList::DoFind(bool doMove, bool searchForward)
         }
     }
 
+    if (m_provider)
+    {
+        int pos = m_provider->Find(m_searchStr, m_searchFields,
+                                   m_searchStartsWith, currPos, searchForward);
+
+        if (pos >= 0 && pos < m_itemCount)
+        {
+            SetItemCurrent(pos);
+            return true;
+        }
+
+        if (pos != MythUIButtonListProvider::kFindUnsupported)
+            return false;
+    }
+
     while (true)
     {
         found = GetItemAt(currPos)->FindText(m_searchStr, m_searchFields, m_searchStartsWith);
@@ -3235,6 +3511,95 @@ bool MythUIButtonList::DoFind(bool doMove, bool searchForward)
     return false;
 }
 
+/// Orders positions in a MythUIButtonListIndex by their text
+class MythUIButtonListIndexLess
+{
+  public:
+    explicit MythUIButtonListIndexLess(const QStringList &texts)
+        : m_texts(texts) {}
+
+    bool operator()(int a, int b) const
+        { return m_texts[a] < m_texts[b]; }
+    bool operator()(int a, const QString &text) const
+        { return m_texts[a] < text; }
+
+  private:
+    const QStringList &m_texts;
+};
+
+void MythUIButtonListIndex::Build(const QStringList &texts)
+{
+    m_texts.clear();
+    m_texts.reserve(texts.size());
+
+    for (int i = 0; i < texts.size(); ++i)
+        m_texts.append(texts[i].toLower());
+
+    m_sorted.resize(m_texts.size());
+    for (int i = 0; i < m_sorted.size(); ++i)
+        m_sorted[i] = i;
+
+    std::stable_sort(m_sorted.begin(), m_sorted.end(),
+                     MythUIButtonListIndexLess(m_texts));
+}
+
+void MythUIButtonListIndex::Clear(void)
+{
+    m_texts.clear();
+    m_sorted.clear();
+}
+
+/**
+ *  \brief Position of the first entry from start, in the given direction and
+ *         wrapping at the ends, that contains or starts with searchStr, or -1
+ */
+int MythUIButtonListIndex::Find(const QString &searchStr, bool startsWith,
+                                int start, bool forward) const
+{
+    int count = m_texts.size();
+
+    if (searchStr.isEmpty() || count == 0)
+        return -1;
+
+    QString needle = searchStr.toLower();
+    int pos = qBound(0, start, count - 1);
+
+    for (int i = 0; i < count; ++i)
+    {
+        const QString &text = m_texts[pos];
+
+        if (startsWith ? text.startsWith(needle) : text.contains(needle))
+            return pos;
+
+        pos = forward ? (pos + 1) % count : (pos + count - 1) % count;
+    }
+
+    return -1;
+}
+
+/**
+ *  \brief Position of the first entry in the list that starts with prefix,
+ *         or -1. The entries with that prefix are found by binary search.
+ */
+int MythUIButtonListIndex::FindPrefix(const QString &prefix) const
+{
+    QString needle = prefix.toLower();
+
+    QVector<int>::const_iterator it =
+        std::lower_bound(m_sorted.begin(), m_sorted.end(), needle,
+                         MythUIButtonListIndexLess(m_texts));
+
+    int pos = -1;
+
+    for (; it != m_sorted.end() && m_texts[*it].startsWith(needle); ++it)
+    {
+        if (pos < 0 || *it < pos)
+            pos = *it;
+    }
+
+    return pos;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 
 MythUIButtonListItem::MythUIButtonListItem(MythUIButtonList *lbtype,
@@ -3286,6 +3651,18 @@ MythUIButtonListItem::MythUIButtonListItem(MythUIButtonList *lbtype,
         m_parent->InsertItem(this, listPosition);
 }
 
+MythUIButtonListItem::MythUIButtonListItem(MythUIButtonList *lbtype)
+{
+    m_parent    = lbtype;
+    m_image     = NULL;
+
+    m_checkable = false;
+    m_state     = CantCheck;
+    m_showArrow = false;
+    m_isVisible = false;
+    m_enabled   = true;
+}
+
 MythUIButtonListItem::~MythUIButtonListItem()
 {
     if (m_parent)
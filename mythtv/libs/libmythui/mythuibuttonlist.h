@@ -3,8 +3,11 @@
 
 #include <QList>
 #include <QHash>
+#include <QSet>
 #include <QString>
+#include <QStringList>
 #include <QVariant>
+#include <QVector>
 
 #include "mythuitype.h"
 #include "mythscreentype.h"
@@ -106,6 +109,9 @@ class MUI_PUBLIC MythUIButtonListItem
     virtual void SetToRealButton(MythUIStateType *button, bool selected);
 
   protected:
+    /// Creates an item for a list with a provider, which places the item
+    explicit MythUIButtonListItem(MythUIButtonList *lbtype);
+
     MythUIButtonList *m_parent;
     QString         m_text;
     QString         m_fontState;
@@ -127,6 +133,85 @@ class MUI_PUBLIC MythUIButtonListItem
     friend class MythGenericTree;
 };
 
+/**
+ * \class MythUIButtonListProvider
+ *
+ * \brief Supplies the items of a MythUIButtonList as they are needed
+ *
+ * A list given a provider with MythUIButtonList::SetProvider() only creates
+ * items for the entries that are shown, plus a margin either side, and asks
+ * the provider to fill each one in when it is created. Items that scroll
+ * well out of view are deleted again, so opening a list of 50,000 entries
+ * costs about the same as opening one of 50.
+ *
+ * Item pointers from such a list are only good until the list next moves,
+ * keep positions instead. Call MythUIButtonList::ReloadProvider() whenever
+ * the entries change, e.g. after sorting or filtering.
+ */
+class MUI_PUBLIC MythUIButtonListProvider
+{
+  public:
+    /// Returned by Find() and FindPrefix() if the provider can't search
+    static const int kFindUnsupported = -2;
+
+    virtual ~MythUIButtonListProvider() { }
+
+    /// Number of entries in the list
+    virtual int  GetItemCount(void) const = 0;
+
+    /// Set the text, images, data and so on of item, a new empty item, from
+    /// the entry at pos
+    virtual void FillItem(MythUIButtonListItem *item, int pos) = 0;
+
+    /**
+     *  \brief Search the entries without creating items for them.
+     *
+     *  \param fieldList As for MythUIButtonListItem::FindText()
+     *  \param start     Entry to start at, it is the first one checked
+     *  \param forward   Direction to search in, wrapping at the ends
+     *  \return Position of the first match, -1 if there is none, or
+     *          kFindUnsupported to have the list check every item.
+     */
+    virtual int  Find(const QString &searchStr, const QString &fieldList,
+                      bool startsWith, int start, bool forward)
+    {
+        (void)searchStr; (void)fieldList; (void)startsWith;
+        (void)start; (void)forward;
+        return kFindUnsupported;
+    }
+
+    /// Position of the first entry whose text starts with prefix, used to
+    /// jump to a letter. -1 if there is none.
+    virtual int  FindPrefix(const QString &prefix)
+    {
+        return Find(prefix, QString(), true, 0, true);
+    }
+};
+
+/**
+ * \class MythUIButtonListIndex
+ *
+ * \brief Searchable copy of the text of each entry of a list, for providers
+ *
+ * Finding a prefix is a binary search, finding text anywhere in an entry
+ * scans the copies, neither needs an item for every entry.
+ */
+class MUI_PUBLIC MythUIButtonListIndex
+{
+  public:
+    void Build(const QStringList &texts);
+    void Clear(void);
+    int  Count(void) const { return m_texts.size(); }
+
+    int  Find(const QString &searchStr, bool startsWith, int start,
+              bool forward) const;
+    int  FindPrefix(const QString &prefix) const;
+
+  private:
+    QStringList  m_texts;   ///< Lower case text of each entry, by position
+    QVector<int> m_sorted;  ///< Positions in order of their text
+};
+
 /**
  * \class MythUIButtonList
  *
@@ -196,6 +281,11 @@ class MUI_PUBLIC MythUIButtonList : public MythUIType
 
     void RemoveItem(MythUIButtonListItem *item);
 
+    void SetProvider(MythUIButtonListProvider *provider, int margin = -1);
+    MythUIButtonListProvider *GetProvider(void) const { return m_provider; }
+    void ReloadProvider(int selectPos = -1);
+    bool JumpToPrefix(const QString &prefix);
+
     void SetLCDTitles(const QString &title, const QString &columnList = "");
     void updateLCD(void);
 
@@ -232,6 +322,9 @@ class MUI_PUBLIC MythUIButtonList : public MythUIType
 
     void InsertItem(MythUIButtonListItem *item, int listPosition = -1);
 
+    MythUIButtonListItem *ItemAt(int pos) const;
+    void ReleaseItems(bool all = false);
+
     int minButtonWidth(const MythRect & area);
     int minButtonHeight(const MythRect & area);
     void InitButton(int itemIdx, MythUIStateType* & realButton,
@@ -254,6 +347,7 @@ class MUI_PUBLIC MythUIButtonList : public MythUIType
                         bool & wrapped);
     bool DistributeButtons(void);
     void CalculateButtonPositions(void);
+    void PrefetchImages(int firstItem, int itemCount);
     void CalculateArrowStates(void);
     void SetScrollBarPosition(void);
     void ItemVisible(MythUIButtonListItem *item);
@@ -330,9 +424,14 @@ class MUI_PUBLIC MythUIButtonList : public MythUIType
     int m_itemCount;
     bool m_keepSelAtBottom;
 
-    QList<MythUIButtonListItem*> m_itemList;
+    // With a provider, entries without an item yet are NULL
+    mutable QList<MythUIButtonListItem*> m_itemList;
     int m_nextItemLoaded;
 
+    MythUIButtonListProvider *m_provider;
+    int                       m_providerMargin;
+    mutable QSet<int>         m_providerItems; ///< Positions with an item
+
     bool m_drawFromBottom;
 
     QString     m_lcdTitle;
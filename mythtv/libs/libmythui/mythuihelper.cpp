@@ -35,6 +35,7 @@
 // mythui headers
 #include "mythprogressdialog.h"
 #include "mythimage.h"
+#include "mythimagecache.h"
 #include "screensaver.h"
 #include "mythmainwindow.h"
 #include "themeinfo.h"
@@ -124,12 +125,7 @@ public:
     int m_baseWidth, m_baseHeight;
     bool m_isWide;
 
-    QMap<QString, MythImage *> imageCache;
-    QMap<QString, uint> CacheTrack;
-    QMutex *m_cacheLock;
-
-    QAtomicInt m_cacheSize;
-    QAtomicInt m_maxCacheSize;
+    MythImageCache imageCache;
 
     // The part of the screen(s) allocated for the GUI. Unless
     // overridden by the user, defaults to drawable area above.
@@ -173,8 +169,6 @@ MythUIHelperPrivate::MythUIHelperPrivate(MythUIHelper *p)
       m_wmult(1.0), m_hmult(1.0), m_pixelAspectRatio(-1.0),
       m_xbase(0), m_ybase(0), m_height(0), m_width(0),
       m_baseWidth(800), m_baseHeight(600), m_isWide(false),
-      m_cacheLock(new QMutex(QMutex::Recursive)),
-      m_cacheSize(0), m_maxCacheSize(30 * 1024 * 1024),
       m_screenxbase(0), m_screenybase(0), m_screenwidth(0), m_screenheight(0),
       screensaver(NULL), screensaverEnabled(false), display_res(NULL),
       screenSetup(false), m_imageThreadPool(new MThreadPool("MythUIHelper")),
@@ -189,19 +183,8 @@ MythUIHelperPrivate::MythUIHelperPrivate(MythUIHelper *p)
 
 MythUIHelperPrivate::~MythUIHelperPrivate()
 {
-    QMutableMapIterator<QString, MythImage *> i(imageCache);
-
-    while (i.hasNext())
-    {
-        i.next();
-        i.value()->SetIsInCache(false);
-        i.value()->DecrRef();
-        i.remove();
-    }
+    imageCache.Clear();
 
-    CacheTrack.clear();
-
-    delete m_cacheLock;
     delete m_imageThreadPool;
     delete m_qtThemeSettings;
     delete screensaver;
@@ -439,12 +422,12 @@ void MythUIHelper::Init(MythUIMenuCallbacks &cbs)
     d->Init();
     d->callbacks = cbs;
 
-    d->m_maxCacheSize.fetchAndStoreRelease(
+    d->imageCache.SetMaxBytes(
         GetMythDB()->GetNumSetting("UIImageCacheSize", 30) * 1024 * 1024);
 
     LOG(VB_GUI, LOG_INFO, LOC +
         QString("MythUI Image Cache size set to %1 bytes")
-        .arg(d->m_maxCacheSize.fetchAndAddRelease(0)));
+        .arg(d->imageCache.GetMaxBytes()));
 }
 
 // This init is used for showing the startup UI that is shown
@@ -547,21 +530,7 @@ Settings *MythUIHelper::qtconfig(void)
 
 void MythUIHelper::UpdateImageCache(void)
 {
-    QMutexLocker locker(d->m_cacheLock);
-
-    QMutableMapIterator<QString, MythImage *> i(d->imageCache);
-
-    while (i.hasNext())
-    {
-        i.next();
-        i.value()->SetIsInCache(false);
-        i.value()->DecrRef();
-        i.remove();
-    }
-
-    d->CacheTrack.clear();
-
-    d->m_cacheSize.fetchAndStoreOrdered(0);
+    d->imageCache.Clear();
 
     ClearOldImageCache();
     PruneCacheDir(GetRemoteCacheDir());
@@ -570,37 +539,7 @@ void MythUIHelper::UpdateImageCache(void)
 
 MythImage *MythUIHelper::GetImageFromCache(const QString &url)
 {
-    QMutexLocker locker(d->m_cacheLock);
-
-    if (d->imageCache.contains(url))
-    {
-        d->CacheTrack[url] = MythDate::current().toTime_t();
-        d->imageCache[url]->IncrRef();
-        return d->imageCache[url];
-    }
-
-    /*
-        if (QFileInfo(url).exists())
-        {
-            MythImage *im = GetMythPainter()->GetFormatImage();
-            im->Load(url,false);
-            return im;
-        }
-    */
-
-    return NULL;
-}
-
-void MythUIHelper::IncludeInCacheSize(MythImage *im)
-{
-    if (im)
-        d->m_cacheSize.fetchAndAddOrdered(im->byteCount());
-}
-
-void MythUIHelper::ExcludeFromCacheSize(MythImage *im)
-{
-    if (im)
-        d->m_cacheSize.fetchAndAddOrdered(-im->byteCount());
+    return d->imageCache.Get(url);
 }
 
 MythImage *MythUIHelper::CacheImage(const QString &url, MythImage *im,
@@ -620,88 +559,22 @@ MythImage *MythUIHelper::CacheImage(const QString &url, MythImage *im,
         im->save(dstfile, "PNG");
     }
 
-    // delete the oldest cached images until we fall below threshold.
-    QMutexLocker locker(d->m_cacheLock);
-
-    while (d->m_cacheSize.fetchAndAddOrdered(0) + im->byteCount() >=
-           d->m_maxCacheSize.fetchAndAddOrdered(0) &&
-           d->imageCache.size())
-    {
-        QMap<QString, MythImage *>::iterator it = d->imageCache.begin();
-        uint oldestTime = MythDate::current().toTime_t();
-        QString oldestKey = it.key();
-
-        int count = 0;
-
-        for (; it != d->imageCache.end(); ++it)
-        {
-            if (d->CacheTrack[it.key()] < oldestTime)
-            {
-                if ((2 == it.value()->IncrRef()) && (it.value() != im))
-                {
-                    oldestTime = d->CacheTrack[it.key()];
-                    oldestKey = it.key();
-                    count++;
-                }
-                it.value()->DecrRef();
-            }
-        }
-
-        LOG(VB_GUI | VB_FILE, LOG_INFO, LOC +
-            QString("%1 images are eligible for expiry").arg(count));
-
-        if (count > 0)
-        {
-            LOG(VB_GUI | VB_FILE, LOG_INFO, LOC +
-                QString("Cache too big (%1), removing :%2:")
-                .arg(d->m_cacheSize.fetchAndAddOrdered(0) + im->byteCount())
-                .arg(oldestKey));
-
-            d->imageCache[oldestKey]->SetIsInCache(false);
-            d->imageCache[oldestKey]->DecrRef();
-            d->imageCache.remove(oldestKey);
-            d->CacheTrack.remove(oldestKey);
-        }
-        else
-        {
-            break;
-        }
-    }
-
-    QMap<QString, MythImage *>::iterator it = d->imageCache.find(url);
+    MythImage *cached = d->imageCache.Insert(url, im);
 
-    if (it == d->imageCache.end())
+    if (VERBOSE_LEVEL_CHECK(VB_GUI | VB_FILE, LOG_INFO))
     {
-        im->IncrRef();
-        d->imageCache[url] = im;
-        d->CacheTrack[url] = MythDate::current().toTime_t();
-
-        im->SetIsInCache(true);
         LOG(VB_GUI | VB_FILE, LOG_INFO, LOC +
-            QString("NOT IN RAM CACHE, Adding, and adding to size :%1: :%2:")
-            .arg(url).arg(im->byteCount()));
+            QString("MythUIHelper::CacheImage : Cache Count = :%1: size :%2:")
+            .arg(d->imageCache.GetCount())
+            .arg(d->imageCache.GetBytes()));
     }
 
-    LOG(VB_GUI | VB_FILE, LOG_INFO, LOC +
-        QString("MythUIHelper::CacheImage : Cache Count = :%1: size :%2:")
-        .arg(d->imageCache.count())
-        .arg(d->m_cacheSize.fetchAndAddRelaxed(0)));
-
-    return d->imageCache[url];
+    return cached;
 }
 
 void MythUIHelper::RemoveFromCacheByURL(const QString &url)
 {
-    QMutexLocker locker(d->m_cacheLock);
-    QMap<QString, MythImage *>::iterator it = d->imageCache.find(url);
-
-    if (it != d->imageCache.end())
-    {
-        d->imageCache[url]->SetIsInCache(false);
-        d->imageCache[url]->DecrRef();
-        d->imageCache.remove(url);
-        d->CacheTrack.remove(url);
-    }
+    d->imageCache.Remove(url);
 
     QString dstfile;
 
@@ -718,9 +591,7 @@ void MythUIHelper::RemoveFromCacheByFile(const QString &fname)
     QString partialKey = fname;
     partialKey.replace('/', '-');
 
-    d->m_cacheLock->lock();
-    QList<QString> imageCacheKeys = d->imageCache.keys();
-    d->m_cacheLock->unlock();
+    QList<QString> imageCacheKeys = d->imageCache.Keys();
 
     for (it = imageCacheKeys.begin(); it != imageCacheKeys.end(); ++it)
     {
@@ -753,9 +624,7 @@ void MythUIHelper::RemoveFromCacheByFile(const QString &fname)
 
 bool MythUIHelper::IsImageInCache(const QString &url)
 {
-    QMutexLocker locker(d->m_cacheLock);
-
-    if (d->imageCache.contains(url))
+    if (d->imageCache.Contains(url))
         return true;
 
     if (QFileInfo(url).exists())
@@ -1682,16 +1551,10 @@ MythImage *MythUIHelper::LoadCacheImage(QString srcfile, QString label,
 
         // This only applies to the MEMORY cache
         const uint kImageCacheTimeout = 60;
-        uint now = MythDate::current().toTime_t();
-
-        QMutexLocker locker(d->m_cacheLock);
 
-        if (d->imageCache.contains(label) &&
-            d->CacheTrack[label] + kImageCacheTimeout > now)
-        {
-            d->imageCache[label]->IncrRef();
-            return d->imageCache[label];
-        }
+        MythImage *im = d->imageCache.GetIfVerified(label, kImageCacheTimeout);
+        if (im)
+            return im;
     }
 
     MythImage *ret = NULL;
@@ -61,8 +61,6 @@ class MUI_PUBLIC MythUIHelper
     QString GetThemeCacheDir(void);
     QString GetCacheDirByUrl(QString url);
 
-    void IncludeInCacheSize(MythImage *im);
-    void ExcludeFromCacheSize(MythImage *im);
 
     Settings *qtconfig(void);
 
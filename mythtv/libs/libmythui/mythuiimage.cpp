@@ -13,6 +13,7 @@
 #include <QDir>
 #include <QDomDocument>
 #include <QImageReader>
+#include <QMap>
 #include <QReadWriteLock>
 #include <QRunnable>
 #include <QEvent>
@@ -229,6 +230,48 @@ class ImageLoader
         return imagelabel;
     }
 
+    /**
+    *  \brief Decodes a local image straight to the size it will be displayed
+    *         at. Formats such as JPEG can do this for a fraction of the cost
+    *         of a full decode followed by a rescale.
+    *  \return false if the image wasn't loaded, a full load should be used
+    */
+    static bool LoadScaled(MythImage *image, const QString &filename,
+                           const QSize &size, bool preserveAspect)
+    {
+        if (size.width() <= 0 || size.height() <= 0 || filename.contains("://"))
+            return false;
+
+        QString path = filename;
+        if (!path.startsWith('/') && !GetMythUI()->FindThemeFile(path))
+            return false;
+
+        QImageReader reader(path);
+        QSize sourceSize = reader.size();
+        if (!sourceSize.isValid())
+            return false;
+
+        QSize scaledSize = sourceSize;
+        scaledSize.scale(size, preserveAspect ? Qt::KeepAspectRatio
+                                              : Qt::IgnoreAspectRatio);
+
+        // Nothing to gain unless the decode is smaller than the original
+        if (scaledSize.width() >= sourceSize.width() &&
+            scaledSize.height() >= sourceSize.height())
+            return false;
+
+        reader.setScaledSize(scaledSize);
+
+        QImage decoded;
+        if (!reader.read(&decoded))
+            return false;
+
+        image->SetFileName(filename);
+        image->Assign(decoded);
+
+        return true;
+    }
+
     static MythImage *LoadImage(MythPainter *painter,
                                  // Must be a copy for thread safety
                                 ImageProperties imProps,
@@ -252,6 +295,7 @@ class ImageLoader
 
         bool bResize = false;
         bool bFoundInCache = false;
+        bool bDecodedAtSize = false;
 
         int w = -1;
         int h = -1;
@@ -305,7 +349,19 @@ class ImageLoader
             if (imageReader)
                 ok = image->Load(imageReader);
             else
-                ok = image->Load(filename);
+            {
+                // Reflections and rotations change the shape of the image
+                // before it is resized, so those have to be decoded in full
+                if (bResize && !imProps.isReflected && !imProps.isOriented)
+                {
+                    bDecodedAtSize = ok = LoadScaled(image, filename,
+                                                     QSize(w, h),
+                                                     imProps.preserveAspect);
+                }
+
+                if (!ok)
+                    ok = image->Load(filename);
+            }
 
             if (!ok)
             {
@@ -353,7 +409,7 @@ class ImageLoader
                 }
             }
 
-            if (bResize)
+            if (bResize && !bDecodedAtSize)
                 image->Resize(QSize(w, h), imProps.preserveAspect);
 
             if (imProps.isMasked)
@@ -505,67 +561,312 @@ QEvent::Type ImageLoadEvent::kEventType =
     (QEvent::Type) QEvent::registerEventType();
 
 /*!
-* \class ImageLoadThread
+* \class ImageLoadQueue
+* \brief Background image loads, in priority order.
+*
+* There is one request for each cache key, i.e. for each file at a given size
+* with a given set of effects. A widget asking for an image that is already
+* queued or being loaded is added to the existing request instead of loading
+* it again. When a pool thread becomes free it takes the highest priority
+* request, so images waiting to be displayed are loaded before prefetched
+* ones, and requests that nobody wants any more are dropped before they are
+* started.
 */
+class ImageLoadQueue
+{
+  public:
+    /// Priority of an image a widget is waiting to display, prefetches are
+    /// always below it
+    static const int kPriorityDisplay = 1000000;
+
+    static void Enqueue(const MythUIImage *parent, MythPainter *painter,
+                        const ImageProperties &imProps,
+                        const QString &basefile, int number,
+                        ImageCacheMode mode);
+    static void Prefetch(const QObject *requester, MythPainter *painter,
+                         const ImageProperties &imProps,
+                         ImageCacheMode mode, int priority);
+    static void Cancel(const QObject *requester);
+    static void RunNext(void);
+
+  private:
+    struct Waiter
+    {
+        const MythUIImage *parent;
+        QString            basefile;
+        int                number;
+    };
+
+    struct Request
+    {
+        QString                    cacheKey;
+        ImageProperties            imageProperties;
+        MythPainter               *painter;
+        ImageCacheMode             cacheMode;
+        int                        priority;
+        quint64                    order;
+        bool                       running;
+        QList<Waiter>              waiters;
+        QHash<const QObject *, int> prefetchers;
+    };
+
+    /// Highest priority first, then oldest first
+    typedef QPair<int, quint64> QueueKey;
+    static QueueKey Key(const Request *req)
+        { return QueueKey(-req->priority, req->order); }
+
+    static Request *Find(const QString &cacheKey, MythPainter *painter,
+                         const ImageProperties &imProps, ImageCacheMode mode);
+    static void Reprioritize(Request *req);
+    static void Finish(Request *req, MythImage *image,
+                       AnimationFrames *frames, bool aborted);
+
+    static QMutex                      s_lock;
+    static QHash<QString, Request *>   s_requests;  ///< Queued and running
+    static QMap<QueueKey, Request *>   s_queue;     ///< Not yet started
+    static quint64                     s_order;
+};
+
+QMutex                                        ImageLoadQueue::s_lock;
+QHash<QString, ImageLoadQueue::Request *>     ImageLoadQueue::s_requests;
+QMap<ImageLoadQueue::QueueKey, ImageLoadQueue::Request *> ImageLoadQueue::s_queue;
+quint64                                       ImageLoadQueue::s_order = 0;
+
+/// Pool task that loads whichever image is most wanted when it gets to run
 class ImageLoadThread : public QRunnable
 {
   public:
-    ImageLoadThread(const MythUIImage *parent, MythPainter *painter,
-                    const ImageProperties &imProps, const QString &basefile,
-                    int number, ImageCacheMode mode) :
-        m_parent(parent), m_painter(painter), m_imageProperties(imProps),
-        m_basefile(basefile), m_number(number), m_cacheMode(mode)
+    void run() { ImageLoadQueue::RunNext(); }
+};
+
+/// Returns the request for cacheKey, creating and queueing it if there
+/// isn't one. Must be called with s_lock held.
+ImageLoadQueue::Request *ImageLoadQueue::Find(const QString &cacheKey,
+                                              MythPainter *painter,
+                                              const ImageProperties &imProps,
+                                              ImageCacheMode mode)
+{
+    QHash<QString, Request *>::iterator it = s_requests.find(cacheKey);
+    if (it != s_requests.end())
+        return *it;
+
+    Request *req         = new Request;
+    req->cacheKey        = cacheKey;
+    req->imageProperties = imProps;
+    req->painter         = painter;
+    req->cacheMode       = mode;
+    req->priority        = 0;
+    req->order           = s_order++;
+    req->running         = false;
+
+    s_requests.insert(cacheKey, req);
+    s_queue.insert(Key(req), req);
+
+    // One task per request, cancelled requests leave a task with nothing to do
+    GetMythUI()->GetImageThreadPool()->start(new ImageLoadThread(),
+                                             "ImageLoad");
+
+    return req;
+}
+
+/// Requeue a request that hasn't started at the priority of its most
+/// important requester. Must be called with s_lock held.
+void ImageLoadQueue::Reprioritize(Request *req)
+{
+    int priority = req->waiters.isEmpty() ? 0 : kPriorityDisplay;
+
+    QHash<const QObject *, int>::const_iterator it = req->prefetchers.begin();
+    for (; it != req->prefetchers.end(); ++it)
+        priority = qMax(priority, *it);
+
+    if (req->running || priority == req->priority)
+        return;
+
+    s_queue.remove(Key(req));
+    req->priority = priority;
+    s_queue.insert(Key(req), req);
+}
+
+void ImageLoadQueue::Enqueue(const MythUIImage *parent, MythPainter *painter,
+                             const ImageProperties &imProps,
+                             const QString &basefile, int number,
+                             ImageCacheMode mode)
+{
+    QString cacheKey = ImageLoader::GenImageLabel(imProps);
+
+    QMutexLocker locker(&s_lock);
+
+    Request *req = Find(cacheKey, painter, imProps, mode);
+
+    Waiter waiter;
+    waiter.parent   = parent;
+    waiter.basefile = basefile;
+    waiter.number   = number;
+    req->waiters.append(waiter);
+
+    Reprioritize(req);
+}
+
+void ImageLoadQueue::Prefetch(const QObject *requester, MythPainter *painter,
+                              const ImageProperties &imProps,
+                              ImageCacheMode mode, int priority)
+{
+    QString cacheKey = ImageLoader::GenImageLabel(imProps);
+
+    QMutexLocker locker(&s_lock);
+
+    Request *req = Find(cacheKey, painter, imProps, mode);
+
+    req->prefetchers[requester] = qMin(priority, kPriorityDisplay - 1);
+
+    Reprioritize(req);
+}
+
+/**
+ *  \brief Forget everything requester asked for. Requests nobody else wants
+ *         are dropped if they haven't started, and once this returns no more
+ *         results will be posted to requester.
+ */
+void ImageLoadQueue::Cancel(const QObject *requester)
+{
+    QMutexLocker locker(&s_lock);
+
+    QHash<QString, Request *>::iterator it = s_requests.begin();
+    while (it != s_requests.end())
     {
+        Request *req = *it;
+
+        for (int i = req->waiters.size() - 1; i >= 0; --i)
+        {
+            if (req->waiters[i].parent == requester)
+                req->waiters.removeAt(i);
+        }
+        req->prefetchers.remove(requester);
+
+        if (!req->running && req->waiters.isEmpty() &&
+            req->prefetchers.isEmpty())
+        {
+            s_queue.remove(Key(req));
+            it = s_requests.erase(it);
+            delete req;
+            continue;
+        }
+
+        Reprioritize(req);
+        ++it;
+    }
+}
+
+void ImageLoadQueue::RunNext(void)
+{
+    s_lock.lock();
+
+    if (s_queue.isEmpty())
+    {
+        s_lock.unlock();
+        return;
+    }
+
+    Request *req = s_queue.begin().value();
+    s_queue.erase(s_queue.begin());
+    req->running = true;
+
+    // The request is only changed with the lock held
+    ImageProperties imProps = req->imageProperties;
+    MythPainter    *painter = req->painter;
+    ImageCacheMode  mode    = req->cacheMode;
+
+    s_lock.unlock();
+
+    bool aborted = false;
+    MythImage *image = NULL;
+    AnimationFrames *frames = NULL;
+
+    // NOTE Do NOT use MythImageReader::supportsAnimation here, it defeats
+    // the point of caching remote images
+    if (ImageLoader::SupportsAnimation(imProps.filename))
+    {
+        frames = ImageLoader::LoadAnimatedImage(painter, imProps, mode,
+                                                NULL, aborted);
+
+        if (frames && frames->count() <= 1)
+        {
+            AnimationFrames::iterator it;
+            for (it = frames->begin(); it != frames->end(); ++it)
+                if ((*it).first)
+                    (*it).first->DecrRef();
+
+            delete frames;
+            frames = NULL;
+            aborted = false;
+        }
     }
 
-    void run()
+    if (!frames)
     {
-        bool aborted = false;
-        QString filename =  m_imageProperties.filename;
+        image = ImageLoader::LoadImage(painter, imProps, mode, NULL, aborted);
+    }
+
+    Finish(req, image, frames, aborted);
+}
+
+/// Hand the result of req to everyone still waiting for it
+void ImageLoadQueue::Finish(Request *req, MythImage *image,
+                            AnimationFrames *frames, bool aborted)
+{
+    s_lock.lock();
+
+    s_requests.remove(req->cacheKey);
 
-        // NOTE Do NOT use MythImageReader::supportsAnimation here, it defeats
-        // the point of caching remote images
-        if (ImageLoader::SupportsAnimation(filename))
+    QList<Waiter>::const_iterator it = req->waiters.begin();
+    for (; it != req->waiters.end(); ++it)
+    {
+        ImageLoadEvent *le;
+
+        if (frames)
+        {
+            AnimationFrames *copy = new AnimationFrames(*frames);
+
+            AnimationFrames::iterator fit;
+            for (fit = copy->begin(); fit != copy->end(); ++fit)
+                if ((*fit).first)
+                    (*fit).first->IncrRef();
+
+            le = new ImageLoadEvent((*it).parent, copy, (*it).basefile,
+                                    req->imageProperties.filename, aborted);
+        }
+        else
         {
-             AnimationFrames *frames;
-
-             frames = ImageLoader::LoadAnimatedImage(m_painter,
-                                                     m_imageProperties,
-                                                     m_cacheMode, m_parent,
-                                                     aborted);
-
-             if (frames && frames->count() > 1)
-             {
-                ImageLoadEvent *le = new ImageLoadEvent(m_parent, frames,
-                                                        m_basefile,
-                                                        m_imageProperties.filename,
-                                                        aborted);
-                QCoreApplication::postEvent(const_cast<MythUIImage*>(m_parent), le);
-
-                return;
-             }
-             delete frames;
+            if (image)
+                image->IncrRef();
+
+            le = new ImageLoadEvent((*it).parent, image, (*it).basefile,
+                                    req->imageProperties.filename,
+                                    (*it).number, aborted);
         }
 
-        MythImage *image = ImageLoader::LoadImage(m_painter,
-                                                    m_imageProperties,
-                                                    m_cacheMode, m_parent,
-                                                    aborted);
+        QCoreApplication::postEvent(const_cast<MythUIImage*>((*it).parent),
+                                    le);
+    }
 
-        ImageLoadEvent *le = new ImageLoadEvent(m_parent, image, m_basefile,
-                                                m_imageProperties.filename,
-                                                m_number, aborted);
-        QCoreApplication::postEvent(const_cast<MythUIImage*>(m_parent), le);
+    s_lock.unlock();
+
+    // Anything not handed out is still in the cache if it was wanted
+    if (image)
+        image->DecrRef();
+
+    if (frames)
+    {
+        AnimationFrames::iterator fit;
+        for (fit = frames->begin(); fit != frames->end(); ++fit)
+            if ((*fit).first)
+                (*fit).first->DecrRef();
+
+        delete frames;
     }
 
-private:
-    const MythUIImage    *m_parent;
-    MythPainter       *m_painter;
-    ImageProperties m_imageProperties;
-    QString         m_basefile;
-    int             m_number;
-    ImageCacheMode  m_cacheMode;
-};
+    delete req;
+}
 
 /////////////////////////////////////////////////////////////////
 class MythUIImagePrivate
@@ -632,13 +933,9 @@ MythUIImage::MythUIImage(MythUIType *parent, const QString &name)
 
 MythUIImage::~MythUIImage()
 {
-    // Wait until all image loading threads are complete or bad things
-    // may happen if this MythUIImage disappears when a queued thread
-    // needs it.
-    if (m_runningThreads > 0)
-    {
-        GetMythUI()->GetImageThreadPool()->waitForDone();
-    }
+    // Images still being loaded for us are no longer wanted, and must not
+    // be posted to us once we're gone
+    ImageLoadQueue::Cancel(this);
 
     Clear();
 
@@ -718,8 +1015,6 @@ void MythUIImage::Init(void)
     m_animationReverse = false;
     m_animatedImage = false;
 
-    m_runningThreads = 0;
-
     m_showingRandomImage = false;
 }
 
@@ -1035,6 +1330,10 @@ bool MythUIImage::Load(bool allowLoadInBackground, bool forceStat)
 
     QString filename = bFilename;
 
+    // Anything still loading from an earlier call has been replaced, e.g. a
+    // button list reusing this widget for another item as it scrolls
+    ImageLoadQueue::Cancel(this);
+
     if (bFilename.isEmpty())
     {
         Clear();
@@ -1101,13 +1400,8 @@ bool MythUIImage::Load(bool allowLoadInBackground, bool forceStat)
             LOG(VB_GUI | VB_FILE, LOG_DEBUG, LOC +
                 QString("Load(), spawning thread to load '%1'").arg(filename));
 
-            m_runningThreads++;
-            ImageLoadThread *bImgThread;
-            bImgThread = new ImageLoadThread(this, GetPainter(),
-                                             imProps,
-                                             bFilename, i,
-                                             static_cast<ImageCacheMode>(cacheMode2));
-            GetMythUI()->GetImageThreadPool()->start(bImgThread, "ImageLoad");
+            ImageLoadQueue::Enqueue(this, GetPainter(), imProps, bFilename, i,
+                                    static_cast<ImageCacheMode>(cacheMode2));
         }
         else
         {
@@ -1193,6 +1487,43 @@ bool MythUIImage::Load(bool allowLoadInBackground, bool forceStat)
     return true;
 }
 
+/**
+ *  \brief Load filename into the image cache in the background, as this
+ *         widget would display it, without displaying it.
+ *
+ *  Lets a list load the images just outside its visible window so they are
+ *  ready when it scrolls. Prefetches are loaded after every image that is
+ *  waiting to be displayed, highest priority first, and those that haven't
+ *  started yet are dropped by CancelPrefetch().
+ */
+void MythUIImage::Prefetch(const QString &filename, const QObject *requester,
+                           int priority)
+{
+    if (filename.isEmpty() || ImageLoader::SupportsAnimation(filename))
+        return;
+
+    d->m_UpdateLock.lockForRead();
+    ImageProperties imProps = m_imageProperties;
+    d->m_UpdateLock.unlock();
+
+    imProps.isThemeImage = false;
+    imProps.filename = filename;
+
+    if (GetMythUI()->IsImageInCache(ImageLoader::GenImageLabel(imProps)))
+        return;
+
+    ImageLoadQueue::Prefetch(requester, GetPainter(), imProps,
+                             kCacheNormal, priority);
+}
+
+/**
+ *  \brief Drop the prefetches requested by requester that haven't started
+ */
+void MythUIImage::CancelPrefetch(const QObject *requester)
+{
+    ImageLoadQueue::Cancel(requester);
+}
+
 /**
  *  \copydoc MythUIType::Pulse()
  */
@@ -1611,8 +1942,6 @@ void MythUIImage::customEvent(QEvent *event)
         animationFrames = le->GetAnimationFrames();
         aborted         = le->GetAbortState();
 
-        m_runningThreads--;
-
         d->m_UpdateLock.lockForRead();
         QString propFilename = m_imageProperties.filename;
         d->m_UpdateLock.unlock();
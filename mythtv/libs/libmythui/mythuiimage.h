@@ -14,7 +14,7 @@
 
 class MythUIImagePrivate;
 class MythScreenType;
-class ImageLoadThread;
+class ImageLoadQueue;
 
 /*!
  * \class ImageLoader
@@ -131,6 +131,10 @@ class MUI_PUBLIC MythUIImage : public MythUIType
     void Reset(void);
     bool Load(bool allowLoadInBackground = true, bool forceStat = false);
 
+    void Prefetch(const QString &filename, const QObject *requester,
+                  int priority = 0);
+    static void CancelPrefetch(const QObject *requester);
+
     virtual void Pulse(void);
 
     virtual void LoadNow(void);
@@ -183,8 +187,6 @@ class MUI_PUBLIC MythUIImage : public MythUIType
 
     ImageProperties m_imageProperties;
 
-    int m_runningThreads;
-
     bool m_showingRandomImage;
     QString m_imageDirectory;
 
@@ -201,7 +203,7 @@ class MUI_PUBLIC MythUIImage : public MythUIType
     friend class MythUIProgressBar;
     friend class MythUIEditBar;
     friend class MythUITextEdit;
-    friend class ImageLoadThread;
+    friend class ImageLoadQueue;
 
   private:
     Q_DISABLE_COPY(MythUIImage)
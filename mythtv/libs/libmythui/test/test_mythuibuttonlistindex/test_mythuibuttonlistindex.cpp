@@ -0,0 +1,3 @@
+#include "test_mythuibuttonlistindex.h"
+
+QTEST_APPLESS_MAIN(TestMythUIButtonListIndex)
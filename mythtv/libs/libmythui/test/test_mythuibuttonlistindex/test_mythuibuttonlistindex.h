@@ -0,0 +1,147 @@
+/*
+ *  Class TestMythUIButtonListIndex
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+
+#include "mythuibuttonlist.h"
+
+class TestMythUIButtonListIndex: public QObject
+{
+    Q_OBJECT
+
+    static QStringList Entries(void)
+    {
+        return QStringList() << "Alpha" << "beta" << "Gamma"
+                             << "alphabet" << "Delta";
+    }
+
+  private slots:
+
+    void EmptyIndexFindsNothing(void)
+    {
+        MythUIButtonListIndex index;
+
+        QCOMPARE(index.Count(), 0);
+        QCOMPARE(index.Find("a", false, 0, true), -1);
+        QCOMPARE(index.FindPrefix("a"), -1);
+    }
+
+    void BuildAndClear(void)
+    {
+        MythUIButtonListIndex index;
+
+        index.Build(Entries());
+        QCOMPARE(index.Count(), 5);
+
+        index.Clear();
+        QCOMPARE(index.Count(), 0);
+        QCOMPARE(index.FindPrefix("alpha"), -1);
+    }
+
+    void FindPrefixIgnoresCase(void)
+    {
+        MythUIButtonListIndex index;
+        index.Build(Entries());
+
+        QCOMPARE(index.FindPrefix("ALP"), 0);
+        QCOMPARE(index.FindPrefix("gam"), 2);
+        QCOMPARE(index.FindPrefix("delta"), 4);
+    }
+
+    void FindPrefixReturnsLowestPosition(void)
+    {
+        MythUIButtonListIndex index;
+        index.Build(QStringList() << "b" << "ab" << "a" << "abc");
+
+        // "ab" and "abc" sort after "a" but "ab" is earlier in the list
+        QCOMPARE(index.FindPrefix("ab"), 1);
+        QCOMPARE(index.FindPrefix("a"), 1);
+        QCOMPARE(index.FindPrefix("abc"), 3);
+        QCOMPARE(index.FindPrefix(""), 0);
+    }
+
+    void FindPrefixWithDuplicates(void)
+    {
+        MythUIButtonListIndex index;
+        index.Build(QStringList() << "b" << "a" << "B");
+
+        QCOMPARE(index.FindPrefix("b"), 0);
+        QCOMPARE(index.FindPrefix("a"), 1);
+    }
+
+    void FindPrefixMissing(void)
+    {
+        MythUIButtonListIndex index;
+        index.Build(Entries());
+
+        QCOMPARE(index.FindPrefix("z"), -1);
+        QCOMPARE(index.FindPrefix("alphabets"), -1);
+        QCOMPARE(index.FindPrefix("0"), -1);
+    }
+
+    void FindContains(void)
+    {
+        MythUIButtonListIndex index;
+        index.Build(Entries());
+
+        QCOMPARE(index.Find("TA", false, 0, true), 1);
+        QCOMPARE(index.Find("ta", false, 2, true), 4);
+        QCOMPARE(index.Find("ta", false, 2, false), 1);
+        QCOMPARE(index.Find("bet", false, 0, true), 1);
+        QCOMPARE(index.Find("bet", false, 2, true), 3);
+    }
+
+    void FindStartsWith(void)
+    {
+        MythUIButtonListIndex index;
+        index.Build(Entries());
+
+        QCOMPARE(index.Find("ta", true, 0, true), -1);
+        QCOMPARE(index.Find("alpha", true, 1, true), 3);
+        QCOMPARE(index.Find("alpha", true, 2, false), 0);
+    }
+
+    void FindWrapsAround(void)
+    {
+        MythUIButtonListIndex index;
+        index.Build(Entries());
+
+        QCOMPARE(index.Find("alpha", true, 4, true), 0);
+        QCOMPARE(index.Find("delta", false, 0, false), 4);
+        QCOMPARE(index.Find("gamma", false, 3, true), 2);
+    }
+
+    void FindClampsStart(void)
+    {
+        MythUIButtonListIndex index;
+        index.Build(Entries());
+
+        QCOMPARE(index.Find("gamma", false, 99, true), 2);
+        QCOMPARE(index.Find("delta", false, -5, false), 4);
+        QCOMPARE(index.Find("alpha", false, -5, true), 0);
+    }
+
+    void FindEmptyStringFindsNothing(void)
+    {
+        MythUIButtonListIndex index;
+        index.Build(Entries());
+
+        QCOMPARE(index.Find("", false, 0, true), -1);
+        QCOMPARE(index.Find("", true, 0, true), -1);
+    }
+};
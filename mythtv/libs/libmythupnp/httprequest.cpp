@@ -52,6 +52,7 @@
 #include "serializers/soapSerializer.h"
 #include "serializers/jsonSerializer.h"
 #include "serializers/xmlplistSerializer.h"
+#include "httpresponsestream.h"
 
 #include <unistd.h> // for gethostname
 
@@ -174,7 +175,8 @@ HTTPRequest::HTTPRequest() : m_procReqLineExp ( "[ \r\n][ \r\n]*"  ),
                              m_nResponseStatus( 200 ),
                              m_pPostProcess   ( NULL ),
                              m_bKeepAlive     ( true ),
-                             m_nKeepAliveTimeout ( 0 )
+                             m_nKeepAliveTimeout ( 0 ),
+                             m_pStream        ( NULL )
 {
     m_response.open( QIODevice::ReadWrite );
 }
@@ -183,6 +185,15 @@ HTTPRequest::HTTPRequest() : m_procReqLineExp ( "[ \r\n][ \r\n]*"  ),
 //
 /////////////////////////////////////////////////////////////////////////////
 
+HTTPRequest::~HTTPRequest()
+{
+    delete m_pStream;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
 RequestType HTTPRequest::SetRequestType( const QString &sType )
 {
     // HTTP
@@ -253,7 +264,9 @@ QString HTTPRequest::BuildResponseHeader( long long nSize )
             SetResponseHeader("Content-Disposition", QString("inline; filename=\"%2\"").arg(QString(filename.toLatin1())));
         }
 
-        SetResponseHeader("Content-Length", QString::number(nSize));
+        // A negative size means the body is sent chunked
+        if (nSize >= 0)
+            SetResponseHeader("Content-Length", QString::number(nSize));
 
         // See DLNA  7.4.1.3.11.4.3 Tolerance to unavailable contentFeatures.dlna.org header
         //
@@ -321,6 +334,29 @@ qint64 HTTPRequest::SendResponse( void )
 {
     qint64      nBytes    = 0;
 
+    // ----------------------------------------------------------------------
+    // A streamed response has already been sent while it was serialized.
+    // If it was cut short the client can only tell from the connection
+    // closing, so return an error.
+    // ----------------------------------------------------------------------
+
+    if (m_pStream && m_pStream->IsStreaming())
+    {
+        if (!m_pStream->IsFinished())
+        {
+            LOG(VB_HTTP, LOG_ERR, "HTTPRequest::SendResponse( Stream ) - "
+                                  "Response incomplete");
+            return( -1 );
+        }
+
+        LOG(VB_HTTP, LOG_INFO,
+            QString("HTTPRequest::SendResponse( Stream ) :%1 -> %2: %3 bytes")
+                .arg(GetResponseStatus()) .arg(GetPeerAddress())
+                .arg(m_pStream->BytesSent()));
+
+        return( m_pStream->BytesSent() );
+    }
+
     switch( m_eResponseType )
     {
         // The following are all eligable for gzip compression
@@ -773,6 +809,13 @@ void HTTPRequest::FormatErrorResponse( bool  bServerError,
 
 void HTTPRequest::FormatActionResponse( Serializer *pSer )
 {
+    if (m_pStream && m_pStream->IsStreaming())
+    {
+        // Headers are long gone, just terminate the stream
+        m_pStream->Finish();
+        return;
+    }
+
     m_eResponseType     = ResponseTypeOther;
     m_sResponseTypeText = pSer->GetContentType();
     m_nResponseStatus   = 200;
@@ -1758,28 +1801,52 @@ bool HTTPRequest::ProcessSOAPPayload( const QString &sSOAPAction )
 Serializer *HTTPRequest::GetSerializer()
 {
     Serializer *pSerializer = NULL;
+    QIODevice  *pDevice     = &m_response;
+
+    // Large responses are sent as they are serialized, see HTTPResponseStream
+
+    if (CanStreamResponse())
+    {
+        m_pStream = new HTTPResponseStream( this );
+        pDevice   = m_pStream;
+    }
 
     if (m_bSOAPRequest)
-        pSerializer = (Serializer *)new SoapSerializer(&m_response,
+        pSerializer = (Serializer *)new SoapSerializer(pDevice,
                                                        m_sNameSpace, m_sMethod);
     else
     {
         QString sAccept = GetRequestHeader( "Accept", "*/*" );
 
         if (sAccept.contains( "application/json", Qt::CaseInsensitive ))
-            pSerializer = (Serializer *)new JSONSerializer(&m_response,
+            pSerializer = (Serializer *)new JSONSerializer(pDevice,
                                                            m_sMethod);
         else if (sAccept.contains( "text/javascript", Qt::CaseInsensitive ))
-            pSerializer = (Serializer *)new JSONSerializer(&m_response,
+            pSerializer = (Serializer *)new JSONSerializer(pDevice,
                                                            m_sMethod);
         else if (sAccept.contains( "text/x-apple-plist+xml", Qt::CaseInsensitive ))
-            pSerializer = (Serializer *)new XmlPListSerializer(&m_response);
+            pSerializer = (Serializer *)new XmlPListSerializer(pDevice);
     }
 
     // Default to XML
 
     if (pSerializer == NULL)
-        pSerializer = (Serializer *)new XmlSerializer(&m_response, m_sMethod);
+        pSerializer = (Serializer *)new XmlSerializer(pDevice, m_sMethod);
+
+    if (m_pStream)
+        m_pStream->SetSerializer( pSerializer );
+
+    // Fields= limits the response to the named properties of the result
+
+    QStringMap::const_iterator it = m_mapParams.constBegin();
+    for (; it != m_mapParams.constEnd(); ++it)
+    {
+        if (it.key().compare( "Fields", Qt::CaseInsensitive ) == 0)
+        {
+            pSerializer->SetFields( *it );
+            break;
+        }
+    }
 
     return pSerializer;
 }
@@ -1788,6 +1855,27 @@ Serializer *HTTPRequest::GetSerializer()
 //
 /////////////////////////////////////////////////////////////////////////////
 
+bool HTTPRequest::CanStreamResponse( void )
+{
+    // Chunked transfer encoding needs HTTP/1.1
+    if ((m_nMajor < 1) || (m_nMajor == 1 && m_nMinor < 1))
+        return false;
+
+    if (m_eType == RequestTypeHead || m_pStream != NULL)
+        return false;
+
+    // The client wants to validate a cached copy, which needs the ETag of
+    // the complete response.
+    if (!GetRequestHeader( "If-None-Match", "" ).isEmpty())
+        return false;
+
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
 QString HTTPRequest::Encode(const QString &sIn)
 {
     QString sStr = sIn;
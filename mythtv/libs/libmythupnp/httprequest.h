@@ -26,6 +26,8 @@
 #include "upnputil.h"
 #include "serializers/serializer.h"
 
+class HTTPResponseStream;
+
 #define SOAP_ENVELOPE_BEGIN  "<s:Envelope xmlns:s=\"http://schemas.xmlsoap.org/soap/envelope/\" " \
                              "s:encodingStyle=\"http://schemas.xmlsoap.org/soap/encoding/\">"     \
                              "<s:Body>"
@@ -104,6 +106,8 @@ class IPostProcess
 
 class UPNP_PUBLIC HTTPRequest
 {
+    friend class HTTPResponseStream;
+
     protected:
 
         static const char  *m_szServerHeaders;
@@ -162,6 +166,8 @@ class UPNP_PUBLIC HTTPRequest
         bool                m_bKeepAlive;
         uint                m_nKeepAliveTimeout;
 
+        HTTPResponseStream *m_pStream;
+
     protected:
 
         RequestType     SetRequestType      ( const QString &sType  );
@@ -187,6 +193,8 @@ class UPNP_PUBLIC HTTPRequest
 
         QString         BuildResponseHeader ( long long nSize );
 
+        bool            CanStreamResponse   ( void );
+
         qint64          SendData            ( QIODevice *pDevice, qint64 llStart, qint64 llBytes );
         qint64          SendFile            ( QFile &file, qint64 llStart, qint64 llBytes );
 
@@ -204,7 +212,7 @@ class UPNP_PUBLIC HTTPRequest
     public:
 
                         HTTPRequest     ();
-        virtual        ~HTTPRequest     () {};
+        virtual        ~HTTPRequest     ();
 
         bool            ParseRequest    ();
 
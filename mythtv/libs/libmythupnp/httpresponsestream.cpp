@@ -0,0 +1,270 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: httpresponsestream.cpp
+//
+// Purpose     : Chunked, optionally gzip'd, streaming of Http responses
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "httpresponsestream.h"
+#include "httprequest.h"
+#include "serializers/serializer.h"
+
+#include <cstring>
+
+#include "mythlogging.h"
+
+// Responses smaller than this are buffered and sent as before
+#define STREAM_THRESHOLD    (64 * 1024)
+// Size of each chunk written to the socket
+#define STREAM_CHUNK_SIZE   (64 * 1024)
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+HTTPResponseStream::HTTPResponseStream( HTTPRequest *pRequest )
+                  : m_pRequest   ( pRequest ),
+                    m_pSerializer( NULL ),
+                    m_bStreaming( false ),
+                    m_bFinished ( false ),
+                    m_bError    ( false ),
+                    m_bGzip     ( false ),
+                    m_nBytesSent( 0 )
+{
+    memset( &m_zStream, 0, sizeof( m_zStream ));
+
+    open( QIODevice::WriteOnly );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+HTTPResponseStream::~HTTPResponseStream()
+{
+    if (m_bGzip)
+        deflateEnd( &m_zStream );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HTTPResponseStream::SetSerializer( Serializer *pSerializer )
+{
+    m_pSerializer  = pSerializer;
+    m_sContentType = pSerializer ? pSerializer->GetContentType() : QString();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+qint64 HTTPResponseStream::writeData( const char *pData, qint64 nLen )
+{
+    if (m_bError || m_bFinished)
+        return -1;
+
+    if (!m_bStreaming)
+    {
+        QBuffer &response = m_pRequest->m_response;
+
+        if (response.write( pData, nLen ) != nLen)
+            return -1;
+
+        if ((response.size() >= STREAM_THRESHOLD) && !BeginStreaming())
+            return -1;
+
+        return nLen;
+    }
+
+    if (!Process( pData, nLen, Z_NO_FLUSH ))
+        return -1;
+
+    return nLen;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+bool HTTPResponseStream::BeginStreaming()
+{
+    m_bStreaming = true;
+
+    if (m_pRequest->m_mapHeaders[ "accept-encoding" ].contains( "gzip" ))
+    {
+        m_bGzip = (deflateInit2( &m_zStream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                                 15 + 16, 8, Z_DEFAULT_STRATEGY ) == Z_OK);
+    }
+
+    // ----------------------------------------------------------------------
+    // Same headers as HTTPRequest::FormatActionResponse(), less the ETag,
+    // which would only be the hash of what has been serialized so far
+    // ----------------------------------------------------------------------
+
+    m_pRequest->m_eResponseType     = ResponseTypeOther;
+    m_pRequest->m_sResponseTypeText = m_sContentType;
+    m_pRequest->m_nResponseStatus   = 200;
+
+    if (m_pSerializer)
+    {
+        m_pSerializer->AddHeaders( m_pRequest->m_mapRespHeaders );
+        m_pRequest->m_mapRespHeaders.remove( "ETag" );
+    }
+    else
+    {
+        m_pRequest->SetResponseHeader( "Cache-Control", "no-cache=\"Ext\", "
+                                       "max-age = 7200", true ); // 2 hours
+    }
+
+    m_pRequest->SetResponseHeader( "Transfer-Encoding", "chunked", true );
+
+    if (m_bGzip)
+        m_pRequest->SetResponseHeader( "Content-Encoding", "gzip", true );
+
+    QByteArray sHeader = m_pRequest->BuildResponseHeader( -1 ).toUtf8();
+
+    qint64 nBytes = m_pRequest->WriteBlock( sHeader.constData(),
+                                            sHeader.length() );
+    if (nBytes != sHeader.length())
+    {
+        LOG(VB_HTTP, LOG_ERR, "HTTPResponseStream: Incomplete write of header");
+        m_bError = true;
+        return false;
+    }
+
+    m_nBytesSent += nBytes;
+
+    LOG(VB_HTTP, LOG_DEBUG, QString("HTTPResponseStream: Streaming %1 "
+                                    "response%2")
+        .arg(m_sContentType).arg(m_bGzip ? " (gzip)" : ""));
+
+    // ----------------------------------------------------------------------
+    // Send what has been buffered so far
+    // ----------------------------------------------------------------------
+
+    QByteArray buffered = m_pRequest->m_response.buffer();
+
+    m_pRequest->m_response.buffer().clear();
+    m_pRequest->m_response.seek( 0 );
+
+    return Process( buffered.constData(), buffered.size(), Z_NO_FLUSH );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+bool HTTPResponseStream::Process( const char *pData, qint64 nLen, int nFlush )
+{
+    if (!m_bGzip)
+    {
+        m_output.append( pData, nLen );
+    }
+    else
+    {
+        char aBuffer[ 16 * 1024 ];
+
+        m_zStream.next_in  = (Bytef*)pData;
+        m_zStream.avail_in = nLen;
+
+        do
+        {
+            m_zStream.next_out  = (Bytef*)aBuffer;
+            m_zStream.avail_out = sizeof( aBuffer );
+
+            int ret = deflate( &m_zStream, nFlush );
+
+            if (ret == Z_STREAM_ERROR)
+            {
+                LOG(VB_HTTP, LOG_ERR, "HTTPResponseStream: deflate failed");
+                m_bError = true;
+                return false;
+            }
+
+            m_output.append( aBuffer, sizeof( aBuffer ) - m_zStream.avail_out );
+        }
+        while (m_zStream.avail_out == 0);
+    }
+
+    if ((m_output.size() >= STREAM_CHUNK_SIZE) ||
+        ((nFlush == Z_FINISH) && !m_output.isEmpty()))
+    {
+        if (!WriteChunk( m_output ))
+            return false;
+
+        m_output.clear();
+    }
+
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+bool HTTPResponseStream::WriteChunk( const QByteArray &chunk )
+{
+    QByteArray data;
+
+    data.reserve( chunk.size() + 16 );
+    data += QByteArray::number( chunk.size(), 16 );
+    data += "\r\n";
+    data += chunk;
+    data += "\r\n";
+
+    qint64 nBytes = m_pRequest->WriteBlock( data.constData(), data.size() );
+
+    if (nBytes != data.size())
+    {
+        LOG(VB_HTTP, LOG_ERR, QString("HTTPResponseStream: Incomplete write "
+                                      "of chunk, %1 written of %2")
+            .arg(nBytes).arg(data.size()));
+        m_bError = true;
+        return false;
+    }
+
+    m_nBytesSent += nBytes;
+
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Sends any remaining output and the terminating chunk.
+ *
+ * Does nothing if streaming never started, the buffered response is then
+ * sent by HTTPRequest::SendResponse() as usual.
+ */
+bool HTTPResponseStream::Finish()
+{
+    if (!m_bStreaming || m_bFinished)
+        return !m_bError;
+
+    if (m_bError || !Process( NULL, 0, Z_FINISH ))
+        return false;
+
+    static const char aLastChunk[] = "0\r\n\r\n";
+
+    qint64 nBytes = m_pRequest->WriteBlock( aLastChunk,
+                                            sizeof( aLastChunk ) - 1 );
+    if (nBytes != (qint64)sizeof( aLastChunk ) - 1)
+    {
+        m_bError = true;
+        return false;
+    }
+
+    m_nBytesSent += nBytes;
+    m_bFinished   = true;
+
+    LOG(VB_HTTP, LOG_DEBUG, QString("HTTPResponseStream: Sent %1 bytes")
+        .arg(m_nBytesSent));
+
+    return true;
+}
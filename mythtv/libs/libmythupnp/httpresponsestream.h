@@ -0,0 +1,84 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: httpresponsestream.h
+//
+// Purpose     : Chunked, optionally gzip'd, streaming of Http responses
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef HTTPRESPONSESTREAM_H_
+#define HTTPRESPONSESTREAM_H_
+
+#include <QIODevice>
+#include <QByteArray>
+#include <QString>
+
+#include <zlib.h>
+
+#include "upnpexp.h"
+
+class HTTPRequest;
+class Serializer;
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+/** \class HTTPResponseStream
+ *  \brief Output device for serializers that sends large responses while
+ *         they are still being generated.
+ *
+ *  Output is collected in the request's response buffer until it grows
+ *  past a threshold, so small responses are sent exactly as before, with
+ *  a Content-Length and an ETag. Once the threshold is passed the headers
+ *  are sent with "Transfer-Encoding: chunked" and from then on the output
+ *  is compressed (if the client accepts gzip) and written to the socket
+ *  in chunks, so only one chunk is ever held in memory.
+ *
+ *  Streamed responses have no ETag, as it isn't known until the last byte
+ *  has been serialized.
+ */
+class UPNP_PUBLIC HTTPResponseStream : public QIODevice
+{
+    public:
+
+        explicit HTTPResponseStream( HTTPRequest *pRequest );
+        virtual ~HTTPResponseStream();
+
+        void    SetSerializer   ( Serializer *pSerializer );
+
+        bool    IsStreaming     () const { return m_bStreaming; }
+        bool    IsFinished      () const { return m_bFinished;  }
+        qint64  BytesSent       () const { return m_nBytesSent; }
+
+        bool    Finish          ();
+
+        virtual bool isSequential() const { return true; }
+
+    protected:
+
+        virtual qint64 readData ( char *, qint64 ) { return -1; }
+        virtual qint64 writeData( const char *pData, qint64 nLen );
+
+    private:
+
+        bool    BeginStreaming  ();
+        bool    Process         ( const char *pData, qint64 nLen, int nFlush );
+        bool    WriteChunk      ( const QByteArray &chunk );
+
+        HTTPRequest *m_pRequest;
+        Serializer  *m_pSerializer;
+        QString      m_sContentType;
+
+        bool         m_bStreaming;
+        bool         m_bFinished;
+        bool         m_bError;
+        bool         m_bGzip;
+
+        z_stream     m_zStream;
+        QByteArray   m_output;     // Pending chunk, compressed if m_bGzip
+        qint64       m_nBytesSent;
+};
+
+#endif
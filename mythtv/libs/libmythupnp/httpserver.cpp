@@ -17,12 +17,18 @@
 
 // ANSI C headers
 #include <cmath>
+#include <cstring>
 
 // POSIX headers
 #include <compat.h>
 #ifndef _WIN32
 #include <sys/utsname.h> 
 #endif
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
 
 // Qt headers
 #include <QScriptEngine>
@@ -31,6 +37,7 @@
 #include <QSslCipher>
 #include <QSslCertificate>
 #include <QUuid>
+#include <QThread>
 
 // MythTV headers
 #include "upnputil.h"
@@ -117,6 +124,8 @@ QString  HttpServer::s_platform;
 HttpServer::HttpServer() :
     ServerPool(), m_sSharePath(GetShareDir()),
     m_threadPool("HttpServerPool"), m_running(true),
+    m_requests(0), m_queueUsecs(0), m_maxQueueUsecs(0), m_workersStarted(0),
+    m_requestUsecs(0), m_maxRequestUsecs(0),
     m_privateToken(QUuid::createUuid().toString()) // Cryptographically random and sufficiently long enough to act as a secure token
 {
     // Number of connections processed concurrently
@@ -129,6 +138,25 @@ HttpServer::HttpServer() :
     LOG(VB_HTTP, LOG_NOTICE, QString("HttpServer(): Max Thread Count %1")
                                 .arg(m_threadPool.maxThreadCount()));
 
+#ifdef __linux__
+    // Reactors only wait on idle sockets, a few of them are plenty
+    int nReactors = min(max(QThread::idealThreadCount() / 4, 1), 4);
+    for (int i = 0; i < nReactors; i++)
+    {
+        HttpReactor *reactor = new HttpReactor(*this, i);
+        if (!reactor->IsValid())
+        {
+            delete reactor;
+            break;
+        }
+        reactor->start();
+        m_reactors.append(reactor);
+    }
+
+    LOG(VB_HTTP, LOG_NOTICE, QString("HttpServer(): %1 idle connection "
+                                     "reactor(s)").arg(m_reactors.size()));
+#endif
+
     // ----------------------------------------------------------------------
     // Build Platform String
     // ----------------------------------------------------------------------
@@ -174,8 +202,17 @@ HttpServer::~HttpServer()
     m_running = false;
     m_rwlock.unlock();
 
+    // Stop the reactors first, they hand connections to the thread pool.
+    // Stopped reactors close any connection a worker still parks, and
+    // they are only deleted once the workers are gone.
+    for (int i = 0; i < m_reactors.size(); ++i)
+        m_reactors[i]->Stop();
+
     m_threadPool.Stop();
 
+    while (!m_reactors.empty())
+        delete m_reactors.takeFirst();
+
     while (!m_extensions.empty())
     {
         delete m_extensions.takeFirst();
@@ -310,6 +347,15 @@ void HttpServer::newTcpConnection(qt_socket_fd_t socket)
     if (server)
         type = server->GetServerType();
 
+    // Plain connections wait for their first request in a reactor, this
+    // is the same 5 second timeout a worker would have waited.
+    if (CanParkConnection(type))
+    {
+        ParkConnection(socket, 5 * 1000);
+        return;
+    }
+
+    m_queuedConnections.ref();
     m_threadPool.startReserved(
         new HttpWorker(*this, socket, type
 #ifndef QT_NO_OPENSSL
@@ -426,6 +472,126 @@ void HttpServer::DelegateRequest(HTTPRequest *pRequest)
     }
 }
 
+/**
+ * \brief Whether idle connections of this type can wait in a reactor.
+ *
+ * SSL connections can't, their session state lives in the QSslSocket.
+ */
+bool HttpServer::CanParkConnection(PoolServerType type) const
+{
+    QReadLocker locker(&m_rwlock);
+    return m_running && (type == kTCPServer) && !m_reactors.isEmpty();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HttpServer::ParkConnection(qt_socket_fd_t socket, int timeout_ms)
+{
+    // The destructor doesn't delete the reactors until the thread pool
+    // has stopped, and a stopped reactor closes the connection.
+    QReadLocker locker(&m_rwlock);
+    if (m_reactors.isEmpty())
+        return;
+
+    HttpReactor *reactor = m_reactors[socket % m_reactors.size()];
+    if (reactor->Park(socket, timeout_ms))
+        m_idleConnections.ref();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HttpServer::ResumeConnection(qt_socket_fd_t socket)
+{
+    m_idleConnections.deref();
+    m_queuedConnections.ref();
+
+    // Reserved, so that a long running request such as a file download
+    // can't hold up the next request.
+    m_threadPool.startReserved(
+        new HttpWorker(*this, socket, kTCPServer
+#ifndef QT_NO_OPENSSL
+                       , m_sslConfig
+#endif
+                       ),
+        QString("HttpServer%1").arg(socket));
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HttpServer::ConnectionClosed(bool idle)
+{
+    if (idle)
+        m_idleConnections.deref();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HttpServer::WorkerStarted(qint64 queue_usecs)
+{
+    m_queuedConnections.deref();
+    m_activeConnections.ref();
+
+    QMutexLocker locker(&m_statsLock);
+    m_workersStarted++;
+    m_queueUsecs += queue_usecs;
+    m_maxQueueUsecs = max(m_maxQueueUsecs, (quint64)queue_usecs);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HttpServer::WorkerFinished(void)
+{
+    m_activeConnections.deref();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HttpServer::RequestHandled(qint64 request_usecs)
+{
+    QMutexLocker locker(&m_statsLock);
+    m_requests++;
+    m_requestUsecs += request_usecs;
+    m_maxRequestUsecs = max(m_maxRequestUsecs, (quint64)request_usecs);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+HttpServerStats HttpServer::GetStats(void) const
+{
+    HttpServerStats stats;
+    stats.m_activeConnections = m_activeConnections.load();
+    stats.m_idleConnections   = m_idleConnections.load();
+    stats.m_queuedConnections = m_queuedConnections.load();
+
+    QMutexLocker locker(&m_statsLock);
+    stats.m_requests        = m_requests;
+    stats.m_avgQueueUsecs   = m_workersStarted ?
+                              m_queueUsecs / m_workersStarted : 0;
+    stats.m_maxQueueUsecs   = m_maxQueueUsecs;
+    stats.m_avgRequestUsecs = m_requests ? m_requestUsecs / m_requests : 0;
+    stats.m_maxRequestUsecs = m_maxRequestUsecs;
+
+    return stats;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
 uint HttpServer::GetSocketTimeout(HTTPRequest* pRequest) const
 {
     int timeout = -1;
@@ -442,6 +608,267 @@ uint HttpServer::GetSocketTimeout(HTTPRequest* pRequest) const
     return timeout;
 }
 
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+//
+// HttpReactor Class Implementation
+//
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+
+HttpReactor::HttpReactor(HttpServer &httpServer, int id)
+           : MThread(QString("HttpReactor%1").arg(id)),
+             m_httpServer(httpServer), m_id(id), m_epoll(-1), m_wake(-1),
+             m_running(true), m_lastReport(0)
+{
+#ifdef __linux__
+    m_epoll = epoll_create1(EPOLL_CLOEXEC);
+    m_wake  = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+    if (m_epoll >= 0 && m_wake >= 0)
+    {
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events  = EPOLLIN;
+        ev.data.fd = m_wake;
+        if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wake, &ev) < 0)
+        {
+            close(m_wake);
+            m_wake = -1;
+        }
+    }
+
+    if (!IsValid())
+        LOG(VB_GENERAL, LOG_ERR, "HttpReactor: Unable to set up epoll" + ENO);
+#endif
+
+    m_clock.start();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+HttpReactor::~HttpReactor()
+{
+    Stop();
+
+#ifdef __linux__
+    if (m_wake >= 0)
+        close(m_wake);
+    if (m_epoll >= 0)
+        close(m_epoll);
+#endif
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Waits for the next request on socket, or closes it once timeout_ms
+ *        passes without one. Takes ownership of the socket.
+ */
+bool HttpReactor::Park(qt_socket_fd_t socket, int timeout_ms)
+{
+#ifdef __linux__
+    QMutexLocker locker(&m_lock);
+
+    if (m_running)
+    {
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events  = EPOLLIN | EPOLLRDHUP;
+        ev.data.fd = socket;
+        if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, socket, &ev) == 0)
+        {
+            m_deadlines[socket] = m_clock.elapsed() + timeout_ms;
+            return true;
+        }
+
+        LOG(VB_GENERAL, LOG_ERR, QString("HttpReactor(%1): Unable to wait "
+                                         "on socket").arg(socket) + ENO);
+    }
+
+    close(socket);
+#else
+    (void) socket;
+    (void) timeout_ms;
+#endif
+    return false;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HttpReactor::Stop(void)
+{
+    {
+        QMutexLocker locker(&m_lock);
+        m_running = false;
+    }
+    Wake();
+    wait();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HttpReactor::Wake(void)
+{
+#ifdef __linux__
+    if (m_wake >= 0)
+    {
+        uint64_t one = 1;
+        if (write(m_wake, &one, sizeof(one)) < 0)
+            LOG(VB_HTTP, LOG_DEBUG, "HttpReactor: wake failed" + ENO);
+    }
+#endif
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HttpReactor::run(void)
+{
+    RunProlog();
+
+#ifdef __linux__
+    const int kMaxEvents = 64;
+    struct epoll_event events[kMaxEvents];
+    qint64 lastExpire = m_clock.elapsed();
+
+    while (true)
+    {
+        {
+            QMutexLocker locker(&m_lock);
+            if (!m_running)
+                break;
+        }
+
+        int nEvents = epoll_wait(m_epoll, events, kMaxEvents, 250);
+        if (nEvents < 0 && errno != EINTR)
+        {
+            LOG(VB_GENERAL, LOG_ERR, "HttpReactor: epoll_wait failed" + ENO);
+            break;
+        }
+
+        for (int i = 0; i < nEvents; i++)
+        {
+            int socket = events[i].data.fd;
+            if (socket == m_wake)
+            {
+                uint64_t count;
+                if (read(m_wake, &count, sizeof(count)) < 0)
+                    LOG(VB_HTTP, LOG_DEBUG, "HttpReactor: read failed" + ENO);
+                continue;
+            }
+
+            {
+                QMutexLocker locker(&m_lock);
+                if (!m_deadlines.remove(socket))
+                    continue;
+                epoll_ctl(m_epoll, EPOLL_CTL_DEL, socket, NULL);
+            }
+
+            // A hang up with nothing left to read needs no worker
+            if ((events[i].events & (EPOLLHUP | EPOLLERR)) &&
+                !(events[i].events & EPOLLIN))
+            {
+                close(socket);
+                m_httpServer.ConnectionClosed(true);
+                continue;
+            }
+
+            m_httpServer.ResumeConnection(socket);
+        }
+
+        if (m_clock.elapsed() - lastExpire >= 250)
+        {
+            ExpireIdle();
+            lastExpire = m_clock.elapsed();
+        }
+
+        if (m_id == 0 && (m_clock.elapsed() - m_lastReport >= 60 * 1000) &&
+            VERBOSE_LEVEL_CHECK(VB_HTTP, LOG_INFO))
+        {
+            HttpServerStats stats = m_httpServer.GetStats();
+            LOG(VB_HTTP, LOG_INFO, QString("HttpServer: %1 active, %2 idle, "
+                    "%3 queued connections, %4 requests, "
+                    "queue avg %5 max %6 usecs, request avg %7 max %8 usecs")
+                .arg(stats.m_activeConnections).arg(stats.m_idleConnections)
+                .arg(stats.m_queuedConnections).arg(stats.m_requests)
+                .arg(stats.m_avgQueueUsecs).arg(stats.m_maxQueueUsecs)
+                .arg(stats.m_avgRequestUsecs).arg(stats.m_maxRequestUsecs));
+            m_lastReport = m_clock.elapsed();
+        }
+    }
+
+    CloseAll();
+#endif
+
+    RunEpilog();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HttpReactor::ExpireIdle(void)
+{
+#ifdef __linux__
+    qint64 now = m_clock.elapsed();
+    QList<int> expired;
+
+    {
+        QMutexLocker locker(&m_lock);
+        QMap<int, qint64>::iterator it = m_deadlines.begin();
+        while (it != m_deadlines.end())
+        {
+            if (*it > now)
+            {
+                ++it;
+                continue;
+            }
+            epoll_ctl(m_epoll, EPOLL_CTL_DEL, it.key(), NULL);
+            expired.append(it.key());
+            it = m_deadlines.erase(it);
+        }
+    }
+
+    for (int i = 0; i < expired.size(); i++)
+    {
+        LOG(VB_HTTP, LOG_DEBUG, QString("HttpReactor(%1): Keep-alive timeout, "
+                                        "closing connection")
+                                            .arg(expired[i]));
+        close(expired[i]);
+        m_httpServer.ConnectionClosed(true);
+    }
+#endif
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+void HttpReactor::CloseAll(void)
+{
+#ifdef __linux__
+    QMutexLocker locker(&m_lock);
+    QMap<int, qint64>::iterator it = m_deadlines.begin();
+    for (; it != m_deadlines.end(); ++it)
+    {
+        epoll_ctl(m_epoll, EPOLL_CTL_DEL, it.key(), NULL);
+        close(it.key());
+        m_httpServer.ConnectionClosed(true);
+    }
+    m_deadlines.clear();
+#endif
+}
+
 /////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////
 //
@@ -464,6 +891,7 @@ HttpWorker::HttpWorker(HttpServer &httpServer, qt_socket_fd_t sock,
 {
     LOG(VB_HTTP, LOG_INFO, QString("HttpWorker(%1): New connection")
                                         .arg(m_socket));
+    m_queued.start();
 }                  
 
 /////////////////////////////////////////////////////////////////////////////
@@ -482,6 +910,9 @@ void HttpWorker::run(void)
     HTTPRequest            *pRequest   = NULL;
     QTcpSocket             *pSocket;
     bool                    bEncrypted = false;
+    bool                    bParked    = false;
+
+    m_httpServer.WorkerStarted(m_queued.nsecsElapsed() / 1000);
 
     if (m_connectionType == kSSLServer)
     {
@@ -515,8 +946,12 @@ void HttpWorker::run(void)
         if (pSslSocket)
             pSocket = dynamic_cast<QTcpSocket *>(pSslSocket);
         else
+        {
+            m_httpServer.WorkerFinished();
             return;
+        }
 #else
+        m_httpServer.WorkerFinished();
         return;
 #endif
     }
@@ -528,6 +963,7 @@ void HttpWorker::run(void)
         {
             delete pSocket;
             pSocket = 0;
+            m_httpServer.WorkerFinished();
             return;
         }
 
@@ -535,6 +971,8 @@ void HttpWorker::run(void)
 
     pSocket->setSocketOption(QAbstractSocket::KeepAliveOption, QVariant(1));
     int nRequestsHandled = 0; // Allow debugging of keep-alive and connection re-use
+    bool bCanPark = m_httpServer.CanParkConnection(m_connectionType);
+    QElapsedTimer requestTimer;
 
     try
     {
@@ -560,6 +998,7 @@ void HttpWorker::run(void)
                 // See if this is a valid request
                 // ----------------------------------------------------------
 
+                requestTimer.start();
                 pRequest = new BufferedSocketDeviceRequest( pSocket );
                 if (pRequest != NULL)
                 {
@@ -614,6 +1053,21 @@ void HttpWorker::run(void)
 
                     delete pRequest;
                     pRequest = NULL;
+
+                    m_httpServer.RequestHandled(requestTimer.nsecsElapsed() / 1000);
+
+                    // ------------------------------------------------------
+                    // Rather than block this thread until the client sends
+                    // another request, hand the idle connection back to the
+                    // server to wait on.
+                    // ------------------------------------------------------
+                    if (bCanPark && bKeepAlive && m_httpServer.IsRunning() &&
+                        pSocket->state() == QAbstractSocket::ConnectedState &&
+                        pSocket->bytesAvailable() == 0)
+                    {
+                        bParked = true;
+                        break;
+                    }
                 }
                 else
                 {
@@ -647,6 +1101,7 @@ void HttpWorker::run(void)
 
     int writeTimeout = 5000; // 5 Seconds
     // Make sure any data in the buffer is flushed before the socket is closed
+    // or parked
     while (m_httpServer.IsRunning() &&
            pSocket->isValid() &&
            pSocket->state() == QAbstractSocket::ConnectedState &&
@@ -687,6 +1142,30 @@ void HttpWorker::run(void)
                                             .arg(pSocket->errorString()));
     }
 
+#ifdef __linux__
+    if (bParked && pSocket->bytesToWrite() == 0 && m_httpServer.IsRunning())
+    {
+        // The QTcpSocket closes its descriptor when deleted, so park a
+        // duplicate of it.
+        int socket = dup(pSocket->socketDescriptor());
+        pSocket->close();
+        delete pSocket;
+        pSocket = NULL;
+
+        if (socket >= 0)
+        {
+            LOG(VB_HTTP, LOG_DEBUG, QString("HttpWorker(%1): Parked idle "
+                                            "connection after %2 requests")
+                                                .arg(m_socket)
+                                                .arg(nRequestsHandled));
+            m_httpServer.ParkConnection(socket, m_socketTimeout);
+        }
+
+        m_httpServer.WorkerFinished();
+        return;
+    }
+#endif
+
     LOG(VB_HTTP, LOG_INFO, QString("HttpWorker(%1): Connection %2 closed. %3 requests were handled")
                                         .arg(m_socket)
                                         .arg(pSocket->socketDescriptor())
@@ -696,6 +1175,8 @@ void HttpWorker::run(void)
     delete pSocket;
     pSocket = NULL;
 
+    m_httpServer.WorkerFinished();
+
 #if 0
     LOG(VB_HTTP, LOG_DEBUG, "HttpWorkerThread::run() -- end");
 #endif
@@ -23,6 +23,8 @@
 
 // Qt headers
 #include <QReadWriteLock>
+#include <QElapsedTimer>
+#include <QAtomicInt>
 #include <QMultiMap>
 #include <QRunnable>
 #include <QPointer>
@@ -39,6 +41,7 @@
 #include "serverpool.h"
 #include "httprequest.h"
 #include "mthreadpool.h"
+#include "mthread.h"
 #include "upnputil.h"
 #include "compat.h"
 
@@ -47,6 +50,7 @@ typedef struct timeval  TaskTime;
 class HttpWorkerThread;
 class QScriptEngine;
 class HttpServer;
+class HttpReactor;
 #ifndef QT_NO_OPENSSL
 class QSslKey;
 class QSslCertificate;
@@ -101,6 +105,35 @@ class UPNP_PUBLIC HttpServerExtension : public QObject
 
 typedef QList<QPointer<HttpServerExtension> > HttpServerExtensionList;
 
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+//
+// HttpServerStats Class Definition
+//
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Snapshot of the connection, queue and latency counters of a server
+ */
+class UPNP_PUBLIC HttpServerStats
+{
+  public:
+    HttpServerStats() :
+        m_activeConnections(0), m_idleConnections(0), m_queuedConnections(0),
+        m_requests(0), m_avgQueueUsecs(0), m_maxQueueUsecs(0),
+        m_avgRequestUsecs(0), m_maxRequestUsecs(0) {}
+
+    int     m_activeConnections; ///< Being served by a worker thread
+    int     m_idleConnections;   ///< Keep-alive connections waiting in a reactor
+    int     m_queuedConnections; ///< Readable, waiting for a worker thread
+    quint64 m_requests;
+    quint64 m_avgQueueUsecs;     ///< From readable to picked up by a worker
+    quint64 m_maxQueueUsecs;
+    quint64 m_avgRequestUsecs;   ///< From parsing to response sent
+    quint64 m_maxRequestUsecs;
+};
+
 /////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////
 //
@@ -125,6 +158,15 @@ class UPNP_PUBLIC HttpServer : public ServerPool
      */
     uint GetSocketTimeout(HTTPRequest*) const;
 
+    bool CanParkConnection(PoolServerType type) const;
+    void ParkConnection(qt_socket_fd_t socket, int timeout_ms);
+    void ResumeConnection(qt_socket_fd_t socket);
+    void ConnectionClosed(bool idle);
+    void WorkerStarted(qint64 queue_usecs);
+    void WorkerFinished(void);
+    void RequestHandled(qint64 request_usecs);
+    HttpServerStats GetStats(void) const;
+
     QString GetSharePath(void) const
     { // never modified after creation, so no need to lock
         return m_sSharePath;
@@ -150,6 +192,20 @@ class UPNP_PUBLIC HttpServer : public ServerPool
     MThreadPool             m_threadPool;
     bool                    m_running; // protected by m_rwlock
 
+    // Idle keep-alive connections wait here instead of in a worker thread
+    QList<HttpReactor*>     m_reactors;
+
+    QAtomicInt              m_activeConnections;
+    QAtomicInt              m_idleConnections;
+    QAtomicInt              m_queuedConnections;
+    mutable QMutex          m_statsLock;
+    quint64                 m_requests;        // protected by m_statsLock
+    quint64                 m_queueUsecs;      // protected by m_statsLock
+    quint64                 m_maxQueueUsecs;   // protected by m_statsLock
+    quint64                 m_workersStarted;  // protected by m_statsLock
+    quint64                 m_requestUsecs;    // protected by m_statsLock
+    quint64                 m_maxRequestUsecs; // protected by m_statsLock
+
     static QMutex           s_platformLock;
     static QString          s_platform;
 
@@ -166,6 +222,52 @@ class UPNP_PUBLIC HttpServer : public ServerPool
     void LoadSSLConfig();
 };
 
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+//
+// HttpReactor Class Definition
+//
+/////////////////////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////////////
+
+/**
+ * \brief Waits on idle keep-alive connections with epoll
+ *
+ * A worker that has answered a request and finds no further request
+ * waiting parks the plain TCP socket here and returns to the pool. When the
+ * client sends its next request the socket is handed to a new HttpWorker;
+ * when the keep-alive timeout passes first it is closed. Only available on
+ * Linux, elsewhere workers keep waiting on their connection.
+ */
+class HttpReactor : public MThread
+{
+  public:
+    explicit HttpReactor(HttpServer &httpServer, int id);
+    ~HttpReactor();
+
+    bool IsValid(void) const { return m_epoll >= 0 && m_wake >= 0; }
+    bool Park(qt_socket_fd_t socket, int timeout_ms);
+    void Stop(void);
+
+  protected:
+    virtual void run(void); // MThread
+
+  private:
+    void Wake(void);
+    void ExpireIdle(void);
+    void CloseAll(void);
+
+    HttpServer         &m_httpServer;
+    int                 m_id;
+    int                 m_epoll;
+    int                 m_wake;
+    QElapsedTimer       m_clock;
+    QMutex              m_lock;
+    QMap<int, qint64>   m_deadlines; // protected by m_lock
+    bool                m_running;   // protected by m_lock
+    qint64              m_lastReport;
+};
+
 /////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////
 //
@@ -197,6 +299,7 @@ class HttpWorker : public QRunnable
     qt_socket_fd_t m_socket;
     int         m_socketTimeout;
     PoolServerType m_connectionType;
+    QElapsedTimer  m_queued;
 
 #ifndef QT_NO_OPENSSL
     QSslConfiguration       m_sslConfig;
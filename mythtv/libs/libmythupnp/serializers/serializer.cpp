@@ -103,6 +103,8 @@ void Serializer::SerializeObjectProperties( const QObject *pObject )
 {
     if (pObject != NULL)
     {
+        ++m_nDepth;
+
         const QMetaObject *pMetaObject = pObject->metaObject();
 
         int nCount = pMetaObject->propertyCount();
@@ -118,7 +120,21 @@ void Serializer::SerializeObjectProperties( const QObject *pObject )
 
                 if ( sPropName.compare( "objectName" ) == 0)
                     continue;
-                
+
+                QVariant value( pObject->property( pszPropName ) );
+
+                // A property named in Fields= is returned complete
+
+                bool bAll = false;
+
+                if (!m_fields.IsEmpty() && m_nProjectAll == 0)
+                {
+                    if (m_fields.Contains( sPropName ))
+                        bAll = true;
+                    else if (!IsProjected( pObject, metaProperty, value ))
+                        continue;
+                }
+
                 bool bHash = false;
 
                 if (ReadPropertyMetadata( pObject, 
@@ -129,19 +145,44 @@ void Serializer::SerializeObjectProperties( const QObject *pObject )
                     m_hash.addData( sPropName.toUtf8() );
                 }
 
-                QVariant value( pObject->property( pszPropName ) );
-
                 if (bHash && !value.canConvert< QObject* >()) 
                 {
                     m_hash.addData( value.toString().toUtf8() );
                 }
 
+                if (bAll)
+                    ++m_nProjectAll;
+
                 AddProperty( sPropName, value, pMetaObject, &metaProperty );
+
+                if (bAll)
+                    --m_nProjectAll;
             }
         }
+
+        --m_nDepth;
     }
 }
 
+//////////////////////////////////////////////////////////////////////////////
+//
+//////////////////////////////////////////////////////////////////////////////
+
+bool Serializer::IsProjected( const QObject       *pObject,
+                              const QMetaProperty &metaProperty,
+                              const QVariant      &value )
+{
+    // Objects and lists are kept if anything inside them was asked for
+
+    if (value.canConvert< QObject* >() || value.type() == QVariant::List)
+        return m_fields.Includes( pObject, metaProperty, value );
+
+    // Plain values of the outermost object (Count, TotalAvailable, etc.)
+    // describe the response itself and are always kept
+
+    return m_nDepth == 1;
+}
+
 /////////////////////////////////////////////////////////////////////////////
 //
 /////////////////////////////////////////////////////////////////////////////
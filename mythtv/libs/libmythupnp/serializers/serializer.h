@@ -15,6 +15,7 @@
 
 #include "upnpexp.h"
 #include "upnputil.h"
+#include "fieldprojection.h"
 
 #include <QList>
 #include <QMetaType>
@@ -33,6 +34,9 @@ class UPNP_PUBLIC Serializer
     protected:
 
         QCryptographicHash  m_hash;
+        DTC::FieldProjection m_fields;
+        int                 m_nDepth;
+        int                 m_nProjectAll;
 
         virtual void BeginSerialize( QString &/*sName*/ ) {}
         virtual void EndSerialize  () {}
@@ -54,6 +58,10 @@ class UPNP_PUBLIC Serializer
                                                  QString  sPropName, 
                                                  QString  sKey );
 
+        bool       IsProjected           ( const QObject       *pObject,
+                                           const QMetaProperty &metaProperty,
+                                           const QVariant      &value );
+
     public:
 
         virtual void Serialize( const QObject *pObject, const QString &_sName = QString() );
@@ -66,6 +74,9 @@ class UPNP_PUBLIC Serializer
         virtual QString GetContentType () = 0;
         virtual void    AddHeaders     ( QStringMap &headers );
 
+        // Only serialize the properties named in sFields, see DTC::FieldProjection
+        void            SetFields      ( const QString &sFields ) { m_fields = DTC::FieldProjection( sFields ); }
+
 
         inline Serializer();
 };
@@ -73,7 +84,7 @@ class UPNP_PUBLIC Serializer
 Q_DECLARE_METATYPE( QList<QObject*> )
 
 inline Serializer::Serializer() :
-    m_hash(QCryptographicHash::Sha1)
+    m_hash(QCryptographicHash::Sha1), m_nDepth(0), m_nProjectAll(0)
 {
     qRegisterMetaType< QList<QObject*> >("QList<QObject*>");
 }
@@ -78,6 +78,7 @@ using namespace std;
 #include "musicmetadata.h"
 #include "imagemanager.h"
 #include "cardutil.h"
+#include "pretuner.h"
 
 // mythbackend headers
 #include "backendcontext.h"
@@ -244,7 +245,8 @@ MainServer::MainServer(bool master, int port,
     masterServerReconnect(NULL),
     masterServer(NULL), ismaster(master), threadPool("ProcessRequestPool"),
     masterBackendOverride(false),
-    m_sched(sched), m_expirer(expirer), deferredDeleteTimer(NULL),
+    m_sched(sched), m_expirer(expirer), m_preTuner(NULL),
+    deferredDeleteTimer(NULL),
     autoexpireUpdateTimer(NULL), m_exitCode(GENERIC_EXIT_OK),
     m_stopped(false)
 {
@@ -324,6 +326,7 @@ MainServer::MainServer(bool master, int port,
         expirer->SetMainServer(this);
 
     metadatafactory = new MetadataFactory(this);
+    metadatafactory->WatchVideoDirectories();
 
     autoexpireUpdateTimer = new QTimer(this);
     connect(autoexpireUpdateTimer, SIGNAL(timeout()),
@@ -347,6 +350,10 @@ MainServer::MainServer(bool master, int port,
         MThreadPool::globalInstance()->startReserved(
             masterFreeSpaceListUpdater, "FreeSpaceUpdater");
     }
+
+    // Frontends only ask the master for free inputs
+    if (master && gCoreContext->GetNumSetting("LiveTVPreTune", 0))
+        m_preTuner = new PreTuner(encoderList);
 }
 
 MainServer::~MainServer()
@@ -369,6 +376,9 @@ void MainServer::Stop()
 
     threadPool.Stop();
 
+    delete m_preTuner;
+    m_preTuner = NULL;
+
     // since Scheduler::SetMainServer() isn't thread-safe
     // we need to shut down the scheduler thread before we
     // can call SetMainServer(NULL)
@@ -698,6 +708,16 @@ void MainServer::ProcessRequestWork(MythSocket *sock)
         else
             HandleGetFreeInputInfo(pbs, tokens[1].toUInt());
     }
+    else if (command == "GET_PRETUNED_INPUT")
+    {
+        if (tokens.size() == 2)
+            HandleGetPreTunedInput(pbs, tokens[1].toUInt());
+        else if (tokens.size() == 4)
+            HandleGetPreTunedInput(pbs, tokens[1].toUInt(),
+                                   tokens[2].toUInt(), tokens[3].toInt());
+        else
+            SendErrorResponse(pbs, "Bad GET_PRETUNED_INPUT");
+    }
     else if (command == "QUERY_RECORDER")
     {
         if (tokens.size() != 2)
@@ -4304,6 +4324,50 @@ void MainServer::HandleGetFreeInputInfo(PlaybackSock *pbs,
     SendResponse(pbssock, strlist);
 }
 
+/**
+ *  \brief Returns an idle input pre-tuned to chanid and the chanid.
+ *
+ *  If chanid is 0, it is the channel inputid would change to in
+ *  direction, worked out by the input's channel as for a channel change.
+ */
+void MainServer::HandleGetPreTunedInput(PlaybackSock *pbs, uint chanid,
+                                        uint inputid, int direction)
+{
+    EncoderLink *enc = encoderList->value(inputid, NULL);
+    if (!chanid && enc && enc->IsLocal())
+    {
+        BrowseDirection browse = BROWSE_INVALID;
+        if (direction == CHANNEL_DIRECTION_UP)
+            browse = BROWSE_UP;
+        else if (direction == CHANNEL_DIRECTION_DOWN)
+            browse = BROWSE_DOWN;
+        else if (direction == CHANNEL_DIRECTION_FAVORITE)
+            browse = BROWSE_FAVORITE;
+
+        uint sourceid = 0;
+        QString callsign, channum, channame, xmltv;
+        if (browse != BROWSE_INVALID &&
+            enc->GetChannelInfo(chanid, sourceid, callsign, channum,
+                                channame, xmltv))
+        {
+            QString title, subtitle, desc, category, starttime, endtime;
+            QString iconpath, seriesid, programid;
+            enc->GetNextProgram(browse, title, subtitle, desc, category,
+                                starttime, endtime, callsign, iconpath,
+                                channum, chanid, seriesid, programid);
+        }
+        else
+            chanid = 0;
+    }
+
+    uint pretuned = (chanid && m_preTuner) ?
+        m_preTuner->GetPreTunedInput(chanid) : 0;
+
+    QStringList strlist;
+    strlist << QString::number(pretuned) << QString::number(chanid);
+    SendResponse(pbs->getSocket(), strlist);
+}
+
 static QString cleanup(const QString &str)
 {
     if (str == " ")
@@ -4341,6 +4405,7 @@ void MainServer::HandleRecorderQuery(QStringList &slist, QStringList &commands,
     QString command = slist[1];
 
     QStringList retlist;
+    bool tuned = false;
 
     EncoderLink *enc = *iter;
     if (!enc->IsConnected())
@@ -4480,6 +4545,7 @@ void MainServer::HandleRecorderQuery(QStringList &slist, QStringList &commands,
 
         enc->SpawnLiveTV(chain, slist[3].toInt(), slist[4]);
         retlist << "OK";
+        tuned = true;
     }
     else if (command == "STOP_LIVETV")
     {
@@ -4539,12 +4605,14 @@ void MainServer::HandleRecorderQuery(QStringList &slist, QStringList &commands,
             (ChannelChangeDirection) slist[2].toInt();
         enc->ChangeChannel(direction);
         retlist << "OK";
+        tuned = true;
     }
     else if (command == "SET_CHANNEL")
     {
         QString name = slist[2];
         enc->SetChannel(name);
         retlist << "OK";
+        tuned = true;
     }
     else if (command == "SET_SIGNAL_MONITORING_RATE")
     {
@@ -4684,6 +4752,10 @@ void MainServer::HandleRecorderQuery(QStringList &slist, QStringList &commands,
     }
 
     SendResponse(pbssock, retlist);
+
+    // After responding, so the frontend doesn't wait for it
+    if (tuned && m_preTuner)
+        m_preTuner->LiveTVTuned(enc);
 }
 
 void MainServer::HandleSetNextLiveTVDir(QStringList &commands,
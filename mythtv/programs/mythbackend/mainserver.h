@@ -34,6 +34,7 @@ class QTimer;
 class FileSystemInfo;
 class MetadataFactory;
 class FreeSpaceUpdater;
+class PreTuner;
 
 class DeleteStruct 
 {
@@ -200,6 +201,8 @@ class MainServer : public QObject, public MythSocketCBs
     void HandleSGGetFileList(QStringList &sList, PlaybackSock *pbs);
     void HandleSGFileQuery(QStringList &sList, PlaybackSock *pbs);
     void HandleGetFreeInputInfo(PlaybackSock *pbs, uint excluded_input);
+    void HandleGetPreTunedInput(PlaybackSock *pbs, uint chanid,
+                                uint inputid = 0, int direction = -1);
     void HandleGetNextFreeRecorder(QStringList &slist, PlaybackSock *pbs);
     void HandleGetFreeRecorder(PlaybackSock *pbs);
     void HandleGetFreeRecorderCount(PlaybackSock *pbs);
@@ -330,6 +333,7 @@ class MainServer : public QObject, public MythSocketCBs
 
     Scheduler *m_sched;
     AutoExpire *m_expirer;
+    PreTuner *m_preTuner;
 
     struct DeferredDeleteStruct
     {
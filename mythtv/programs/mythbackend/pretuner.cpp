@@ -0,0 +1,246 @@
+// C++ headers
+#include <algorithm>
+#include <vector>
+using namespace std;
+
+// Qt headers
+#include <QPair>
+#include <QSet>
+
+// MythTV headers
+#include "mythcorecontext.h"
+#include "mythlogging.h"
+#include "encoderlink.h"
+#include "channelutil.h"
+#include "inputinfo.h"
+#include "cardutil.h"
+#include "pretuner.h"
+#include "tv_rec.h"
+
+#define LOC QString("PreTuner: ")
+
+PreTuner::PreTuner(QMap<int, EncoderLink *> *encoders) :
+    m_encoders(encoders), m_changes(0), m_hits(0)
+{
+}
+
+/**
+ *  \brief Called after a LiveTV input has been tuned, to record the
+ *         channel change and pre-tune the channels likely to be next.
+ */
+void PreTuner::LiveTVTuned(EncoderLink *enc)
+{
+    uint chanid = CurrentChanID(enc);
+    if (!chanid)
+        return;
+
+    uint inputid  = enc->GetInputID();
+    uint sourceid = CardUtil::GetSourceID(inputid);
+
+    QMutexLocker locker(&m_lock);
+
+    uint from = m_watching.value(inputid, 0);
+
+    // The frontend switched to an input tuned for it
+    QMap<uint, PreTune>::iterator it = m_preTuned.find(inputid);
+    if (it != m_preTuned.end())
+    {
+        if ((*it).chanid == chanid)
+        {
+            ++m_hits;
+            from = (*it).from;
+        }
+        m_preTuned.erase(it);
+    }
+
+    m_watching[inputid] = chanid;
+
+    if (from && from != chanid)
+    {
+        ++m_transitions[from][chanid];
+
+        if ((++m_changes % kReportInterval) == 0)
+        {
+            LOG(VB_GENERAL, LOG_INFO, LOC +
+                QString("%1 of %2 channel changes were to a pre-tuned "
+                        "channel (%3%)").arg(m_hits).arg(m_changes)
+                .arg(m_hits * 100 / m_changes));
+        }
+    }
+
+    QList<uint> likely = LikelyChannels(sourceid, chanid);
+    QList<EncoderLink*> idle = IdleInputs(sourceid);
+
+    // Keep the inputs that are already on one of the channels
+    QList<EncoderLink*> spare;
+    for (int i = 0; i < idle.size(); ++i)
+    {
+        it = m_preTuned.find(idle[i]->GetInputID());
+        if (it != m_preTuned.end())
+        {
+            if (likely.removeOne((*it).chanid))
+            {
+                (*it).from = chanid;
+                continue;
+            }
+            m_preTuned.erase(it);
+        }
+        spare.push_back(idle[i]);
+    }
+
+    for (int i = 0; i < spare.size() && !likely.empty(); ++i)
+    {
+        uint next = likely.takeFirst();
+        QString channum = ChannelUtil::GetChanNum(next);
+        TVRec *rec = spare[i]->GetTVRec();
+
+        if (channum.isEmpty() || !rec || !rec->QueueEITChannelChange(channum))
+            continue;
+
+        LOG(VB_CHANNEL, LOG_INFO, LOC + QString("Tuning input %1 to %2")
+            .arg(spare[i]->GetInputID()).arg(channum));
+
+        PreTune pretune;
+        pretune.chanid = next;
+        pretune.from   = chanid;
+        m_preTuned[spare[i]->GetInputID()] = pretune;
+    }
+}
+
+/**
+ *  \return An idle input tuned to chanid, or 0 if there isn't one
+ */
+uint PreTuner::GetPreTunedInput(uint chanid)
+{
+    QMutexLocker locker(&m_lock);
+
+    QMap<uint, PreTune>::iterator it = m_preTuned.begin();
+    while (it != m_preTuned.end())
+    {
+        if ((*it).chanid != chanid)
+        {
+            ++it;
+            continue;
+        }
+
+        // Make sure the EIT scanner or a recording hasn't retuned it
+        EncoderLink *enc = m_encoders->value(it.key(), NULL);
+        if (enc && enc->GetState() == kState_None &&
+            !enc->IsBusy(NULL, kRecordingBufferSecs) &&
+            CurrentChanID(enc) == chanid)
+        {
+            return it.key();
+        }
+
+        it = m_preTuned.erase(it);
+    }
+
+    return 0;
+}
+
+/// \note m_lock must be held
+QList<uint> PreTuner::LikelyChannels(uint sourceid, uint chanid) const
+{
+    QList<uint> likely;
+
+    // The channels most often changed to from this one
+    vector<QPair<uint, uint> > frequent;
+    const QHash<uint, uint> to = m_transitions.value(chanid);
+    QHash<uint, uint>::const_iterator it = to.begin();
+    for (; it != to.end(); ++it)
+        frequent.push_back(qMakePair(it.value(), it.key()));
+    sort(frequent.rbegin(), frequent.rend());
+
+    for (uint i = 0; i < frequent.size() && i < (uint)kMaxFrequent; ++i)
+        likely.push_back(frequent[i].second);
+
+    // Then the channels either side of it
+    ChannelInfoList channels = ChannelUtil::GetChannels(sourceid, true);
+    ChannelUtil::SortChannels(
+        channels, gCoreContext->GetSetting("ChannelOrdering", "channum"),
+        true);
+
+    uint up   = ChannelUtil::GetNextChannel(
+        channels, chanid, 0, 0, CHANNEL_DIRECTION_UP);
+    uint down = ChannelUtil::GetNextChannel(
+        channels, chanid, 0, 0, CHANNEL_DIRECTION_DOWN);
+
+    if (up && up != chanid && !likely.contains(up))
+        likely.push_back(up);
+    if (down && down != chanid && !likely.contains(down))
+        likely.push_back(down);
+
+    return likely;
+}
+
+/**
+ *  \brief Returns the local inputs on sourceid that are free for LiveTV,
+ *         have no recording starting soon, and don't share a tuner
+ *         with a busy input.
+ *  \note m_lock must be held
+ */
+QList<EncoderLink*> PreTuner::IdleInputs(uint sourceid)
+{
+    QList<EncoderLink*> idle;
+    QList<QSet<uint> > idle_groups;
+    QSet<uint> busy_groups;
+
+    QMap<int, EncoderLink *>::const_iterator it = m_encoders->begin();
+    for (; it != m_encoders->end(); ++it)
+    {
+        EncoderLink *enc = *it;
+        if (!enc->IsConnected() || enc->IsTunerLocked())
+            continue;
+
+        InputInfo info;
+        info.inputid = enc->GetInputID();
+        vector<uint> groups;
+        CardUtil::GetInputInfo(info, &groups);
+
+        QSet<uint> group_set;
+        for (uint i = 0; i < groups.size(); ++i)
+            group_set.insert(groups[i]);
+
+        if (enc->GetState() != kState_None ||
+            enc->IsBusy(NULL, kRecordingBufferSecs))
+        {
+            m_preTuned.remove(info.inputid);
+            busy_groups.unite(group_set);
+            continue;
+        }
+
+        m_watching.remove(info.inputid);
+
+        if (enc->IsLocal() && info.livetvorder && info.sourceid == sourceid)
+        {
+            idle.push_back(enc);
+            idle_groups.push_back(group_set);
+        }
+    }
+
+    for (int i = idle.size() - 1; i >= 0; --i)
+    {
+        if (!QSet<uint>(idle_groups[i]).intersect(busy_groups).isEmpty())
+        {
+            m_preTuned.remove(idle[i]->GetInputID());
+            idle.removeAt(i);
+        }
+    }
+
+    return idle;
+}
+
+uint PreTuner::CurrentChanID(EncoderLink *enc)
+{
+    TVRec *rec = enc->GetTVRec();
+    if (!enc->IsLocal() || !rec)
+        return 0;
+
+    uint chanid = 0, sourceid = 0;
+    QString callsign, channum, channame, xmltvid;
+    if (!rec->GetChannelInfo(chanid, sourceid, callsign, channum,
+                             channame, xmltvid))
+        return 0;
+
+    return chanid;
+}
@@ -0,0 +1,61 @@
+#ifndef PRETUNER_H_
+#define PRETUNER_H_
+
+#include <QMutex>
+#include <QHash>
+#include <QList>
+#include <QMap>
+
+class EncoderLink;
+
+/** \class PreTuner
+ *  \brief Tunes idle inputs to the channels a LiveTV viewer is likely to
+ *         change to next.
+ *
+ *  The frontend asks which input is pre-tuned to the channel it is
+ *  changing to, and switches to that input instead of retuning the one
+ *  it is watching.  The likely channels are the ones most often changed
+ *  to from the current channel, then the channels either side of it.
+ *
+ *  Only idle local inputs on the same video source are used.  Inputs
+ *  with a recording about to start, or sharing a tuner with a busy
+ *  input, are left alone, and the scheduler can take a pre-tuned input
+ *  at any time since it is still idle.
+ */
+class PreTuner
+{
+  public:
+    explicit PreTuner(QMap<int, EncoderLink *> *encoders);
+
+    void LiveTVTuned(EncoderLink *enc);
+    uint GetPreTunedInput(uint chanid);
+
+  private:
+    struct PreTune
+    {
+        uint chanid;
+        uint from;      ///< The channel being watched when it was tuned
+    };
+
+    QList<uint> LikelyChannels(uint sourceid, uint chanid) const;
+    QList<EncoderLink*> IdleInputs(uint sourceid);
+    static uint CurrentChanID(EncoderLink *enc);
+
+    QMap<int, EncoderLink *> *m_encoders;
+
+    QMutex                 m_lock;
+    QMap<uint, uint>       m_watching;     ///< LiveTV input -> chanid
+    QMap<uint, PreTune>    m_preTuned;     ///< Idle input -> channel
+    /// Channel changed from -> channel changed to -> times
+    QHash<uint, QHash<uint, uint> > m_transitions;
+    uint                   m_changes;
+    uint                   m_hits;
+
+    /// Leave inputs with a recording starting this soon alone
+    static const int  kRecordingBufferSecs = 10 * 60;
+    /// Most frequent changes from a channel to pre-tune
+    static const int  kMaxFrequent         = 2;
+    static const uint kReportInterval      = 20;
+};
+
+#endif // PRETUNER_H_
@@ -26,6 +26,8 @@
 #include <QMap>
 #include <QRegExp>
 
+#include <algorithm>
+
 #include "dvr.h"
 
 #include "compat.h"
@@ -45,6 +47,7 @@
 #include "recordingtypes.h"
 
 #include "serviceUtil.h"
+#include "fieldprojection.h"
 #include "mythscheduler.h"
 #include "storagegroup.h"
 #include "playgroup.h"
@@ -59,13 +62,113 @@ extern AutoExpire  *expirer;
 //
 /////////////////////////////////////////////////////////////////////////////
 
+// A cursor names the last recording of a page by its start time and
+// recordedid, the columns recordings are ordered by. It stays valid when
+// recordings are added or deleted, unlike a StartIndex.
+
+static QString MakeRecordedCursor( const ProgramInfo *pInfo )
+{
+    QString sCursor = QString("%1|%2")
+        .arg(MythDate::toString(pInfo->GetRecordingStartTime(),
+                                MythDate::ISODate))
+        .arg(pInfo->GetRecordingID());
+
+    return sCursor.toUtf8().toBase64(QByteArray::Base64UrlEncoding |
+                                     QByteArray::OmitTrailingEquals);
+}
+
+static bool ParseRecordedCursor( const QString &sCursor,
+                                 QDateTime &dtStart, uint &nRecordedId )
+{
+    QString sValue = QString::fromUtf8(
+        QByteArray::fromBase64(sCursor.toLatin1(),
+                               QByteArray::Base64UrlEncoding));
+
+    QStringList parts = sValue.split('|');
+
+    if (parts.size() != 2)
+        return false;
+
+    bool ok = false;
+
+    dtStart     = MythDate::fromString(parts[0]);
+    nRecordedId = parts[1].toUInt(&ok);
+
+    return ok && dtStart.isValid();
+}
+
+static int CountRecorded( const QString &sSQL, const MSqlBindings &bindings )
+{
+    MSqlQuery query(MSqlQuery::InitCon());
+
+    query.prepare("SELECT COUNT(*) FROM recorded AS r WHERE " + sSQL);
+    query.bindValues(bindings);
+
+    if (!query.exec() || !query.next())
+    {
+        MythDB::DBError("CountRecorded", query);
+        return 0;
+    }
+
+    return query.value(0).toInt();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
 DTC::ProgramList* Dvr::GetRecordedList( bool           bDescending,
                                         int            nStartIndex,
                                         int            nCount,
                                         const QString &sTitleRegEx,
                                         const QString &sRecGroup,
-                                        const QString &sStorageGroup )
+                                        const QString &sStorageGroup,
+                                        const QString &sCursor,
+                                        const QString &sFields )
 {
+    QDateTime dtCursor;
+    uint      nCursorId = 0;
+
+    if (!sCursor.isEmpty() && !ParseRecordedCursor(sCursor, dtCursor, nCursorId))
+        throw QString("Cursor is invalid");
+
+    nStartIndex = std::max(nStartIndex, 0);
+
+    // ----------------------------------------------------------------------
+    // Filter in the database, only the title regular expression has to be
+    // applied once the recordings are loaded
+    // ----------------------------------------------------------------------
+
+    QString      sSQL = "r.deletepending = 0";
+    MSqlBindings bindings;
+
+    if (!sRecGroup.isEmpty())
+    {
+        sSQL += " AND r.recgroup = :RECGROUP";
+        bindings[":RECGROUP"] = sRecGroup;
+    }
+
+    if (!sStorageGroup.isEmpty())
+    {
+        sSQL += " AND r.storagegroup = :STORAGEGROUP";
+        bindings[":STORAGEGROUP"] = sStorageGroup;
+    }
+
+    QString      sCursorSQL = sSQL;
+    MSqlBindings cursorBindings = bindings;
+
+    if (dtCursor.isValid())
+    {
+        const char *op = bDescending ? "<" : ">";
+
+        sCursorSQL += QString(" AND (r.starttime %1 :CURSORSTART OR "
+                              "(r.starttime = :CURSORSTART2 AND "
+                              "r.recordedid %1 :CURSORID))").arg(op);
+        cursorBindings[":CURSORSTART"]  = dtCursor;
+        cursorBindings[":CURSORSTART2"] = dtCursor;
+        cursorBindings[":CURSORID"]     = nCursorId;
+    }
+
     QMap< QString, ProgramInfo* > recMap;
 
     if (gCoreContext->GetScheduler())
@@ -80,7 +183,72 @@ DTC::ProgramList* Dvr::GetRecordedList( bool           bDescending,
     if (bDescending)
         desc = -1;
 
-    LoadFromRecorded( progList, false, inUseMap, isJobRunning, recMap, desc );
+    // One more than asked for tells us whether there is a next page
+
+    uint nLimit = (nCount > 0) ? nCount + 1 : 0;
+    int  nAvailable;
+    uint nFirst = 0;
+
+    if (sTitleRegEx.isEmpty())
+    {
+        nAvailable = CountRecorded(sSQL, bindings);
+
+        if (dtCursor.isValid())
+        {
+            nStartIndex = nAvailable - CountRecorded(sCursorSQL, cursorBindings);
+
+            LoadFromRecorded( progList, sCursorSQL, cursorBindings, inUseMap,
+                              isJobRunning, recMap, desc, 0, nLimit );
+        }
+        else
+        {
+            LoadFromRecorded( progList, sSQL, bindings, inUseMap,
+                              isJobRunning, recMap, desc, nStartIndex, nLimit );
+        }
+    }
+    else
+    {
+        LoadFromRecorded( progList, sSQL, bindings, inUseMap,
+                          isJobRunning, recMap, desc );
+
+        QRegExp rTitleRegEx = QRegExp(sTitleRegEx, Qt::CaseInsensitive);
+
+        ProgramList::iterator it = progList.begin();
+
+        while (it != progList.end())
+        {
+            if (!(*it)->GetTitle().contains(rTitleRegEx))
+                it = progList.erase(it);
+            else
+                ++it;
+        }
+
+        nAvailable = progList.size();
+
+        if (dtCursor.isValid())
+        {
+            nStartIndex = 0;
+
+            for (; nFirst < progList.size(); ++nFirst, ++nStartIndex)
+            {
+                QDateTime dtStart = progList[nFirst]->GetRecordingStartTime();
+                uint      nId     = progList[nFirst]->GetRecordingID();
+
+                bool bAfter = (dtStart > dtCursor) ||
+                              (dtStart == dtCursor && nId > nCursorId);
+                if (bDescending)
+                    bAfter = (dtStart < dtCursor) ||
+                             (dtStart == dtCursor && nId < nCursorId);
+
+                if (bAfter)
+                    break;
+            }
+        }
+        else
+        {
+            nFirst = std::min((uint)nStartIndex, (uint)progList.size());
+        }
+    }
 
     QMap< QString, ProgramInfo* >::iterator mit = recMap.begin();
 
@@ -92,40 +260,36 @@ DTC::ProgramList* Dvr::GetRecordedList( bool           bDescending,
     // ----------------------------------------------------------------------
 
     DTC::ProgramList *pPrograms = new DTC::ProgramList();
-    int nAvailable = 0;
 
-    int nMax      = (nCount > 0) ? nCount : progList.size();
+    // Don't build the parts of each program that weren't asked for
 
-    nAvailable = 0;
-    nCount = 0;
+    DTC::FieldProjection fields( sFields );
+    DTC::Program         program;
+
+    bool bIncChannel = fields.Includes( &program, "Channel" );
+    bool bIncCast    = fields.Includes( &program, "Cast"    );
+    bool bIncArtwork = fields.Includes( &program, "Artwork" );
+
+    uint nMax  = (nCount > 0) ? nFirst + nCount : progList.size();
+    uint nLast = std::min(nMax, (uint)progList.size());
 
-    QRegExp rTitleRegEx        = QRegExp(sTitleRegEx, Qt::CaseInsensitive);
+    nCount = 0;
 
-    for( unsigned int n = 0; n < progList.size(); n++)
+    for( uint n = nFirst; n < nLast; n++)
     {
         ProgramInfo *pInfo = progList[ n ];
 
-        if (pInfo->IsDeletePending() ||
-            (!sTitleRegEx.isEmpty() && !pInfo->GetTitle().contains(rTitleRegEx)) ||
-            (!sRecGroup.isEmpty() && sRecGroup != pInfo->GetRecordingGroup()) ||
-            (!sStorageGroup.isEmpty() && sStorageGroup != pInfo->GetStorageGroup()))
-            continue;
+        DTC::Program *pProgram = pPrograms->AddNewProgram();
 
-        if ((nAvailable < nStartIndex) ||
-            (nCount >= nMax))
-        {
-            ++nAvailable;
-            continue;
-        }
+        FillProgramInfo( pProgram, pInfo, bIncChannel, true, bIncCast,
+                         bIncArtwork );
 
-        ++nAvailable;
         ++nCount;
-
-        DTC::Program *pProgram = pPrograms->AddNewProgram();
-
-        FillProgramInfo( pProgram, pInfo, true );
     }
 
+    if (nLast < progList.size() && nLast > 0)
+        pPrograms->setNextCursor( MakeRecordedCursor( progList[ nLast - 1 ] ));
+
     // ----------------------------------------------------------------------
 
     pPrograms->setStartIndex    ( nStartIndex     );
@@ -48,7 +48,9 @@ class Dvr : public DvrServices
                                                 int              Count,
                                                 const QString   &TitleRegEx,
                                                 const QString   &RecGroup,
-                                                const QString   &StorageGroup );
+                                                const QString   &StorageGroup,
+                                                const QString   &Cursor,
+                                                const QString   &Fields );
 
         DTC::ProgramList* GetOldRecordedList  ( bool             Descending,
                                                 int              StartIndex,
@@ -323,7 +325,8 @@ class ScriptableDvr : public QObject
             SCRIPT_CATCH_EXCEPTION( NULL,
                 return m_obj.GetRecordedList( Descending, StartIndex, Count,
                                               TitleRegEx, RecGroup,
-                                              StorageGroup);
+                                              StorageGroup, QString(),
+                                              QString() );
             )
         }
 
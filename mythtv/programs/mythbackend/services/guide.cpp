@@ -35,6 +35,7 @@
 #include "channelutil.h"
 #include "channelgroup.h"
 #include "storagegroup.h"
+#include "fieldprojection.h"
 
 #include "mythlogging.h"
 
@@ -50,7 +51,8 @@ DTC::ProgramGuide *Guide::GetProgramGuide( const QDateTime &rawStartTime ,
                                            bool             bDetails,
                                            int              nChannelGroupId,
                                            int              nStartIndex,
-                                           int              nCount)
+                                           int              nCount,
+                                           const QString   &sFields )
 {
     if (!rawStartTime.isValid())
         throw QString( "StartTime is invalid" );
@@ -86,19 +88,24 @@ DTC::ProgramGuide *Guide::GetProgramGuide( const QDateTime &rawStartTime ,
     // Build SQL statement for Program Listing
     // ----------------------------------------------------------------------
 
+    // The programmes of all the channels on this page are loaded with one
+    // query rather than one per channel
+
     ProgramList  schedList;
     MSqlBindings bindings;
+    QStringList  chanIds;
+
+    ChannelInfoList::iterator chan_it;
+    for (chan_it = chanList.begin(); chan_it != chanList.end(); ++chan_it)
+        chanIds << QString::number((*chan_it).chanid);
 
-    QString sWhere   = "program.chanid = :CHANID "
+    QString sWhere   = "program.chanid IN (" + chanIds.join(",") + ") "
                        "AND program.endtime >= :STARTDATE "
                        "AND program.starttime < :ENDDATE "
                        "AND program.starttime >= :STARTDATELIMIT "
                        "AND program.manualid = 0"; // Omit 'manual' recordings scheds
 
-    QString sGroupBy = "program.starttime, channel.channum,"
-                       "channel.callsign, program.title";
-
-    QString sOrderBy = "program.starttime";
+    QString sOrderBy = "program.chanid, program.starttime";
 
     bindings[":STARTDATE"     ] = dtStartTime;
     bindings[":STARTDATELIMIT"] = dtStartTime.addDays(-1);
@@ -120,7 +127,8 @@ DTC::ProgramGuide *Guide::GetProgramGuide( const QDateTime &rawStartTime ,
 
     DTC::ProgramGuide *pGuide = new DTC::ProgramGuide();
 
-    ChannelInfoList::iterator chan_it;
+    QMap< uint, DTC::ChannelInfo* > channels;
+
     for (chan_it = chanList.begin(); chan_it != chanList.end(); ++chan_it)
     {
         // Create ChannelInfo Object
@@ -128,18 +136,34 @@ DTC::ProgramGuide *Guide::GetProgramGuide( const QDateTime &rawStartTime ,
         pChannel = pGuide->AddNewChannel();
         FillChannelInfo( pChannel, (*chan_it), bDetails );
 
-        // Load the list of programmes for this channel
-        ProgramList  progList;
-        bindings[":CHANID"] = (*chan_it).chanid;
+        channels[ (*chan_it).chanid ] = pChannel;
+    }
+
+    if (!channels.isEmpty())
+    {
+        ProgramList progList;
         LoadFromProgram( progList, sWhere, sOrderBy, sOrderBy, bindings,
                          schedList );
 
-        // Create Program objects and add them to the channel object
+        // Artwork is only looked up if it, or something in it, was asked for
+
+        DTC::FieldProjection fields( sFields );
+        DTC::Program         program;
+
+        bool bIncArtwork = fields.Includes( &program, "Artwork" );
+
+        // Create Program objects and add them to their channel objects
         ProgramList::iterator progIt;
         for( progIt = progList.begin(); progIt != progList.end(); ++progIt)
         {
+            DTC::ChannelInfo *pChannel = channels.value( (*progIt)->GetChanID() );
+
+            if (pChannel == NULL)
+                continue;
+
             DTC::Program *pProgram = pChannel->AddNewProgram();
-            FillProgramInfo( pProgram, *progIt, false, bDetails, false ); // No cast info
+            FillProgramInfo( pProgram, *progIt, false, bDetails, false, // No cast info
+                             bIncArtwork );
         }
     }
 
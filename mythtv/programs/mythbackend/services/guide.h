@@ -53,7 +53,8 @@ class Guide : public GuideServices
                                                   bool             Details,
                                                   int              ChannelGroupId,
                                                   int              StartIndex,
-                                                  int              Count);
+                                                  int              Count,
+                                                  const QString   &Fields );
 
         DTC::ProgramList*   GetProgramList      ( int              StartIndex,
                                                   int              Count,
@@ -131,7 +132,8 @@ class ScriptableGuide : public QObject
         {
             SCRIPT_CATCH_EXCEPTION( NULL,
                 return m_obj.GetProgramGuide( StartTime, EndTime, Details,
-                                              ChannelGroupId, StartIndex, Count );
+                                              ChannelGroupId, StartIndex, Count,
+                                              QString() );
             )
         }
 
@@ -45,7 +45,8 @@ void FillProgramInfo( DTC::Program *pProgram,
                       ProgramInfo  *pInfo,
                       bool          bIncChannel /* = true */,
                       bool          bDetails    /* = true */,
-                      bool          bIncCast    /* = true */)
+                      bool          bIncCast    /* = true */,
+                      bool          bIncArtwork /* = true */)
 {
     if ((pProgram == NULL) || (pInfo == NULL))
         return;
@@ -152,7 +153,7 @@ void FillProgramInfo( DTC::Program *pProgram,
         }
     }
 
-    if (!pInfo->GetInetRef().isEmpty() )
+    if (bIncArtwork && !pInfo->GetInetRef().isEmpty() )
     {
         pProgram->setSerializeArtwork( true );
 
@@ -50,7 +50,8 @@ void FillProgramInfo( DTC::Program *pProgram,
                       ProgramInfo  *pInfo,
                       bool          bIncChannel = true,
                       bool          bDetails    = true,
-                      bool          bIncCast    = true);
+                      bool          bIncCast    = true,
+                      bool          bIncArtwork = true);
 
 bool FillChannelInfo( DTC::ChannelInfo *pChannel,
                       uint              nChanID,
@@ -5,6 +5,9 @@
 #include <termios.h>
 #include <iostream>
 #include <sys/poll.h>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
 
 using namespace std;
 
@@ -20,6 +23,7 @@ using namespace std;
 #include "mythcontext.h"
 #include "mythversion.h"
 #include "mythlogging.h"
+#include "recorders/ExternalRing.h"
 
 
 #define VERSION "1.0.0"
@@ -29,7 +33,8 @@ Streamer::Streamer(Commands *parent, const QString &fname,
                    int data_rate, bool loopinput) :
     m_parent(parent), m_fileName(fname), m_file(NULL), m_loop(loopinput),
     m_bufferMax(188 * 100000), m_blockSize(m_bufferMax / 4),
-    m_data_rate(data_rate), m_data_read(0)
+    m_data_rate(data_rate), m_data_read(0),
+    m_ring(NULL), m_ringdata(NULL), m_datafd(-1), m_spacefd(-1)
 {
     setObjectName("Streamer");
     OpenFile();
@@ -40,6 +45,10 @@ Streamer::~Streamer(void)
 {
     LOG(VB_RECORD, LOG_INFO, LOC + "Streamer::dtor -- begin");
     CloseFile();
+#ifdef __linux__
+    if (m_ring)
+        munmap(m_ring, kExternRingData + m_ring->size);
+#endif
     LOG(VB_RECORD, LOG_INFO, LOC + "Streamer::dtor -- end");
 }
 
@@ -144,7 +153,12 @@ void Streamer::SendBytes(void)
     LOG(VB_RECORD, LOG_DEBUG, LOC +
         QString("SendBytes -- writing %1 bytes").arg(write_len));
 
-    wrote = write(1, m_buffer.constData(), write_len);
+    if (m_ring)
+        wrote = WriteRing(m_buffer.constData(), write_len);
+    else
+        wrote = write(1, m_buffer.constData(), write_len);
+    if (wrote < 0)
+        wrote = 0;
 
     LOG(VB_RECORD, LOG_DEBUG, LOC +
         QString("SendBytes -- wrote %1 bytes").arg(wrote));
@@ -161,6 +175,112 @@ void Streamer::SendBytes(void)
     LOG(VB_RECORD, LOG_DEBUG, LOC + "SendBytes -- end");
 }
 
+/**
+ *  \brief Maps the ring MythTV passed us as ringfd, and writes the TS
+ *         into it from now on instead of to stdout.
+ */
+bool Streamer::UseSharedMemory(int ringfd, int datafd, int spacefd,
+                               uint64_t size)
+{
+#ifdef __linux__
+    void *map = mmap(NULL, kExternRingData + size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED, ringfd, 0);
+    if (map == MAP_FAILED)
+    {
+        m_error = "Failed to map shared memory: " + ENO;
+        LOG(VB_RECORD, LOG_ERR, LOC + m_error);
+        return false;
+    }
+
+    ExternRing *ring = reinterpret_cast<ExternRing*>(map);
+    if (ring->magic != kExternRingMagic ||
+        ring->version != kExternRingVersion || ring->size != size)
+    {
+        m_error = QString("Shared memory ring is invalid, version %1 "
+                          "size %2").arg(ring->version).arg(ring->size);
+        LOG(VB_RECORD, LOG_ERR, LOC + m_error);
+        munmap(map, kExternRingData + size);
+        return false;
+    }
+
+    m_ringdata = reinterpret_cast<char*>(map) + kExternRingData;
+    m_datafd   = datafd;
+    m_spacefd  = spacefd;
+    m_ring     = ring;
+
+    LOG(VB_RECORD, LOG_INFO, LOC +
+        QString("Writing to a %1 byte shared memory ring").arg(size));
+    return true;
+#else
+    Q_UNUSED(ringfd);
+    Q_UNUSED(datafd);
+    Q_UNUSED(spacefd);
+    Q_UNUSED(size);
+    m_error = "Shared memory is not supported on this platform";
+    return false;
+#endif
+}
+
+/**
+ *  \brief Copies up to len bytes into the shared memory ring and tells
+ *         MythTV about them.  If the ring is full, waits briefly for MythTV
+ *         to read some.
+ *  \return bytes written, which may be less than len, or -1 on error.
+ */
+int Streamer::WriteRing(const char *data, int len)
+{
+#ifdef __linux__
+    uint64_t write_pos = m_ring->write_pos;
+    uint64_t read_pos  = __atomic_load_n(&m_ring->read_pos, __ATOMIC_ACQUIRE);
+
+    if (write_pos - read_pos >= m_ring->size)
+    {
+        // Full, wait for MythTV to make some space
+        ++m_ring->writer_waits;
+
+        struct pollfd fds;
+        memset(&fds, 0, sizeof(fds));
+        fds.fd = m_spacefd;
+        fds.events = POLLIN;
+        if (poll(&fds, 1, 100) <= 0)
+            return 0;
+
+        uint64_t count;
+        if (read(m_spacefd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+        {
+            LOG(VB_RECORD, LOG_ERR, LOC +
+                "Failed to read space eventfd: " + ENO);
+            return -1;
+        }
+
+        read_pos = __atomic_load_n(&m_ring->read_pos, __ATOMIC_ACQUIRE);
+        if (write_pos - read_pos >= m_ring->size)
+            return 0;
+    }
+
+    uint64_t space = m_ring->size - (write_pos - read_pos);
+    len = min((uint64_t)len, space);
+    uint offset = write_pos % m_ring->size;
+    uint first  = min((uint64_t)len, m_ring->size - offset);
+
+    memcpy(m_ringdata + offset, data, first);
+    if (first < (uint)len)
+        memcpy(m_ringdata, data + first, len - first);
+
+    __atomic_store_n(&m_ring->write_pos, write_pos + len, __ATOMIC_RELEASE);
+
+    uint64_t one = 1;
+    if (write(m_datafd, &one, sizeof(one)) < 0 && errno != EAGAIN)
+        LOG(VB_RECORD, LOG_WARNING, LOC +
+            "Failed to write data eventfd: " + ENO);
+
+    return len;
+#else
+    Q_UNUSED(data);
+    Q_UNUSED(len);
+    return -1;
+#endif // __linux__
+}
 
 Commands::Commands(void) : m_streamer(NULL), m_timeout(10), m_run(true),
     m_eof(false)
@@ -285,6 +405,23 @@ bool Commands::process_command(QString & cmd)
         emit CloseFile();
         return false;
     }
+    else if (cmd.startsWith("SharedMemory"))
+    {
+        // SharedMemory:<ring fd>:<data fd>:<space fd>:<size>
+        QStringList args = cmd.split(':');
+        bool ok = args.size() == 5;
+        int fds[3] = { -1, -1, -1 };
+        for (int idx = 0; ok && idx < 3; ++idx)
+            fds[idx] = args[idx + 1].toInt(&ok);
+        uint64_t size = ok ? args[4].toULongLong(&ok) : 0;
+
+        if (!ok)
+            send_status(QString("ERR:Invalid command '%1'").arg(cmd));
+        else if (m_streamer->UseSharedMemory(fds[0], fds[1], fds[2], size))
+            send_status("OK");
+        else
+            send_status("ERR:" + m_streamer->ErrorString());
+    }
     else if (cmd.startsWith("FlowControl?"))
     {
         send_status("OK:Polling");
@@ -12,6 +12,7 @@
 #include <mythdate.h>
 
 class Commands;
+struct ExternRing;
 
 class Streamer : public QObject
 {
@@ -28,9 +29,11 @@ class Streamer : public QObject
     void BlockSize(int val) { m_blockSize = val; }
     bool IsOpen(void) const { return m_file; }
     QString ErrorString(void) const { return m_error; }
+    bool UseSharedMemory(int ringfd, int datafd, int spacefd, uint64_t size);
 
   protected:
     void OpenFile(void);
+    int  WriteRing(const char *data, int len);
 
   private:
     Commands *m_parent;
@@ -48,6 +51,12 @@ class Streamer : public QObject
     uint      m_data_rate;  // bytes per second
     QDateTime m_start_time; // When the first packet was processed
     quint64   m_data_read;  // How many bytes have been sent
+
+    // Shared memory transport, see ExternalRing.h
+    ExternRing *m_ring;
+    char       *m_ringdata;
+    int         m_datafd;
+    int         m_spacefd;
 };
 
 class Commands : public QObject
@@ -54,6 +54,7 @@ using namespace std;
 
 // mythfrontend
 #include "progfind.h"
+#include "guideprogramcache.h"
 
 QWaitCondition epgIsVisibleCond;
 
@@ -284,6 +285,14 @@ public:
             return false;
         }
 
+        // Load the listings of every row that needs them in one go
+        QVector<int> needed;
+        for (unsigned int i = 0; i < m_numRows; ++i)
+            if (!m_proglists[i])
+                needed.push_back(m_channums[i]);
+        if (!needed.empty())
+            m_guide->loadProgramLists(needed);
+
         for (unsigned int i = 0; i < m_numRows; ++i)
         {
             unsigned int row = i + m_firstRow;
@@ -417,6 +426,47 @@ QMutex                GuideHelper::s_lock;
 QWaitCondition        GuideHelper::s_wait;
 QMap<GuideGrid*,uint> GuideHelper::s_loading;
 
+// GuidePrefetcher loads the listings around the visible part of the
+// guide into the GuideProgramCache, so that moving to them doesn't have
+// to wait for the database.
+class GuidePrefetcher : public QRunnable
+{
+public:
+    GuidePrefetcher(GuideGrid *guide, const QList<uint> &visible,
+                    const QList<uint> &neighbours,
+                    const QDateTime &start, const QDateTime &end,
+                    int span)
+        : m_guide(guide), m_currentStartChannel(guide->GetCurrentStartChannel()),
+          m_currentStartTime(guide->GetCurrentStartTime()),
+          m_visible(visible), m_neighbours(neighbours),
+          m_start(start), m_end(end), m_span(span) {}
+    virtual void run(void)
+    {
+        // Let the visible rows load first
+        GuideHelper::Wait(m_guide);
+
+        // Don't bother if the guide has moved on since this was queued
+        if (m_currentStartChannel != m_guide->GetCurrentStartChannel() ||
+            m_currentStartTime != m_guide->GetCurrentStartTime())
+            return;
+
+        QThread::currentThread()->setPriority(QThread::IdlePriority);
+
+        GuideProgramCache *cache = GuideProgramCache::GetCache();
+        cache->Load(m_visible, m_start.addSecs(-m_span),
+                    m_end.addSecs(m_span));
+        cache->Load(m_neighbours, m_start, m_end);
+    }
+private:
+    GuideGrid *m_guide;
+    const uint m_currentStartChannel;
+    const QDateTime m_currentStartTime;
+    const QList<uint> m_visible;
+    const QList<uint> m_neighbours;
+    const QDateTime m_start, m_end;
+    const int m_span;
+};
+
 void GuideGrid::RunProgramGuide(uint chanid, const QString &channum,
                                 const QDateTime &startTime,
                                 TV *player, bool embedVideo,
@@ -513,6 +563,7 @@ GuideGrid::GuideGrid(MythScreenStack *parent,
            m_channelOrdering(gCoreContext->GetSetting("ChannelOrdering", "channum")),
            m_updateTimer(new QTimer(this)),
            m_threadPool("GuideGridHelperPool"),
+           m_prefetchPool("GuideGridPrefetchPool"),
            m_changrpid(changrpid),
            m_changrplist(ChannelGroup::GetChannelGroups(false)),
            m_jumpToChannelLock(QMutex::Recursive),
@@ -548,6 +599,10 @@ GuideGrid::GuideGrid(MythScreenStack *parent,
                         m_originalStartTime.time().second());
     m_currentStartTime = m_originalStartTime.addSecs(secsoffset);
     m_threadPool.setMaxThreadCount(1);
+    m_prefetchPool.setMaxThreadCount(1);
+
+    // Make sure the cache is created in the UI thread, so it gets events
+    GuideProgramCache::GetCache();
 }
 
 bool GuideGrid::Create()
@@ -597,7 +652,6 @@ bool GuideGrid::Create()
 
 void GuideGrid::Load(void)
 {
-    LoadFromScheduler(m_recList);
     fillChannelInfos();
 
     int maxchannel = max((int)GetChannelCount() - 1, 0);
@@ -649,6 +703,7 @@ GuideGrid::~GuideGrid()
     m_updateTimer = NULL;
 
     GuideHelper::Wait(this);
+    m_prefetchPool.waitForDone();
 
     gCoreContext->removeListener(this);
 
@@ -1201,21 +1256,15 @@ int GuideGrid::GetStartChannelOffset(int row) const
 ProgramList GuideGrid::GetProgramList(uint chanid) const
 {
     ProgramList proglist;
-    MSqlBindings bindings;
-    QString querystr =
-        "WHERE program.chanid     = :CHANID       AND "
-        "      program.endtime   >= :STARTTS      AND "
-        "      program.starttime <= :ENDTS        AND "
-        "      program.starttime >= :STARTLIMITTS AND "
-        "      program.manualid   = 0 ";
     QDateTime starttime = m_currentStartTime.addSecs(0 - m_currentStartTime.time().second());
-    bindings[":STARTTS"] = starttime;
-    bindings[":STARTLIMITTS"] = starttime.addDays(-1);
-    bindings[":ENDTS"] = m_currentEndTime.addSecs(0 - m_currentEndTime.time().second());
-    bindings[":CHANID"]  = chanid;
+    QDateTime endtime = m_currentEndTime.addSecs(0 - m_currentEndTime.time().second());
 
-    ProgramList dummy;
-    LoadFromProgram(proglist, querystr, bindings, dummy);
+    GuideProgramCache *cache = GuideProgramCache::GetCache();
+    if (!cache->Get(chanid, starttime, endtime, proglist))
+    {
+        cache->Load(QList<uint>() << chanid, starttime, endtime);
+        cache->Get(chanid, starttime, endtime, proglist);
+    }
 
     return proglist;
 }
@@ -1558,24 +1607,75 @@ ProgramList *GuideGrid::getProgramListFromProgram(int chanNum)
 
     if (proglist)
     {
-        MSqlBindings bindings;
-        QString querystr = "WHERE program.chanid = :CHANID "
-                           "  AND program.endtime >= :STARTTS "
-                           "  AND program.starttime <= :ENDTS "
-                           "  AND program.starttime >= :STARTLIMITTS "
-                           "  AND program.manualid = 0 ";
         QDateTime starttime = m_currentStartTime.addSecs(0 - m_currentStartTime.time().second());
-        bindings[":CHANID"]  = GetChannelInfo(chanNum)->chanid;
-        bindings[":STARTTS"] = starttime;
-        bindings[":STARTLIMITTS"] = starttime.addDays(-1);
-        bindings[":ENDTS"] = m_currentEndTime.addSecs(0 - m_currentEndTime.time().second());
+        QDateTime endtime = m_currentEndTime.addSecs(0 - m_currentEndTime.time().second());
+        uint chanid = GetChannelInfo(chanNum)->chanid;
 
-        LoadFromProgram(*proglist, querystr, bindings, m_recList);
+        // If the cache was dropped since loadProgramLists(), a schedule
+        // change is on its way and the rows will be filled again
+        GuideProgramCache *cache = GuideProgramCache::GetCache();
+        if (!cache->Get(chanid, starttime, endtime, *proglist))
+        {
+            cache->Load(QList<uint>() << chanid, starttime, endtime);
+            cache->Get(chanid, starttime, endtime, *proglist);
+        }
     }
 
     return proglist;
 }
 
+/// Load the listings of several channels into the cache with one query
+void GuideGrid::loadProgramLists(const QVector<int> &chanNums)
+{
+    QList<uint> chanids;
+    for (int i = 0; i < chanNums.size(); ++i)
+    {
+        const ChannelInfo *chinfo = GetChannelInfo(chanNums[i]);
+        if (chinfo)
+            chanids.push_back(chinfo->chanid);
+    }
+
+    QDateTime starttime = m_currentStartTime.addSecs(0 - m_currentStartTime.time().second());
+    QDateTime endtime = m_currentEndTime.addSecs(0 - m_currentEndTime.time().second());
+
+    GuideProgramCache::GetCache()->Load(chanids, starttime, endtime);
+}
+
+/// Queue loading the pages either side of the visible one into the cache
+void GuideGrid::prefetchPrograms(void)
+{
+    int count = (int) GetChannelCount();
+    if (!count || !m_channelCount)
+        return;
+
+    QList<uint> visible;
+    QList<uint> neighbours;
+
+    for (int i = -m_channelCount; i < 2 * m_channelCount; ++i)
+    {
+        int chanNum = ((int) m_currentStartChannel + i) % count;
+        if (chanNum < 0)
+            chanNum += count;
+
+        const ChannelInfo *chinfo = GetChannelInfo(chanNum);
+        if (!chinfo)
+            continue;
+
+        QList<uint> &list =
+            (i >= 0 && i < m_channelCount) ? visible : neighbours;
+        if (!list.contains(chinfo->chanid))
+            list.push_back(chinfo->chanid);
+    }
+
+    QDateTime starttime = m_currentStartTime.addSecs(0 - m_currentStartTime.time().second());
+    QDateTime endtime = m_currentEndTime.addSecs(0 - m_currentEndTime.time().second());
+
+    m_prefetchPool.start(new GuidePrefetcher(this, visible, neighbours,
+                                             starttime, endtime,
+                                             starttime.secsTo(endtime)),
+                         "GuidePrefetcher");
+}
+
 void GuideGrid::fillProgramRowInfos(int firstRow, bool useExistingData)
 {
     bool allRows = false;
@@ -1641,6 +1741,9 @@ void GuideGrid::fillProgramRowInfos(int firstRow, bool useExistingData)
     GuideUpdateProgramRow *updater =
         new GuideUpdateProgramRow(this, gs, proglists);
     m_threadPool.start(new GuideHelper(this, updater), "GuideHelper");
+
+    if (allRows)
+        prefetchPrograms();
 }
 
 void GuideUpdateProgramRow::fillProgramRowInfosWith(int row,
@@ -1889,7 +1992,7 @@ void GuideGrid::customEvent(QEvent *event)
         if (message == "SCHEDULE_CHANGE")
         {
             GuideHelper::Wait(this);
-            LoadFromScheduler(m_recList);
+            GuideProgramCache::GetCache()->Invalidate();
             fillProgramInfos();
         }
         else if (message == "STOP_VIDEO_REFRESH_TIMER")
@@ -2280,7 +2383,6 @@ void GuideGrid::generateListings()
     maxchannel = max((int)GetChannelCount() - 1, 0);
     m_channelCount = min(m_guideGrid->getChannelCount(), maxchannel + 1);
 
-    LoadFromScheduler(m_recList);
     fillProgramInfos();
 }
 
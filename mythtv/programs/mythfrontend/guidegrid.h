@@ -211,6 +211,7 @@ class GuideGrid : public ScheduleCommon, public JumpToChannelListener
 public:
     // These need to be public so that the helper classes can operate.
     ProgramList *getProgramListFromProgram(int chanNum);
+    void loadProgramLists(const QVector<int> &chanNums);
     void updateProgramsUI(unsigned int firstRow, unsigned int numRows,
                           int progPast,
                           const QVector<ProgramList*> &proglists,
@@ -223,6 +224,7 @@ public:
 private:
 
     void setStartChannel(int newStartChannel);
+    void prefetchPrograms(void);
 
     ChannelInfo       *GetChannelInfo(uint chan_idx, int sel = -1);
     const ChannelInfo *GetChannelInfo(uint chan_idx, int sel = -1) const;
@@ -242,7 +244,6 @@ private:
 
     vector<ProgramList*> m_programs;
     ProgInfoGuideArray m_programInfos;
-    ProgramList  m_recList;
 
     QDateTime m_originalStartTime;
     QDateTime m_currentStartTime;
@@ -276,6 +277,7 @@ private:
     QTimer *m_updateTimer; // audited ref #5318
 
     MThreadPool       m_threadPool;
+    MThreadPool       m_prefetchPool;
 
     int               m_changrpid;
     ChannelGroupList  m_changrplist;
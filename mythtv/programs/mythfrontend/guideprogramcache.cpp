@@ -0,0 +1,303 @@
+// -*- Mode: c++ -*-
+// vim:set sw=4 ts=4 expandtab:
+
+#include "guideprogramcache.h"
+
+// C++ headers
+#include <algorithm>
+
+// Qt headers
+#include <QStringList>
+
+// MythTV headers
+#include "mythcorecontext.h"
+#include "mythlogging.h"
+#include "mythevent.h"
+#include "mythdate.h"
+#include "mythdbcon.h"
+
+#define LOC QString("GuideProgramCache: ")
+
+GuideProgramCache *GuideProgramCache::GetCache(void)
+{
+    static QMutex             s_lock;
+    static GuideProgramCache *s_cache = NULL;
+
+    QMutexLocker locker(&s_lock);
+    if (!s_cache)
+        s_cache = new GuideProgramCache();
+    return s_cache;
+}
+
+GuideProgramCache::GuideProgramCache() : m_generation(0)
+{
+    gCoreContext->addListener(this);
+}
+
+GuideProgramCache::~GuideProgramCache()
+{
+    gCoreContext->removeListener(this);
+    Clear();
+}
+
+QDateTime GuideProgramCache::BlockStart(const QDateTime &time)
+{
+    uint secs = time.toTime_t();
+    return MythDate::fromTime_t(secs - (secs % kBlockSecs));
+}
+
+/// \note m_lock must be held
+bool GuideProgramCache::IsCached(uint chanid, const QDateTime &start,
+                                 const QDateTime &now) const
+{
+    QHash<uint, BlockMap>::const_iterator chan = m_channels.find(chanid);
+    if (chan == m_channels.end())
+        return false;
+
+    BlockMap::const_iterator it = chan->find(start);
+    return (it != chan->end()) && ((*it)->loaded.secsTo(now) < kMaxAgeSecs);
+}
+
+/**
+ *  \brief Make sure the listings of each channel between start and end are
+ *         cached, loading any that are missing from the database.
+ *
+ *  Channels that are missing any of the blocks are loaded together in one
+ *  query.  The results are dropped if the cache is invalidated while they
+ *  are being loaded.
+ */
+void GuideProgramCache::Load(const QList<uint> &chanids,
+                             const QDateTime &start, const QDateTime &end)
+{
+    QDateTime first = BlockStart(start);
+    QDateTime last  = BlockStart(end);
+    QDateTime now   = MythDate::current();
+
+    QList<uint> missing;
+    uint generation;
+    QSharedPointer<ProgramList> schedule;
+
+    {
+        QMutexLocker locker(&m_lock);
+
+        generation = m_generation;
+        schedule   = m_schedule;
+
+        QList<uint>::const_iterator it = chanids.begin();
+        for (; it != chanids.end(); ++it)
+        {
+            for (QDateTime block = first; block <= last;
+                 block = block.addSecs(kBlockSecs))
+            {
+                if (!IsCached(*it, block, now))
+                {
+                    if (!missing.contains(*it))
+                        missing.push_back(*it);
+                    break;
+                }
+            }
+        }
+    }
+
+    if (missing.isEmpty())
+        return;
+
+    // The schedule is loaded once, then shared until the next change
+    if (!schedule)
+    {
+        schedule = QSharedPointer<ProgramList>(new ProgramList());
+        LoadFromScheduler(*schedule);
+
+        QMutexLocker locker(&m_lock);
+        if (generation != m_generation)
+            return;
+        m_schedule = schedule;
+    }
+
+    QStringList ids;
+    QList<uint>::const_iterator it = missing.begin();
+    for (; it != missing.end(); ++it)
+        ids.push_back(QString::number(*it));
+
+    QDateTime blocksEnd = last.addSecs(kBlockSecs);
+
+    MSqlBindings bindings;
+    QString querystr = QString(
+        "WHERE program.chanid IN (%1) "
+        "  AND program.endtime >= :STARTTS "
+        "  AND program.starttime <= :ENDTS "
+        "  AND program.starttime >= :STARTLIMITTS "
+        "  AND program.manualid = 0 "
+        "GROUP BY program.chanid, program.starttime, program.title "
+        "ORDER BY program.starttime ").arg(ids.join(","));
+    bindings[":STARTTS"] = first;
+    bindings[":STARTLIMITTS"] = first.addDays(-1);
+    bindings[":ENDTS"] = blocksEnd;
+
+    ProgramList programs;
+    if (!LoadFromProgram(programs, querystr, bindings, *schedule))
+        return;
+
+    LOG(VB_GUI, LOG_DEBUG, LOC +
+        QString("Loaded %1 programs on %2 channels from %3 to %4")
+        .arg(programs.size()).arg(missing.size())
+        .arg(first.toString(Qt::ISODate))
+        .arg(blocksEnd.toString(Qt::ISODate)));
+
+    QMutexLocker locker(&m_lock);
+
+    // The schedule changed while loading, so the status may be out of date
+    if (generation != m_generation)
+        return;
+
+    for (it = missing.begin(); it != missing.end(); ++it)
+    {
+        BlockMap &blocks = m_channels[*it];
+
+        for (QDateTime block = first; block <= last;
+             block = block.addSecs(kBlockSecs))
+        {
+            BlockKey key(*it, block);
+            BlockMap::iterator old = blocks.find(block);
+            if (old != blocks.end())
+            {
+                delete *old;
+                blocks.erase(old);
+                m_order.removeOne(key);
+            }
+
+            Block *newblock = new Block;
+            newblock->loaded = now;
+            blocks.insert(block, newblock);
+            m_order.push_back(key);
+        }
+    }
+
+    // Add a copy of each program to every block it overlaps
+    ProgramList::const_iterator pit = programs.begin();
+    for (; pit != programs.end(); ++pit)
+    {
+        const ProgramInfo *pginfo = *pit;
+        BlockMap &blocks = m_channels[pginfo->GetChanID()];
+
+        QDateTime block =
+            std::max(first, BlockStart(pginfo->GetScheduledStartTime()));
+        QDateTime stop  =
+            std::min(last, BlockStart(pginfo->GetScheduledEndTime()));
+        for (; block <= stop; block = block.addSecs(kBlockSecs))
+        {
+            BlockMap::iterator bit = blocks.find(block);
+            if (bit != blocks.end())
+                (*bit)->programs.push_back(new ProgramInfo(*pginfo));
+        }
+    }
+
+    // Drop the oldest blocks
+    while (m_order.size() > kMaxBlocks)
+    {
+        BlockKey key = m_order.takeFirst();
+        QHash<uint, BlockMap>::iterator chan = m_channels.find(key.first);
+        if (chan == m_channels.end())
+            continue;
+
+        BlockMap::iterator bit = chan->find(key.second);
+        if (bit != chan->end())
+        {
+            delete *bit;
+            chan->erase(bit);
+        }
+
+        if (chan->isEmpty())
+            m_channels.erase(chan);
+    }
+}
+
+/**
+ *  \brief Append copies of the programs on chanid that overlap start to end
+ *         to programs, as GuideGrid would have loaded them from the database.
+ *  \return false if any of the listings between start and end are not cached
+ */
+bool GuideProgramCache::Get(uint chanid, const QDateTime &start,
+                            const QDateTime &end, ProgramList &programs) const
+{
+    QDateTime first = BlockStart(start);
+    QDateTime last  = BlockStart(end);
+    QDateTime now   = MythDate::current();
+    QDateTime limit = start.addDays(-1);
+
+    QMutexLocker locker(&m_lock);
+
+    for (QDateTime block = first; block <= last;
+         block = block.addSecs(kBlockSecs))
+    {
+        if (!IsCached(chanid, block, now))
+            return false;
+    }
+
+    const BlockMap &blocks = *m_channels.find(chanid);
+
+    // Programs that cross into the next block are in both blocks
+    QDateTime lastStart;
+    for (QDateTime block = first; block <= last;
+         block = block.addSecs(kBlockSecs))
+    {
+        QDateTime blockLastStart = lastStart;
+
+        const ProgramList &list = blocks[block]->programs;
+        ProgramList::const_iterator it = list.begin();
+        for (; it != list.end(); ++it)
+        {
+            const ProgramInfo *pginfo = *it;
+            QDateTime pstart = pginfo->GetScheduledStartTime();
+
+            if (pginfo->GetScheduledEndTime() < start || pstart > end ||
+                pstart < limit)
+                continue;
+
+            if (lastStart.isValid() && pstart <= lastStart)
+                continue;
+
+            programs.push_back(new ProgramInfo(*pginfo));
+            blockLastStart = pstart;
+        }
+
+        lastStart = blockLastStart;
+    }
+
+    return true;
+}
+
+/// Drop everything cached, and any loads in progress
+void GuideProgramCache::Invalidate(void)
+{
+    QMutexLocker locker(&m_lock);
+
+    ++m_generation;
+    Clear();
+}
+
+/// \note m_lock must be held, except when destroying the cache
+void GuideProgramCache::Clear(void)
+{
+    QHash<uint, BlockMap>::iterator chan = m_channels.begin();
+    for (; chan != m_channels.end(); ++chan)
+        qDeleteAll(*chan);
+
+    m_channels.clear();
+    m_order.clear();
+    m_schedule.clear();
+}
+
+void GuideProgramCache::customEvent(QEvent *event)
+{
+    if ((MythEvent::Type)(event->type()) == MythEvent::MythEventMessage)
+    {
+        MythEvent *me = static_cast<MythEvent *>(event);
+
+        if (me->Message() == "SCHEDULE_CHANGE")
+        {
+            LOG(VB_GUI, LOG_DEBUG, LOC + "Schedule changed, dropping cache");
+            Invalidate();
+        }
+    }
+}
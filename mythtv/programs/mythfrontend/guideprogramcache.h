@@ -0,0 +1,79 @@
+// -*- Mode: c++ -*-
+// vim:set sw=4 ts=4 expandtab:
+#ifndef _GUIDE_PROGRAM_CACHE_H_
+#define _GUIDE_PROGRAM_CACHE_H_
+
+// Qt headers
+#include <QSharedPointer>
+#include <QDateTime>
+#include <QObject>
+#include <QMutex>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QMap>
+
+// MythTV headers
+#include "programinfo.h"
+
+/** \class GuideProgramCache
+ *  \brief Program guide listings shared by every GuideGrid, indexed by
+ *         channel and time.
+ *
+ *  Listings are loaded for a channel a block of kBlockSecs at a time, with
+ *  one query for all the channels that are missing the same blocks, so
+ *  paging back through the guide or opening it again doesn't go back to
+ *  the database.  The recording status of every program depends on the
+ *  schedule, so the whole cache is dropped when the scheduler reports a
+ *  change, and blocks are loaded again as they are next needed.
+ *
+ *  All methods may be called from any thread.
+ */
+class GuideProgramCache : public QObject
+{
+    Q_OBJECT
+
+  public:
+    /// \note The first call must be made from the UI thread.
+    static GuideProgramCache *GetCache(void);
+
+    void Load(const QList<uint> &chanids,
+              const QDateTime &start, const QDateTime &end);
+    bool Get(uint chanid, const QDateTime &start, const QDateTime &end,
+             ProgramList &programs) const;
+    void Invalidate(void);
+
+  protected:
+    void customEvent(QEvent *event);
+
+  private:
+    GuideProgramCache();
+   ~GuideProgramCache();
+
+    struct Block
+    {
+        QDateTime   loaded;
+        ProgramList programs;   ///< Ordered by start time
+    };
+
+    /// The blocks of one channel, keyed on the start of the block
+    typedef QMap<QDateTime, Block*> BlockMap;
+    typedef QPair<uint, QDateTime>  BlockKey;
+
+    static QDateTime BlockStart(const QDateTime &time);
+    bool IsCached(uint chanid, const QDateTime &start,
+                  const QDateTime &now) const;
+    void Clear(void);
+
+    mutable QMutex        m_lock;
+    QHash<uint, BlockMap> m_channels;
+    QList<BlockKey>       m_order;        ///< Oldest block first
+    uint                  m_generation;   ///< Incremented by Invalidate()
+    QSharedPointer<ProgramList> m_schedule;
+
+    static const int kBlockSecs  = 3 * 60 * 60;
+    static const int kMaxBlocks  = 4096;
+    static const int kMaxAgeSecs = 60 * 60;
+};
+
+#endif // _GUIDE_PROGRAM_CACHE_H_
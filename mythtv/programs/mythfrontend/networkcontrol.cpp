@@ -9,6 +9,7 @@
 #include <QStringList>
 #include <QTextStream>
 #include <QDir>
+#include <QFileInfo>
 #include <QKeyEvent>
 #include <QEvent>
 #include <QMap>
@@ -23,6 +24,7 @@
 #include "mythsystemevent.h"
 #include "mythdirs.h"
 #include "mythlogging.h"
+#include "mythtrace.h"
 
 // libmythui
 #include "mythmainwindow.h"
@@ -1092,6 +1094,45 @@ QString NetworkControl::processSet(NetworkCommand *nc)
 
         return result;
     }
+    else if (nc->getArg(1) == "trace")
+    {
+        if (nc->getArgCount() < 3)
+            return QString("ERROR: Missing on, off or dump.");
+
+        if (nc->getArg(2) == "on")
+        {
+            MythTrace::Clear();
+            MythTrace::SetEnabled(true);
+            return QString("OK");
+        }
+        else if (nc->getArg(2) == "off")
+        {
+            MythTrace::SetEnabled(false);
+            return QString("OK");
+        }
+        else if (nc->getArg(2) == "dump" && nc->getArgCount() <= 4)
+        {
+            // Anyone who can reach this port can ask for a dump, so only
+            // ever write to the traces directory.
+            QString name;
+            if (nc->getArgCount() == 4)
+                name = QFileInfo(nc->getArg(3)).fileName();
+            name.remove(QRegExp("[^A-Za-z0-9._-]"));
+            if (name.isEmpty() || name.startsWith("."))
+                name = QString("trace-%1.json")
+                    .arg(MythDate::toString(MythDate::current(),
+                                            MythDate::kFilename));
+
+            QString dir = GetConfDir() + "/traces";
+            if (!QDir().mkpath(dir))
+                return QString("ERROR: Unable to create %1").arg(dir);
+
+            QString filename = dir + "/" + name;
+            if (MythTrace::Dump(filename))
+                return QString("OK %1").arg(filename);
+            return QString("ERROR: Unable to write %1").arg(filename);
+        }
+    }
 
     return QString("ERROR: See 'help %1' for usage information")
                    .arg(nc->getArg(0));
@@ -1429,7 +1470,13 @@ QString NetworkControl::processHelp(NetworkCommand *nc)
             "Change the VERBOSE mask to 'debug-mask'\r\n"
             "                         (i.e. 'set verbose playback,audio')\r\n"
             "                         use 'set verbose default' to revert\r\n"
-            "                         back to the default level of\r\n";
+            "                         back to the default level of\r\n"
+            "set trace on|off        - Start or stop recording a timeline\r\n"
+            "                         of traced operations\r\n"
+            "set trace dump [NAME]   - Write the recorded timeline to NAME\r\n"
+            "                         in the traces directory under the\r\n"
+            "                         MythTV config directory, in the\r\n"
+            "                         Chrome trace event format\r\n";
     }
     else if (is_abbrev("screenshot", command))
     {
@@ -36,6 +36,11 @@ void MythTranscodeCommandLineParser::LoadArguments(void)
     add(QStringList( QStringList() << "-m" << "--mpeg2" ), "mpeg2", false,
             "Specifies that a lossless transcode should be used.", "")
         ->SetGroup("Encoding");
+    add("--smartcut", "smartcut", false,
+            "Specifies that an H.264 or HEVC recording should be cut by "
+            "copying whole GOPs and only re-encoding at the cut points.", "")
+        ->SetGroup("Encoding")
+        ->SetBlocks("hls");
     add(QStringList( QStringList() << "-e" << "--ostream" ), "ostream", "",
             "Output stream type: ps, dvd, ts (Default: ps)", "")
         ->SetGroup("Encoding");
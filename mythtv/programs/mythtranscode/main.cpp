@@ -22,6 +22,7 @@ using namespace std;
 #include "mythdate.h"
 #include "transcode.h"
 #include "mpeg2fix.h"
+#include "smartcut.h"
 #include "remotefile.h"
 #include "mythtranslation.h"
 #include "loggingserver.h"
@@ -156,6 +157,7 @@ int main(int argc, char *argv[])
     bool useCutlist = false, keyframesonly = false;
     bool build_index = false, fifosync = false;
     bool mpeg2 = false;
+    bool smartcut = false;
     bool fifo_info = false;
     bool cleanCut = false;
     QMap<QString, QString> settingsOverride;
@@ -347,6 +349,8 @@ int main(int argc, char *argv[])
         recorderOptions = cmdline.toString("recopt");
     if (cmdline.toBool("mpeg2"))
         mpeg2 = true;
+    if (cmdline.toBool("smartcut"))
+        smartcut = true;
     if (cmdline.toBool("ostream"))
     {
         if (cmdline.toString("ostream") == "dvd")
@@ -601,7 +605,7 @@ int main(int argc, char *argv[])
     if (!recorderOptions.isEmpty())
         transcode->SetRecorderOptions(recorderOptions);
     int result = 0;
-    if ((!mpeg2 && !build_index) || cmdline.toBool("hls"))
+    if ((!mpeg2 && !smartcut && !build_index) || cmdline.toBool("hls"))
     {
         result = transcode->TranscodeFile(infile, outfile,
                                           profilename, useCutlist,
@@ -626,7 +630,51 @@ int main(int argc, char *argv[])
     }
 
     int exitcode = GENERIC_EXIT_OK;
-    if ((result == REENCODE_MPEG2TRANS) || mpeg2 || build_index)
+    if (((result == REENCODE_SMARTCUT) || smartcut) && !build_index)
+    {
+        void (*update_func)(float) = NULL;
+        int (*check_func)() = NULL;
+        if (useCutlist)
+        {
+            LOG(VB_GENERAL, LOG_INFO, "Honoring the cutlist while smart cutting");
+            if (deleteMap.isEmpty())
+                pginfo->QueryCutList(deleteMap);
+        }
+        if (jobID >= 0)
+        {
+           glbl_jobID = jobID;
+           update_func = &UpdateJobQueue;
+           check_func = &CheckJobQueue;
+        }
+
+        // The keyframe seek table lets the cutter jump straight to each
+        // section that is kept.
+        frm_pos_map_t inPosMap, inDurMap;
+        pginfo->QueryPositionMap(inPosMap, MARK_GOP_BYFRAME);
+        pginfo->QueryPositionMap(inDurMap, MARK_DURATION_MS);
+
+        SmartCutter cutter(infile, outfile, deleteMap, inPosMap, inDurMap,
+                           showprogress, update_func, check_func);
+        cutter.SetAllAudio(cmdline.toBool("allaudio"));
+
+        result = cutter.Start();
+        if (result == REENCODE_OK)
+        {
+            posMap = cutter.GetPositionMap();
+            durMap = cutter.GetDurationMap();
+            if (update_index)
+                UpdatePositionMap(posMap, durMap, NULL, pginfo);
+            else
+                UpdatePositionMap(posMap, durMap, outfile + QString(".map"),
+                                  pginfo);
+
+            RecordingInfo recInfo(*pginfo);
+            RecordingFile *recFile = recInfo.GetRecordingFile();
+            recFile->m_containerFormat = formatMPEG2_TS;
+            recFile->Save();
+        }
+    }
+    else if ((result == REENCODE_MPEG2TRANS) || mpeg2 || build_index)
     {
         void (*update_func)(float) = NULL;
         int (*check_func)() = NULL;
@@ -0,0 +1,947 @@
+// C++
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+using namespace std;
+
+// Qt
+#include <QFileInfo>
+
+// MythTV
+#include "mythlogging.h"
+#include "mythdate.h"
+#include "smartcut.h"
+
+extern "C"
+{
+#include "libavutil/opt.h"
+}
+
+#define LOC QString("SmartCut: ")
+
+/// Bit rate for re-encoded pictures if the recording doesn't tell us one
+static const int64_t kSmartCutDefaultBitrate = 10000000;
+
+SmartCutter::SmartCutter(const QString &inf, const QString &outf,
+                         const frm_dir_map_t &deleteMap,
+                         const frm_pos_map_t &posMap,
+                         const frm_pos_map_t &durMap,
+                         bool showprog, void (*update_func)(float),
+                         int (*check_func)())
+    : m_infile(inf), m_outfile(outf),
+      m_deleteMap(deleteMap), m_posMap(posMap), m_durMap(durMap),
+      m_inputFC(NULL), m_outputFC(NULL),
+      m_decoder(NULL), m_encoder(NULL), m_frame(NULL),
+      m_canEncode(false), m_allAudio(false),
+      m_videoIndex(-1), m_fps(29.97),
+      m_startPts(0), m_outputPts(0), m_ptsOffset(0),
+      m_videoDelay(0), m_lastVideoPts(0), m_lastVideoDts(AV_NOPTS_VALUE),
+      m_headDone(false),
+      m_outFrames(0),
+      m_showProgress(showprog), m_updateStatus(update_func),
+      m_checkAbort(check_func), m_statusUpdateTime(5), m_fileSize(0)
+{
+    m_videoTimeBase.num = 1;
+    m_videoTimeBase.den = 90000;
+
+    if (m_showProgress || m_updateStatus)
+    {
+        if (m_updateStatus)
+        {
+            m_statusUpdateTime = 20;
+            m_updateStatus(0);
+        }
+        m_statusTime = MythDate::current().addSecs(m_statusUpdateTime);
+        m_fileSize = QFileInfo(inf).size();
+    }
+}
+
+SmartCutter::~SmartCutter()
+{
+    FreeGOP(m_prevGOP);
+
+    if (m_frame)
+        av_frame_free(&m_frame);
+    if (m_encoder)
+        avcodec_free_context(&m_encoder);
+    if (m_decoder)
+        avcodec_free_context(&m_decoder);
+    if (m_inputFC)
+        avformat_close_input(&m_inputFC);
+    if (m_outputFC)
+    {
+        if (m_outputFC->pb)
+            avio_closep(&m_outputFC->pb);
+        avformat_free_context(m_outputFC);
+    }
+}
+
+void SmartCutter::FreeGOP(GOP &gop)
+{
+    while (!gop.isEmpty())
+    {
+        AVPacket *pkt = gop.takeFirst();
+        av_packet_free(&pkt);
+    }
+}
+
+int SmartCutter::Start(void)
+{
+    if (!InitInput() || !InitOutput())
+        return REENCODE_ERROR;
+
+    m_segments = BuildSegments(m_deleteMap, m_durMap, m_fps, m_startPts,
+                               m_videoTimeBase);
+    if (m_segments.isEmpty())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "The cutlist removes the whole file");
+        return REENCODE_ERROR;
+    }
+
+    for (int i = 0; i < m_segments.size(); i++)
+    {
+        LOG(VB_GENERAL, LOG_INFO, LOC +
+            QString("Keeping frames from %1, pts %2 to %3")
+                .arg(m_segments[i].startFrame).arg(m_segments[i].start)
+                .arg((m_segments[i].end == INT64_MAX) ?
+                     QString("end") : QString::number(m_segments[i].end)));
+    }
+
+    m_outputPts = m_startPts;
+    QList<Segment>::const_iterator it = m_segments.begin();
+    for (; it != m_segments.end(); ++it)
+    {
+        int ret = ProcessSegment(*it);
+        if (ret != REENCODE_OK)
+            return ret;
+        if ((*it).end != INT64_MAX)
+            m_outputPts += (*it).end - (*it).start;
+    }
+
+    if (av_write_trailer(m_outputFC) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Failed to finish " + m_outfile);
+        return REENCODE_ERROR;
+    }
+
+    LOG(VB_GENERAL, LOG_INFO, LOC + QString("Wrote %1 video frames to %2")
+        .arg(m_outFrames).arg(m_outfile));
+
+    return REENCODE_OK;
+}
+
+/// Only MPEG-TS recordings can be smart cut, other containers aren't.
+bool SmartCutter::IsSupportedFile(const QString &filename)
+{
+    av_register_all();
+
+    AVFormatContext *fc = NULL;
+    QByteArray fname = filename.toLocal8Bit();
+    if (avformat_open_input(&fc, fname.constData(), NULL, NULL) < 0)
+        return false;
+
+    bool supported = (strcmp(fc->iformat->name, "mpegts") == 0);
+    avformat_close_input(&fc);
+
+    return supported;
+}
+
+bool SmartCutter::InitInput(void)
+{
+    av_register_all();
+
+    QByteArray fname = m_infile.toLocal8Bit();
+    if (avformat_open_input(&m_inputFC, fname.constData(), NULL, NULL) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Couldn't open " + m_infile);
+        return false;
+    }
+
+    if (avformat_find_stream_info(m_inputFC, NULL) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Couldn't get stream info for " +
+            m_infile);
+        return false;
+    }
+
+    if (strcmp(m_inputFC->iformat->name, "mpegts") != 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Only MPEG-TS recordings can be smart cut, %1 is %2")
+                .arg(m_infile).arg(m_inputFC->iformat->name));
+        return false;
+    }
+
+    m_videoIndex = av_find_best_stream(m_inputFC, AVMEDIA_TYPE_VIDEO,
+                                       -1, -1, NULL, 0);
+    if (m_videoIndex < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "No video stream in " + m_infile);
+        return false;
+    }
+
+    AVStream *st = m_inputFC->streams[m_videoIndex];
+    AVCodecID codec_id = st->codecpar->codec_id;
+    if (!IsSupported(codec_id))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Smart cutting isn't supported for %1 video")
+                .arg(avcodec_get_name(codec_id)));
+        return false;
+    }
+
+    m_videoTimeBase = st->time_base;
+    AVRational rate = st->avg_frame_rate.num ? st->avg_frame_rate :
+                                               st->r_frame_rate;
+    if (rate.num && rate.den)
+        m_fps = av_q2d(rate);
+    if (st->start_time != AV_NOPTS_VALUE)
+        m_startPts = st->start_time;
+
+    AVCodec *decoder = avcodec_find_decoder(codec_id);
+    if (!decoder)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("No decoder for %1")
+            .arg(avcodec_get_name(codec_id)));
+        return false;
+    }
+
+    m_decoder = avcodec_alloc_context3(decoder);
+    if (!m_decoder ||
+        avcodec_parameters_to_context(m_decoder, st->codecpar) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Couldn't set up the video decoder");
+        return false;
+    }
+    m_decoder->pkt_timebase = st->time_base;
+
+    if (avcodec_open2(m_decoder, decoder, NULL) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Couldn't open the video decoder");
+        return false;
+    }
+
+    m_canEncode = (avcodec_find_encoder(codec_id) != NULL);
+    if (!m_canEncode)
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            QString("No %1 encoder available, cut points will be moved "
+                    "to the next keyframe").arg(avcodec_get_name(codec_id)));
+    }
+
+    m_frame = av_frame_alloc();
+
+    return m_frame != NULL;
+}
+
+bool SmartCutter::InitOutput(void)
+{
+    QByteArray fname = m_outfile.toLocal8Bit();
+    avformat_alloc_output_context2(&m_outputFC, NULL, "mpegts",
+                                   fname.constData());
+    if (!m_outputFC)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Couldn't create the MPEG-TS muxer");
+        return false;
+    }
+
+    for (uint i = 0; i < m_inputFC->nb_streams; i++)
+    {
+        AVStream *in = m_inputFC->streams[i];
+
+        if ((int)i != m_videoIndex)
+        {
+            if (in->codecpar->codec_type != AVMEDIA_TYPE_AUDIO)
+                continue;
+            if (!m_allAudio && in->codecpar->channels == 0)
+                continue;
+        }
+
+        AVStream *out = avformat_new_stream(m_outputFC, NULL);
+        if (!out || avcodec_parameters_copy(out->codecpar, in->codecpar) < 0)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC + "Couldn't create output stream");
+            return false;
+        }
+        out->codecpar->codec_tag = 0;
+        out->time_base = in->time_base;
+        av_dict_copy(&out->metadata, in->metadata, 0);
+
+        m_streamMap[i] = out->index;
+    }
+
+    if (avio_open(&m_outputFC->pb, fname.constData(), AVIO_FLAG_WRITE) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Couldn't open " + m_outfile);
+        return false;
+    }
+
+    if (avformat_write_header(m_outputFC, NULL) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Couldn't write header of " +
+            m_outfile);
+        return false;
+    }
+
+    return true;
+}
+
+/** \fn SmartCutter::BuildSegments(const frm_dir_map_t&, const frm_pos_map_t&, double, int64_t, AVRational)
+ *  \brief Turns the cutlist into the list of sections to keep.
+ *
+ *   A cut includes both its start and end frame.
+ */
+QList<SmartCutter::Segment> SmartCutter::BuildSegments(
+    const frm_dir_map_t &deleteMap, const frm_pos_map_t &durMap,
+    double fps, int64_t startPts, AVRational timeBase)
+{
+    QList<Segment> segments;
+
+    uint64_t keep = 0;
+    bool cutting = false;
+
+    frm_dir_map_t::const_iterator it = deleteMap.begin();
+    for (; it != deleteMap.end(); ++it)
+    {
+        if (*it == MARK_CUT_START)
+        {
+            if (!cutting && it.key() > keep)
+            {
+                Segment seg;
+                seg.startFrame = keep;
+                seg.start = FrameToPts(keep, durMap, fps, startPts, timeBase);
+                seg.end   = FrameToPts(it.key(), durMap, fps, startPts,
+                                       timeBase);
+                segments.push_back(seg);
+            }
+            cutting = true;
+        }
+        else if (*it == MARK_CUT_END)
+        {
+            keep = it.key() + 1;
+            cutting = false;
+        }
+    }
+
+    if (!cutting)
+    {
+        Segment seg;
+        seg.startFrame = keep;
+        seg.start      = FrameToPts(keep, durMap, fps, startPts, timeBase);
+        seg.end        = INT64_MAX;
+        segments.push_back(seg);
+    }
+
+    return segments;
+}
+
+/// Converts a frame number to a pts using the duration map of the recording.
+int64_t SmartCutter::FrameToPts(uint64_t frame, const frm_pos_map_t &durMap,
+                                double fps, int64_t startPts,
+                                AVRational timeBase)
+{
+    double ms = frame * 1000.0 / fps;
+
+    frm_pos_map_t::const_iterator it = durMap.upperBound(frame);
+    if (!durMap.isEmpty() && it != durMap.begin())
+    {
+        --it;
+        ms = *it + (frame - it.key()) * 1000.0 / fps;
+    }
+
+    AVRational ms_tb = { 1, 1000 };
+    return startPts + av_rescale_q(llrint(ms), ms_tb, timeBase);
+}
+
+/** \fn SmartCutter::Unwrap(int64_t, int64_t, int)
+ *  \brief Moves a timestamp that wrapped at wrapBits bits, 33 for MPEG-TS,
+ *         to the wrap period of the reference.
+ *
+ *   Timestamps are taken to be within half a period, about 13 hours for
+ *   MPEG-TS, of the reference.
+ */
+int64_t SmartCutter::Unwrap(int64_t ts, int64_t reference, int wrapBits)
+{
+    if (ts == AV_NOPTS_VALUE || reference == AV_NOPTS_VALUE ||
+        wrapBits <= 0 || wrapBits >= 63)
+    {
+        return ts;
+    }
+
+    int64_t wrap = INT64_C(1) << wrapBits;
+    while (ts < reference - wrap / 2)
+        ts += wrap;
+    while (ts >= reference + wrap / 2)
+        ts -= wrap;
+
+    return ts;
+}
+
+/** \fn SmartCutter::UnwrapTimestamps(AVPacket*)
+ *  \brief Makes the timestamps of a packet read from the input continue
+ *         on from the previous packet of its stream across a wrap.
+ */
+void SmartCutter::UnwrapTimestamps(AVPacket *pkt)
+{
+    AVStream *st = m_inputFC->streams[pkt->stream_index];
+    int64_t &reference = m_tsReference[pkt->stream_index];
+
+    pkt->pts = Unwrap(pkt->pts, reference, st->pts_wrap_bits);
+    pkt->dts = Unwrap(pkt->dts, reference, st->pts_wrap_bits);
+
+    if (pkt->dts != AV_NOPTS_VALUE)
+        reference = pkt->dts;
+    else if (pkt->pts != AV_NOPTS_VALUE)
+        reference = pkt->pts;
+}
+
+/** \fn SmartCutter::SeekToSegment(const Segment&)
+ *  \brief Seeks to a keyframe before the start of a segment, using the
+ *         keyframe seek table when the recording has one.
+ */
+bool SmartCutter::SeekToSegment(const Segment &seg)
+{
+    if (seg.startFrame == 0)
+        return av_seek_frame(m_inputFC, -1, 0, AVSEEK_FLAG_BYTE) >= 0;
+
+    frm_pos_map_t::const_iterator it = m_posMap.upperBound(seg.startFrame);
+    if (!m_posMap.isEmpty() && it != m_posMap.begin())
+    {
+        // Step back one more GOP, so the head of the segment can be
+        // decoded even if the seek table is slightly off.
+        --it;
+        if (it != m_posMap.begin())
+            --it;
+        return av_seek_frame(m_inputFC, -1, *it, AVSEEK_FLAG_BYTE) >= 0;
+    }
+
+    return av_seek_frame(m_inputFC, m_videoIndex, seg.start,
+                         AVSEEK_FLAG_BACKWARD) >= 0;
+}
+
+/** \fn SmartCutter::ProcessSegment(const Segment&)
+ *  \brief Writes one kept section to the output.
+ *
+ *   Video packets before the first keyframe of the segment are decoded
+ *   so the head of the segment can be re-encoded. From then on packets
+ *   are collected a GOP at a time; once the next keyframe is seen a GOP
+ *   that ends before the cut point is copied and the GOP that contains
+ *   the cut point is re-encoded up to it. Audio packets inside the
+ *   segment are copied.
+ */
+int SmartCutter::ProcessSegment(const Segment &seg)
+{
+    if (!SeekToSegment(seg))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Seek to frame %1 failed")
+            .arg(seg.startFrame));
+        return REENCODE_ERROR;
+    }
+
+    avcodec_flush_buffers(m_decoder);
+    FreeGOP(m_prevGOP);
+
+    // Leave room for the decoding delay of the first pictures of the
+    // segment after the last picture of the previous one, so the dts
+    // keep increasing where the segments meet
+    if (m_lastVideoDts != AV_NOPTS_VALUE)
+        m_outputPts = max(m_outputPts, m_lastVideoDts + m_videoDelay + 1);
+
+    m_ptsOffset    = seg.start - m_outputPts;
+    m_lastVideoPts = seg.start - 1;
+    m_headDone     = false;
+
+    // Timestamps are unwrapped from the start of the segment on
+    m_tsReference.clear();
+    QMap<int, int>::const_iterator sit = m_streamMap.begin();
+    for (; sit != m_streamMap.end(); ++sit)
+    {
+        m_tsReference[sit.key()] =
+            av_rescale_q(seg.start, m_videoTimeBase,
+                         m_inputFC->streams[sit.key()]->time_base);
+    }
+
+    int64_t end_margin = INT64_MAX;
+    if (seg.end != INT64_MAX)
+    {
+        AVRational sec = { 1, 1 };
+        end_margin = seg.end + av_rescale_q(2, sec, m_videoTimeBase);
+    }
+
+    int audio_count = m_streamMap.size() - 1;
+    QMap<int, bool> audio_done;
+    bool video_done = false;
+    bool synced = false;
+    bool ok = true;
+    GOP gop;
+
+    AVPacket pkt;
+    av_init_packet(&pkt);
+    pkt.data = NULL;
+    pkt.size = 0;
+
+    while (ok && av_read_frame(m_inputFC, &pkt) >= 0)
+    {
+        if (!UpdateStatus(pkt.pos))
+        {
+            av_packet_unref(&pkt);
+            FreeGOP(gop);
+            return REENCODE_STOPPED;
+        }
+
+        if (!m_streamMap.contains(pkt.stream_index))
+        {
+            av_packet_unref(&pkt);
+            continue;
+        }
+
+        UnwrapTimestamps(&pkt);
+
+        if (pkt.stream_index != m_videoIndex)
+        {
+            // The segment is in video time base, audio may have its own
+            AVStream *st = m_inputFC->streams[pkt.stream_index];
+            int64_t pts = (pkt.pts == AV_NOPTS_VALUE) ? AV_NOPTS_VALUE :
+                av_rescale_q(pkt.pts, st->time_base, m_videoTimeBase);
+
+            if (pts != AV_NOPTS_VALUE && pts >= seg.end)
+                audio_done[pkt.stream_index] = true;
+            else if (pts != AV_NOPTS_VALUE && pts >= seg.start)
+                ok = WritePacket(&pkt);
+            av_packet_unref(&pkt);
+
+            if (video_done && audio_done.size() >= audio_count)
+                break;
+            continue;
+        }
+
+        if (pkt.pts != AV_NOPTS_VALUE && pkt.dts != AV_NOPTS_VALUE)
+            m_videoDelay = max(m_videoDelay, pkt.pts - pkt.dts);
+
+        if (video_done)
+        {
+            bool past = (pkt.dts != AV_NOPTS_VALUE) && (pkt.dts > end_margin);
+            av_packet_unref(&pkt);
+            if (past)
+                break;
+            continue;
+        }
+
+        bool key = pkt.flags & AV_PKT_FLAG_KEY;
+        synced |= key;
+
+        if (key && pkt.pts != AV_NOPTS_VALUE && pkt.pts >= seg.start)
+        {
+            bool last = (pkt.pts >= seg.end);
+            if (!gop.isEmpty())
+            {
+                ok = ProcessGOP(seg, gop, last);
+            }
+            else if (last)
+            {
+                // no keyframe inside the segment, all of it is re-encoded
+                ok = DrainDecoder(seg.end) && FinishEncoder();
+                m_headDone = true;
+            }
+
+            if (last)
+                video_done = true;
+            else
+                gop.push_back(av_packet_clone(&pkt));
+        }
+        else if (!gop.isEmpty())
+        {
+            gop.push_back(av_packet_clone(&pkt));
+        }
+        else if (synced)
+        {
+            ok = Decode(&pkt, seg.end);
+            if (ok && (pkt.dts != AV_NOPTS_VALUE) && (pkt.dts >= seg.end))
+            {
+                ok = DrainDecoder(seg.end) && FinishEncoder();
+                m_headDone = true;
+                video_done = true;
+            }
+        }
+
+        av_packet_unref(&pkt);
+    }
+
+    if (ok && !video_done)
+    {
+        if (!gop.isEmpty())
+            ok = ProcessGOP(seg, gop, true);
+        else if (!m_headDone)
+            ok = DrainDecoder(seg.end) && FinishEncoder();
+    }
+
+    FreeGOP(gop);
+    FreeGOP(m_prevGOP);
+
+    return ok ? REENCODE_OK : REENCODE_ERROR;
+}
+
+/** \fn SmartCutter::ProcessGOP(const Segment&, GOP&, bool)
+ *  \brief Outputs a complete GOP of the current segment.
+ *
+ *   The first GOP also completes the head of the segment: its keyframe
+ *   and leading pictures are decoded after the pre-roll so that every
+ *   picture between the cut point and the keyframe can be re-encoded.
+ *
+ *  \param last true if the GOP contains the end of the segment, in which
+ *              case it is re-encoded up to the end of the segment instead
+ *              of being copied.
+ */
+bool SmartCutter::ProcessGOP(const Segment &seg, GOP &gop, bool last)
+{
+    int64_t key_pts = gop.first()->pts;
+
+    if (!m_headDone)
+    {
+        int64_t head_end = min(key_pts, seg.end);
+        GOP::iterator it = gop.begin();
+        for (; it != gop.end(); ++it)
+        {
+            if (it != gop.begin() && (*it)->pts > key_pts)
+                break;
+            if (!Decode(*it, head_end))
+                return false;
+        }
+        if (!DrainDecoder(head_end) || !FinishEncoder())
+            return false;
+
+        // Anything before the keyframe that could not be re-encoded is lost,
+        // its leading pictures can't be copied without their references.
+        m_lastVideoPts = max(m_lastVideoPts, key_pts - 1);
+        m_headDone = true;
+    }
+
+    if (!last)
+        return CopyGOP(gop);
+
+    if (!m_canEncode || key_pts >= seg.end)
+    {
+        FreeGOP(gop);
+        return true;
+    }
+
+    // Leading pictures of this GOP reference the previous GOP, which was
+    // copied, so it is decoded again without output.
+    bool leading = false;
+    for (int i = 1; i < gop.size(); i++)
+        leading |= (gop[i]->pts != AV_NOPTS_VALUE && gop[i]->pts < key_pts);
+
+    bool ok = true;
+    avcodec_flush_buffers(m_decoder);
+    if (leading)
+    {
+        for (int i = 0; ok && i < m_prevGOP.size(); i++)
+            ok = Decode(m_prevGOP[i], seg.end);
+    }
+    for (int i = 0; ok && i < gop.size(); i++)
+        ok = Decode(gop[i], seg.end);
+    ok = ok && DrainDecoder(seg.end) && FinishEncoder();
+
+    FreeGOP(gop);
+    return ok;
+}
+
+/// Copies a GOP, leaving out leading pictures that are already in the output.
+bool SmartCutter::CopyGOP(GOP &gop)
+{
+    int64_t threshold = m_lastVideoPts;
+
+    GOP::iterator it = gop.begin();
+    for (; it != gop.end(); ++it)
+    {
+        if ((*it)->pts == AV_NOPTS_VALUE)
+        {
+            if (!WritePacket(*it))
+                return false;
+            continue;
+        }
+        if ((*it)->pts <= threshold)
+            continue;
+        if (!WritePacket(*it))
+            return false;
+        m_lastVideoPts = max(m_lastVideoPts, (*it)->pts);
+    }
+
+    FreeGOP(m_prevGOP);
+    m_prevGOP = gop;
+    gop.clear();
+
+    return true;
+}
+
+/** \fn SmartCutter::Decode(AVPacket*, int64_t)
+ *  \brief Decodes a video packet, re-encoding any pictures that come out
+ *         after the last picture output and before the pts before.
+ */
+bool SmartCutter::Decode(AVPacket *pkt, int64_t before)
+{
+    if (!m_canEncode)
+        return true;
+
+    int ret = avcodec_send_packet(m_decoder, pkt);
+    if (ret < 0 && ret != AVERROR(EAGAIN))
+    {
+        // A damaged picture only costs us that picture
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            QString("Failed to decode picture at pts %1").arg(pkt->pts));
+    }
+
+    return ReceiveFrames(before);
+}
+
+/// Flushes the decoder, re-encoding the remaining pictures before before.
+bool SmartCutter::DrainDecoder(int64_t before)
+{
+    if (!m_canEncode)
+        return true;
+
+    avcodec_send_packet(m_decoder, NULL);
+    bool ok = ReceiveFrames(before);
+    avcodec_flush_buffers(m_decoder);
+
+    return ok;
+}
+
+bool SmartCutter::ReceiveFrames(int64_t before)
+{
+    while (avcodec_receive_frame(m_decoder, m_frame) >= 0)
+    {
+        int64_t pts = av_frame_get_best_effort_timestamp(m_frame);
+        bool ok = true;
+        if (pts != AV_NOPTS_VALUE && pts > m_lastVideoPts && pts < before)
+        {
+            m_frame->pts = pts;
+            ok = EncodeFrame(m_frame);
+        }
+        av_frame_unref(m_frame);
+        if (!ok)
+            return false;
+    }
+
+    return true;
+}
+
+bool SmartCutter::OpenEncoder(const AVFrame *frame)
+{
+    AVCodec *codec = avcodec_find_encoder(m_decoder->codec_id);
+    if (!codec)
+        return false;
+
+    m_encoder = avcodec_alloc_context3(codec);
+    if (!m_encoder)
+        return false;
+
+    AVStream *st = m_inputFC->streams[m_videoIndex];
+    int64_t bitrate = st->codecpar->bit_rate ? st->codecpar->bit_rate :
+                      m_inputFC->bit_rate ? m_inputFC->bit_rate :
+                      kSmartCutDefaultBitrate;
+
+    m_encoder->width               = frame->width;
+    m_encoder->height              = frame->height;
+    m_encoder->pix_fmt             = (AVPixelFormat) frame->format;
+    m_encoder->sample_aspect_ratio = frame->sample_aspect_ratio;
+    m_encoder->time_base           = m_videoTimeBase;
+    m_encoder->framerate           = av_d2q(m_fps, 100000);
+    m_encoder->bit_rate            = bitrate;
+    m_encoder->color_primaries     = m_decoder->color_primaries;
+    m_encoder->color_trc           = m_decoder->color_trc;
+    m_encoder->colorspace          = m_decoder->colorspace;
+    m_encoder->color_range         = m_decoder->color_range;
+    // No B-frames, so re-encoded pictures keep pts order and their dts can
+    // be lined up with the copied pictures around them.
+    m_encoder->max_b_frames        = 0;
+    if (frame->interlaced_frame)
+    {
+        m_encoder->flags |= AV_CODEC_FLAG_INTERLACED_DCT |
+                            AV_CODEC_FLAG_INTERLACED_ME;
+        m_encoder->field_order = frame->top_field_first ? AV_FIELD_TT :
+                                                          AV_FIELD_BB;
+    }
+
+    // Only used by libx264 and libx265, other encoders ignore them
+    av_opt_set(m_encoder->priv_data, "preset", "fast", 0);
+    av_opt_set(m_encoder->priv_data, "crf", "18", 0);
+
+    if (avcodec_open2(m_encoder, codec, NULL) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Couldn't open %1 encoder")
+            .arg(codec->name));
+        avcodec_free_context(&m_encoder);
+        return false;
+    }
+
+    return true;
+}
+
+bool SmartCutter::EncodeFrame(AVFrame *frame)
+{
+    if (!m_encoder && !OpenEncoder(frame))
+        return false;
+
+    frame->pict_type = AV_PICTURE_TYPE_NONE;
+    if (avcodec_send_frame(m_encoder, frame) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Failed to encode picture at pts %1").arg(frame->pts));
+        return false;
+    }
+    m_lastVideoPts = frame->pts;
+
+    return ReceivePackets();
+}
+
+bool SmartCutter::ReceivePackets(void)
+{
+    AVPacket pkt;
+    av_init_packet(&pkt);
+    pkt.data = NULL;
+    pkt.size = 0;
+
+    while (true)
+    {
+        int ret = avcodec_receive_packet(m_encoder, &pkt);
+        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF)
+            return true;
+        if (ret < 0)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC + "Failed to encode picture");
+            return false;
+        }
+
+        // Without B-frames any dts after the last one written and up to
+        // the pts is valid. Keep the decoding delay of the copied pictures
+        // where the pictures already written allow it.
+        pkt.stream_index = m_videoIndex;
+        if (pkt.pts != AV_NOPTS_VALUE)
+        {
+            pkt.dts = pkt.pts - m_videoDelay;
+            if (m_lastVideoDts != AV_NOPTS_VALUE)
+                pkt.dts = max(pkt.dts, m_lastVideoDts + m_ptsOffset + 1);
+        }
+
+        bool ok = WritePacket(&pkt);
+        av_packet_unref(&pkt);
+        if (!ok)
+            return false;
+    }
+}
+
+/// Flushes and closes the encoder, a new one is opened for the next cut.
+bool SmartCutter::FinishEncoder(void)
+{
+    if (!m_encoder)
+        return true;
+
+    bool ok = (avcodec_send_frame(m_encoder, NULL) >= 0) && ReceivePackets();
+    avcodec_free_context(&m_encoder);
+
+    return ok;
+}
+
+/** \fn SmartCutter::WritePacket(AVPacket*)
+ *  \brief Writes a packet of the input stream to the output with the cut
+ *         out time removed from its timestamps.
+ */
+bool SmartCutter::WritePacket(AVPacket *pkt)
+{
+    AVStream *in  = m_inputFC->streams[pkt->stream_index];
+    int       idx = m_streamMap[pkt->stream_index];
+    AVStream *out = m_outputFC->streams[idx];
+    bool    video = (pkt->stream_index == m_videoIndex);
+
+    // The offset is in video time base, each stream may have its own
+    int64_t offset = av_rescale_q(m_ptsOffset, m_videoTimeBase,
+                                  in->time_base);
+
+    AVPacket opkt;
+    if (av_packet_ref(&opkt, pkt) < 0)
+        return false;
+
+    if (opkt.pts != AV_NOPTS_VALUE)
+        opkt.pts -= offset;
+    if (opkt.dts != AV_NOPTS_VALUE)
+        opkt.dts -= offset;
+    av_packet_rescale_ts(&opkt, in->time_base, out->time_base);
+    opkt.stream_index = idx;
+    opkt.pos = -1;
+
+    // The muxer insists on increasing dts that don't come after the pts.
+    // Anything else is a mistake in the cut, so the packet is reported and
+    // dropped rather than given made up timestamps.
+    if (opkt.dts != AV_NOPTS_VALUE &&
+        ((m_lastDts.contains(idx) && opkt.dts <= m_lastDts[idx]) ||
+         (opkt.pts != AV_NOPTS_VALUE && opkt.pts < opkt.dts)))
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            QString("Dropping packet of stream %1 with dts %2 pts %3, "
+                    "previous dts %4")
+                .arg(idx).arg(opkt.dts).arg(opkt.pts)
+                .arg(m_lastDts.value(idx, AV_NOPTS_VALUE)));
+        av_packet_unref(&opkt);
+        return true;
+    }
+    if (opkt.dts != AV_NOPTS_VALUE)
+        m_lastDts[idx] = opkt.dts;
+
+    if (video)
+    {
+        if (pkt->dts != AV_NOPTS_VALUE)
+            m_lastVideoDts = pkt->dts - m_ptsOffset;
+
+        // The muxer may still hold packets that go before this one, so
+        // the keyframe lands at or after the current position. Seeking
+        // there and reading on finds it.
+        if ((opkt.flags & AV_PKT_FLAG_KEY) && pkt->pts != AV_NOPTS_VALUE)
+        {
+            AVRational ms_tb = { 1, 1000 };
+            m_outPosMap[m_outFrames] = avio_tell(m_outputFC->pb);
+            m_outDurMap[m_outFrames] =
+                av_rescale_q(pkt->pts - m_ptsOffset - m_startPts,
+                             m_videoTimeBase, ms_tb);
+        }
+        m_outFrames++;
+    }
+
+    // Video is held back a GOP at a time while audio is written as it is
+    // read, so the muxer interleaves the streams by dts. It takes over
+    // the packet's reference.
+    int ret = av_interleaved_write_frame(m_outputFC, &opkt);
+    av_packet_unref(&opkt);
+
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Failed to write to " + m_outfile);
+        return false;
+    }
+
+    return true;
+}
+
+bool SmartCutter::UpdateStatus(int64_t pos)
+{
+    if (!(m_showProgress || m_updateStatus) ||
+        MythDate::current() <= m_statusTime)
+    {
+        return true;
+    }
+
+    float percent_done = (m_fileSize > 0 && pos >= 0) ?
+        100.0 * pos / m_fileSize : 0.0;
+    if (m_updateStatus)
+        m_updateStatus(percent_done);
+    if (m_showProgress)
+        LOG(VB_GENERAL, LOG_INFO, QString("%1% complete")
+                .arg(percent_done, 0, 'f', 1));
+    if (m_checkAbort && m_checkAbort())
+        return false;
+
+    m_statusTime = MythDate::current().addSecs(m_statusUpdateTime);
+    return true;
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,140 @@
+#ifndef SMARTCUT_H
+#define SMARTCUT_H
+
+#include <stdint.h>
+
+extern "C"
+{
+#include "libavcodec/avcodec.h"
+#include "libavformat/avformat.h"
+}
+
+// Qt
+#include <QDateTime>
+#include <QString>
+#include <QList>
+#include <QMap>
+
+// MythTV
+#include "transcodedefs.h"
+#include "programtypes.h"
+
+/** \class SmartCutter
+ *  \brief Applies a cutlist to an H.264 or HEVC MPEG-TS recording without
+ *         re-encoding all of it.
+ *
+ *   Whole GOPs that lie inside a kept section are stream copied. Only the
+ *   frames between a cut point and the nearest keyframe are decoded and
+ *   re-encoded, so the cost is mostly I/O. The keyframe seek table of the
+ *   recording is used to jump directly to each kept section, and a new
+ *   seek table is built for the output while it is written.
+ *
+ *   If no encoder is available for the video codec the cut points are
+ *   moved to the nearest following keyframe instead.
+ */
+class SmartCutter
+{
+  public:
+    SmartCutter(const QString &inf, const QString &outf,
+                const frm_dir_map_t &deleteMap,
+                const frm_pos_map_t &posMap, const frm_pos_map_t &durMap,
+                bool showprog, void (*update_func)(float) = NULL,
+                int (*check_func)() = NULL);
+    ~SmartCutter();
+
+    int Start(void);
+    void SetAllAudio(bool keep) { m_allAudio = keep; }
+
+    static bool IsSupported(AVCodecID codec_id)
+    {
+        return codec_id == AV_CODEC_ID_H264 || codec_id == AV_CODEC_ID_HEVC;
+    }
+    static bool IsSupportedFile(const QString &filename);
+
+    /// Seek table of the output file, valid after Start() succeeds
+    const frm_pos_map_t &GetPositionMap(void) const { return m_outPosMap; }
+    const frm_pos_map_t &GetDurationMap(void) const { return m_outDurMap; }
+
+    class Segment
+    {
+      public:
+        uint64_t startFrame;
+        int64_t  start;       ///< first kept pts, in video time base
+        int64_t  end;         ///< first pts that is cut again
+    };
+
+    static QList<Segment> BuildSegments(const frm_dir_map_t &deleteMap,
+                                        const frm_pos_map_t &durMap,
+                                        double fps, int64_t startPts,
+                                        AVRational timeBase);
+    static int64_t FrameToPts(uint64_t frame, const frm_pos_map_t &durMap,
+                              double fps, int64_t startPts,
+                              AVRational timeBase);
+    static int64_t Unwrap(int64_t ts, int64_t reference, int wrapBits);
+
+  private:
+    typedef QList<AVPacket*> GOP;
+
+    bool InitInput(void);
+    bool InitOutput(void);
+    void UnwrapTimestamps(AVPacket *pkt);
+    bool SeekToSegment(const Segment &seg);
+    int ProcessSegment(const Segment &seg);
+    bool ProcessGOP(const Segment &seg, GOP &gop, bool last);
+    bool CopyGOP(GOP &gop);
+    bool Decode(AVPacket *pkt, int64_t before);
+    bool DrainDecoder(int64_t before);
+    bool ReceiveFrames(int64_t before);
+    bool OpenEncoder(const AVFrame *frame);
+    bool EncodeFrame(AVFrame *frame);
+    bool ReceivePackets(void);
+    bool FinishEncoder(void);
+    bool WritePacket(AVPacket *pkt);
+    bool UpdateStatus(int64_t pos);
+    static void FreeGOP(GOP &gop);
+
+    QString m_infile;
+    QString m_outfile;
+
+    frm_dir_map_t m_deleteMap;
+    frm_pos_map_t m_posMap;
+    frm_pos_map_t m_durMap;
+    frm_pos_map_t m_outPosMap;
+    frm_pos_map_t m_outDurMap;
+    QList<Segment> m_segments;
+
+    AVFormatContext *m_inputFC;
+    AVFormatContext *m_outputFC;
+    AVCodecContext  *m_decoder;
+    AVCodecContext  *m_encoder;
+    AVFrame         *m_frame;
+    bool             m_canEncode;
+    bool             m_allAudio;
+
+    int              m_videoIndex;
+    QMap<int, int>   m_streamMap;     ///< input stream -> output stream
+    QMap<int, int64_t> m_lastDts;     ///< per output stream
+    QMap<int, int64_t> m_tsReference; ///< last unwrapped dts, per input stream
+    AVRational       m_videoTimeBase;
+    double           m_fps;
+    int64_t          m_startPts;      ///< pts of frame 0
+    int64_t          m_outputPts;     ///< output pts of the current segment
+    int64_t          m_ptsOffset;     ///< subtracted from input timestamps
+    int64_t          m_videoDelay;    ///< largest pts - dts seen in the input
+    int64_t          m_lastVideoPts;  ///< last video pts output, input based
+    int64_t          m_lastVideoDts;  ///< last video dts output, output based
+    bool             m_headDone;      ///< segment head has been re-encoded
+    uint64_t         m_outFrames;
+
+    GOP              m_prevGOP;
+
+    bool             m_showProgress;
+    void           (*m_updateStatus)(float percent_done);
+    int            (*m_checkAbort)();
+    QDateTime        m_statusTime;
+    int              m_statusUpdateTime;
+    int64_t          m_fileSize;
+};
+
+#endif
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -0,0 +1,158 @@
+/*
+ *  Class TestSmartCut
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+
+#include "smartcut.h"
+
+// 25 fps in the 90kHz MPEG-TS time base, 3600 ticks a frame
+static const double     kFps      = 25.0;
+static const int64_t    kStartPts = 1000;
+static const AVRational kTimeBase = { 1, 90000 };
+static const int64_t    kWrap     = INT64_C(1) << 33;
+
+class TestSmartCut: public QObject
+{
+    Q_OBJECT
+
+    static QList<SmartCutter::Segment> Segments(
+        const frm_dir_map_t &deleteMap,
+        const frm_pos_map_t &durMap = frm_pos_map_t())
+    {
+        return SmartCutter::BuildSegments(deleteMap, durMap, kFps,
+                                          kStartPts, kTimeBase);
+    }
+
+  private slots:
+
+    void NoCutsKeepsEverything(void)
+    {
+        QList<SmartCutter::Segment> segs = Segments(frm_dir_map_t());
+
+        QCOMPARE(segs.size(), 1);
+        QCOMPARE(segs[0].startFrame, (uint64_t)0);
+        QCOMPARE(segs[0].start, kStartPts);
+        QCOMPARE(segs[0].end, (int64_t)INT64_MAX);
+    }
+
+    void KnownCutList(void)
+    {
+        frm_dir_map_t cuts;
+        cuts[100] = MARK_CUT_START;
+        cuts[199] = MARK_CUT_END;
+        cuts[500] = MARK_CUT_START;
+        cuts[599] = MARK_CUT_END;
+
+        QList<SmartCutter::Segment> segs = Segments(cuts);
+
+        QCOMPARE(segs.size(), 3);
+
+        QCOMPARE(segs[0].startFrame, (uint64_t)0);
+        QCOMPARE(segs[0].start, kStartPts);
+        QCOMPARE(segs[0].end,   kStartPts + 100 * 3600);
+
+        // A cut includes its end frame
+        QCOMPARE(segs[1].startFrame, (uint64_t)200);
+        QCOMPARE(segs[1].start, kStartPts + 200 * 3600);
+        QCOMPARE(segs[1].end,   kStartPts + 500 * 3600);
+
+        QCOMPARE(segs[2].startFrame, (uint64_t)600);
+        QCOMPARE(segs[2].start, kStartPts + 600 * 3600);
+        QCOMPARE(segs[2].end,   (int64_t)INT64_MAX);
+    }
+
+    void CutAtStart(void)
+    {
+        frm_dir_map_t cuts;
+        cuts[0]  = MARK_CUT_START;
+        cuts[99] = MARK_CUT_END;
+
+        QList<SmartCutter::Segment> segs = Segments(cuts);
+
+        QCOMPARE(segs.size(), 1);
+        QCOMPARE(segs[0].startFrame, (uint64_t)100);
+        QCOMPARE(segs[0].start, kStartPts + 100 * 3600);
+        QCOMPARE(segs[0].end,   (int64_t)INT64_MAX);
+    }
+
+    void CutToEnd(void)
+    {
+        frm_dir_map_t cuts;
+        cuts[300] = MARK_CUT_START;
+
+        QList<SmartCutter::Segment> segs = Segments(cuts);
+
+        QCOMPARE(segs.size(), 1);
+        QCOMPARE(segs[0].startFrame, (uint64_t)0);
+        QCOMPARE(segs[0].start, kStartPts);
+        QCOMPARE(segs[0].end,   kStartPts + 300 * 3600);
+    }
+
+    void CutEverything(void)
+    {
+        frm_dir_map_t cuts;
+        cuts[0] = MARK_CUT_START;
+
+        QVERIFY(Segments(cuts).isEmpty());
+    }
+
+    void DurationMapIsUsed(void)
+    {
+        // 10.4s at frame 250 rather than the 10s 25 fps would give
+        frm_pos_map_t durations;
+        durations[0]   = 0;
+        durations[250] = 10400;
+
+        frm_dir_map_t cuts;
+        cuts[100] = MARK_CUT_START;
+        cuts[299] = MARK_CUT_END;
+
+        QList<SmartCutter::Segment> segs = Segments(cuts, durations);
+
+        QCOMPARE(segs.size(), 2);
+        QCOMPARE(segs[0].end,   kStartPts + 4000 * 90);
+        QCOMPARE(segs[1].start, kStartPts + 12400 * 90);
+    }
+
+    void UnwrapLeavesNearbyTimestamps(void)
+    {
+        QCOMPARE(SmartCutter::Unwrap(5000, 1000, 33), (int64_t)5000);
+        QCOMPARE(SmartCutter::Unwrap(500, 1000, 33), (int64_t)500);
+        QCOMPARE(SmartCutter::Unwrap(kWrap - 500, kWrap - 1000, 33),
+                 kWrap - 500);
+        // Already unwrapped by the demuxer
+        QCOMPARE(SmartCutter::Unwrap(kWrap + 100, kWrap - 1000, 33),
+                 kWrap + 100);
+    }
+
+    void UnwrapAcrossTheWrap(void)
+    {
+        QCOMPARE(SmartCutter::Unwrap(100, kWrap - 1000, 33), kWrap + 100);
+        QCOMPARE(SmartCutter::Unwrap(kWrap - 100, 100, 33), (int64_t)-100);
+        QCOMPARE(SmartCutter::Unwrap(100, 3 * kWrap - 1000, 33),
+                 3 * kWrap + 100);
+    }
+
+    void UnwrapWithoutWrap(void)
+    {
+        QCOMPARE(SmartCutter::Unwrap(AV_NOPTS_VALUE, 1000, 33),
+                 (int64_t)AV_NOPTS_VALUE);
+        QCOMPARE(SmartCutter::Unwrap(100, AV_NOPTS_VALUE, 33), (int64_t)100);
+        QCOMPARE(SmartCutter::Unwrap(100, kWrap - 1000, 64), (int64_t)100);
+    }
+};
@@ -34,6 +34,7 @@
 
 #include "videodecodebuffer.h"
 #include "cutter.h"
+#include "smartcut.h"
 #include "audioreencodebuffer.h"
 
 extern "C" {
@@ -675,6 +676,15 @@ int Transcode::TranscodeFile(const QString &inputname,
             return REENCODE_MPEG2TRANS;
         }
 
+        if ((encodingType == "H.264" || encodingType == "HEVC") &&
+            get_int_option(m_recProfile, "transcodelossless") &&
+            SmartCutter::IsSupportedFile(inputname))
+        {
+            LOG(VB_GENERAL, LOG_NOTICE, "Switching to smart cutter.");
+            SetPlayerContext(NULL);
+            return REENCODE_SMARTCUT;
+        }
+
         // Recorder setup
         if (get_int_option(m_recProfile, "transcodelossless"))
         {
@@ -341,6 +341,19 @@ static HostCheckBoxSetting *DisableFirewireReset()
     return hc;
 }
 
+static HostCheckBoxSetting *VideoScanWatchDirs()
+{
+    HostCheckBoxSetting *hc = new HostCheckBoxSetting("VideoScanWatchDirs");
+    hc->setLabel(QObject::tr("Watch video directories for changes"));
+    hc->setHelpText(
+        QObject::tr(
+            "If enabled, the backend watches its local video directories "
+            "and rescans them shortly after files are added, moved or "
+            "removed, instead of waiting for a scan to be requested."));
+    hc->setValue(false);
+    return hc;
+}
+
 static HostTextEditSetting *MiscStatusScript()
 {
     HostTextEditSetting *he = new HostTextEditSetting("MiscStatusScript");
@@ -390,6 +403,19 @@ static GlobalSpinBoxSetting *EITCrawIdleStart()
     return gc;
 }
 
+static GlobalCheckBoxSetting *LiveTVPreTune()
+{
+    GlobalCheckBoxSetting *gc = new GlobalCheckBoxSetting("LiveTVPreTune");
+    gc->setLabel(QObject::tr("Pre-tune idle tuners for LiveTV"));
+    gc->setValue(false);
+    gc->setHelpText(QObject::tr("If enabled, the master backend tunes idle "
+                    "tuners to the channels a LiveTV viewer is likely to "
+                    "change to next, so the change is quicker. Tuners with a "
+                    "recording about to start are left alone. The master "
+                    "backend must be restarted for this to take effect."));
+    return gc;
+}
+
 static GlobalSpinBoxSetting *WOLbackendReconnectWaitTime()
 {
     GlobalSpinBoxSetting *gc = new GlobalSpinBoxSetting("WOLbackendReconnectWaitTime", 0, 1200, 5);
@@ -926,6 +952,7 @@ BackendSettings::BackendSettings() :
     fm->addChild(TruncateDeletes());
     fm->addChild(HDRingbufferSize());
     fm->addChild(StorageScheduler());
+    fm->addChild(VideoScanWatchDirs());
     group2->addChild(fm);
     GroupSetting* upnp = new GroupSetting();
     upnp->setLabel(QObject::tr("UPnP Server Settings"));
@@ -943,6 +970,11 @@ BackendSettings::BackendSettings() :
     group2a1->addChild(EITCrawIdleStart());
     addChild(group2a1);
 
+    GroupSetting* group2a2 = new GroupSetting();
+    group2a2->setLabel(QObject::tr("LiveTV Options"));
+    group2a2->addChild(LiveTVPreTune());
+    addChild(group2a2);
+
     GroupSetting* group3 = new GroupSetting();
     group3->setLabel(QObject::tr("Shutdown/Wakeup Options"));
     group3->addChild(startupCommand());
@@ -24,3 +24,16 @@ using_backend {
 }
 
 using_mythtranscode: SUBDIRS += mythtranscode
+
+# unit tests mythtranscode
+using_mythtranscode {
+    mythtranscode-test.depends = sub-mythtranscode
+    mythtranscode-test.target = buildtestmythtranscode
+    mythtranscode-test.commands = cd mythtranscode/test && $(QMAKE) && $(MAKE)
+    unix:QMAKE_EXTRA_TARGETS += mythtranscode-test
+
+    unittest.depends = mythtranscode-test
+    unittest.target = test
+    unittest.commands = scripts/unittests.sh
+    unix:QMAKE_EXTRA_TARGETS += unittest
+}